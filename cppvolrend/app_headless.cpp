@@ -0,0 +1,884 @@
+#include "app_headless.h"
+#ifdef USING_HEADLESS
+
+#include "renderingmanager.h"
+#include "volrenderbase.h"
+#include "utils/parameterspace.h"
+#include "utils/evaluationcheckpoint.h"
+#include "utils/uniformbenchmark.h"
+
+#ifndef USING_HEADLESS_OSMESA
+#include <EGL/eglext.h>
+#endif
+
+#include <gl_utils/memoryregistry.h>
+#include <gl_utils/profiler.h>
+#include <gl_utils/programcache.h>
+#include <gl_utils/timer.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio> // fprintf
+#include <cstdlib> // exit
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
+
+void ApplicationHeadless::PrintUsage ()
+{
+  printf("Usage: cppvolrend [options]\n");
+  printf("  --list                 print renderers, datasets, transfer functions and camera states\n");
+  printf("  --renderer <name>      volume renderer name, abbreviation or index\n");
+  printf("  --dataset <name>       structured dataset name\n");
+  printf("  --tf <name>            transfer function name\n");
+  printf("  --camera <name>        camera state name\n");
+  printf("  --path <a;b;...>       fly through the camera states, writing trace.csv (see utils/camerapath.h)\n");
+  printf("  --width <w>            image width\n");
+  printf("  --height <h>           image height\n");
+  printf("  --frames <n>           number of measured frames\n");
+  printf("  --warmup <n>           number of frames rendered before measuring\n");
+  printf("  --output <dir>         output directory for images and timing.csv\n");
+  printf("  --save-all-frames      write every measured frame, not only the last one\n");
+  printf("  --eval                 evaluate the parameter space of the renderer, writing eval.csv (see Evaluation.md)\n");
+  printf("  --bench <job file>     render every configuration of a benchmark job (see utils/benchmarkjob.h)\n");
+  printf("  --resume               continue the evaluation or benchmark stopped in the --output directory\n");
+  printf("  --gpu-budget <MB>      GPU memory budget, light caches are reduced to fit (see gl_utils/memoryregistry.h)\n");
+  printf("  --shader-cache <dir>   directory of the shader program binaries, default data folder/#shader_cache\n");
+  printf("  --no-shader-cache      always compile the shaders from source (cold start)\n");
+  printf("  --uniform-bench        CPU time to submit the ray caster parameters, named uniforms vs uniform block\n");
+  printf("  --trace <n>            capture the loading and the first n frames to profile.json, opened with ui.perfetto.dev\n");
+}
+
+ApplicationHeadless::ApplicationHeadless ()
+{
+  m_width = 0;
+  m_height = 0;
+  m_frames = 100;
+  m_warmup_frames = 5;
+  m_save_all_frames = false;
+  m_list_only = false;
+  m_uniform_bench = false;
+  m_evaluation = false;
+  m_resume = false;
+  m_trace_frames = 0;
+
+#ifdef USING_HEADLESS_OSMESA
+  m_osmesa_context = NULL;
+#else
+  m_egl_display = EGL_NO_DISPLAY;
+  m_egl_surface = EGL_NO_SURFACE;
+  m_egl_context = EGL_NO_CONTEXT;
+#endif
+}
+
+ApplicationHeadless::~ApplicationHeadless ()
+{
+}
+
+bool ApplicationHeadless::Init (int argc, char** argv)
+{
+  if (!ParseArguments(argc, argv))
+  {
+    PrintUsage();
+    return false;
+  }
+
+  // The job defines the size of the offscreen buffer
+  if (!m_bench_job_file.empty())
+  {
+    if (!m_bench_job.Read(m_bench_job_file)) return false;
+    if (m_bench_job.m_width > 0) m_width = m_bench_job.m_width;
+    if (m_bench_job.m_height > 0) m_height = m_bench_job.m_height;
+  }
+
+  if (m_width <= 0) m_width = RenderingManager::Instance()->GetScreenWidth();
+  if (m_height <= 0) m_height = RenderingManager::Instance()->GetScreenHeight();
+
+  if (!CreateContext())
+  {
+    fprintf(stderr, "Failed to create the offscreen OpenGL context\n");
+    return false;
+  }
+
+  // GLEW must be built for the same backend (GLEW_EGL or GLEW_OSMESA)
+  glewExperimental = GL_TRUE;
+  if (glewInit() != GLEW_OK)
+  {
+    printf("Glew didn't initialized!\n");
+    exit(EXIT_FAILURE);
+  }
+  // glewInit may leave an invalid enum error with core contexts
+  glGetError();
+  printf("Running OpenGL %s (%s)\n\n", glGetString(GL_VERSION), glGetString(GL_RENDERER));
+
+  // Started before the data is loaded, so the capture includes the preprocessing
+  if (m_trace_frames > 0)
+    gl::Profiler::Instance().Start(m_output_dir.empty() ? "profile.json" : m_output_dir + "/profile.json", m_trace_frames);
+
+  return true;
+}
+
+bool ApplicationHeadless::InitImGui ()
+{
+  // No interface is drawn, but renderers may still query the ImGui context
+  IMGUI_CHECKVERSION();
+  ImGui::CreateContext();
+
+  return true;
+}
+
+void ApplicationHeadless::MainLoop ()
+{
+  RenderingManager* rm = RenderingManager::Instance();
+  rm->SetImGuiRenderUI(false);
+
+  if (m_list_only)
+  {
+    rm->PrintSelectionLists();
+    return;
+  }
+
+  if (m_uniform_bench)
+  {
+    UniformBenchmark bench;
+    bench.Run(m_warmup_frames, m_frames);
+    bench.Print();
+    return;
+  }
+
+  if (!m_bench_job_file.empty())
+  {
+    if (!m_renderer.empty() && !rm->SelectVolumeRenderer(m_renderer))
+    {
+      fprintf(stderr, "Volume renderer \"%s\" not found (use --list)\n", m_renderer.c_str());
+      exit(EXIT_FAILURE);
+    }
+    rm->Reshape(m_width, m_height);
+    RunBenchmark();
+    return;
+  }
+
+  // Data first, so the renderer is only initialized once with it
+  if (!m_dataset.empty() && !rm->SelectVolume(m_dataset))
+  {
+    fprintf(stderr, "Dataset \"%s\" not found (use --list)\n", m_dataset.c_str());
+    exit(EXIT_FAILURE);
+  }
+  if (!m_transfer_function.empty() && !rm->SelectTransferFunction(m_transfer_function))
+  {
+    fprintf(stderr, "Transfer function \"%s\" not found (use --list)\n", m_transfer_function.c_str());
+    exit(EXIT_FAILURE);
+  }
+  if (!m_renderer.empty() && !rm->SelectVolumeRenderer(m_renderer))
+  {
+    fprintf(stderr, "Volume renderer \"%s\" not found or not supported by the dataset (use --list)\n", m_renderer.c_str());
+    exit(EXIT_FAILURE);
+  }
+  if (!m_camera_state.empty() && !rm->SelectCameraState(m_camera_state))
+  {
+    fprintf(stderr, "Camera state \"%s\" not found (use --list)\n", m_camera_state.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  rm->Reshape(m_width, m_height);
+
+  if (m_output_dir.empty()) m_output_dir = GetDefaultOutputDirectory("headless");
+  std::filesystem::create_directories(m_output_dir);
+
+  if (!m_camera_path.empty())
+  {
+    RunCameraPath();
+    return;
+  }
+
+  if (m_evaluation)
+  {
+    RunEvaluation();
+    return;
+  }
+
+  std::ofstream csvfile(m_output_dir + "/timing.csv", std::ios_base::out);
+  if (!csvfile.is_open())
+  {
+    fprintf(stderr, "Could not write \"%s/timing.csv\"\n", m_output_dir.c_str());
+    exit(EXIT_FAILURE);
+  }
+  csvfile << "frame,gpu_ms,cpu_ms\n";
+
+  printf("Rendering %d (+%d warm-up) frames of %dx%d with %s\n", m_frames, m_warmup_frames,
+    m_width, m_height, rm->GetCurrentVolumeRenderer()->GetName());
+
+  int n_image_errors = 0;
+  FrameStatistics stats = MeasureFrames(m_warmup_frames, m_frames, [&](int frame, double gpu_ms, double cpu_ms) {
+    csvfile << frame << "," << std::to_string(gpu_ms) << "," << std::to_string(cpu_ms) << "\n";
+
+    if (m_save_all_frames || frame == m_frames - 1)
+    {
+      std::string imagefilename = std::to_string(frame);
+      size_t n_zero = 4;
+      imagefilename = std::string(n_zero - std::min(n_zero, imagefilename.length()), '0') + imagefilename + ".png";
+      if (!rm->SaveScreenshot(m_output_dir + "/" + imagefilename)) n_image_errors++;
+    }
+  });
+  csvfile.close();
+
+  if (m_frames > 0)
+  {
+    printf("GPU: %.3f ms/frame (min %.3f, max %.3f) - CPU: %.3f ms/frame\n",
+      stats.mean_gpu_ms, stats.min_gpu_ms, stats.max_gpu_ms, stats.mean_cpu_ms);
+  }
+  if (n_image_errors > 0)
+  {
+    fprintf(stderr, "%d images could not be written to \"%s\"\n", n_image_errors, m_output_dir.c_str());
+    exit(EXIT_FAILURE);
+  }
+  printf("Results written to \"%s\"\n", m_output_dir.c_str());
+}
+
+ApplicationHeadless::FrameStatistics ApplicationHeadless::MeasureFrames (int warmup, int frames,
+  const std::function<void(int, double, double)>& on_frame)
+{
+  RenderingManager* rm = RenderingManager::Instance();
+
+  gl::Timer gpu_timer;
+  FrameStatistics stats = { 0.0, 0.0, 0.0, 0.0 };
+  for (int i = 0; i < warmup + frames; i++)
+  {
+    // Every frame is rendered from scratch
+    rm->GetCurrentVolumeRenderer()->SetOutdated();
+
+    auto cpu_start = std::chrono::high_resolution_clock::now();
+    gpu_timer.Start();
+    rm->Display();
+    double gpu_ms = gpu_timer.End();
+    glFinish();
+    double cpu_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - cpu_start).count();
+
+    int frame = i - warmup;
+    if (frame < 0) continue;
+
+    stats.mean_gpu_ms += gpu_ms;
+    stats.mean_cpu_ms += cpu_ms;
+    stats.min_gpu_ms = (frame == 0) ? gpu_ms : std::min(stats.min_gpu_ms, gpu_ms);
+    stats.max_gpu_ms = (frame == 0) ? gpu_ms : std::max(stats.max_gpu_ms, gpu_ms);
+
+    if (on_frame) on_frame(frame, gpu_ms, cpu_ms);
+  }
+
+  if (frames > 0)
+  {
+    stats.mean_gpu_ms /= frames;
+    stats.mean_cpu_ms /= frames;
+  }
+  return stats;
+}
+
+void ApplicationHeadless::RunEvaluation ()
+{
+  RenderingManager* rm = RenderingManager::Instance();
+
+  printf("%s the evaluation of %s in \"%s\"\n", m_resume ? "Resuming" : "Starting",
+    rm->GetCurrentVolumeRenderer()->GetName(), m_output_dir.c_str());
+
+  rm->SetEvaluationFrames(m_frames, m_warmup_frames);
+  if (!rm->StartEvaluation(m_output_dir, m_resume))
+  {
+    fprintf(stderr, "The evaluation could not be started\n");
+    exit(EXIT_FAILURE);
+  }
+  while (rm->IsEvaluationRunning())
+    rm->Display();
+
+  if (rm->GetEvaluationImageErrors() > 0)
+  {
+    fprintf(stderr, "%d evaluation images could not be written to \"%s/img\"\n", rm->GetEvaluationImageErrors(), m_output_dir.c_str());
+    exit(EXIT_FAILURE);
+  }
+  printf("Results written to \"%s/eval.csv\"\n", m_output_dir.c_str());
+}
+
+void ApplicationHeadless::RunCameraPath ()
+{
+  RenderingManager* rm = RenderingManager::Instance();
+
+  rm->ClearCameraPath();
+  std::istringstream names(m_camera_path);
+  std::string name;
+  while (std::getline(names, name, ';'))
+  {
+    if (!rm->AddCameraPathKeyframe(name))
+    {
+      fprintf(stderr, "Camera state \"%s\" not found (use --list)\n", name.c_str());
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  printf("Rendering a camera path of %d (+%d warm-up) frames of %dx%d with %s\n", m_frames, m_warmup_frames,
+    m_width, m_height, rm->GetCurrentVolumeRenderer()->GetName());
+
+  if (!rm->StartCameraPath(m_output_dir + "/trace.csv", m_frames, m_warmup_frames))
+  {
+    fprintf(stderr, "The camera path could not be started\n");
+    exit(EXIT_FAILURE);
+  }
+  while (rm->IsCameraPathPlaying())
+    rm->Display();
+
+  if (!rm->SaveScreenshot(m_output_dir + "/path.png"))
+  {
+    fprintf(stderr, "Could not write \"%s/path.png\"\n", m_output_dir.c_str());
+    exit(EXIT_FAILURE);
+  }
+}
+
+std::string ApplicationHeadless::GetDefaultOutputDirectory (std::string prefix)
+{
+  // Same naming as the evaluation directories
+  auto t = std::time(nullptr);
+  auto tm = *std::localtime(&t);
+  std::ostringstream oss;
+  oss << prefix << std::put_time(&tm, "_%d-%m-%Y_%H-%M-%S");
+  const std::string path_to_data = CPPVOLREND_DATA_DIR;
+  return path_to_data + oss.str();
+}
+
+static std::string CSVString (const std::string& s)
+{
+  std::string r = "\"";
+  for (char c : s) r += (c == '"') ? std::string("\"\"") : std::string(1, c);
+  return r + "\"";
+}
+
+static std::string JSONString (const std::string& s)
+{
+  std::string r = "\"";
+  for (char c : s)
+  {
+    if (c == '"' || c == '\\') r += '\\';
+    r += c;
+  }
+  return r + "\"";
+}
+
+// Keeps the first n_rows rows of a json array written by RunBenchmark, without the closing bracket
+static bool ResumeJSONArray (const std::string& filepath, int n_rows)
+{
+  std::vector<std::string> lines;
+  {
+    std::ifstream file(filepath);
+    if (!file.is_open()) return false;
+    std::string line;
+    while ((int)lines.size() < n_rows + 1 && std::getline(file, line)) lines.push_back(line);
+  }
+  if (lines.empty() || (int)lines.size() < n_rows + 1) return false;
+
+  // The separator of the next row is written with it
+  if (n_rows > 0 && !lines.back().empty() && lines.back().back() == ',') lines.back().pop_back();
+
+  std::ofstream file(filepath, std::ios_base::out | std::ios_base::trunc);
+  for (size_t i = 0; i < lines.size(); i++) file << (i == 0 ? "" : "\n") << lines[i];
+  return file.good();
+}
+
+void ApplicationHeadless::RunBenchmark ()
+{
+  RenderingManager* rm = RenderingManager::Instance();
+  vis::DataManager* dm = rm->GetDataManager();
+  const BenchmarkJob& job = m_bench_job;
+
+  // Missing lists use the current selection
+  auto or_current = [](std::vector<std::string> names, std::string current) {
+    if (names.empty()) names.push_back(current);
+    return names;
+  };
+  std::vector<std::string> datasets = or_current(job.m_datasets, dm->GetCurrentVolumeName());
+  std::vector<std::string> transfer_functions = or_current(job.m_transfer_functions, dm->GetCurrentTransferFunctionName());
+  std::vector<std::string> renderers = or_current(job.m_renderers, rm->GetCurrentVolumeRenderer()->GetName());
+  std::vector<std::string> camera_states = or_current(job.m_camera_states, rm->GetCurrentCameraStateName());
+  std::vector<std::string> light_source_lists = or_current(job.m_light_source_lists, rm->GetCurrentLightSourceListName());
+
+  std::string output_dir = !m_output_dir.empty() ? m_output_dir
+    : (!job.m_output_dir.empty() ? job.m_output_dir : GetDefaultOutputDirectory("bench"));
+  std::filesystem::create_directories(output_dir);
+  if (job.m_save_images) std::filesystem::create_directories(output_dir + "/img");
+
+  // Rows are identified by their index, a resumed benchmark must go through the same configurations
+  EvaluationCheckpoint checkpoint;
+  auto join = [](const std::vector<std::string>& names) {
+    std::string s;
+    for (const std::string& name : names) s += (s.empty() ? "" : ";") + name;
+    return s;
+  };
+  checkpoint.SetIdentity("datasets", join(datasets));
+  checkpoint.SetIdentity("transfer_functions", join(transfer_functions));
+  checkpoint.SetIdentity("renderers", join(renderers));
+  checkpoint.SetIdentity("camera_states", join(camera_states));
+  checkpoint.SetIdentity("light_sources", join(light_source_lists));
+  std::string parameters;
+  for (const BenchmarkJob::Parameter& p : job.m_parameters)
+    parameters += (parameters.empty() ? "" : ";") + p.name + "=" + join(p.values);
+  checkpoint.SetIdentity("parameters", parameters);
+  checkpoint.SetIdentity("sweep", std::to_string(job.m_sweep_renderer_space));
+  checkpoint.SetIdentity("screen", std::to_string(m_width) + "x" + std::to_string(m_height));
+  checkpoint.SetIdentity("frames", std::to_string(job.m_frames));
+  checkpoint.SetIdentity("warmup_frames", std::to_string(job.m_warmup_frames));
+
+  const std::string csvpath = output_dir + "/bench.csv";
+  const std::string jsonpath = output_dir + "/bench.json";
+  if (m_resume)
+  {
+    // The rows are completed in order: keep the header and the completed rows, also in the json array
+    if (!checkpoint.Read(output_dir + "/checkpoint")) exit(EXIT_FAILURE);
+    std::vector<bool> keep_rows(1 + checkpoint.GetNumCompleted(), true);
+    if (!EvaluationCheckpoint::KeepLines(csvpath, keep_rows) || !ResumeJSONArray(jsonpath, checkpoint.GetNumCompleted()))
+    {
+      fprintf(stderr, "Could not read the results in \"%s\"\n", output_dir.c_str());
+      exit(EXIT_FAILURE);
+    }
+    printf("Resuming the benchmark in \"%s\": %d configurations completed, the last run stopped at %d\n",
+      output_dir.c_str(), checkpoint.GetNumCompleted(), checkpoint.GetCursor());
+  }
+
+  std::ofstream csvfile(csvpath, m_resume ? std::ios_base::out | std::ios_base::app : std::ios_base::out);
+  std::ofstream jsonfile(jsonpath, m_resume ? std::ios_base::out | std::ios_base::app : std::ios_base::out);
+  if (!csvfile.is_open() || !jsonfile.is_open() || !checkpoint.Create(output_dir + "/checkpoint"))
+  {
+    fprintf(stderr, "Could not write the results to \"%s\"\n", output_dir.c_str());
+    exit(EXIT_FAILURE);
+  }
+  if (!m_resume)
+  {
+    csvfile << "Dataset,TransferFunction,Renderer,CameraState,LightSources,Parameters,Width,Height,Frames,"
+          << "VolumeLoad (ms),VolumeUpload (MB/s),Gradient (ms),Preprocessing (ms),ShaderPrograms (ms),"
+            << "TimePerFrame (ms),MinTimePerFrame (ms),MaxTimePerFrame (ms),CPUTimePerFrame (ms),FramesPerSecond,GPUMemory (MB),ImageFile\n";
+    jsonfile << "[";
+  }
+
+  printf("Benchmark: %zu scenes x renderer parameters, %d (+%d warm-up) frames of %dx%d\n",
+    job.GetNumScenes(), job.m_frames, job.m_warmup_frames, m_width, m_height);
+
+  int n_rows = 0;
+  // Job parameters applied to at least one renderer, and parameters that could not be set
+  std::set<std::string> applied_parameters;
+  int n_parameter_errors = 0;
+  int n_image_errors = 0;
+  for (const std::string& dataset : datasets)
+  {
+    // Data changes are done with the null renderer, so the benchmarked renderers are only preprocessed once
+    rm->SelectVolumeRenderer("0");
+    if (!rm->SelectVolume(dataset))
+    {
+      fprintf(stderr, "Benchmark: dataset \"%s\" not found, skipped\n", dataset.c_str());
+      continue;
+    }
+    double load_ms = dm->GetLastVolumeLoadTime();
+    double upload_mbs = dm->GetLastVolumeUploadTime() > 0.0 ?
+      dm->GetLastVolumeUploadBytes() / (1024.0 * 1024.0) / (dm->GetLastVolumeUploadTime() / 1000.0) : 0.0;
+    double gradient_ms = dm->GetLastGradientTime();
+
+    for (const std::string& transfer_function : transfer_functions)
+    {
+      rm->SelectVolumeRenderer("0");
+      if (!rm->SelectTransferFunction(transfer_function))
+      {
+        fprintf(stderr, "Benchmark: transfer function \"%s\" not found, skipped\n", transfer_function.c_str());
+        continue;
+      }
+
+      for (const std::string& renderer : renderers)
+      {
+        if (!rm->SelectVolumeRenderer(renderer))
+        {
+          fprintf(stderr, "Benchmark: volume renderer \"%s\" not found or not supported by \"%s\", skipped\n",
+            renderer.c_str(), dataset.c_str());
+          continue;
+        }
+        BaseVolumeRenderer* vr = rm->GetCurrentVolumeRenderer();
+        double preprocessing_ms = rm->GetLastRendererInitTime();
+        double programs_ms = rm->GetLastRendererProgramTime();
+
+        // Job parameters that are evaluation, tuning or variant dimensions of this renderer
+        // . tuning dimensions (e.g. BlockSize) rebuild structures with ApplyTuningParameters
+        // . variant dimensions (e.g. Composition) switch shader variants on the next Update
+        ParameterSpace pspace;
+        vr->FillParameterSpace(pspace);
+        ParameterSpace tuning_space;
+        vr->FillTuningSpace(tuning_space);
+        ParameterSpace variant_space;
+        vr->FillVariantSpace(variant_space);
+        std::vector<const BenchmarkJob::Parameter*> params;
+        std::vector<ParameterSpace*> param_spaces;
+        for (const BenchmarkJob::Parameter& p : job.m_parameters)
+        {
+          ParameterSpace* space = nullptr;
+          for (ParameterSpace* s : { &pspace, &tuning_space, &variant_space })
+            if (!space && s->GetDimensionIndex(p.name) >= 0) space = s;
+          if (!space) continue;
+          params.push_back(&p);
+          param_spaces.push_back(space);
+          applied_parameters.insert(p.name);
+        }
+        std::vector<std::string> default_values, default_tuning_values, default_variant_values;
+        for (int i = 0; i < pspace.GetNumDimensions(); i++)
+          default_values.push_back(pspace.GetDimensionValue(i));
+        for (int i = 0; i < tuning_space.GetNumDimensions(); i++)
+          default_tuning_values.push_back(tuning_space.GetDimensionValue(i));
+        for (int i = 0; i < variant_space.GetNumDimensions(); i++)
+          default_variant_values.push_back(variant_space.GetDimensionValue(i));
+        bool sweep_space = params.empty() && job.m_sweep_renderer_space && pspace.GetNumDimensions() > 0;
+        auto is_varying = [&](int i) {
+          bool varying = sweep_space;
+          for (const BenchmarkJob::Parameter* p : params) varying |= (p->name == pspace.GetDimensionName(i));
+          return varying;
+        };
+        // Sets a value, true if a tuning value changed
+        auto set_value = [&](ParameterSpace* space, const std::string& name, const std::string& value) {
+          const int d = space->GetDimensionIndex(name);
+          const std::string previous = space->GetDimensionValue(d);
+          if (!space->SetDimensionValue(name, value))
+          {
+            fprintf(stderr, "Benchmark: invalid value \"%s\" of parameter \"%s\" of \"%s\"\n",
+              value.c_str(), name.c_str(), vr->GetName());
+            n_parameter_errors++;
+            return false;
+          }
+          return space == &tuning_space && space->GetDimensionValue(d) != previous;
+        };
+
+        for (const std::string& light_source_list : light_source_lists)
+        {
+          if (!light_source_list.empty() && !rm->SelectLightSourceList(light_source_list))
+          {
+            fprintf(stderr, "Benchmark: light source list \"%s\" not found, skipped\n", light_source_list.c_str());
+            continue;
+          }
+
+          for (const std::string& camera_state : camera_states)
+          {
+            if (!camera_state.empty() && !rm->SelectCameraState(camera_state))
+            {
+              fprintf(stderr, "Benchmark: camera state \"%s\" not found, skipped\n", camera_state.c_str());
+              continue;
+            }
+
+            if (sweep_space) pspace.StartEvaluation();
+            std::vector<size_t> value_ids(params.size(), 0);
+            bool more = true;
+            while (more)
+            {
+              // "Param=Value" pairs of the varying parameters, as in the auto-tuner cache
+              std::string config;
+              bool tuning_changed = false;
+              for (size_t k = 0; k < params.size(); k++)
+                tuning_changed |= set_value(param_spaces[k], params[k]->name, params[k]->values[value_ids[k]]);
+              if (tuning_changed) vr->ApplyTuningParameters();
+              for (int i = 0; i < pspace.GetNumDimensions(); i++)
+              {
+                if (is_varying(i))
+                  config += (config.empty() ? "" : ";") + pspace.GetDimensionName(i) + "=" + pspace.GetDimensionValue(i);
+              }
+              for (ParameterSpace* space : { &tuning_space, &variant_space })
+              {
+                for (int i = 0; i < space->GetNumDimensions(); i++)
+                  for (const BenchmarkJob::Parameter* p : params)
+                    if (p->name == space->GetDimensionName(i))
+                      config += (config.empty() ? "" : ";") + p->name + "=" + space->GetDimensionValue(i);
+              }
+
+              // Rows of a resumed benchmark that were completed before
+              if (!checkpoint.IsCompleted(n_rows))
+              {
+                checkpoint.MarkStarted(n_rows);
+                FrameStatistics stats = MeasureFrames(job.m_warmup_frames, job.m_frames);
+
+                std::string imagefilename;
+                if (job.m_save_images)
+                {
+                  imagefilename = std::to_string(n_rows);
+                  size_t n_zero = 4;
+                  imagefilename = std::string(n_zero - std::min(n_zero, imagefilename.length()), '0') + imagefilename + ".png";
+                  // The row does not reference an image that is not on disk
+                  if (!rm->SaveScreenshot(output_dir + "/img/" + imagefilename))
+                  {
+                    imagefilename.clear();
+                    n_image_errors++;
+                  }
+                }
+
+                const double frames_per_second = stats.mean_gpu_ms > 0.0 ? 1000.0 / stats.mean_gpu_ms : 0.0;
+                const double gpu_memory_mb = gl::MemoryRegistry::Instance().GetTotalBytes() / (1024.0 * 1024.0);
+                csvfile << CSVString(dataset) << "," << CSVString(transfer_function) << ","
+                        << CSVString(vr->GetName()) << "," << CSVString(camera_state) << ","
+                        << CSVString(light_source_list) << "," << CSVString(config) << ","
+                        << m_width << "," << m_height << "," << job.m_frames << ","
+                        << std::to_string(load_ms) << "," << std::to_string(upload_mbs) << "," << std::to_string(gradient_ms) << "," << std::to_string(preprocessing_ms) << "," << std::to_string(programs_ms) << ","
+                        << std::to_string(stats.mean_gpu_ms) << "," << std::to_string(stats.min_gpu_ms) << ","
+                        << std::to_string(stats.max_gpu_ms) << "," << std::to_string(stats.mean_cpu_ms) << ","
+                        << std::to_string(frames_per_second) << "," << std::to_string(gpu_memory_mb) << ","
+                        << CSVString(imagefilename) << "\n";
+                csvfile.flush();
+
+                jsonfile << (n_rows == 0 ? "\n" : ",\n")
+                         << "  {\"dataset\": " << JSONString(dataset)
+                         << ", \"transfer_function\": " << JSONString(transfer_function)
+                         << ", \"renderer\": " << JSONString(vr->GetName())
+                         << ", \"camera_state\": " << JSONString(camera_state)
+                         << ", \"light_sources\": " << JSONString(light_source_list)
+                         << ", \"parameters\": {";
+                int n_json_params = 0;
+                for (int i = 0; i < pspace.GetNumDimensions(); i++)
+                {
+                  if (is_varying(i))
+                    jsonfile << (n_json_params++ == 0 ? "" : ", ") << JSONString(pspace.GetDimensionName(i)) << ": " << JSONString(pspace.GetDimensionValue(i));
+                }
+                for (ParameterSpace* space : { &tuning_space, &variant_space })
+                {
+                  for (int i = 0; i < space->GetNumDimensions(); i++)
+                    for (const BenchmarkJob::Parameter* p : params)
+                      if (p->name == space->GetDimensionName(i))
+                        jsonfile << (n_json_params++ == 0 ? "" : ", ") << JSONString(p->name) << ": " << JSONString(space->GetDimensionValue(i));
+                }
+                jsonfile << "}"
+                         << ", \"width\": " << m_width << ", \"height\": " << m_height << ", \"frames\": " << job.m_frames
+                         << ", \"volume_load_ms\": " << load_ms << ", \"volume_upload_mbs\": " << upload_mbs
+                         << ", \"gradient_ms\": " << gradient_ms
+                         << ", \"preprocessing_ms\": " << preprocessing_ms
+                         << ", \"shader_programs_ms\": " << programs_ms
+                         << ", \"gpu_ms\": " << stats.mean_gpu_ms << ", \"gpu_min_ms\": " << stats.min_gpu_ms
+                         << ", \"gpu_max_ms\": " << stats.max_gpu_ms << ", \"cpu_ms\": " << stats.mean_cpu_ms
+                         << ", \"fps\": " << frames_per_second << ", \"gpu_memory_mb\": " << gpu_memory_mb
+                         << ", \"image\": " << JSONString(imagefilename) << "}";
+                jsonfile.flush();
+                checkpoint.MarkCompleted(n_rows);
+
+                printf("[%d] %s | %s | %s | %s | %s | %s: %.3f ms/frame\n", n_rows, dataset.c_str(), transfer_function.c_str(),
+                  vr->GetAbbreviationName(), camera_state.c_str(), light_source_list.c_str(), config.c_str(), stats.mean_gpu_ms);
+              }
+              n_rows++;
+
+              // Next sample point, the last parameter first
+              if (sweep_space)
+              {
+                more = pspace.IncrEvaluation();
+              }
+              else
+              {
+                more = false;
+                for (int k = (int)params.size() - 1; k >= 0 && !more; k--)
+                {
+                  if (++value_ids[k] < params[k]->values.size()) more = true;
+                  else value_ids[k] = 0;
+                }
+              }
+            }
+            if (sweep_space) pspace.EndEvaluation();
+          }
+        }
+
+        // Restore the values of the renderer for the next scene
+        for (int i = 0; i < pspace.GetNumDimensions(); i++)
+          pspace.SetDimensionValue(pspace.GetDimensionName(i), default_values[i]);
+        for (int i = 0; i < variant_space.GetNumDimensions(); i++)
+          variant_space.SetDimensionValue(variant_space.GetDimensionName(i), default_variant_values[i]);
+        bool tuning_changed = false;
+        for (int i = 0; i < tuning_space.GetNumDimensions(); i++)
+          tuning_changed |= set_value(&tuning_space, tuning_space.GetDimensionName(i), default_tuning_values[i]);
+        if (tuning_changed) vr->ApplyTuningParameters();
+      }
+    }
+  }
+
+  jsonfile << "\n]\n";
+  jsonfile.close();
+  csvfile.close();
+  checkpoint.Close();
+
+  printf("%d configurations written to \"%s\"\n", n_rows, output_dir.c_str());
+
+  // The rows are written, but the job did not render what it asked for
+  for (const BenchmarkJob::Parameter& p : job.m_parameters)
+  {
+    if (applied_parameters.count(p.name) == 0)
+    {
+      fprintf(stderr, "Benchmark: parameter \"%s\" is not a parameter of any renderer of the job, not applied\n", p.name.c_str());
+      n_parameter_errors++;
+    }
+  }
+  if (n_image_errors > 0)
+    fprintf(stderr, "Benchmark: %d images could not be written\n", n_image_errors);
+  if (n_parameter_errors > 0)
+    fprintf(stderr, "Benchmark: %d parameter errors\n", n_parameter_errors);
+  if (n_parameter_errors > 0 || n_image_errors > 0)
+    exit(EXIT_FAILURE);
+}
+
+void ApplicationHeadless::ImGuiDestroy ()
+{
+  ImGui::DestroyContext();
+}
+
+void ApplicationHeadless::Destroy ()
+{
+  // Fewer frames were rendered than captured
+  gl::Profiler::Instance().Finish();
+
+  RenderingManager::Instance()->DestroyInstance();
+
+#ifdef USING_HEADLESS_OSMESA
+  if (m_osmesa_context) OSMesaDestroyContext(m_osmesa_context);
+  m_osmesa_context = NULL;
+  m_osmesa_buffer.clear();
+#else
+  if (m_egl_display != EGL_NO_DISPLAY)
+  {
+    eglMakeCurrent(m_egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (m_egl_context != EGL_NO_CONTEXT) eglDestroyContext(m_egl_display, m_egl_context);
+    if (m_egl_surface != EGL_NO_SURFACE) eglDestroySurface(m_egl_display, m_egl_surface);
+    eglTerminate(m_egl_display);
+  }
+  m_egl_display = EGL_NO_DISPLAY;
+  m_egl_surface = EGL_NO_SURFACE;
+  m_egl_context = EGL_NO_CONTEXT;
+#endif
+}
+
+bool ApplicationHeadless::ParseArguments (int argc, char** argv)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg(argv[i]);
+    bool has_value = i + 1 < argc;
+
+    if (arg == "--list")                          m_list_only = true;
+    else if (arg == "--save-all-frames")          m_save_all_frames = true;
+    else if (arg == "--eval")                     m_evaluation = true;
+    else if (arg == "--resume")                   m_resume = true;
+    else if (arg == "--uniform-bench")            m_uniform_bench = true;
+    else if (arg == "--renderer" && has_value)    m_renderer = argv[++i];
+    else if (arg == "--dataset" && has_value)     m_dataset = argv[++i];
+    else if (arg == "--tf" && has_value)          m_transfer_function = argv[++i];
+    else if (arg == "--camera" && has_value)      m_camera_state = argv[++i];
+    else if (arg == "--path" && has_value)        m_camera_path = argv[++i];
+    else if (arg == "--output" && has_value)      m_output_dir = argv[++i];
+    else if (arg == "--bench" && has_value)       m_bench_job_file = argv[++i];
+    else if (arg == "--width" && has_value)       m_width = atoi(argv[++i]);
+    else if (arg == "--height" && has_value)      m_height = atoi(argv[++i]);
+    else if (arg == "--frames" && has_value)      m_frames = std::max(atoi(argv[++i]), 0);
+    else if (arg == "--warmup" && has_value)      m_warmup_frames = std::max(atoi(argv[++i]), 0);
+    else if (arg == "--gpu-budget" && has_value)  gl::MemoryRegistry::Instance().SetBudget((size_t)std::max(atoi(argv[++i]), 0) * 1024 * 1024);
+    else if (arg == "--no-shader-cache")          gl::ProgramCache::Instance().SetEnabled(false);
+    else if (arg == "--shader-cache" && has_value) gl::ProgramCache::Instance().SetDirectory(argv[++i]);
+    else if (arg == "--trace" && has_value)       m_trace_frames = std::max(atoi(argv[++i]), 0);
+    else
+    {
+      fprintf(stderr, "Unknown or incomplete argument \"%s\"\n", arg.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+#ifdef USING_HEADLESS_OSMESA
+bool ApplicationHeadless::CreateContext ()
+{
+  const int attribs[] = {
+    OSMESA_FORMAT, OSMESA_RGBA,
+    OSMESA_DEPTH_BITS, 24,
+    OSMESA_STENCIL_BITS, 8,
+    OSMESA_PROFILE, OSMESA_COMPAT_PROFILE,
+    OSMESA_CONTEXT_MAJOR_VERSION, 4,
+    OSMESA_CONTEXT_MINOR_VERSION, 3,
+    0
+  };
+  m_osmesa_context = OSMesaCreateContextAttribs(attribs, NULL);
+  if (!m_osmesa_context) return false;
+
+  // The buffer is the default framebuffer of the context
+  m_osmesa_buffer.resize((size_t)m_width * (size_t)m_height * 4);
+  return OSMesaMakeCurrent(m_osmesa_context, m_osmesa_buffer.data(), GL_UNSIGNED_BYTE, m_width, m_height) == GL_TRUE;
+}
+#else
+bool ApplicationHeadless::CreateContext ()
+{
+  // Display without a window system:
+  // . a GPU device (EGL_EXT_platform_device), e.g. render nodes without X
+  // . Mesa surfaceless platform, e.g. llvmpipe on CI machines
+  // . the default display otherwise
+  PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+    (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+  PFNEGLQUERYDEVICESEXTPROC query_devices =
+    (PFNEGLQUERYDEVICESEXTPROC)eglGetProcAddress("eglQueryDevicesEXT");
+
+  EGLint major, minor;
+  if (get_platform_display && query_devices)
+  {
+    EGLDeviceEXT devices[8];
+    EGLint n_devices = 0;
+    if (query_devices(8, devices, &n_devices) && n_devices > 0)
+    {
+      m_egl_display = get_platform_display(EGL_PLATFORM_DEVICE_EXT, devices[0], NULL);
+      if (m_egl_display != EGL_NO_DISPLAY && !eglInitialize(m_egl_display, &major, &minor))
+        m_egl_display = EGL_NO_DISPLAY;
+    }
+  }
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+  if (m_egl_display == EGL_NO_DISPLAY && get_platform_display)
+  {
+    m_egl_display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    if (m_egl_display != EGL_NO_DISPLAY && !eglInitialize(m_egl_display, &major, &minor))
+      m_egl_display = EGL_NO_DISPLAY;
+  }
+#endif
+  if (m_egl_display == EGL_NO_DISPLAY)
+  {
+    m_egl_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (m_egl_display == EGL_NO_DISPLAY || !eglInitialize(m_egl_display, &major, &minor))
+      return false;
+  }
+  printf("EGL %d.%d - %s\n", major, minor, eglQueryString(m_egl_display, EGL_VENDOR));
+
+  const EGLint config_attribs[] = {
+    EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+    EGL_RED_SIZE, 8,
+    EGL_GREEN_SIZE, 8,
+    EGL_BLUE_SIZE, 8,
+    EGL_ALPHA_SIZE, 8,
+    EGL_DEPTH_SIZE, 24,
+    EGL_STENCIL_SIZE, 8,
+    EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+    EGL_NONE
+  };
+  EGLConfig config;
+  EGLint n_configs = 0;
+  if (!eglChooseConfig(m_egl_display, config_attribs, &config, 1, &n_configs) || n_configs < 1)
+    return false;
+
+  // The pbuffer is the default framebuffer, so renderers that bind
+  //   framebuffer 0 still draw into the offscreen image
+  const EGLint pbuffer_attribs[] = {
+    EGL_WIDTH, m_width,
+    EGL_HEIGHT, m_height,
+    EGL_NONE
+  };
+  m_egl_surface = eglCreatePbufferSurface(m_egl_display, config, pbuffer_attribs);
+  if (m_egl_surface == EGL_NO_SURFACE) return false;
+
+  if (!eglBindAPI(EGL_OPENGL_API)) return false;
+
+  // Compatibility profile: the manager still uses some fixed function state
+  const EGLint context_attribs[] = {
+    EGL_CONTEXT_MAJOR_VERSION_KHR, 4,
+    EGL_CONTEXT_MINOR_VERSION_KHR, 3,
+    EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT_KHR,
+    EGL_NONE
+  };
+  m_egl_context = eglCreateContext(m_egl_display, config, EGL_NO_CONTEXT, context_attribs);
+  if (m_egl_context == EGL_NO_CONTEXT) return false;
+
+  return eglMakeCurrent(m_egl_display, m_egl_surface, m_egl_surface, m_egl_context) == EGL_TRUE;
+}
+#endif
+#endif
@@ -0,0 +1,120 @@
+#ifndef APPLICATION_HEADLESS
+#define APPLICATION_HEADLESS
+
+#include "defines.h"
+
+#ifdef USING_HEADLESS
+#ifdef USING_HEADLESS_OSMESA
+#include <GL/osmesa.h>
+#else
+#include <EGL/egl.h>
+#endif
+
+#include "utils/benchmarkjob.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/** Application without a window system.
+*
+*   Creates an offscreen OpenGL context (EGL pbuffer or OSMesa buffer),
+*   and drives the RenderingManager from the command line: the selected
+*   renderer, dataset, transfer function and camera state are rendered
+*   for a number of frames, writing the images and frame times to disk.
+*   Works with software OpenGL implementations (e.g. Mesa llvmpipe).
+*
+*   With --bench, a job file (see BenchmarkJob) is run instead: every
+*   configuration of the job is rendered and written as one row of
+*   bench.csv and bench.json.
+*
+*   With --eval, the parameter space of the renderer is evaluated as in
+*   the "Evaluation" header of the interface. Evaluations and benchmarks
+*   write a checkpoint and can be continued with --resume after a crash.
+*
+*   With --path, the camera flies through the given camera states instead
+*   of staying at one, writing the frame trace of the path to trace.csv.
+*
+*   With --trace, the profiler zones of the data loading, renderer setup
+*   and first frames are written to profile.json (Chrome trace events).
+*/
+class ApplicationHeadless
+{
+public:
+  ApplicationHeadless ();
+  ~ApplicationHeadless ();
+
+  bool Init (int argc, char** argv);
+  bool InitImGui ();
+  void MainLoop ();
+  void ImGuiDestroy ();
+  void Destroy ();
+
+  static void PrintUsage ();
+
+protected:
+
+private:
+  bool ParseArguments (int argc, char** argv);
+  bool CreateContext ();
+
+  // Times of the measured frames, in ms
+  struct FrameStatistics
+  {
+    double mean_gpu_ms;
+    double min_gpu_ms;
+    double max_gpu_ms;
+    double mean_cpu_ms;
+  };
+
+  // Renders warmup + frames frames of the current renderer from scratch
+  // . on_frame(frame, gpu_ms, cpu_ms) is called after each measured frame
+  FrameStatistics MeasureFrames (int warmup, int frames,
+    const std::function<void(int, double, double)>& on_frame = nullptr);
+
+  void RunBenchmark ();
+  // Plays m_camera_path once, the trace is written by the RenderingManager
+  void RunCameraPath ();
+  // Evaluation of the RenderingManager, resumable with --resume
+  void RunEvaluation ();
+
+  // Output directory with the time it was created, under the data folder
+  std::string GetDefaultOutputDirectory (std::string prefix);
+
+  std::string m_renderer;
+  std::string m_dataset;
+  std::string m_transfer_function;
+  std::string m_camera_state;
+  // Camera states of a camera path, separated by ';'
+  std::string m_camera_path;
+  std::string m_output_dir;
+
+  int m_width;
+  int m_height;
+  int m_frames;
+  int m_warmup_frames;
+  bool m_save_all_frames;
+  bool m_list_only;
+  // Runs the UniformBenchmark instead of rendering
+  bool m_uniform_bench;
+  bool m_evaluation;
+  // Continue the evaluation or benchmark in m_output_dir from its checkpoint
+  bool m_resume;
+  // Frames captured by gl::Profiler from the start, written to profile.json, 0 for none
+  int m_trace_frames;
+
+  std::string m_bench_job_file;
+  BenchmarkJob m_bench_job;
+
+#ifdef USING_HEADLESS_OSMESA
+  OSMesaContext m_osmesa_context;
+  std::vector<unsigned char> m_osmesa_buffer;
+#else
+  EGLDisplay m_egl_display;
+  EGLSurface m_egl_surface;
+  EGLContext m_egl_context;
+#endif
+};
+#endif
+
+#endif
@@ -22,7 +22,13 @@
 //#define USING_GLFW 
 // --> COMMENT USING_FREEGLUT TO USE GLFW
 // http://freeglut.sourceforge.net/
+#ifndef USING_HEADLESS
 #define USING_FREEGLUT
+#endif
+//----------------------------------------------------------------------
+// USING_HEADLESS: no window system, the application is driven by the
+//   command line and renders with an offscreen context (EGL pbuffer, or
+//   OSMesa if USING_HEADLESS_OSMESA is also defined).
 //----------------------------------------------------------------------
 
 // undefine glfw if freeglut is defined
@@ -30,6 +36,10 @@
 #undef USING_GLFW
 #endif
 
+#ifdef USING_HEADLESS
+#undef USING_GLFW
+#endif
+
 #include <GL/glew.h>
 
 #ifdef USING_GLFW
@@ -22,6 +22,8 @@
 // 1-pass - Ray Casting - GLSL
 #include "structured/rc1pass/rc1prenderer.h"
 #include "structured/rc1pisoadapt/rc1pisoadaptrenderer.h"
+#include "structured/rc1pcpu/rc1pcpurenderer.h"
+#include "structured/rc1pisocpu/rc1pisocpurenderer.h"
 #include "structured/rc1pcrtgt/crtgtrenderer.h"
 #include "structured/rc1pdosct/dosrcrenderer.h"
 #include "structured/rc1pextbsd/ebsrenderer.h"
@@ -42,6 +44,11 @@ ApplicationFreeGLUT app;
 #ifdef USING_GLFW
 #include "app_glfw.h"
 ApplicationGLFW app;
+#else
+#ifdef USING_HEADLESS
+#include "app_headless.h"
+ApplicationHeadless app;
+#endif
 #endif
 #endif
 
@@ -64,6 +71,8 @@ int main (int argc, char **argv)
   // 1-pass - Ray Casting - GLSL
   RenderingManager::Instance()->AddVolumeRenderer(new RayCasting1Pass());
   RenderingManager::Instance()->AddVolumeRenderer(new RayCasting1PassIsoAdapt());
+  RenderingManager::Instance()->AddVolumeRenderer(new RayCasting1PassCPU());
+  RenderingManager::Instance()->AddVolumeRenderer(new RayCasting1PassIsoCPU());
   RenderingManager::Instance()->AddVolumeRenderer(new RC1PConeLightGroundTruthSteps());
   RenderingManager::Instance()->AddVolumeRenderer(new RC1PConeTracingDirOcclusionShading());
   RenderingManager::Instance()->AddVolumeRenderer(new RC1PExtinctionBasedShading());
@@ -6,15 +6,21 @@
 
 #include "volrenderbase.h"
 #include <gl_utils/framebufferobject.h>
+#include <gl_utils/memoryregistry.h>
+#include <gl_utils/programcache.h>
+#include <gl_utils/programcompiler.h>
+#include <gl_utils/profiler.h>
 
 #include <volvis_utils/transferfunction1d.h>
 
 #include <volvis_utils/utils.h>
 
-#define USING_IM_EXT
+// USING_IM_EXT: CPPVOLREND_IM CMake option
 #ifdef USING_IM_EXT
 #include <im/im.h>
 #include <im/im_image.h>
+#else
+#include <file_utils/pngwriter.h>
 #endif
 
 #include <math_utils/utils.h>
@@ -27,9 +33,12 @@
 #include <iostream>
 #include <iomanip>
 #include <chrono>
+#include <memory>
 #include <filesystem>
 
+#ifndef USING_HEADLESS
 #include <GL/wglew.h>
+#endif
 
 #define ALWAYS_OUTDATE_THE_CURRENT_VR_RENDERER
 
@@ -51,6 +60,18 @@ double GetCurrentRenderTime()
   return glutGet(GLUT_ELAPSED_TIME);
 #elif USING_GLFW
   return glfwGetTime();
+#elif defined(USING_HEADLESS)
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void SetSwapInterval (int interval)
+{
+#ifndef USING_HEADLESS
+  wglSwapIntervalEXT(interval);
+#else
+  // Offscreen surfaces are never presented
+  (void)interval;
 #endif
 }
 
@@ -84,6 +105,8 @@ void RenderingManager::DestroyInstance ()
 // Init glew + camera + curr vol renderer
 void RenderingManager::InitGL()
 {
+  gl::Profiler::Instance().SetThreadName("Context");
+
 #ifdef USING_FREEGLUT
   glEnable(GL_TEXTURE_2D);
   glEnable(GL_TEXTURE_3D);
@@ -132,6 +155,13 @@ void RenderingManager::InitData ()
   // Read camera states and set first camera data
   std::string path_data_folder1(MAKE_STR(CMAKE_PATH_TO_DATA_FOLDER));
   m_camera_state_list.ReadCameraStates(path_data_folder1 + "#list_camera_states");
+  m_autotuner.ReadCache(path_data_folder1 + "#autotune_cache");
+  // Unless the application chose another directory
+  if (gl::ProgramCache::Instance().GetDirectory().empty())
+    gl::ProgramCache::Instance().SetDirectory(path_data_folder1 + "#shader_cache");
+  // The programs every renderer linked in previous sessions are compiled by the driver meanwhile
+  gl::ProgramCompiler::Instance().Initialize();
+  gl::ProgramCompiler::Instance().Precompile();
   m_std_cam_state_names.clear();
   for (int i = 0; i < m_camera_state_list.NumberOfCameraStates(); i++)
     m_std_cam_state_names.push_back(m_camera_state_list.GetCameraState(i)->cam_setup_name);
@@ -173,8 +203,8 @@ void RenderingManager::InitData ()
 
 void RenderingManager::Display ()
 {
-  //We always redraw during evaluation
-  if (m_eval_running)
+  //We always redraw during evaluation and auto-tuning
+  if (m_eval_running || m_autotuner.IsRunning())
   {
     curr_vol_renderer->SetOutdated();
   }
@@ -190,21 +220,88 @@ void RenderingManager::Display ()
     curr_vol_renderer->SetOutdated();
   }
 
+  // Auto-tuning moves the camera along its own path
+  if (m_autotuner.IsRunning())
+    m_autotuner.PreRender(curr_rdr_parameters.GetCamera());
+
+  // Camera path playback, the warm-up frames are rendered at the first keyframe
+  if (m_camera_path_playing)
+  {
+    int path_frame = std::max(0, m_camera_path_currframe - m_camera_path_warmup_frames);
+    vis::CameraData cdata = m_camera_path.GetFrame(path_frame, m_camera_path_frames);
+    curr_rdr_parameters.GetCamera()->SetData(&cdata);
+    curr_vol_renderer->SetOutdated();
+  }
+
+  // The null renderer stays on screen until the programs of the new renderer are linked
+  if (m_renderer_compiling && gl::ProgramCompiler::Instance().GetNumberOfCompiling(curr_vol_renderer->GetName()) == 0)
+    InitCurrentRenderer();
+
   // Build ImgGui interface
-  if (m_imgui_render_ui) SetImGuiInterface();
+  if (m_imgui_render_ui)
+  {
+    PROFILE_ZONE("ImGui Build");
+    SetImGuiInterface();
+  }
+
+  // The cached configuration depends on the tuning key, e.g. the isovalue band of the renderer
+  if (curr_vol_renderer && curr_vol_renderer->IsBuilt() && !m_eval_running)
+    m_autotuner.UpdateCachedConfiguration(curr_vol_renderer, m_data_mgr.GetCurrentVolumeName());
 
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
   // Render Function
   if (curr_vol_renderer && curr_vol_renderer->IsBuilt())
   {
-    curr_vol_renderer->PrepareRender(curr_rdr_parameters.GetCamera());
+    // Frames of an evaluation sample after the warm-up
+    const bool eval_measure = m_eval_running && !m_eval_reference_pass && m_eval_currframe >= m_eval_warmup_frames;
+    // Frames of a camera path trace after the warm-up
+    const bool path_measure = m_camera_path_playing && !m_camera_path_trace_file.empty()
+                           && m_camera_path_currframe >= m_camera_path_warmup_frames;
+    auto eval_cpu_start = std::chrono::high_resolution_clock::now();
+
+    if (m_autotuner.IsRunning()) m_autotune_timer.Start();
+    else if (eval_measure) m_eval_gpu_timer.Start();
+    else if (path_measure) m_camera_path_gpu_timer.Start();
+
+    {
+      // Structures built on demand belong to the renderer
+      gl::MemoryRegistry::ScopedTag memory_tag(curr_vol_renderer->GetName());
+      PROFILE_ZONE(curr_vol_renderer->GetName());
+      PROFILE_GPU_ZONE(curr_vol_renderer->GetName());
+      curr_vol_renderer->PrepareRender(curr_rdr_parameters.GetCamera());
 
 #ifdef MULTISAMPLE_AVAILABLE
-    f_render[curr_vol_renderer->GetCurrentMultiScalingMode()](this);
+      f_render[curr_vol_renderer->GetCurrentMultiScalingMode()](this);
 #else
-    curr_vol_renderer->Redraw();
+      curr_vol_renderer->Redraw();
 #endif
+    }
+
+    const double cpu_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - eval_cpu_start).count();
+    if (eval_measure && !m_autotuner.IsRunning())
+    {
+      m_eval_gpu_timer.End();
+      m_eval_cpu_times.Add(cpu_ms);
+    }
+    else if (path_measure && !m_autotuner.IsRunning())
+    {
+      m_camera_path_gpu_timer.End();
+
+      CameraPathTraceFrame trace_frame;
+      trace_frame.position = m_camera_path_frames > 1 ?
+        (float)(m_camera_path_currframe - m_camera_path_warmup_frames) / (float)(m_camera_path_frames - 1) : 0.0f;
+      trace_frame.eye = curr_rdr_parameters.GetCamera()->GetEye();
+      trace_frame.cpu_ms = cpu_ms;
+      curr_vol_renderer->GetFrameStatistics(trace_frame.statistics);
+      m_camera_path_trace.push_back(trace_frame);
+    }
+
+    if (m_autotuner.IsRunning())
+    {
+      if (m_autotuner.PostRender(m_autotune_timer.End(), curr_rdr_parameters.GetCamera()))
+        EndAutoTuning();
+    }
   }
 
   // If we must capture a screenshot
@@ -212,7 +309,12 @@ void RenderingManager::Display ()
     SaveScreenshot();
 
   // Render the current ImGui interface
-  if (m_imgui_render_ui) DrawImGuiInterface();
+  if (m_imgui_render_ui)
+  {
+    PROFILE_ZONE("ImGui Draw");
+    PROFILE_GPU_ZONE("ImGui Draw");
+    DrawImGuiInterface();
+  }
 
 #ifdef USING_FREEGLUT
   // Swap buffer
@@ -222,6 +324,7 @@ void RenderingManager::Display ()
   f_swapbuffer(d_swapbuffer);
 #endif
 #endif
+  // . headless: the offscreen surface is single buffered and read back by the application
   
   // If camera is rotating
   if (animate_camera_rotation)
@@ -238,6 +341,8 @@ void RenderingManager::Display ()
 #else
 #ifdef USING_GLFW
     double endframetime = glfwGetTime() * 1000.0;
+#else
+    double endframetime = GetCurrentRenderTime();
 #endif
 #endif
     double lwindowms = endframetime - m_ts_last_time;
@@ -258,57 +363,134 @@ void RenderingManager::Display ()
     curr_vol_renderer->SetOutdated();
   }
 
+  if (m_camera_path_playing)
+  {
+    m_camera_path_currframe++;
+    if (m_camera_path_currframe >= m_camera_path_warmup_frames + m_camera_path_frames)
+      EndCameraPath();
+  }
+
   if (m_eval_running)
   {
     //We shoot a number of frames for each evaluation sample
     m_eval_currframe++; //go to the next frame
-    if (m_eval_currframe >= m_eval_numframes)
+
+    //Images of the previous samples that were read back in the meantime
+    while (CompleteEvaluationReadback(false));
+
+    if (m_eval_reference_pass && m_eval_currframe >= m_eval_numframes)
+    {
+      //Keep the reference frame and go back to the evaluated renderer and parameters
+      EndEvaluationReferencePass();
+    }
+    else if (!m_eval_reference_pass && m_eval_warmup_frames > 0 && m_eval_currframe == m_eval_warmup_frames)
+    {
+      //Start time taking after the warm-up frames
+      m_eval_lasttime = GetCurrentRenderTime();
+    }
+    else if (m_eval_currframe >= m_eval_warmup_frames + m_eval_numframes)
     {
       //Compute the rendering speed for that sample point
       const double currenttime = GetCurrentRenderTime();
       const double time_per_frame = (currenttime - m_eval_lasttime) / m_eval_numframes;
       const double frames_per_second = 1000.0 / time_per_frame;
 
-      //Save the last rendered image
-      std::string imagefilename = std::to_string(m_eval_currsample);
-      size_t n_zero = 4;
-      imagefilename = std::string(n_zero - std::min(n_zero, imagefilename.length()), '0') + imagefilename + ".png";
-      SaveScreenshot(m_eval_imgdirectory + "/" + imagefilename);
+      //Distribution of the GPU and CPU times of the measured frames
+      m_eval_gpu_timer.Finish();
+      FrameTimeStatistics gpu_times;
+      gpu_times.Add(m_eval_gpu_timer.GetResults());
+      const FrameTimeStatistics::Summary gpu = gpu_times.Summarize();
+      const FrameTimeStatistics::Summary cpu = m_eval_cpu_times.Summarize();
+
+      //Read the last rendered image back without waiting for the GPU,
+      //it is compared and saved by CompleteEvaluationReadback()
+      const std::string imagefilename = GetEvaluationImageName(m_eval_currsample);
+      if (m_eval_pixel_reader.IsFull()) CompleteEvaluationReadback(true);
+      ReadFrontBufferPixelDataAsync();
 
       //Store evaluation results in csv file
+      std::ostringstream row;
       for(int i=0;i<m_eval_paramspace.GetNumDimensions();i++)
       {
-        m_eval_csvfile << m_eval_paramspace.GetDimensionValue(i) << ",";
+        row << m_eval_paramspace.GetDimensionValue(i) << ",";
       }
-      m_eval_csvfile << std::to_string(time_per_frame) << ","
-                     << std::to_string(frames_per_second) << ","
-                     << "\"" << imagefilename << "\"\n";
-
+      row << std::to_string(time_per_frame) << ","
+          << std::to_string(frames_per_second) << ","
+          << std::to_string(gpu.mean) << "," << std::to_string(gpu.min) << ","
+          << std::to_string(gpu.median) << "," << std::to_string(gpu.p95) << ","
+          << std::to_string(gpu.p99) << "," << std::to_string(gpu.stddev) << ","
+          << std::to_string(cpu.mean) << "," << std::to_string(cpu.p95) << ","
+          << std::to_string(gl::MemoryRegistry::Instance().GetTotalBytes() / (1024.0 * 1024.0)) << ","
+          << "\"" << imagefilename << "\"";
+      m_eval_readbacks.push_back(EvaluationReadback{ m_eval_currsample, row.str(), imagefilename });
 
       //We go to the next sample point in the parameter space.
-      if (m_eval_paramspace.IncrEvaluation())
+      bool next_sample;
+      if (m_eval_adaptive)
+      {
+        //The search needs the image error of this sample now
+        ImageComparison::Scores scores = { 0.0, 0.0, 0.0 };
+        while (CompleteEvaluationReadback(true, &scores));
+
+        const double error = m_eval_adaptive_metric == 0 ? 1.0 - scores.ssim
+                           : m_eval_adaptive_metric == 1 ? -scores.psnr
+                           : scores.mae;
+        m_eval_search.AddResult(gpu.median, error);
+
+        std::vector<int> steps;
+        next_sample = m_eval_search.NextSample(steps);
+        if (next_sample) m_eval_paramspace.SetSamplePoint(steps);
+      }
+      else
+      {
+        //Samples completed by a previous run are skipped
+        next_sample = m_eval_paramspace.IncrEvaluation();
+        while (next_sample && m_eval_checkpoint.IsCompleted(m_eval_currsample + 1))
+        {
+          m_eval_currsample++;
+          next_sample = m_eval_paramspace.IncrEvaluation();
+        }
+      }
+
+      if (next_sample)
       {
         //The ID of the new sample point
         m_eval_currsample++;
+        if (!m_eval_adaptive) m_eval_checkpoint.MarkStarted(m_eval_currsample);
         //... and we shoot as many frames there as for the other samples.
         m_eval_currframe = 0;
         //Restart time taking
         m_eval_lasttime = GetCurrentRenderTime();
+        m_eval_gpu_timer.Clear();
+        m_eval_cpu_times.Clear();
       }
       else
       {
         //We reached the end of the evaluation.
+        while (CompleteEvaluationReadback(true));
+        m_eval_pixel_reader.Destroy();
+        m_eval_image_writer.WaitIdle();
+        if (m_eval_adaptive)
+        {
+          const std::vector<bool> pareto = m_eval_search.GetParetoFlags();
+          for (size_t i = 0; i < m_eval_rows.size(); i++)
+            m_eval_csvfile << m_eval_rows[i] << "," << ((i < pareto.size() && pareto[i]) ? 1 : 0) << "\n";
+          m_eval_rows.clear();
+          printf("Adaptive evaluation: %d of %d samples\n", m_eval_currsample + 1, m_eval_paramspace.GetNumSamplePoints());
+        }
         m_eval_paramspace.EndEvaluation();
         m_eval_running = false;
         m_eval_csvfile.close();
+        m_eval_checkpoint.Close();
+        m_eval_image_comparison.ClearReference();
         //Enable or disable vsync according to user prefs
         if (m_vsync)
         {
-          wglSwapIntervalEXT(1);
+          SetSwapInterval(1);
         }
         else
         {
-          wglSwapIntervalEXT(0);
+          SetSwapInterval(0);
         }
         //Restore UI
         m_imgui_render_ui = true;
@@ -316,6 +498,106 @@ void RenderingManager::Display ()
     }
   }
 
+  // Frame boundary of the trace, a capture of n frames ends here
+  gl::Profiler::Instance().EndFrame();
+}
+
+bool RenderingManager::AddCameraPathKeyframe (std::string camera_state_name)
+{
+  for (int i = 0; i < m_camera_state_list.NumberOfCameraStates(); i++)
+  {
+    if (m_camera_state_list.GetCameraState(i)->cam_setup_name == camera_state_name)
+    {
+      m_camera_path.AddKeyframe(*m_camera_state_list.GetCameraState(i), camera_state_name);
+      return true;
+    }
+  }
+  return false;
+}
+
+void RenderingManager::ClearCameraPath ()
+{
+  m_camera_path.Clear();
+}
+
+bool RenderingManager::StartCameraPath (std::string trace_file, int frames, int warmup)
+{
+  if (m_camera_path.GetNumKeyframes() == 0 || m_eval_running || m_autotuner.IsRunning()) return false;
+
+  m_camera_path_frames = std::max(frames, 1);
+  m_camera_path_warmup_frames = std::max(warmup, 0);
+  m_camera_path_currframe = 0;
+  m_camera_path_trace_file = trace_file;
+  m_camera_path_trace.clear();
+  m_camera_path_gpu_timer.Clear();
+  m_camera_path_playing = true;
+  //The path advances one frame per redraw
+  m_idle_rendering = true;
+
+  //Same as evaluation: measure the volume renderer only, at full speed
+  if (!m_camera_path_trace_file.empty())
+  {
+    m_imgui_render_ui = false;
+    SetSwapInterval(0);
+  }
+  return true;
+}
+
+void RenderingManager::EndCameraPath ()
+{
+  m_camera_path_playing = false;
+  if (m_camera_path_trace_file.empty()) return;
+
+  m_camera_path_gpu_timer.Finish();
+  const std::vector<double>& gpu_ms = m_camera_path_gpu_timer.GetResults();
+
+  std::ofstream tracefile(m_camera_path_trace_file, std::ios_base::out);
+  if (tracefile.is_open())
+  {
+    //The statistics of the renderer are the same for all frames
+    tracefile << "Frame,PathPosition,EyeX,EyeY,EyeZ,GPUTime (ms),CPUSubmitTime (ms)";
+    if (!m_camera_path_trace.empty())
+    {
+      for (const auto& s : m_camera_path_trace[0].statistics) tracefile << "," << s.first;
+    }
+    tracefile << "\n";
+
+    for (size_t i = 0; i < m_camera_path_trace.size(); i++)
+    {
+      const CameraPathTraceFrame& f = m_camera_path_trace[i];
+      tracefile << i << "," << std::to_string(f.position) << ","
+                << std::to_string(f.eye.x) << "," << std::to_string(f.eye.y) << "," << std::to_string(f.eye.z) << ","
+                << std::to_string(i < gpu_ms.size() ? gpu_ms[i] : 0.0) << "," << std::to_string(f.cpu_ms);
+      for (const auto& s : f.statistics) tracefile << "," << std::to_string(s.second);
+      tracefile << "\n";
+    }
+    tracefile.close();
+
+    FrameTimeStatistics gpu_times;
+    gpu_times.Add(gpu_ms);
+    const FrameTimeStatistics::Summary gpu = gpu_times.Summarize();
+    const size_t slowest = std::max_element(gpu_ms.begin(), gpu_ms.end()) - gpu_ms.begin();
+    printf("Camera path: GPU %.3f ms/frame (median %.3f, p95 %.3f), slowest frame %zu at %.1f%% of the path\n",
+      gpu.mean, gpu.median, gpu.p95, slowest, slowest < m_camera_path_trace.size() ? 100.0f * m_camera_path_trace[slowest].position : 0.0f);
+    printf("Trace written to \"%s\"\n", m_camera_path_trace_file.c_str());
+  }
+  else
+  {
+    fprintf(stderr, "Could not write \"%s\"\n", m_camera_path_trace_file.c_str());
+  }
+
+  m_camera_path_trace.clear();
+  SetSwapInterval(m_vsync ? 1 : 0);
+  m_imgui_render_ui = true;
+}
+
+void RenderingManager::EndAutoTuning ()
+{
+  //Enable or disable vsync according to user prefs
+  SetSwapInterval(m_vsync ? 1 : 0);
+  //Restore UI
+  m_imgui_render_ui = true;
+  curr_vol_renderer->SetOutdated();
 }
 
 void RenderingManager::Reshape (int w, int h)
@@ -327,6 +609,7 @@ void RenderingManager::Reshape (int w, int h)
 
   if (curr_vol_renderer->IsBuilt())
   {
+    gl::MemoryRegistry::ScopedTag memory_tag(curr_vol_renderer->GetName());
     curr_vol_renderer->Reshape(w,h);
     curr_vol_renderer->SetOutdated();
   }
@@ -373,6 +656,8 @@ void RenderingManager::CloseFunc ()
 {
   gl::PipelineShader::Unbind();
   gl::ArrayObject::Unbind();
+  // Precompiled programs of the renderers never activated
+  gl::ProgramCompiler::Instance().Release();
 
   for (int i = m_vtr_vr_methods.size() - 1; i >= 0; i--) delete m_vtr_vr_methods[i];
   m_vtr_vr_methods.clear();
@@ -380,7 +665,8 @@ void RenderingManager::CloseFunc ()
 
 void RenderingManager::IdleFunc ()
 {
-  if (m_idle_rendering)
+  // Polls the programs of a renderer being activated
+  if (m_idle_rendering || m_renderer_compiling)
   {
 #ifdef ALWAYS_OUTDATE_THE_CURRENT_VR_RENDERER
     curr_vol_renderer->SetOutdated();
@@ -398,15 +684,192 @@ void RenderingManager::PostRedisplay ()
   Display();
 #endif
 #endif
+  // . headless: frames are only drawn by the command line loop
 }
 
 // Update the volume renderer with the current volume and transfer function
 void RenderingManager::UpdateDataAndResetCurrentVRMode ()
 {
-  curr_vol_renderer->Init(curr_rdr_parameters.GetScreenWidth(), curr_rdr_parameters.GetScreenHeight());
+  // The tuned structures of the renderer are rebuilt by Init
+  if (m_autotuner.IsRunning())
+  {
+    m_autotuner.Abort(curr_rdr_parameters.GetCamera());
+    EndAutoTuning();
+  }
+
+  // Evaluations, benchmarks and the headless application render right after the switch
+  m_renderer_compiling = false;
+  if (m_async_renderer_activation && !m_eval_running && !m_camera_path_playing)
+  {
+    gl::ProgramCompiler& compiler = gl::ProgramCompiler::Instance();
+    if (compiler.HasRecords(curr_vol_renderer->GetName()))
+    {
+      compiler.Precompile(curr_vol_renderer->GetName());
+      if (compiler.GetNumberOfCompiling(curr_vol_renderer->GetName()) > 0)
+      {
+        m_renderer_compiling = true;
+        return;
+      }
+    }
+  }
+
+  InitCurrentRenderer();
+}
+
+void RenderingManager::UpdateTransferFunction ()
+{
+  m_time_transfer_function_update_ms = -1.0;
+  if (m_autotuner.IsRunning() || m_renderer_compiling || !curr_vol_renderer->IsBuilt())
+  {
+    UpdateDataAndResetCurrentVRMode();
+    return;
+  }
+
+  auto update_start = std::chrono::high_resolution_clock::now();
+  bool updated = false;
+  {
+    gl::MemoryRegistry::ScopedTag memory_tag(curr_vol_renderer->GetName());
+    updated = curr_vol_renderer->OnTransferFunctionChanged();
+  }
+  if (!updated)
+  {
+    UpdateDataAndResetCurrentVRMode();
+    return;
+  }
+  glFinish();
+  m_time_transfer_function_update_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - update_start).count();
+
+  curr_vol_renderer->SetOutdated();
+}
+
+void RenderingManager::InitCurrentRenderer ()
+{
+  m_renderer_compiling = false;
+
+  // Preprocessing time, including the GPU work issued by Init
+  gl::ProgramCache& program_cache = gl::ProgramCache::Instance();
+  int programs_cached = program_cache.GetNumberOfHits();
+  int programs_compiled = program_cache.GetNumberOfMisses();
+  double programs_ms = program_cache.GetHitTime() + program_cache.GetMissTime();
+  auto init_start = std::chrono::high_resolution_clock::now();
+  {
+    PROFILE_ZONE(std::string("Init ") + curr_vol_renderer->GetName());
+    gl::MemoryRegistry::ScopedTag memory_tag(curr_vol_renderer->GetName());
+    curr_vol_renderer->Init(curr_rdr_parameters.GetScreenWidth(), curr_rdr_parameters.GetScreenHeight());
+  }
+  glFinish();
+  m_time_renderer_init_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - init_start).count();
+
+  // Cold (compiled) and warm (cached) builds of the shader programs
+  m_renderer_programs_cached = program_cache.GetNumberOfHits() - programs_cached;
+  m_renderer_programs_compiled = program_cache.GetNumberOfMisses() - programs_compiled;
+  m_time_renderer_programs_ms = program_cache.GetHitTime() + program_cache.GetMissTime() - programs_ms;
+  if (m_renderer_programs_cached + m_renderer_programs_compiled > 0)
+  {
+    printf("%s: Init %.1f ms, shader programs %.1f ms (%d cached, %d compiled)\n", curr_vol_renderer->GetName(),
+      m_time_renderer_init_ms, m_time_renderer_programs_ms, m_renderer_programs_cached, m_renderer_programs_compiled);
+  }
+
+  // Start with the best configuration found in a previous session
+  if (curr_vol_renderer->IsBuilt())
+    m_autotuner.ApplyCachedConfiguration(curr_vol_renderer, m_data_mgr.GetCurrentVolumeName());
+
+  //The evaluation parameters may depend on the renderer and the data
+  if (!m_eval_running)
+    curr_vol_renderer->FillParameterSpace(m_eval_paramspace);
+}
+
+bool RenderingManager::SelectVolumeRenderer (std::string name)
+{
+  int id = -1;
+  for (int i = 0; i < m_vtr_vr_methods.size() && id < 0; i++)
+  {
+    if (m_vtr_vr_methods[i]->GetName() == name || m_vtr_vr_methods[i]->GetAbbreviationName() == name)
+      id = i;
+  }
+  if (id < 0 && !name.empty() && name.find_first_not_of("0123456789") == std::string::npos)
+    id = std::stoi(name);
+  if (id < 0 || id >= m_vtr_vr_methods.size()) return false;
+
+  ResetGLStateConfig();
+  m_current_vr_method_id = id;
+  SetCurrentVolumeRenderer();
+
+  // Renderers that do not support the input data fall back to the null renderer
+  return m_current_vr_method_id == id;
+}
+
+bool RenderingManager::SelectVolume (std::string name)
+{
+  if (!m_data_mgr.SetVolume(name)) return false;
+  UpdateDataAndResetCurrentVRMode();
+  return true;
 }
 
-void RenderingManager::SaveScreenshot (std::string filename)
+bool RenderingManager::SelectTransferFunction (std::string name)
+{
+  if (!m_data_mgr.SetTransferFunction(name)) return false;
+  UpdateDataAndResetCurrentVRMode();
+  return true;
+}
+
+bool RenderingManager::SelectCameraState (std::string name)
+{
+  for (int i = 0; i < m_camera_state_list.NumberOfCameraStates(); i++)
+  {
+    if (m_camera_state_list.GetCameraState(i)->cam_setup_name == name)
+    {
+      m_current_camera_state_id = i;
+      curr_rdr_parameters.GetCamera()->SetData(m_camera_state_list.GetCameraState(m_current_camera_state_id));
+      UpdateLightSourceCameraVectors();
+      curr_vol_renderer->SetOutdated();
+      return true;
+    }
+  }
+  return false;
+}
+
+bool RenderingManager::SelectLightSourceList (std::string name)
+{
+  for (int i = 0; i < m_light_source_list.NumberOfLists(); i++)
+  {
+    if (m_light_source_list.GetList(i)->l_name == name)
+    {
+      m_current_lightsource_data_id = i;
+      curr_rdr_parameters.EraseAllLightSources();
+      for (int l = 0; l < m_light_source_list.GetList(i)->m_lightsources.size(); l++)
+        curr_rdr_parameters.CreateNewLightSource(m_light_source_list.GetList(i)->m_lightsources[l]);
+      curr_vol_renderer->SetOutdated();
+      return true;
+    }
+  }
+  return false;
+}
+
+void RenderingManager::PrintSelectionLists ()
+{
+  printf("Volume renderers:\n");
+  for (int i = 0; i < m_vtr_vr_methods.size(); i++)
+    printf("  %d: %s [%s]\n", i, m_vtr_vr_methods[i]->GetName(), m_vtr_vr_methods[i]->GetAbbreviationName());
+
+  printf("Datasets:\n");
+  for (const std::string& s : m_data_mgr.GetUINameDatasetList())
+    printf("  %s\n", s.c_str());
+
+  printf("Transfer functions:\n");
+  for (const std::string& s : m_data_mgr.GetUINameTransferFunctionList())
+    printf("  %s\n", s.c_str());
+
+  printf("Camera states:\n");
+  for (const std::string& s : m_std_cam_state_names)
+    printf("  %s\n", s.c_str());
+
+  printf("Light source lists:\n");
+  for (const std::string& s : m_std_lsource_names)
+    printf("  %s\n", s.c_str());
+}
+
+bool RenderingManager::SaveScreenshot (std::string filename)
 {
   // Get pixel data without alpha
   GLubyte* rgb_data = GetFrontBufferPixelData(false);
@@ -414,8 +877,9 @@ void RenderingManager::SaveScreenshot (std::string filename)
   {
     filename = AddAbreviationName(curr_rdr_parameters.GetDefaultScreenshotName());
   }
-  GenerateImgFile(filename, curr_rdr_parameters.GetScreenWidth(), curr_rdr_parameters.GetScreenHeight(), rgb_data, false);
+  bool written = GenerateImgFile(filename, curr_rdr_parameters.GetScreenWidth(), curr_rdr_parameters.GetScreenHeight(), rgb_data, false);
   delete[] rgb_data;
+  return written;
 }
 
 void RenderingManager::UpdateLightSourceCameraVectors ()
@@ -427,7 +891,7 @@ void RenderingManager::UpdateLightSourceCameraVectors ()
 
 void RenderingManager::ResetGLStateConfig ()
 {
-#ifdef USING_FREEGLUT
+#if defined(USING_FREEGLUT) || defined(USING_HEADLESS)
   glEnable(GL_CULL_FACE);
   glEnable(GL_DEPTH_TEST);
 
@@ -452,7 +916,6 @@ bool RenderingManager::GenerateImgFile (std::string out_str, int w, int h, unsig
 {
   int error;
 
-#ifdef USING_IM_EXT
   //Deal with absolute and relative paths
   if (std::filesystem::path(out_str).is_relative())
   {
@@ -460,26 +923,48 @@ bool RenderingManager::GenerateImgFile (std::string out_str, int w, int h, unsig
     out_str = path_to_data + out_str;
   }
 
+#ifdef USING_IM_EXT
   //Create the file and save it
   imFile* ifile = imFileNew(out_str.c_str(), image_type.c_str(), &error);
+  if (!ifile)
+  {
+    fprintf(stderr, "Could not create image file %s\n", out_str.c_str());
+    return false;
+  }
   int user_color_mode = alpha ? IM_RGB | IM_ALPHA | IM_PACKED : IM_RGB | IM_PACKED;
   error = imFileWriteImageInfo(ifile, w, h, user_color_mode, IM_BYTE);
   error = imFileWriteImageData(ifile, gl_data);
   imFileClose(ifile);
 #else
-  error = -1;
+  //Without IM only PNG files are written
+  if (image_type != "PNG")
+  {
+    fprintf(stderr, "Image type %s needs CPPVOLREND_IM, %s not written\n", image_type.c_str(), out_str.c_str());
+    return false;
+  }
+  error = WritePNGFile(out_str, w, h, alpha ? 4 : 3, gl_data) ? 0 : -1;
 #endif
+  if (error != 0)
+    fprintf(stderr, "Could not write image file %s\n", out_str.c_str());
 
   return error == 0;
 }
 
 GLubyte* RenderingManager::GetFrontBufferPixelData (bool alpha)
 {
+  PROFILE_ZONE("Readback");
   GLubyte *gl_img_data = new GLubyte[(alpha ? 4 : 3) * curr_rdr_parameters.GetScreenWidth() * curr_rdr_parameters.GetScreenHeight()];
   
   glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
   glPushAttrib(GL_PIXEL_MODE_BIT);
+#ifdef USING_HEADLESS
+  // Offscreen surfaces may be single buffered: read the buffer we draw to
+  GLint draw_buffer;
+  glGetIntegerv(GL_DRAW_BUFFER, &draw_buffer);
+  glReadBuffer(draw_buffer);
+#else
   glReadBuffer(GL_BACK);
+#endif
   glFlush();
   glPixelStorei(GL_PACK_ALIGNMENT, 1);
   
@@ -491,6 +976,21 @@ GLubyte* RenderingManager::GetFrontBufferPixelData (bool alpha)
   return gl_img_data;
 }
 
+void RenderingManager::ReadFrontBufferPixelDataAsync ()
+{
+  glPushAttrib(GL_PIXEL_MODE_BIT);
+#ifdef USING_HEADLESS
+  // Offscreen surfaces may be single buffered: read the buffer we draw to
+  GLint draw_buffer;
+  glGetIntegerv(GL_DRAW_BUFFER, &draw_buffer);
+  glReadBuffer(draw_buffer);
+#else
+  glReadBuffer(GL_BACK);
+#endif
+  m_eval_pixel_reader.ReadPixels(curr_rdr_parameters.GetScreenWidth(), curr_rdr_parameters.GetScreenHeight(), false);
+  glPopAttrib();
+}
+
 // Go to previous renderer
 bool RenderingManager::PreviousRenderer ()
 {
@@ -520,7 +1020,12 @@ bool RenderingManager::NextRenderer ()
 // Set current volume renderer
 void RenderingManager::SetCurrentVolumeRenderer ()
 {
-  if (curr_vol_renderer) curr_vol_renderer->Clean();
+  if (curr_vol_renderer)
+  {
+    curr_vol_renderer->Clean();
+    // Programs submitted for the renderer and not taken by its Init (e.g. other defines)
+    gl::ProgramCompiler::Instance().Release(curr_vol_renderer->GetName());
+  }
 
   curr_vol_renderer = m_vtr_vr_methods[m_current_vr_method_id];
   if (curr_vol_renderer->GetDataTypeSupport() == m_data_mgr.GetInputVolumeDataType())
@@ -539,6 +1044,277 @@ void RenderingManager::SetCurrentVolumeRenderer ()
   curr_vol_renderer->FillParameterSpace(m_eval_paramspace);
 }
 
+bool RenderingManager::StartEvaluation (std::string directory, bool resume)
+{
+  if (m_eval_running || m_autotuner.IsRunning() || m_camera_path_playing) return false;
+
+  //The parameters may depend on the renderer options changed since (e.g. a different step scheme)
+  curr_vol_renderer->FillParameterSpace(m_eval_paramspace);
+
+  m_eval_basedirectory = directory;
+  // - and an image subsirectory
+  m_eval_imgdirectory = m_eval_basedirectory + "/img";
+
+  //Create the new directories
+  std::filesystem::create_directories(m_eval_basedirectory);
+  std::filesystem::create_directory(m_eval_imgdirectory);
+  m_eval_image_errors = 0;
+
+#ifdef USING_IM_EXT
+  //The images are written by several threads: register the formats before
+  imFormatRegisterInternal();
+#endif
+
+  //Everything that changes the measured samples, a resumed evaluation must match it
+  m_eval_checkpoint.ClearIdentity();
+  m_eval_checkpoint.SetIdentity("renderer", curr_vol_renderer->GetName());
+  m_eval_checkpoint.SetIdentity("dataset", m_data_mgr.GetCurrentVolumeName());
+  m_eval_checkpoint.SetIdentity("transfer_function", m_data_mgr.GetCurrentTransferFunctionName());
+  m_eval_checkpoint.SetIdentity("light_sources", GetCurrentLightSourceListName());
+  vis::CameraData cdata = curr_rdr_parameters.GetCamera()->GetData();
+  std::ostringstream camera;
+  camera << cdata.eye.x << " " << cdata.eye.y << " " << cdata.eye.z << " "
+         << cdata.center.x << " " << cdata.center.y << " " << cdata.center.z << " "
+         << cdata.up.x << " " << cdata.up.y << " " << cdata.up.z;
+  m_eval_checkpoint.SetIdentity("camera", camera.str());
+  m_eval_checkpoint.SetIdentity("screen", std::to_string(curr_rdr_parameters.GetScreenWidth()) + "x"
+                                        + std::to_string(curr_rdr_parameters.GetScreenHeight()));
+  m_eval_checkpoint.SetIdentity("frames", std::to_string(m_eval_numframes));
+  m_eval_checkpoint.SetIdentity("warmup_frames", std::to_string(m_eval_warmup_frames));
+  std::string reference = std::to_string(m_eval_reference_mode);
+  if (m_eval_reference_mode == 1) reference += " sample " + std::to_string(m_eval_reference_sample);
+  if (m_eval_reference_mode == 2) reference += " " + std::string(m_vtr_vr_methods[m_eval_reference_renderer_id]->GetName());
+  m_eval_checkpoint.SetIdentity("reference", reference);
+  std::string space;
+  const std::vector<int> num_steps = m_eval_paramspace.GetNumSteps();
+  for (int i = 0; i < m_eval_paramspace.GetNumDimensions(); i++)
+    space += (i == 0 ? "" : ";") + m_eval_paramspace.GetDimensionName(i) + ":" + std::to_string(num_steps[i]);
+  m_eval_checkpoint.SetIdentity("parameter_space", space);
+
+  //Open a CSV file to record the results of the evaluation.
+  if (m_eval_csvfile.is_open()) m_eval_csvfile.close(); //Should really not happen, but better be save.
+  const std::string csvpath = m_eval_basedirectory + "/eval.csv";
+  const std::string checkpointpath = m_eval_basedirectory + "/checkpoint";
+  if (resume)
+  {
+    //The adaptive search depends on the results of all the previous samples
+    if (m_eval_adaptive)
+    {
+      fprintf(stderr, "Adaptive evaluations cannot be resumed\n");
+      return false;
+    }
+    if (!m_eval_checkpoint.Read(checkpointpath)) return false;
+
+    //Samples whose image was not written before the stop are rendered again
+    std::vector<bool> keep_rows(1, true);
+    const std::vector<int> completed = m_eval_checkpoint.GetCompleted();
+    for (int sample : completed)
+    {
+      const bool written = std::filesystem::exists(m_eval_imgdirectory + "/" + GetEvaluationImageName(sample));
+      if (!written) m_eval_checkpoint.ForgetCompleted(sample);
+      keep_rows.push_back(written);
+    }
+    if (!EvaluationCheckpoint::KeepLines(csvpath, keep_rows))
+    {
+      fprintf(stderr, "Could not read \"%s\"\n", csvpath.c_str());
+      return false;
+    }
+
+    printf("Resuming the evaluation in \"%s\": %d of %d samples completed, the last run stopped at sample %d\n",
+      m_eval_basedirectory.c_str(), m_eval_checkpoint.GetNumCompleted(), m_eval_paramspace.GetNumSamplePoints(),
+      m_eval_checkpoint.GetCursor());
+    if (m_eval_checkpoint.GetNumCompleted() >= m_eval_paramspace.GetNumSamplePoints()) return false;
+
+    m_eval_csvfile.open(csvpath, std::ios_base::out | std::ios_base::app);
+  }
+  else
+  {
+    m_eval_csvfile.open(csvpath, std::ios_base::out);
+  }
+
+  //Start the evaluation if everything is fine
+  if (!m_eval_csvfile.is_open()) return false;
+
+  if (!resume)
+  {
+    //Initialize the csv file
+    for(int i=0;i<m_eval_paramspace.GetNumDimensions();i++)
+    {
+      m_eval_csvfile << m_eval_paramspace.GetDimensionName(i) << ",";
+    }
+    m_eval_csvfile << "TimePerFrame (ms),FramesPerSecond,"
+                   << "GPUTimePerFrame (ms),GPUMinTime (ms),GPUMedianTime (ms),GPUP95Time (ms),GPUP99Time (ms),GPUStdDevTime (ms),"
+                   << "CPUSubmitTime (ms),CPUSubmitP95Time (ms),GPUMemory (MB),ImageFile";
+    if (m_eval_reference_mode != 0) m_eval_csvfile << ",SSIM,PSNR (dB),MAE";
+    if (m_eval_adaptive) m_eval_csvfile << ",Pareto";
+    m_eval_csvfile << "\n";
+    m_eval_csvfile.flush();
+  }
+
+  //The rows of an adaptive evaluation are only written at the end
+  if (!m_eval_adaptive && !m_eval_checkpoint.Create(checkpointpath))
+    fprintf(stderr, "The evaluation cannot be resumed without a checkpoint\n");
+
+  //Set a bool to trigger evaluation action in Display().
+  m_eval_running = true;
+  m_eval_renderer_id = m_current_vr_method_id;
+  m_eval_image_comparison.ClearReference();
+  m_eval_reference_pass = m_eval_reference_mode != 0;
+  if (m_eval_reference_mode == 1)
+  {
+    //Go to the reference sample
+    m_eval_paramspace.StartEvaluation();
+    for (int i = 0; i < m_eval_reference_sample; i++) m_eval_paramspace.IncrEvaluation();
+  }
+  else if (m_eval_reference_mode == 2)
+  {
+    //Same initialization as when the renderer is selected in the UI
+    ResetGLStateConfig();
+    m_current_vr_method_id = m_eval_reference_renderer_id;
+    SetCurrentVolumeRenderer();
+  }
+  m_eval_currframe = 0;
+  if (!m_eval_reference_pass) StartEvaluationSamples();
+  curr_vol_renderer->SetOutdated();
+  // Careful: Not rendering the ImGui may have unintended consequences,
+  // namely if they Gui code changes parameters based on the parameters
+  // that we are setting during the eval.
+  // On the other hand, we want to measure the speed of the volume renderer and not of ImGui.
+  m_imgui_render_ui = false;
+
+  //Disable VSync for full speed
+  SetSwapInterval(0);
+  return true;
+}
+
+void RenderingManager::SetEvaluationFrames (int frames, int warmup)
+{
+  m_eval_numframes = std::max(frames, 1);
+  m_eval_warmup_frames = std::max(warmup, 0);
+}
+
+void RenderingManager::StartEvaluationSamples ()
+{
+  //Reset parameter space to the beginning
+  m_eval_paramspace.StartEvaluation();
+
+  //The adaptive search starts at its first coarse sample instead
+  if (m_eval_adaptive)
+  {
+    m_eval_rows.clear();
+    m_eval_search.Start(m_eval_paramspace.GetNumSteps(), m_eval_max_samples);
+    std::vector<int> steps;
+    if (m_eval_search.NextSample(steps)) m_eval_paramspace.SetSamplePoint(steps);
+  }
+
+  m_eval_currframe = 0;
+  m_eval_currsample = 0;
+  if (!m_eval_adaptive)
+  {
+    //Samples completed by a previous run are skipped
+    while (m_eval_checkpoint.IsCompleted(m_eval_currsample) && m_eval_paramspace.IncrEvaluation())
+      m_eval_currsample++;
+    m_eval_checkpoint.MarkStarted(m_eval_currsample);
+  }
+  m_eval_lasttime = GetCurrentRenderTime();
+  m_eval_gpu_timer.Clear();
+  m_eval_cpu_times.Clear();
+  curr_vol_renderer->SetOutdated();
+}
+
+bool RenderingManager::CompleteEvaluationReadback (bool wait, ImageComparison::Scores* scores)
+{
+  auto pixels = std::make_shared<std::vector<unsigned char>>();
+  int w, h;
+  if (!m_eval_pixel_reader.Collect(*pixels, w, h, wait)) return false;
+
+  //Reads are collected in the order they were issued
+  EvaluationReadback readback = m_eval_readbacks.front();
+  m_eval_readbacks.pop_front();
+
+  //Compare it with the reference while it is still in memory
+  if (m_eval_image_comparison.HasReference())
+  {
+    //The window may have been resized since the reference was taken
+    if (w != m_eval_image_comparison.GetWidth() || h != m_eval_image_comparison.GetHeight())
+    {
+      printf("Evaluation: sample %d is %dx%d, the reference is %dx%d, it is not compared.\n", readback.sample, w, h,
+        m_eval_image_comparison.GetWidth(), m_eval_image_comparison.GetHeight());
+      readback.row += ",,,";
+      //Worst scores, so the adaptive search does not keep the sample
+      if (scores) *scores = { 0.0, 0.0, 1.0 };
+    }
+    else
+    {
+      const ImageComparison::Scores s = m_eval_image_comparison.Compare(pixels->data());
+      readback.row += "," + std::to_string(s.ssim) + "," + std::to_string(s.psnr) + "," + std::to_string(s.mae);
+      if (scores) *scores = s;
+    }
+  }
+
+  //The Pareto flags are only known at the end
+  if (m_eval_adaptive)
+  {
+    m_eval_rows.push_back(readback.row);
+  }
+  else
+  {
+    //On disk before the checkpoint, so that a resumed evaluation finds the rows of the completed samples
+    m_eval_csvfile << readback.row << "\n";
+    m_eval_csvfile.flush();
+    m_eval_checkpoint.MarkCompleted(readback.sample);
+  }
+
+  //Encode and write the image in the background, Push waits if too many images are queued
+  //It is renamed once complete: a resumed evaluation renders the samples without image again
+  const std::string filepath = m_eval_imgdirectory + "/" + readback.imagefilename;
+  m_eval_image_writer.Push([this, filepath, w, h, pixels]()
+  {
+    if (!GenerateImgFile(filepath + ".part", w, h, pixels->data(), false))
+    {
+      m_eval_image_errors++;
+      return;
+    }
+    std::error_code ec;
+    std::filesystem::rename(filepath + ".part", filepath, ec);
+    if (ec) m_eval_image_errors++;
+  });
+  return true;
+}
+
+std::string RenderingManager::GetEvaluationImageName (int sample)
+{
+  std::string imagefilename = std::to_string(sample);
+  size_t n_zero = 4;
+  return std::string(n_zero - std::min(n_zero, imagefilename.length()), '0') + imagefilename + ".png";
+}
+
+void RenderingManager::EndEvaluationReferencePass ()
+{
+  const int w = curr_rdr_parameters.GetScreenWidth(), h = curr_rdr_parameters.GetScreenHeight();
+  GLubyte* rgb_data = GetFrontBufferPixelData(false);
+  m_eval_image_comparison.SetReference(rgb_data, w, h);
+  if (!GenerateImgFile(m_eval_imgdirectory + "/reference.png", w, h, rgb_data, false))
+    m_eval_image_errors++;
+  delete[] rgb_data;
+  m_eval_reference_pass = false;
+
+  if (m_eval_reference_mode == 1)
+  {
+    //Restore the values, they are saved again by StartEvaluation
+    m_eval_paramspace.EndEvaluation();
+  }
+  else if (m_eval_reference_mode == 2)
+  {
+    //The evaluated renderer fills the parameter space again
+    ResetGLStateConfig();
+    m_current_vr_method_id = m_eval_renderer_id;
+    SetCurrentVolumeRenderer();
+  }
+
+  StartEvaluationSamples();
+}
+
 void RenderingManager::SetImGuiInterface ()
 {
 #ifdef USING_IMGUI
@@ -602,11 +1378,11 @@ void RenderingManager::SetImGuiInterface ()
     {
       if (m_vsync)
       {
-        wglSwapIntervalEXT(1);
+        SetSwapInterval(1);
       }
       else
       {
-        wglSwapIntervalEXT(0);
+        SetSwapInterval(0);
       }
     };
     if (ImGui::Checkbox("Idle Redraw", &m_idle_rendering));
@@ -813,10 +1589,50 @@ void RenderingManager::SetImGuiInterface ()
       ImGui::InputInt("Eval Frames per Sample", &m_eval_numframes, 1, 10);
       ImGui::PopItemWidth();
       m_eval_numframes = std::max(std::min(m_eval_numframes, 500), 1);
+      ImGui::PushItemWidth(100);
+      ImGui::InputInt("Eval Warm-up Frames", &m_eval_warmup_frames, 1, 10);
+      ImGui::PopItemWidth();
+      m_eval_warmup_frames = std::max(std::min(m_eval_warmup_frames, 100), 0);
 
-      const double neededtime = ceil(m_ts_window_ms * numsamples * m_eval_numframes / 1000.);
+      const double neededtime = ceil(m_ts_window_ms * numsamples * (m_eval_warmup_frames + m_eval_numframes) / 1000.);
       ImGui::Text("approx. %.0f seconds for evaluation at current FPS", neededtime);
-      if (ImGui::Button("Start Evaluation"))
+
+      //Reference frame of the SSIM, PSNR and MAE columns
+      ImGui::PushItemWidth(150);
+      ImGui::Combo("Reference###EvalReferenceMode", &m_eval_reference_mode, "None\0Parameter Sample\0Renderer\0");
+      ImGui::PopItemWidth();
+      if (m_eval_reference_mode == 1)
+      {
+        ImGui::PushItemWidth(100);
+        ImGui::InputInt("Reference Sample", &m_eval_reference_sample, 1, 10);
+        ImGui::PopItemWidth();
+        m_eval_reference_sample = std::max(std::min(m_eval_reference_sample, numsamples - 1), 0);
+      }
+      else if (m_eval_reference_mode == 2)
+      {
+        ImGui::Combo("###EvalReferenceRenderer", &m_eval_reference_renderer_id, vector_getter,
+          static_cast<void*>(&m_vtr_vr_ui_names), m_vtr_vr_ui_names.size());
+      }
+
+      //Searching the Pareto front needs the image error of each sample
+      if (m_eval_reference_mode != 0)
+      {
+        ImGui::Checkbox("Adaptive Pareto Search", &m_eval_adaptive);
+        if (m_eval_adaptive)
+        {
+          ImGui::PushItemWidth(100);
+          ImGui::Combo("Error Metric###EvalAdaptiveMetric", &m_eval_adaptive_metric, "1 - SSIM\0-PSNR\0MAE\0");
+          ImGui::InputInt("Max Samples (0: no limit)", &m_eval_max_samples, 1, 10);
+          ImGui::PopItemWidth();
+          m_eval_max_samples = std::max(m_eval_max_samples, 0);
+        }
+      }
+      else
+      {
+        m_eval_adaptive = false;
+      }
+
+      if (ImGui::Button("Start Evaluation") && !m_camera_path_playing)
       {
         //Name of a directory containing all the evaluation files - naming is datetime-based
         auto t = std::time(nullptr);
@@ -824,47 +1640,153 @@ void RenderingManager::SetImGuiInterface ()
         std::ostringstream oss;
         oss << std::put_time(&tm, "eval_%d-%m-%Y_%H-%M-%S");
         const std::string path_to_data = CPPVOLREND_DATA_DIR;
-        m_eval_basedirectory = path_to_data + oss.str();
-        // - and an image subsirectory
-        m_eval_imgdirectory = m_eval_basedirectory + "/img";
+        StartEvaluation(path_to_data + oss.str(), false);
+      }
+
+      //Continue an evaluation that was stopped, e.g. by a crash
+      ImGui::InputText("###EvalResumeDirectory", m_eval_resume_directory, sizeof(m_eval_resume_directory));
+      ImGui::SameLine();
+      if (ImGui::Button("Resume Evaluation") && !m_camera_path_playing)
+      {
+        std::string directory(m_eval_resume_directory);
+        if (std::filesystem::path(directory).is_relative())
+        {
+          const std::string path_to_data = CPPVOLREND_DATA_DIR;
+          directory = path_to_data + directory;
+        }
+        StartEvaluation(directory, true);
+      }
+    }
+
+    if (ImGui::CollapsingHeader("Auto-Tuning###AutoTuneHeader"))
+    {
+      ParameterSpace tuning_space;
+      curr_vol_renderer->FillTuningSpace(tuning_space);
+      if (tuning_space.GetNumSamplePoints() == 0)
+      {
+        ImGui::Text("Current renderer has no tuning parameters");
+      }
+      else
+      {
+        for (int i = 0; i < tuning_space.GetNumDimensions(); i++)
+          ImGui::Text("%s: %s", tuning_space.GetDimensionName(i).c_str(), tuning_space.GetDimensionValue(i).c_str());
 
-        //Create the new directories
-        std::filesystem::create_directory(m_eval_basedirectory);
-        std::filesystem::create_directory(m_eval_imgdirectory);
+        int path_frames = m_autotuner.GetPathFrames();
+        ImGui::PushItemWidth(100);
+        if (ImGui::InputInt("Camera Path Frames", &path_frames, 1, 10))
+          m_autotuner.SetPathFrames(std::max(std::min(path_frames, 1000), 1));
+        ImGui::PopItemWidth();
 
-        //Open a CSV file to record the results of the evaluation.
-        if (m_eval_csvfile.is_open()) m_eval_csvfile.close(); //Should really not happen, but better be save.
-        m_eval_csvfile.open(m_eval_basedirectory + "/eval.csv", std::ios_base::out);
+        if (ImGui::Button("Start Auto-Tuning") && !m_camera_path_playing)
+        {
+          if (m_autotuner.Start(curr_vol_renderer, curr_rdr_parameters.GetCamera(), m_data_mgr.GetCurrentVolumeName()))
+          {
+            //Same as evaluation: measure the volume renderer only, at full speed
+            m_imgui_render_ui = false;
+            SetSwapInterval(0);
+          }
+        }
 
-        //Start the evaluation if everything is fine
-        if (m_eval_csvfile.is_open())
+        const std::vector<AutoTuner::Result>& results = m_autotuner.GetLastResults();
+        for (int i = 0; i < (int)results.size(); i++)
         {
-          //Reset parameter space to the beginning
-          m_eval_paramspace.StartEvaluation();
+          ImGui::Text("%s %s: %.3f ms", i == m_autotuner.GetLastBestResult() ? "*" : " ",
+            results[i].config.c_str(), results[i].time_ms);
+        }
+      }
+    }
+
+    if (ImGui::CollapsingHeader("GPU Memory###GPUMemoryHeader"))
+    {
+      gl::MemoryRegistry& registry = gl::MemoryRegistry::Instance();
+      const double mb = 1024.0 * 1024.0;
+      ImGui::Text("Total: %.1f MB (peak %.1f MB)", registry.GetTotalBytes() / mb, registry.GetPeakBytes() / mb);
+      if (registry.HasBudget())
+        ImGui::Text("Budget: %.1f MB, %.1f MB available", registry.GetBudget() / mb, registry.GetAvailableBytes() / mb);
+
+      //Light caches are fitted to the budget when the renderer is rebuilt
+      ImGui::PushItemWidth(100);
+      ImGui::InputInt("Budget (MB), 0 = none", &m_gpu_memory_budget_mb, 64, 512);
+      ImGui::PopItemWidth();
+      m_gpu_memory_budget_mb = std::max(m_gpu_memory_budget_mb, 0);
+      if (ImGui::Button("Apply Budget and Rebuild Renderer"))
+      {
+        registry.SetBudget((size_t)m_gpu_memory_budget_mb * 1024 * 1024);
+        UpdateDataAndResetCurrentVRMode();
+        curr_vol_renderer->SetOutdated();
+      }
+      ImGui::SameLine();
+      if (ImGui::Button("Reset Peak")) registry.ResetPeak();
+
+      //Products shared by the renderers, the unused ones are deleted when they exceed their budget
+      vis::PreprocessingRegistry& preprocessing = m_data_mgr.GetPreprocessingRegistry();
+      ImGui::Text("Preprocessing: %d products, %.1f MB, %d in use", preprocessing.GetNumberOfProducts(),
+        preprocessing.GetTotalBytes() / mb, preprocessing.GetNumberOfReferences());
+      ImGui::Text("- %d built, %d reused (%.0f ms saved)", preprocessing.GetNumberOfBuilds(),
+        preprocessing.GetNumberOfHits(), preprocessing.GetSavedTime());
+      ImGui::PushItemWidth(100);
+      if (ImGui::InputInt("Preprocessing Budget (MB)", &m_preprocessing_budget_mb, 64, 256))
+      {
+        m_preprocessing_budget_mb = std::max(m_preprocessing_budget_mb, 0);
+        preprocessing.SetBudget((size_t)m_preprocessing_budget_mb * 1024 * 1024);
+      }
+      ImGui::PopItemWidth();
+      if (ImGui::Button("Delete Unused Products")) preprocessing.Clear();
 
-          //Initialize the csv file
-          for(int i=0;i<m_eval_paramspace.GetNumDimensions();i++)
+      for (const auto& tag : registry.GetBytesPerTag())
+      {
+        if (ImGui::TreeNode(tag.first.c_str(), "%s: %.2f MB", tag.first.c_str(), tag.second / mb))
+        {
+          for (const gl::MemoryRegistry::Allocation& a : registry.GetAllocations())
           {
-            m_eval_csvfile << m_eval_paramspace.GetDimensionName(i) << ",";
+            if (a.tag != tag.first) continue;
+            if (a.kind == gl::MemoryRegistry::BUFFER)
+              ImGui::BulletText("buffer %u: %.2f MB", a.id, a.bytes / mb);
+            else if (a.kind == gl::MemoryRegistry::PROGRAM)
+              ImGui::BulletText("submitted program %u: %.2f MB", a.id, a.bytes / mb);
+            else
+              ImGui::BulletText("texture %u: %dx%dx%d %s%s: %.2f MB", a.id, a.width, a.height, a.depth,
+                gl::MemoryRegistry::GetFormatName(a.internalformat), a.levels > 1 ? " mipmapped" : "", a.bytes / mb);
           }
-          m_eval_csvfile << "TimePerFrame (ms),FramesPerSecond,ImageFile\n";
+          ImGui::TreePop();
+        }
+      }
+    }
 
-          //Set a bool to trigger evaluation action in Display().
-          m_eval_running = true;
-          m_eval_currframe = 0;
-          m_eval_currsample = 0;
-          m_eval_lasttime = GetCurrentRenderTime();
-          curr_vol_renderer->SetOutdated();
-          // Careful: Not rendering the ImGui may have unintended consequences,
-          // namely if they Gui code changes parameters based on the parameters
-          // that we are setting during the eval.
-          // On the other hand, we want to measure the speed of the volume renderer and not of ImGui.
-          m_imgui_render_ui = false;
-
-          //Disable VSync for full speed
-          wglSwapIntervalEXT(0);
+    if (ImGui::CollapsingHeader("Profiler###ProfilerHeader"))
+    {
+      gl::Profiler& profiler = gl::Profiler::Instance();
+#ifndef USING_PROFILER
+      ImGui::Text("Built without the profiler zones (CPPVOLREND_PROFILER)");
+#endif
+      if (profiler.IsCapturing())
+      {
+        if (profiler.GetCaptureFrames() > 0)
+          ImGui::Text("Capturing: frame %d of %d", profiler.GetCapturedFrames(), profiler.GetCaptureFrames());
+        else
+          ImGui::Text("Capturing: frame %d", profiler.GetCapturedFrames());
+        if (ImGui::Button("Stop Capture")) profiler.Stop();
+      }
+      else
+      {
+        ImGui::PushItemWidth(100);
+        if (ImGui::InputInt("Frames (0: until stopped)###ProfilerFrames", &m_profiler_frames, 10, 100))
+          m_profiler_frames = std::max(m_profiler_frames, 0);
+        ImGui::PopItemWidth();
+
+        if (ImGui::Button("Start Capture"))
+        {
+          // Trace event file, opened with ui.perfetto.dev or chrome://tracing
+          auto t = std::time(nullptr);
+          auto tm = *std::localtime(&t);
+          std::ostringstream oss;
+          oss << std::put_time(&tm, "trace_%d-%m-%Y_%H-%M-%S.json");
+          const std::string path_to_data = CPPVOLREND_DATA_DIR;
+          profiler.Start(path_to_data + oss.str(), m_profiler_frames);
         }
       }
+      if (!profiler.GetLastFile().empty())
+        ImGui::TextWrapped("Last capture: %s", profiler.GetLastFile().c_str());
     }
 
     //int u_cam_beha = m_camera.GetCameraBehaviour();
@@ -890,6 +1812,59 @@ void RenderingManager::SetImGuiInterface ()
     //  }
     }
 
+    if (ImGui::CollapsingHeader("Camera Path###CameraPathHeader"))
+    {
+      ImGui::Text("- Keyframe: ");
+      ImGui::Combo("###ImArrayCameraPathKeyframe", &m_camera_path_keyframe_id, vector_getter,
+        static_cast<void*>(&m_std_cam_state_names), m_std_cam_state_names.size());
+      if (ImGui::Button("Add Keyframe###BTNaddcampathkeyframe") && !m_camera_path_playing)
+        AddCameraPathKeyframe(m_std_cam_state_names[m_camera_path_keyframe_id]);
+
+      for (int i = 0; i < m_camera_path.GetNumKeyframes(); i++)
+        ImGui::Text("%d: %s", i, m_camera_path.GetKeyframeName(i).c_str());
+
+      if (ImGui::Button("Remove Last###BTNremovecampathkeyframe") && !m_camera_path_playing)
+        m_camera_path.RemoveLastKeyframe();
+      ImGui::SameLine();
+      if (ImGui::Button("Clear###BTNclearcampath") && !m_camera_path_playing)
+        ClearCameraPath();
+
+      ImGui::PushItemWidth(100);
+      if (ImGui::InputInt("Path Frames", &m_camera_path_frames, 1, 10))
+        m_camera_path_frames = std::max(m_camera_path_frames, 2);
+      if (ImGui::InputInt("Path Warm-up Frames", &m_camera_path_warmup_frames, 1, 10))
+        m_camera_path_warmup_frames = std::max(m_camera_path_warmup_frames, 0);
+      ImGui::PopItemWidth();
+
+      if (m_camera_path.GetNumKeyframes() < 2)
+      {
+        ImGui::Text("Add at least 2 keyframes");
+      }
+      else if (m_camera_path_playing)
+      {
+        ImGui::Text("Playing: frame %d of %d", m_camera_path_currframe, m_camera_path_warmup_frames + m_camera_path_frames);
+      }
+      else
+      {
+        if (ImGui::Button("Play###BTNplaycampath"))
+          StartCameraPath("", m_camera_path_frames, m_camera_path_warmup_frames);
+        ImGui::SameLine();
+        if (ImGui::Button("Play and Record Trace###BTNrecordcampath"))
+        {
+          //Same naming as the evaluation directories
+          auto t = std::time(nullptr);
+          auto tm = *std::localtime(&t);
+          std::ostringstream oss;
+          oss << std::put_time(&tm, "path_%d-%m-%Y_%H-%M-%S");
+          const std::string path_to_data = CPPVOLREND_DATA_DIR;
+          const std::string path_directory = path_to_data + oss.str();
+          std::filesystem::create_directory(path_directory);
+
+          StartCameraPath(path_directory + "/trace.csv", m_camera_path_frames, m_camera_path_warmup_frames);
+        }
+      }
+    }
+
     if (ImGui::CollapsingHeader("Light Sources###LightSourceManagerHeader"))
     {
       ImGui::Text("- Light Source List:");
@@ -1080,6 +2055,17 @@ void RenderingManager::SetImGuiInterface ()
           ImGui::BulletText("Voxel Size: %.2f %.2f %.2f", m_data_mgr.GetCurrentStructuredVolume()->GetScaleX()
                                                         , m_data_mgr.GetCurrentStructuredVolume()->GetScaleY()
                                                         , m_data_mgr.GetCurrentStructuredVolume()->GetScaleZ());
+
+          // Stages of the load, on the pool or on the context thread
+          if (ImGui::TreeNode("###DataManagerLoadStages", "Load: %.1f ms, critical path %.1f ms",
+            m_data_mgr.GetLastLoadTotalTime(), m_data_mgr.GetLastLoadCriticalPathTime()))
+          {
+            ImGui::TextWrapped("%s", m_data_mgr.GetLastLoadCriticalPath().c_str());
+            for (const vis::TaskGraph::TaskTiming& stage : m_data_mgr.GetLastLoadStages())
+              ImGui::BulletText("%s%s: %.1f ms (%s)", stage.critical ? "* " : "", stage.name.c_str(),
+                stage.end_ms - stage.start_ms, stage.thread < 0 ? "context" : "worker");
+            ImGui::TreePop();
+          }
         }
         
         if (ImGui::CollapsingHeader("Gradient Volume###DataManagerGradientVolume"))
@@ -1110,20 +2096,20 @@ void RenderingManager::SetImGuiInterface ()
         if (transfer_function_index != m_data_mgr.GetCurrentTransferFunctionIndex())
         {
           m_data_mgr.SetCurrentTransferFunction(transfer_function_index);
-          UpdateDataAndResetCurrentVRMode();
+          UpdateTransferFunction();
         }
       }
       ImGui::SameLine();
       if (ImGui::Button("<###PreviousTF"))
       {
         m_data_mgr.PreviousTransferFunction();
-        UpdateDataAndResetCurrentVRMode();
+        UpdateTransferFunction();
       }
       ImGui::SameLine();
       if (ImGui::Button(">###NextTF"))
       {
         m_data_mgr.NextTransferFunction();
-        UpdateDataAndResetCurrentVRMode();
+        UpdateTransferFunction();
       }
     }
     ImGui::End();
@@ -1139,12 +2125,31 @@ void RenderingManager::SetImGuiInterface ()
       SetCurrentVolumeRenderer();
     }
 
-    if (ImGui::Button("Reload Shaders"))
+    if (ImGui::Button("Reload Shaders") && curr_vol_renderer->IsBuilt())
     {
       curr_vol_renderer->ReloadShaders();
     }
+    ImGui::Text("Init: %.1f ms, Shader Programs: %.1f ms", m_time_renderer_init_ms, m_time_renderer_programs_ms);
+    ImGui::Text("(%d cached, %d compiled)", m_renderer_programs_cached, m_renderer_programs_compiled);
+    if (m_time_transfer_function_update_ms >= 0.0)
+      ImGui::Text("Transfer Function Update: %.1f ms", m_time_transfer_function_update_ms);
+    bool use_program_cache = gl::ProgramCache::Instance().IsEnabled();
+    if (ImGui::Checkbox("Shader Program Cache###RendererProgramCache", &use_program_cache))
+      gl::ProgramCache::Instance().SetEnabled(use_program_cache);
 
-    curr_vol_renderer->SetImGuiComponents();
+    ImGui::Checkbox("Compile Shaders in Background###RendererAsyncActivation", &m_async_renderer_activation);
+
+    if (m_renderer_compiling)
+    {
+      ImGui::Separator();
+      ImGui::Text("Compiling shader programs (%d left)...",
+        gl::ProgramCompiler::Instance().GetNumberOfCompiling(curr_vol_renderer->GetName()));
+    }
+    else
+    {
+      gl::MemoryRegistry::ScopedTag memory_tag(curr_vol_renderer->GetName());
+      curr_vol_renderer->SetImGuiComponents();
+    }
 
     ImGui::End();
   }
@@ -1239,9 +2244,39 @@ RenderingManager::RenderingManager ()
 
   animate_camera_rotation = false;
 
+  m_time_renderer_init_ms = 0.0;
+  m_time_transfer_function_update_ms = -1.0;
+  m_time_renderer_programs_ms = 0.0;
+  m_renderer_programs_cached = 0;
+  m_renderer_programs_compiled = 0;
+#ifdef USING_HEADLESS
+  m_async_renderer_activation = false;
+#else
+  m_async_renderer_activation = true;
+#endif
+  m_renderer_compiling = false;
+  m_camera_path_frames = 300;
+  m_camera_path_warmup_frames = 5;
+  m_camera_path_keyframe_id = 0;
+  m_camera_path_playing = false;
+  m_camera_path_currframe = 0;
   m_eval_running = false;
+  m_eval_image_errors = 0;
   m_eval_numframes = 100;
+  m_eval_warmup_frames = 5;
   m_eval_currframe = 0;
+  m_eval_reference_mode = 0;
+  m_eval_reference_sample = 0;
+  m_eval_reference_renderer_id = 0;
+  m_eval_resume_directory[0] = '\0';
+  m_eval_reference_pass = false;
+  m_eval_renderer_id = 0;
+  m_eval_adaptive = false;
+  m_eval_adaptive_metric = 0;
+  m_eval_max_samples = 0;
+  m_gpu_memory_budget_mb = 0;
+  m_preprocessing_budget_mb = (int)(m_data_mgr.GetPreprocessingRegistry().GetBudget() / (1024 * 1024));
+  m_profiler_frames = 60;
 
   m_imgui_render_ui = true;
 
@@ -1254,6 +2289,8 @@ RenderingManager::RenderingManager ()
 #else
 #ifdef USING_GLFW
   m_ts_last_time = glfwGetTime();
+#else
+  m_ts_last_time = GetCurrentRenderTime();
 #endif
 #endif
   m_ts_n_frames = 0;
@@ -14,7 +14,9 @@
 
 #include <glm/glm.hpp>
 #include <vector>
+#include <deque>
 #include <fstream>
+#include <atomic>
 
 #include <volvis_utils/datamanager.h>
 #include <volvis_utils/renderingparameters.h>
@@ -23,6 +25,16 @@
 #include <volvis_utils/lightsourcelist.h>
 
 #include "utils/parameterspace.h"
+#include "utils/autotuner.h"
+#include "utils/imagecomparison.h"
+#include "utils/frametimestatistics.h"
+#include "utils/paretosearch.h"
+#include "utils/boundedtaskqueue.h"
+#include "utils/camerapath.h"
+#include "utils/evaluationcheckpoint.h"
+
+#include <gl_utils/timer.h>
+#include <gl_utils/asyncpixelreader.h>
 
 class BaseVolumeRenderer;
 
@@ -65,7 +77,13 @@ public:
   void PostRedisplay ();
 
   // Update the volume renderer with the current volume and transfer function
+  // . interactive sessions keep drawing while the recorded programs of the
+  //   renderer compile in the background, Init is called by Display once they are linked
   void UpdateDataAndResetCurrentVRMode ();
+  // Update the volume renderer with the current transfer function
+  // . renderers that support it only update their transfer function texture and
+  //   the structures computed from it, the others are reset
+  void UpdateTransferFunction ();
 
   unsigned int GetScreenWidth ()
   {
@@ -82,11 +100,86 @@ public:
     return m_idle_rendering;
   }
 
+  // Selection by name, used by the command line (headless) application
+  // . the volume renderer can also be given by its abbreviation or index
+  bool SelectVolumeRenderer (std::string name);
+  bool SelectVolume (std::string name);
+  bool SelectTransferFunction (std::string name);
+  bool SelectCameraState (std::string name);
+  bool SelectLightSourceList (std::string name);
+
+  // Print the available renderers, datasets, transfer functions and camera states
+  void PrintSelectionLists ();
+
+  // Evaluation of the parameter space of the current renderer, written to
+  // directory/eval.csv and directory/img. With resume, the samples completed
+  // by a previous run of the same evaluation in directory are skipped (see EvaluationCheckpoint)
+  bool StartEvaluation (std::string directory, bool resume);
+  void SetEvaluationFrames (int frames, int warmup);
+  bool IsEvaluationRunning ()
+  {
+    return m_eval_running;
+  }
+  // Images of the last evaluation that could not be written
+  int GetEvaluationImageErrors ()
+  {
+    return m_eval_image_errors;
+  }
+
+  // Camera flythrough, the keyframes are camera states (see CameraPath)
+  bool AddCameraPathKeyframe (std::string camera_state_name);
+  void ClearCameraPath ();
+  // Plays the path once: warmup frames at the first keyframe, then frames along the path.
+  // . with a trace file, the GPU time, CPU time and renderer statistics of each frame are written to it
+  bool StartCameraPath (std::string trace_file, int frames, int warmup);
+  bool IsCameraPathPlaying ()
+  {
+    return m_camera_path_playing;
+  }
+
+  void SetImGuiRenderUI (bool render_ui)
+  {
+    m_imgui_render_ui = render_ui;
+  }
+
+  BaseVolumeRenderer* GetCurrentVolumeRenderer ()
+  {
+    return curr_vol_renderer;
+  }
+
+  vis::DataManager* GetDataManager ()
+  {
+    return &m_data_mgr;
+  }
+
+  std::string GetCurrentCameraStateName ()
+  {
+    return m_std_cam_state_names.empty() ? "" : m_std_cam_state_names[m_current_camera_state_id];
+  }
+
+  std::string GetCurrentLightSourceListName ()
+  {
+    return m_std_lsource_names.empty() ? "" : m_std_lsource_names[m_current_lightsource_data_id];
+  }
+
+  // Time of the last Init of the current renderer (preprocessing), in ms
+  double GetLastRendererInitTime ()
+  {
+    return m_time_renderer_init_ms;
+  }
+
+  // Part of the last Init spent building shader programs (see gl::ProgramCache), in ms
+  double GetLastRendererProgramTime ()
+  {
+    return m_time_renderer_programs_ms;
+  }
+
+  bool SaveScreenshot (std::string filename = "");
+
 protected:
 
 
 private:
-  void SaveScreenshot (std::string filename = "");
   void UpdateLightSourceCameraVectors ();
   void ResetGLStateConfig ();
 
@@ -94,6 +187,8 @@ private:
   bool GenerateImgFile (std::string out_str, int w, int h, unsigned char *gl_data, bool alpha = true, std::string image_type = "PNG");
 
   GLubyte* GetFrontBufferPixelData (bool alpha = true);
+  // Same buffer as GetFrontBufferPixelData, read by m_eval_pixel_reader
+  void ReadFrontBufferPixelDataAsync ();
 
   // Go to previous renderer
   bool PreviousRenderer ();
@@ -124,12 +219,107 @@ private:
   ParameterSpace m_eval_paramspace;
   bool m_eval_running;
   int m_eval_numframes;
+  // Frames rendered before the measured ones of each sample
+  int m_eval_warmup_frames;
   int m_eval_currframe;
   int m_eval_currsample;
   double m_eval_lasttime;
   std::string m_eval_basedirectory;
   std::string m_eval_imgdirectory;
   std::ofstream m_eval_csvfile;
+  // GPU time of each measured frame, read back a few frames later
+  gl::PipelinedTimer m_eval_gpu_timer;
+  // Time to issue the rendering commands of each measured frame
+  FrameTimeStatistics m_eval_cpu_times;
+
+  // Image quality of each sample against a reference frame kept in memory:
+  // . 0: none
+  // . 1: a sample of the parameter space of the evaluated renderer
+  // . 2: another renderer, with its current parameters
+  int m_eval_reference_mode;
+  int m_eval_reference_sample;
+  int m_eval_reference_renderer_id;
+  // The reference frame is rendered before the samples
+  bool m_eval_reference_pass;
+  int m_eval_renderer_id;
+  ImageComparison m_eval_image_comparison;
+  void StartEvaluationSamples ();
+
+  // Adaptive search of the Pareto front of GPU time (median) against image
+  // error instead of all the samples, needs a reference frame
+  bool m_eval_adaptive;
+  // 0: 1 - SSIM, 1: -PSNR, 2: MAE
+  int m_eval_adaptive_metric;
+  // 0: no limit
+  int m_eval_max_samples;
+  ParetoSearch m_eval_search;
+  // Rows of eval.csv, written with the Pareto flags at the end
+  std::vector<std::string> m_eval_rows;
+
+  // The sample images are read back a frame or more later, then compared
+  // with the reference and written to disk by background threads
+  struct EvaluationReadback
+  {
+    int sample;
+    // csv row without the image comparison columns
+    std::string row;
+    std::string imagefilename;
+  };
+  gl::AsyncPixelReader m_eval_pixel_reader;
+  std::deque<EvaluationReadback> m_eval_readbacks;
+  BoundedTaskQueue m_eval_image_writer;
+  std::atomic<int> m_eval_image_errors;
+  // Returns false if no readback was finished (or pending, if wait is true)
+  bool CompleteEvaluationReadback (bool wait, ImageComparison::Scores* scores = nullptr);
+  void EndEvaluationReferencePass ();
+  std::string GetEvaluationImageName (int sample);
+
+  // Samples whose row and image are written, exhaustive evaluations only
+  EvaluationCheckpoint m_eval_checkpoint;
+  // Directory typed in the UI
+  char m_eval_resume_directory[512];
+
+  double m_time_renderer_init_ms;
+  double m_time_renderer_programs_ms;
+  // Last transfer function change handled without a reset, -1 if it was reset
+  double m_time_transfer_function_update_ms;
+  int m_renderer_programs_cached;
+  int m_renderer_programs_compiled;
+
+  // Renderer activation waiting for its programs (see gl::ProgramCompiler)
+  bool m_async_renderer_activation;
+  bool m_renderer_compiling;
+  void InitCurrentRenderer ();
+
+  // Budget typed in the UI, applied to gl::MemoryRegistry on demand
+  int m_gpu_memory_budget_mb;
+  int m_preprocessing_budget_mb;
+
+  // Frames of the next trace capture (see gl::Profiler), 0 until stopped
+  int m_profiler_frames;
+
+  CameraPath m_camera_path;
+  int m_camera_path_frames;
+  int m_camera_path_warmup_frames;
+  // Camera state added by the UI
+  int m_camera_path_keyframe_id;
+  bool m_camera_path_playing;
+  int m_camera_path_currframe;
+  std::string m_camera_path_trace_file;
+  gl::PipelinedTimer m_camera_path_gpu_timer;
+  struct CameraPathTraceFrame
+  {
+    float position;
+    glm::vec3 eye;
+    double cpu_ms;
+    std::vector<std::pair<std::string, double>> statistics;
+  };
+  std::vector<CameraPathTraceFrame> m_camera_path_trace;
+  void EndCameraPath ();
+
+  AutoTuner m_autotuner;
+  gl::Timer m_autotune_timer;
+  void EndAutoTuning ();
 
   void SetImGuiInterface ();
   void DrawImGuiInterface ();
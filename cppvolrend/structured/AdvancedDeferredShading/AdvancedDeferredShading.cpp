@@ -8,6 +8,7 @@
 #include <glm/ext.hpp>
 
 #include <math_utils/utils.h>
+#include <gl_utils/memoryregistry.h>
 
 #include <GLFW/glfw3.h>
 
@@ -167,6 +168,7 @@ void AdvancedDeferredShading::CreateGBuffer(int width, int height)
     glGenTextures(1, &gPosition);
     glBindTexture(GL_TEXTURE_2D, gPosition);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+    gl::MemoryRegistry::Instance().RegisterTexture(gPosition, GL_RGBA32F, width, height);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gPosition, 0);
@@ -175,6 +177,7 @@ void AdvancedDeferredShading::CreateGBuffer(int width, int height)
     glGenTextures(1, &gNormal);
     glBindTexture(GL_TEXTURE_2D, gNormal);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+    gl::MemoryRegistry::Instance().RegisterTexture(gNormal, GL_RGBA32F, width, height);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gNormal, 0);
@@ -182,6 +185,7 @@ void AdvancedDeferredShading::CreateGBuffer(int width, int height)
     glGenTextures(1, &gCurvatureMax);
     glBindTexture(GL_TEXTURE_2D, gCurvatureMax);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, width, height, 0, GL_RED, GL_FLOAT, NULL);
+    gl::MemoryRegistry::Instance().RegisterTexture(gCurvatureMax, GL_R32F, width, height);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, gCurvatureMax, 0);
@@ -190,6 +194,7 @@ void AdvancedDeferredShading::CreateGBuffer(int width, int height)
     glGenTextures(1, &gCurvatureMin);
     glBindTexture(GL_TEXTURE_2D, gCurvatureMin);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, width, height, 0, GL_RED, GL_FLOAT, NULL);
+    gl::MemoryRegistry::Instance().RegisterTexture(gCurvatureMin, GL_R32F, width, height);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT3, GL_TEXTURE_2D, gCurvatureMin, 0);
@@ -197,6 +202,7 @@ void AdvancedDeferredShading::CreateGBuffer(int width, int height)
     glGenTextures(1, &gCurvatureDir);
     glBindTexture(GL_TEXTURE_2D, gCurvatureDir);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, width, height, 0, GL_RED, GL_FLOAT, NULL);
+    gl::MemoryRegistry::Instance().RegisterTexture(gCurvatureDir, GL_R32F, width, height);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT4, GL_TEXTURE_2D, gCurvatureDir, 0);
@@ -205,6 +211,7 @@ void AdvancedDeferredShading::CreateGBuffer(int width, int height)
     glGenTextures(1, &gCurvatureDebug);
     glBindTexture(GL_TEXTURE_2D, gCurvatureDebug);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+    gl::MemoryRegistry::Instance().RegisterTexture(gCurvatureDebug, GL_RGBA32F, width, height);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT5, GL_TEXTURE_2D, gCurvatureDebug, 0);
@@ -266,6 +273,7 @@ void AdvancedDeferredShading::CreateTransferFunctions() {
     glGenTextures(1, &curvatureColorMap);
     glBindTexture(GL_TEXTURE_1D, curvatureColorMap);
     glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA32F, colorMapSize, 0, GL_RGBA, GL_FLOAT, colorMap.data());
+    gl::MemoryRegistry::Instance().RegisterTexture(curvatureColorMap, GL_RGBA32F, colorMapSize);
     glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -295,6 +303,7 @@ void AdvancedDeferredShading::CreateTransferFunctions() {
     glGenTextures(1, &ridgeValleyMap);
     glBindTexture(GL_TEXTURE_2D, ridgeValleyMap);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, ridgeMapSize, ridgeMapSize, 0, GL_RGBA, GL_FLOAT, ridgeMap.data());
+    gl::MemoryRegistry::Instance().RegisterTexture(ridgeValleyMap, GL_RGBA32F, ridgeMapSize, ridgeMapSize);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -317,6 +326,7 @@ void AdvancedDeferredShading::CreateTransferFunctions() {
     glGenTextures(1, &noiseTexture);
     glBindTexture(GL_TEXTURE_2D, noiseTexture);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, noiseSize, noiseSize, 0, GL_RED, GL_FLOAT, noise.data());
+    gl::MemoryRegistry::Instance().RegisterTexture(noiseTexture, GL_R32F, noiseSize, noiseSize);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -398,7 +408,9 @@ void AdvancedDeferredShading::Clean() {
     // 清理G-Buffer
     if (gBuffer) {
         glDeleteFramebuffers(1, &gBuffer);
+        gl::MemoryRegistry::Instance().Unregister(gl::MemoryRegistry::TEXTURE, gPosition);
         glDeleteTextures(1, &gPosition);
+        gl::MemoryRegistry::Instance().Unregister(gl::MemoryRegistry::TEXTURE, gNormal);
         glDeleteTextures(1, &gNormal);
         gBuffer = 0;
         gPosition = 0;
@@ -417,22 +429,31 @@ void AdvancedDeferredShading::Clean() {
 
     // 清理分块纹理
     if (m_texBlockMin) {
+        gl::MemoryRegistry::Instance().Unregister(gl::MemoryRegistry::TEXTURE, m_texBlockMin);
         glDeleteTextures(1, &m_texBlockMin);
         m_texBlockMin = 0;
     }
     if (m_texBlockMax) {
+        gl::MemoryRegistry::Instance().Unregister(gl::MemoryRegistry::TEXTURE, m_texBlockMax);
         glDeleteTextures(1, &m_texBlockMax);
         m_texBlockMax = 0;
     }
     if (m_lighting_texture) {
+        gl::MemoryRegistry::Instance().Unregister(gl::MemoryRegistry::TEXTURE, m_lighting_texture);
         glDeleteTextures(1, &m_lighting_texture);
         m_lighting_texture = 0;
     }
+    gl::MemoryRegistry::Instance().Unregister(gl::MemoryRegistry::TEXTURE, gCurvatureMax);
     glDeleteTextures(1, &gCurvatureMax);
+    gl::MemoryRegistry::Instance().Unregister(gl::MemoryRegistry::TEXTURE, gCurvatureMin);
     glDeleteTextures(1, &gCurvatureMin);
+    gl::MemoryRegistry::Instance().Unregister(gl::MemoryRegistry::TEXTURE, gCurvatureDir);
     glDeleteTextures(1, &gCurvatureDir);
+    gl::MemoryRegistry::Instance().Unregister(gl::MemoryRegistry::TEXTURE, curvatureColorMap);
     glDeleteTextures(1, &curvatureColorMap);
+    gl::MemoryRegistry::Instance().Unregister(gl::MemoryRegistry::TEXTURE, ridgeValleyMap);
     glDeleteTextures(1, &ridgeValleyMap);
+    gl::MemoryRegistry::Instance().Unregister(gl::MemoryRegistry::TEXTURE, noiseTexture);
     glDeleteTextures(1, &noiseTexture);
    // delete cp_curvature_pass;
 
@@ -559,9 +580,19 @@ bool AdvancedDeferredShading::Init(int swidth, int sheight) {
     if (!volume) return false;
 
     glm::vec3 numBlocks(4, 4, 4);
-    std::vector<float> minValues;
-    std::vector<float> maxValues;
-    ComputeBlocksFromVolume(volume, numBlocks, minValues, maxValues, vol_voxelsize);
+    // Shared with the other block-based renderers of the same volume
+    vis::PreprocessingRegistry& preprocessing = m_ext_data_manager->GetPreprocessingRegistry();
+    vis::BlockMinMax* blocks = preprocessing.Acquire<vis::BlockMinMax>(
+        m_ext_data_manager->GetPreprocessingKey("BlockMinMax", false,
+            std::to_string((int)numBlocks.x) + "x" + std::to_string((int)numBlocks.y) + "x" + std::to_string((int)numBlocks.z)),
+        [&]() {
+            vis::BlockMinMax* computed = new vis::BlockMinMax();
+            ComputeBlocksFromVolume(volume, numBlocks, computed->min_values, computed->max_values, vol_voxelsize);
+            return computed;
+        });
+    std::vector<float> minValues = blocks->min_values;
+    std::vector<float> maxValues = blocks->max_values;
+    preprocessing.Release(blocks);
 
     // 创建几何Pass着色器
     cp_geometry_pass = new gl::ComputeShader();
@@ -617,6 +648,7 @@ bool AdvancedDeferredShading::Init(int swidth, int sheight) {
     glTexImage3D(GL_TEXTURE_3D, 0, GL_R32F,
         (GLsizei)numBlocks.x, (GLsizei)numBlocks.y, (GLsizei)numBlocks.z,
         0, GL_RED, GL_FLOAT, minValues.data());
+    gl::MemoryRegistry::Instance().RegisterTexture(texIDBlockMin, GL_R32F, numBlocks.x, numBlocks.y, numBlocks.z);
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glBindTexture(GL_TEXTURE_3D, 0);
@@ -626,10 +658,13 @@ bool AdvancedDeferredShading::Init(int swidth, int sheight) {
     glTexImage3D(GL_TEXTURE_3D, 0, GL_R32F,
         (GLsizei)numBlocks.x, (GLsizei)numBlocks.y, (GLsizei)numBlocks.z,
         0, GL_RED, GL_FLOAT, maxValues.data());
+    gl::MemoryRegistry::Instance().RegisterTexture(texIDBlockMax, GL_R32F, numBlocks.x, numBlocks.y, numBlocks.z);
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glBindTexture(GL_TEXTURE_3D, 0);
 
+    m_texBlockMin = texIDBlockMin;
+    m_texBlockMax = texIDBlockMax;
     cp_geometry_pass->SetUniformTexture3D("TexBlockMin", texIDBlockMin, 3);
     cp_geometry_pass->SetUniformTexture3D("TexBlockMax", texIDBlockMax, 4);
 
@@ -637,6 +672,7 @@ bool AdvancedDeferredShading::Init(int swidth, int sheight) {
     glBindTexture(GL_TEXTURE_2D, m_lighting_texture);
     std::vector<float> clearColor(swidth * sheight * 4, 1.0f);  // 初始化为白色
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, swidth, sheight, 0, GL_RGBA, GL_FLOAT, NULL);
+    gl::MemoryRegistry::Instance().RegisterTexture(m_lighting_texture, GL_RGBA32F, swidth, sheight);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_lighting_texture, 0);
@@ -32,7 +32,7 @@ public:
         std::vector<float>& minValues,
         std::vector<float>& maxValues,
         glm::vec3 vol_voxelsize);
-    void AdvancedDeferredShading::LightingPass(vis::Camera* camera);
+    void LightingPass(vis::Camera* camera);
     GLuint m_texBlockMin = 0;  
     GLuint m_texBlockMax = 0;  
 
@@ -102,7 +102,7 @@ public:
     void RenderQuad();
     void UpdateGeometryPassUniforms(vis::Camera* camera);
     void UpdateLightingPassUniforms(vis::Camera* camera);
-    void AdvancedDeferredShading::InitQuad();
+    void InitQuad();
     // ˽ȾĿ
     GLuint m_outputTexture;      // 
     GLuint m_lightingBuffer;     // ռ㻺
@@ -131,10 +131,10 @@ public:
     bool m_show_ridges = true;
     bool m_show_valleys = true;
     float m_accessibility_strength = 0.5f;
-    void AdvancedDeferredShading::InitCurvaturePass();
-    void AdvancedDeferredShading::CreateTransferFunctions();
+    void InitCurvaturePass();
+    void CreateTransferFunctions();
 
-    void AdvancedDeferredShading::CurvaturePass();
+    void CurvaturePass();
 
     // HSV color control
     float m_hsv_h = 0.0f;    // Hue [0-360]
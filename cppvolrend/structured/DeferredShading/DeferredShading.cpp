@@ -8,6 +8,7 @@
 #include <glm/ext.hpp>
 
 #include <math_utils/utils.h>
+#include <gl_utils/memoryregistry.h>
 
 
 
@@ -163,6 +164,7 @@ void DeferredShading::CreateGBuffer(int width, int height)
     glGenTextures(1, &gPosition);
     glBindTexture(GL_TEXTURE_2D, gPosition);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+    gl::MemoryRegistry::Instance().RegisterTexture(gPosition, GL_RGBA32F, width, height);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gPosition, 0);
@@ -171,6 +173,7 @@ void DeferredShading::CreateGBuffer(int width, int height)
     glGenTextures(1, &gNormal);
     glBindTexture(GL_TEXTURE_2D, gNormal);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+    gl::MemoryRegistry::Instance().RegisterTexture(gNormal, GL_RGBA32F, width, height);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gNormal, 0);
@@ -235,7 +238,9 @@ void DeferredShading::Clean() {
     // 清理G-Buffer
     if (gBuffer) {
         glDeleteFramebuffers(1, &gBuffer);
+        gl::MemoryRegistry::Instance().Unregister(gl::MemoryRegistry::TEXTURE, gPosition);
         glDeleteTextures(1, &gPosition);
+        gl::MemoryRegistry::Instance().Unregister(gl::MemoryRegistry::TEXTURE, gNormal);
         glDeleteTextures(1, &gNormal);
         gBuffer = 0;
         gPosition = 0;
@@ -254,14 +259,17 @@ void DeferredShading::Clean() {
 
     // 清理分块纹理
     if (m_texBlockMin) {
+        gl::MemoryRegistry::Instance().Unregister(gl::MemoryRegistry::TEXTURE, m_texBlockMin);
         glDeleteTextures(1, &m_texBlockMin);
         m_texBlockMin = 0;
     }
     if (m_texBlockMax) {
+        gl::MemoryRegistry::Instance().Unregister(gl::MemoryRegistry::TEXTURE, m_texBlockMax);
         glDeleteTextures(1, &m_texBlockMax);
         m_texBlockMax = 0;
     }
     if (m_lighting_texture) {
+        gl::MemoryRegistry::Instance().Unregister(gl::MemoryRegistry::TEXTURE, m_lighting_texture);
         glDeleteTextures(1, &m_lighting_texture);
         m_lighting_texture = 0;
     }
@@ -346,9 +354,19 @@ bool DeferredShading::Init(int swidth, int sheight) {
     if (!volume) return false;
 
     glm::vec3 numBlocks(4, 4, 4);
-    std::vector<float> minValues;
-    std::vector<float> maxValues;
-    ComputeBlocksFromVolume(volume, numBlocks, minValues, maxValues, vol_voxelsize);
+    // Shared with the other block-based renderers of the same volume
+    vis::PreprocessingRegistry& preprocessing = m_ext_data_manager->GetPreprocessingRegistry();
+    vis::BlockMinMax* blocks = preprocessing.Acquire<vis::BlockMinMax>(
+        m_ext_data_manager->GetPreprocessingKey("BlockMinMax", false,
+            std::to_string((int)numBlocks.x) + "x" + std::to_string((int)numBlocks.y) + "x" + std::to_string((int)numBlocks.z)),
+        [&]() {
+            vis::BlockMinMax* computed = new vis::BlockMinMax();
+            ComputeBlocksFromVolume(volume, numBlocks, computed->min_values, computed->max_values, vol_voxelsize);
+            return computed;
+        });
+    std::vector<float> minValues = blocks->min_values;
+    std::vector<float> maxValues = blocks->max_values;
+    preprocessing.Release(blocks);
 
     // 创建几何Pass着色器
     cp_geometry_pass = new gl::ComputeShader();
@@ -404,6 +422,7 @@ bool DeferredShading::Init(int swidth, int sheight) {
     glTexImage3D(GL_TEXTURE_3D, 0, GL_R32F,
         (GLsizei)numBlocks.x, (GLsizei)numBlocks.y, (GLsizei)numBlocks.z,
         0, GL_RED, GL_FLOAT, minValues.data());
+    gl::MemoryRegistry::Instance().RegisterTexture(texIDBlockMin, GL_R32F, numBlocks.x, numBlocks.y, numBlocks.z);
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glBindTexture(GL_TEXTURE_3D, 0);
@@ -413,16 +432,20 @@ bool DeferredShading::Init(int swidth, int sheight) {
     glTexImage3D(GL_TEXTURE_3D, 0, GL_R32F,
         (GLsizei)numBlocks.x, (GLsizei)numBlocks.y, (GLsizei)numBlocks.z,
         0, GL_RED, GL_FLOAT, maxValues.data());
+    gl::MemoryRegistry::Instance().RegisterTexture(texIDBlockMax, GL_R32F, numBlocks.x, numBlocks.y, numBlocks.z);
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glBindTexture(GL_TEXTURE_3D, 0);
 
+    m_texBlockMin = texIDBlockMin;
+    m_texBlockMax = texIDBlockMax;
     cp_geometry_pass->SetUniformTexture3D("TexBlockMin", texIDBlockMin, 3);
     cp_geometry_pass->SetUniformTexture3D("TexBlockMax", texIDBlockMax, 4);
 
     glGenTextures(1, &m_lighting_texture);
     glBindTexture(GL_TEXTURE_2D, m_lighting_texture);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, swidth, sheight, 0, GL_RGBA, GL_FLOAT, NULL);
+    gl::MemoryRegistry::Instance().RegisterTexture(m_lighting_texture, GL_RGBA32F, swidth, sheight);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_lighting_texture, 0);
@@ -32,7 +32,7 @@ public:
         std::vector<float>& minValues,
         std::vector<float>& maxValues,
         glm::vec3 vol_voxelsize);
-    void DeferredShading::LightingPass(vis::Camera* camera);
+    void LightingPass(vis::Camera* camera);
     GLuint m_texBlockMin = 0;  
     GLuint m_texBlockMax = 0;  
 
@@ -102,7 +102,7 @@ public:
     void RenderQuad();
     void UpdateGeometryPassUniforms(vis::Camera* camera);
     void UpdateLightingPassUniforms(vis::Camera* camera);
-    void DeferredShading::InitQuad();
+    void InitQuad();
     // ˽ȾĿ
     GLuint m_outputTexture;      // 
     GLuint m_lightingBuffer;     // ռ㻺
@@ -188,9 +188,19 @@ bool FowardRendering::Init(int swidth, int sheight)
 
     // 初始化块分割
     glm::vec3 numBlocks(4, 4, 4);
-    std::vector<float> minValues;
-    std::vector<float> maxValues;
-    ComputeBlocksFromVolume(volume, numBlocks, minValues, maxValues, vol_voxelsize);
+    // Shared with the other block-based renderers of the same volume
+    vis::PreprocessingRegistry& preprocessing = m_ext_data_manager->GetPreprocessingRegistry();
+    vis::BlockMinMax* blocks = preprocessing.Acquire<vis::BlockMinMax>(
+        m_ext_data_manager->GetPreprocessingKey("BlockMinMax", false,
+            std::to_string((int)numBlocks.x) + "x" + std::to_string((int)numBlocks.y) + "x" + std::to_string((int)numBlocks.z)),
+        [&]() {
+            vis::BlockMinMax* computed = new vis::BlockMinMax();
+            ComputeBlocksFromVolume(volume, numBlocks, computed->min_values, computed->max_values, vol_voxelsize);
+            return computed;
+        });
+    std::vector<float> minValues = blocks->min_values;
+    std::vector<float> maxValues = blocks->max_values;
+    preprocessing.Release(blocks);
 
 
     // - 加载着色器
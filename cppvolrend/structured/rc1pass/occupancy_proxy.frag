@@ -0,0 +1,15 @@
+#version 430
+
+// Written with GL_MIN blending: (tnear, -tfar) of the faces covering each pixel
+layout (location = 0) out vec4 FragColor;
+
+uniform vec3 CameraEye;
+
+in vec3 world_pos;
+
+void main (void)
+{
+  // Ray parameter along the normalized ray direction
+  float t = length(world_pos - CameraEye);
+  FragColor = vec4(t, -t, 0.0, 0.0);
+}
@@ -0,0 +1,19 @@
+#version 430
+
+// Boundary faces of the non-empty blocks, in voxel coordinates
+layout(location = 0) in vec3 VerPos;
+
+uniform vec3 VolumeVoxelSize;
+uniform vec3 VolumeGridSize;
+
+uniform mat4 u_CameraLookAt;
+uniform mat4 ProjectionMatrix;
+
+out vec3 world_pos;
+
+void main (void)
+{
+  // Same world space of the ray casting: volume centered at the origin
+  world_pos = VerPos * VolumeVoxelSize - (VolumeGridSize * 0.5);
+  gl_Position = ProjectionMatrix * u_CameraLookAt * vec4(world_pos, 1.0);
+}
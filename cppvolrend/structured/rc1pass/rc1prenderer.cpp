@@ -16,10 +16,23 @@
 #include "imgui_impl_opengl2.h"
 
 RayCasting1Pass::RayCasting1Pass ()
-  : m_glsl_transfer_function(nullptr)
+  : m_u_step_size(0.5f)
+  , m_glsl_transfer_function(nullptr)
   , cp_geometry_pass(nullptr)
-  , m_u_step_size(0.5f)
+  , m_parameter_block(nullptr)
   , m_apply_gradient_shading(false)
+  , m_composition(0)
+  , m_precompiled_variant(-1)
+  , m_glsl_occupancy_distance(nullptr)
+  , m_apply_empty_space_skipping(true)
+  , m_occupancy_block_size(8)
+  , ps_proxy_pass(nullptr)
+  , m_proxy_fbo(nullptr)
+  , m_proxy_vao(nullptr)
+  , m_proxy_vbo(nullptr)
+  , m_proxy_ibo(nullptr)
+  , m_proxy_index_count(0)
+  , m_apply_proxy_geometry(true)
 {
 #ifdef MULTISAMPLE_AVAILABLE
   vr_pixel_multiscaling_support = true;
@@ -36,6 +49,14 @@ void RayCasting1Pass::Clean ()
   if (m_glsl_transfer_function) delete m_glsl_transfer_function;
   m_glsl_transfer_function = nullptr;
 
+  if (m_glsl_occupancy_distance) delete m_glsl_occupancy_distance;
+  m_glsl_occupancy_distance = nullptr;
+
+  DestroyProxyGeometry();
+
+  if (m_proxy_fbo) delete m_proxy_fbo;
+  m_proxy_fbo = nullptr;
+
   DestroyRenderingPass();
 
   BaseVolumeRenderer::Clean();
@@ -44,6 +65,7 @@ void RayCasting1Pass::Clean ()
 void RayCasting1Pass::ReloadShaders ()
 {
   cp_geometry_pass->Reload();
+  ps_proxy_pass->Reload();
   m_rdr_frame_to_screen.ClearShaders();
 }
 
@@ -53,6 +75,9 @@ bool RayCasting1Pass::Init (int swidth, int sheight)
 
   if (m_ext_data_manager->GetCurrentVolumeTexture() == nullptr) return false;
   m_glsl_transfer_function = m_ext_data_manager->GetCurrentTransferFunction()->GenerateTexture_1D_RGBt();
+
+  // Update block occupancy based on the current transfer function
+  UpdateOccupancyGrid();
   
   // Create Rendering Buffers and Shaders
   CreateRenderingPass();
@@ -71,64 +96,63 @@ bool RayCasting1Pass::Init (int swidth, int sheight)
 
 bool RayCasting1Pass::Update (vis::Camera* camera)
 {
-  cp_geometry_pass->Bind();
-
   // MULTISAMPLE
+  int shader_width = m_ext_rendering_parameters->GetScreenWidth();
+  int shader_height = m_ext_rendering_parameters->GetScreenHeight();
   if (IsPixelMultiScalingSupported() && GetCurrentMultiScalingMode() > 0)
   {
-    cp_geometry_pass->RecomputeNumberOfGroups(m_rdr_frame_to_screen.GetWidth(),
-                                                 m_rdr_frame_to_screen.GetHeight(), 0);
+    shader_width = m_rdr_frame_to_screen.GetWidth();
+    shader_height = m_rdr_frame_to_screen.GetHeight();
   }
-  else
-  {
-    cp_geometry_pass->RecomputeNumberOfGroups(m_ext_rendering_parameters->GetScreenWidth(),
-                                                 m_ext_rendering_parameters->GetScreenHeight(), 0);
-  }
-
-  cp_geometry_pass->SetUniform("CameraEye", camera->GetEye());
-  cp_geometry_pass->BindUniform("CameraEye");
-
-  cp_geometry_pass->SetUniform("u_CameraLookAt", camera->LookAt());
-  cp_geometry_pass->BindUniform("u_CameraLookAt");
-
-  cp_geometry_pass->SetUniform("ProjectionMatrix", camera->Projection());
-  cp_geometry_pass->BindUniform("ProjectionMatrix");
-
-  cp_geometry_pass->SetUniform("u_TanCameraFovY", (float)tan(DEGREE_TO_RADIANS(camera->GetFovY()) / 2.0));
-  cp_geometry_pass->BindUniform("u_TanCameraFovY");
-
-  cp_geometry_pass->SetUniform("u_CameraAspectRatio", camera->GetAspectRatio());
-  cp_geometry_pass->BindUniform("u_CameraAspectRatio");
 
-  cp_geometry_pass->SetUniform("StepSize", m_u_step_size);
-  cp_geometry_pass->BindUniform("StepSize");
+  // The proxy texture must have the same size of the ray casting output
+  bool use_proxy = m_apply_proxy_geometry && m_apply_empty_space_skipping && m_proxy_vao;
+  if (use_proxy) RenderProxyGeometry(camera, shader_width, shader_height);
 
-  cp_geometry_pass->SetUniform("ApplyOcclusion", 1);
-  cp_geometry_pass->BindUniform("ApplyOcclusion");
-
-  cp_geometry_pass->SetUniform("ApplyShadow", 1);
-  cp_geometry_pass->BindUniform("ApplyShadow");
-
-  cp_geometry_pass->SetUniform("ApplyGradientPhongShading", (m_apply_gradient_shading && m_ext_data_manager->GetCurrentGradientTexture()) ? 1 : 0);
-  cp_geometry_pass->BindUniform("ApplyGradientPhongShading");
-
-  cp_geometry_pass->SetUniform("BlinnPhongKa", m_ext_rendering_parameters->GetBlinnPhongKambient());
-  cp_geometry_pass->BindUniform("BlinnPhongKa");
-  cp_geometry_pass->SetUniform("BlinnPhongKd", m_ext_rendering_parameters->GetBlinnPhongKdiffuse());
-  cp_geometry_pass->BindUniform("BlinnPhongKd");
-  cp_geometry_pass->SetUniform("BlinnPhongKs", m_ext_rendering_parameters->GetBlinnPhongKspecular());
-  cp_geometry_pass->BindUniform("BlinnPhongKs");
-  cp_geometry_pass->SetUniform("BlinnPhongShininess", m_ext_rendering_parameters->GetBlinnPhongNshininess());
-  cp_geometry_pass->BindUniform("BlinnPhongShininess");
-
-  cp_geometry_pass->SetUniform("BlinnPhongIspecular", m_ext_rendering_parameters->GetLightSourceSpecular());
-  cp_geometry_pass->BindUniform("BlinnPhongIspecular");
-
-  cp_geometry_pass->SetUniform("WorldEyePos", camera->GetEye());
-  cp_geometry_pass->BindUniform("WorldEyePos");
+  UpdateShaderVariant(use_proxy);
+  cp_geometry_pass->Bind();
+  PrecompileNeighborVariants(use_proxy);
+  cp_geometry_pass->RecomputeNumberOfGroups(shader_width, shader_height, 0);
+
+  // Per-frame parameters are written to the uniform block, only the proxy texture is a named uniform
+  RayMarchingParameters& params = m_parameter_block->values;
+  params.CameraEye = camera->GetEye();
+  params.u_CameraLookAt = camera->LookAt();
+  params.ProjectionMatrix = camera->Projection();
+  params.u_TanCameraFovY = (float)tan(DEGREE_TO_RADIANS(camera->GetFovY()) / 2.0);
+  params.u_CameraAspectRatio = camera->GetAspectRatio();
+  params.StepSize = m_u_step_size;
+
+  cp_geometry_pass->ClearUniform("TexProxyNearFar");
+  if (use_proxy)
+  {
+    cp_geometry_pass->SetUniformTexture2D("TexProxyNearFar", m_proxy_fbo->GetColorAttachmentID(0), 5);
+    cp_geometry_pass->BindUniform("TexProxyNearFar");
+  }
 
-  cp_geometry_pass->SetUniform("LightSourcePosition", m_ext_rendering_parameters->GetBlinnPhongLightingPosition());
-  cp_geometry_pass->BindUniform("LightSourcePosition");
+  // Faces closer than the near plane are clipped, so the rasterized tnear is
+  //   only valid if the eye is far enough from the volume bounding box
+  glm::vec3 vol_half = glm::vec3(m_ext_data_manager->GetCurrentStructuredVolume()->GetWidth(),
+                                 m_ext_data_manager->GetCurrentStructuredVolume()->GetHeight(),
+                                 m_ext_data_manager->GetCurrentStructuredVolume()->GetDepth())
+                     * glm::vec3(m_ext_data_manager->GetCurrentStructuredVolume()->GetScale()) * 0.5f;
+  glm::vec3 eye_out = glm::max(glm::abs(camera->GetEye()) - vol_half, glm::vec3(0.0f));
+  // . distance from the eye to the corners of the near plane
+  float tan_fovy = (float)tan(DEGREE_TO_RADIANS(camera->GetFovY()) / 2.0);
+  float tan_fovx = tan_fovy * camera->GetAspectRatio();
+  float near_radius = camera->GetData().z_near * glm::sqrt(1.0f + tan_fovx * tan_fovx + tan_fovy * tan_fovy);
+  params.ProxyUseNear = glm::length(eye_out) > near_radius ? 1 : 0;
+
+  params.BlinnPhongKa = m_ext_rendering_parameters->GetBlinnPhongKambient();
+  params.BlinnPhongKd = m_ext_rendering_parameters->GetBlinnPhongKdiffuse();
+  params.BlinnPhongKs = m_ext_rendering_parameters->GetBlinnPhongKspecular();
+  params.BlinnPhongShininess = m_ext_rendering_parameters->GetBlinnPhongNshininess();
+  params.BlinnPhongIspecular = m_ext_rendering_parameters->GetLightSourceSpecular();
+
+  params.WorldEyePos = camera->GetEye();
+  params.LightSourcePosition = m_ext_rendering_parameters->GetBlinnPhongLightingPosition();
+
+  m_parameter_block->Upload();
 
   cp_geometry_pass->BindUniforms();
 
@@ -142,6 +166,7 @@ void RayCasting1Pass::Redraw ()
   m_rdr_frame_to_screen.ClearTexture();
 
   cp_geometry_pass->Bind();
+  m_parameter_block->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
   cp_geometry_pass->Dispatch();
@@ -155,6 +180,7 @@ void RayCasting1Pass::MultiSampleRedraw ()
   m_rdr_frame_to_screen.ClearTexture();
 
   cp_geometry_pass->Bind();
+  m_parameter_block->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
   cp_geometry_pass->Dispatch();
@@ -168,6 +194,7 @@ void RayCasting1Pass::DownScalingRedraw ()
   m_rdr_frame_to_screen.ClearTexture();
 
   cp_geometry_pass->Bind();
+  m_parameter_block->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
   cp_geometry_pass->Dispatch();
@@ -181,6 +208,7 @@ void RayCasting1Pass::UpScalingRedraw ()
   m_rdr_frame_to_screen.ClearTexture();
 
   cp_geometry_pass->Bind();
+  m_parameter_block->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
   cp_geometry_pass->Dispatch();
@@ -200,6 +228,11 @@ void RayCasting1Pass::SetImGuiComponents ()
   }
   
   AddImGuiMultiSampleOptions();
+
+  static const char* compositions[] = { "Opacity", "Transparency", "Transparency (Extinction)" };
+  ImGui::Text("Composition: ");
+  if (ImGui::Combo("###RayCasting1PassUIComposition", &m_composition, compositions, IM_ARRAYSIZE(compositions)))
+    SetOutdated();
   
   if (m_ext_data_manager->GetCurrentGradientTexture())
   {
@@ -220,6 +253,36 @@ void RayCasting1Pass::SetImGuiComponents ()
     }
     ImGui::Separator();
   }
+
+  ImGui::Separator();
+  if (ImGui::Checkbox("Empty Space Skipping###RayCasting1PassUIEmptySpaceSkipping", &m_apply_empty_space_skipping))
+    SetOutdated();
+
+  if (m_apply_empty_space_skipping)
+  {
+    if (ImGui::Checkbox("Proxy Geometry###RayCasting1PassUIProxyGeometry", &m_apply_proxy_geometry))
+      SetOutdated();
+
+    static const char* block_sizes[] = { "4", "8", "16", "32" };
+    int block_size_id = glm::clamp((int)glm::round(glm::log2((float)m_occupancy_block_size)) - 2, 0, 3);
+    ImGui::Text("Block Size: ");
+    if (ImGui::Combo("###RayCasting1PassUIOccupancyBlockSize", &block_size_id, block_sizes, IM_ARRAYSIZE(block_sizes)))
+    {
+      m_occupancy_block_size = 4 << block_size_id;
+      UpdateOccupancyGrid();
+      BindOccupancyUniforms();
+      SetOutdated();
+    }
+
+    size_t n_blocks = m_occupancy_grid.GetNumberOfBlocks();
+    ImGui::Text("Empty Blocks: %zu/%zu (%.1f%%)", m_occupancy_grid.GetNumberOfEmptyBlocks(), n_blocks,
+      n_blocks > 0 ? 100.0 * (double)m_occupancy_grid.GetNumberOfEmptyBlocks() / (double)n_blocks : 0.0);
+    ImGui::Text("Min/Max: %.1f ms, Occupancy: %.2f ms", m_occupancy_grid.GetBlockMinMaxBuildTime(),
+      m_occupancy_grid.GetOccupancyUpdateTime());
+    ImGui::Text("Proxy Faces: %d", (int)m_proxy_index_count / 6);
+  }
+  ImGui::Separator();
+  ImGui::Text("Shader Variants: %d", cp_geometry_pass->GetNumberOfVariants());
 }
 
 void RayCasting1Pass::FillParameterSpace(ParameterSpace& pspace)
@@ -228,6 +291,40 @@ void RayCasting1Pass::FillParameterSpace(ParameterSpace& pspace)
   pspace.AddParameterDimension(new ParameterRangeFloat("StepSize", &m_u_step_size, 0.2, 2.0, 0.1));
 }
 
+void RayCasting1Pass::FillVariantSpace (ParameterSpace& pspace)
+{
+  pspace.ClearParameterDimensions();
+  pspace.AddParameterDimension(new ParameterRangeList<bool>("EmptySpaceSkipping", &m_apply_empty_space_skipping, { false, true }));
+  pspace.AddParameterDimension(new ParameterRangeList<int>("Composition", &m_composition, { 0, 1, 2 }));
+}
+
+void RayCasting1Pass::FillTuningSpace (ParameterSpace& pspace)
+{
+  pspace.ClearParameterDimensions();
+  // The step size is not tuned: the fastest one is always the largest
+  pspace.AddParameterDimension(new ParameterRangeList<int>("BlockSize", &m_occupancy_block_size, { 4, 8, 16, 32 }));
+}
+
+void RayCasting1Pass::ApplyTuningParameters ()
+{
+  // Only the voxel pass of a new block size is computed, the volume is not reloaded
+  UpdateOccupancyGrid();
+  BindOccupancyUniforms();
+  SetOutdated();
+}
+
+bool RayCasting1Pass::OnTransferFunctionChanged ()
+{
+  if (!m_ext_data_manager->GetCurrentTransferFunction()->UpdateTexture_1D_RGBt(m_glsl_transfer_function))
+    return false;
+
+  // Only the transfer function pass of the occupancy, the block min/max is kept
+  UpdateOccupancyGrid();
+  BindOccupancyUniforms();
+  SetOutdated();
+  return true;
+}
+
 void RayCasting1Pass::CreateRenderingPass ()
 {
   glm::vec3 vol_resolution = glm::vec3(m_ext_data_manager->GetCurrentStructuredVolume()->GetWidth() ,
@@ -243,15 +340,22 @@ void RayCasting1Pass::CreateRenderingPass ()
   cp_geometry_pass = new gl::ComputeShader();
   cp_geometry_pass->AddShaderFile(CPPVOLREND_DIR"structured/_common_shaders/ray_bbox_intersection.comp");
   cp_geometry_pass->AddShaderFile(CPPVOLREND_DIR"structured/rc1pass/ray_marching_1p.comp");
+  m_precompiled_variant = -1;
+  UpdateShaderVariant(m_apply_proxy_geometry && m_apply_empty_space_skipping && m_proxy_vao);
   cp_geometry_pass->LoadAndLink();
   cp_geometry_pass->Bind();
 
+  m_parameter_block = new gl::ParameterBlock<RayMarchingParameters>(0);
+
   if (m_ext_data_manager->GetCurrentVolumeTexture())
     cp_geometry_pass->SetUniformTexture3D("TexVolume", m_ext_data_manager->GetCurrentVolumeTexture()->GetTextureID(), 1);
   if (m_glsl_transfer_function)
     cp_geometry_pass->SetUniformTexture1D("TexTransferFunc", m_glsl_transfer_function->GetTextureID(), 2);
   if (m_apply_gradient_shading && m_ext_data_manager->GetCurrentGradientTexture())
     cp_geometry_pass->SetUniformTexture3D("TexVolumeGradient", m_ext_data_manager->GetCurrentGradientTexture()->GetTextureID(), 3);
+  if (m_glsl_occupancy_distance)
+    cp_geometry_pass->SetUniformTexture3D("TexOccupancyDistance", m_glsl_occupancy_distance->GetTextureID(), 4);
+  cp_geometry_pass->SetUniform("OccupancyBlockSize", (float)m_occupancy_grid.GetBlockSize());
 
   cp_geometry_pass->SetUniform("VolumeGridResolution", vol_resolution);
   cp_geometry_pass->SetUniform("VolumeVoxelSize", vol_voxelsize);
@@ -259,6 +363,66 @@ void RayCasting1Pass::CreateRenderingPass ()
 
   cp_geometry_pass->BindUniforms();
   cp_geometry_pass->Unbind();
+
+  ps_proxy_pass = new gl::PipelineShader();
+  ps_proxy_pass->AddShaderFile(gl::PipelineShader::TYPE::VERTEX, CPPVOLREND_DIR"structured/rc1pass/occupancy_proxy.vert");
+  ps_proxy_pass->AddShaderFile(gl::PipelineShader::TYPE::FRAGMENT, CPPVOLREND_DIR"structured/rc1pass/occupancy_proxy.frag");
+  ps_proxy_pass->LoadAndLink();
+  ps_proxy_pass->Bind();
+
+  ps_proxy_pass->SetUniform("VolumeVoxelSize", vol_voxelsize);
+  ps_proxy_pass->SetUniform("VolumeGridSize", vol_aabb);
+
+  ps_proxy_pass->BindUniforms();
+  gl::PipelineShader::Unbind();
+}
+
+void RayCasting1Pass::UpdateShaderVariant (bool use_proxy)
+{
+  cp_geometry_pass->SetFlag("GRADIENT_SHADING", m_apply_gradient_shading && m_ext_data_manager->GetCurrentGradientTexture());
+  cp_geometry_pass->SetFlag("EMPTY_SPACE_SKIPPING", m_apply_empty_space_skipping && m_glsl_occupancy_distance);
+  cp_geometry_pass->SetFlag("PROXY_GEOMETRY", use_proxy);
+  cp_geometry_pass->SetFlag("USE_TRANSPARENCY", m_composition > 0);
+  cp_geometry_pass->SetFlag("USE_TRANSPARENCY_DS", m_composition == 2);
+}
+
+void RayCasting1Pass::PrecompileNeighborVariants (bool use_proxy)
+{
+  int variant = (m_apply_gradient_shading ? 1 : 0) | (m_apply_empty_space_skipping ? 2 : 0)
+              | (m_apply_proxy_geometry ? 4 : 0) | (m_composition << 3);
+  if (variant == m_precompiled_variant) return;
+  m_precompiled_variant = variant;
+
+  bool gradient_shading = m_apply_gradient_shading;
+  bool empty_space_skipping = m_apply_empty_space_skipping;
+  bool proxy_geometry = m_apply_proxy_geometry;
+  int composition = m_composition;
+  auto submit = [&] () {
+    UpdateShaderVariant(m_apply_proxy_geometry && m_apply_empty_space_skipping && m_proxy_vao);
+    cp_geometry_pass->PrecompileVariant(GetName());
+  };
+
+  m_apply_gradient_shading = !gradient_shading;
+  submit();
+  m_apply_gradient_shading = gradient_shading;
+
+  m_apply_empty_space_skipping = !empty_space_skipping;
+  submit();
+  m_apply_empty_space_skipping = empty_space_skipping;
+
+  m_apply_proxy_geometry = !proxy_geometry;
+  submit();
+  m_apply_proxy_geometry = proxy_geometry;
+
+  for (int c = 0; c < 3; c++)
+  {
+    if (c == composition) continue;
+    m_composition = c;
+    submit();
+  }
+  m_composition = composition;
+
+  UpdateShaderVariant(use_proxy);
 }
 
 void RayCasting1Pass::DestroyRenderingPass ()
@@ -266,6 +430,12 @@ void RayCasting1Pass::DestroyRenderingPass ()
   if (cp_geometry_pass) delete cp_geometry_pass;
   cp_geometry_pass = nullptr;
 
+  if (m_parameter_block) delete m_parameter_block;
+  m_parameter_block = nullptr;
+
+  if (ps_proxy_pass) delete ps_proxy_pass;
+  ps_proxy_pass = nullptr;
+
   gl::ExitOnGLError("Could not destroy shaders");
 }
 
@@ -276,3 +446,131 @@ void RayCasting1Pass::RecreateRenderingPass ()
 
   gl::ExitOnGLError("Could not recreate rendering pass");
 }
+
+void RayCasting1Pass::UpdateOccupancyGrid ()
+{
+  vis::StructuredGridVolume* vol = m_ext_data_manager->GetCurrentStructuredVolume();
+  vis::TransferFunction* tf = m_ext_data_manager->GetCurrentTransferFunction();
+  if (!vol || !tf || !m_glsl_transfer_function) return;
+
+  // Voxel pass, only if the volume or the block size changed
+  if (!m_occupancy_grid.IsBlockMinMaxBuiltFor(vol, m_occupancy_block_size))
+    m_occupancy_grid.BuildBlockMinMax(vol, m_occupancy_block_size);
+
+  // Transfer function pass: occupancy + distance transform
+  m_occupancy_grid.UpdateOccupancy(tf, m_glsl_transfer_function->GetLength());
+
+  if (m_glsl_occupancy_distance) delete m_glsl_occupancy_distance;
+  m_glsl_occupancy_distance = m_occupancy_grid.GenerateDistanceTexture();
+
+  UpdateProxyGeometry();
+}
+
+void RayCasting1Pass::BindOccupancyUniforms ()
+{
+  if (!cp_geometry_pass) return;
+
+  cp_geometry_pass->Bind();
+  cp_geometry_pass->ClearUniform("TexOccupancyDistance");
+  if (m_glsl_occupancy_distance)
+  {
+    cp_geometry_pass->SetUniformTexture3D("TexOccupancyDistance", m_glsl_occupancy_distance->GetTextureID(), 4);
+    cp_geometry_pass->BindUniform("TexOccupancyDistance");
+  }
+  cp_geometry_pass->SetUniform("OccupancyBlockSize", (float)m_occupancy_grid.GetBlockSize());
+  cp_geometry_pass->BindUniform("OccupancyBlockSize");
+  gl::ComputeShader::Unbind();
+}
+
+void RayCasting1Pass::UpdateProxyGeometry ()
+{
+  DestroyProxyGeometry();
+
+  std::vector<glm::vec3> vertices;
+  std::vector<unsigned int> indices;
+  if (m_occupancy_grid.GenerateBoundaryMesh(vertices, indices) == 0) return;
+
+  m_proxy_vao = new gl::ArrayObject(1);
+  m_proxy_vao->Bind();
+
+  m_proxy_vbo = new gl::BufferObject(gl::BufferObject::TYPES::VERTEXBUFFEROBJECT);
+  m_proxy_ibo = new gl::BufferObject(gl::BufferObject::TYPES::INDEXBUFFEROBJECT);
+
+  // bind the VBO to the VAO
+  m_proxy_vbo->SetBufferData(vertices.size() * sizeof(glm::vec3), vertices.data(), GL_STATIC_DRAW);
+  m_proxy_vao->SetVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (GLvoid*)0);
+
+  // bind the IBO to the VAO
+  m_proxy_ibo->SetBufferData(indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+  m_proxy_index_count = (GLsizei)indices.size();
+
+  gl::ArrayObject::Unbind();
+  gl::BufferObject::Unbind(GL_ARRAY_BUFFER);
+  gl::BufferObject::Unbind(GL_ELEMENT_ARRAY_BUFFER);
+  gl::ExitOnGLError("RayCasting1Pass: After UpdateProxyGeometry.");
+}
+
+void RayCasting1Pass::DestroyProxyGeometry ()
+{
+  if (m_proxy_vao) delete m_proxy_vao;
+  m_proxy_vao = nullptr;
+  if (m_proxy_vbo) delete m_proxy_vbo;
+  m_proxy_vbo = nullptr;
+  if (m_proxy_ibo) delete m_proxy_ibo;
+  m_proxy_ibo = nullptr;
+  m_proxy_index_count = 0;
+}
+
+void RayCasting1Pass::RenderProxyGeometry (vis::Camera* camera, int width, int height)
+{
+  // Resize only regenerates the attachments if the size changed
+  if (!m_proxy_fbo)
+  {
+    m_proxy_fbo = new gl::FrameBufferObject(1, false, 32);
+    m_proxy_fbo->GenerateAttachments(width, height);
+  }
+  m_proxy_fbo->Resize(width, height);
+
+  GLint viewport[4];
+  glGetIntegerv(GL_VIEWPORT, viewport);
+  GLboolean cull_face = glIsEnabled(GL_CULL_FACE);
+  GLboolean depth_test = glIsEnabled(GL_DEPTH_TEST);
+  GLboolean blend = glIsEnabled(GL_BLEND);
+
+  m_proxy_fbo->Bind();
+  glViewport(0, 0, width, height);
+
+  // Pixels not covered by any face keep tnear > tfar
+  const GLfloat clear_nf[4] = { 1e30f, 1e30f, 0.0f, 0.0f };
+  glClearBufferfv(GL_COLOR, 0, clear_nf);
+
+  // Front and back faces in a single pass: min(t) and min(-t) = -max(t)
+  glDisable(GL_CULL_FACE);
+  glDisable(GL_DEPTH_TEST);
+  glEnable(GL_BLEND);
+  glBlendEquation(GL_MIN);
+
+  ps_proxy_pass->Bind();
+  ps_proxy_pass->SetUniform("CameraEye", camera->GetEye());
+  ps_proxy_pass->BindUniform("CameraEye");
+  ps_proxy_pass->SetUniform("u_CameraLookAt", camera->LookAt());
+  ps_proxy_pass->BindUniform("u_CameraLookAt");
+  ps_proxy_pass->SetUniform("ProjectionMatrix", camera->Projection());
+  ps_proxy_pass->BindUniform("ProjectionMatrix");
+
+  m_proxy_vao->Bind();
+  m_proxy_vao->DrawElements(GL_TRIANGLES, m_proxy_index_count, GL_UNSIGNED_INT);
+  gl::ArrayObject::Unbind();
+  gl::PipelineShader::Unbind();
+
+  // Restore state
+  glBlendEquation(GL_FUNC_ADD);
+  if (!blend) glDisable(GL_BLEND);
+  if (depth_test) glEnable(GL_DEPTH_TEST);
+  if (cull_face) glEnable(GL_CULL_FACE);
+
+  gl::FrameBufferObject::Unbind();
+  glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+  gl::ExitOnGLError("RayCasting1Pass: After RenderProxyGeometry.");
+}
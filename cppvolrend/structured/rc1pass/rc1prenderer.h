@@ -22,6 +22,11 @@
 #include <gl_utils/bufferobject.h>
 
 #include <gl_utils/computeshader.h>
+#include <gl_utils/pipelineshader.h>
+#include <gl_utils/framebufferobject.h>
+#include <gl_utils/uniformblock.h>
+
+#include <volvis_utils/occupancygrid.h>
 
 #include "../../volrenderbase.h"
 
@@ -29,6 +34,32 @@
 #include "imgui_impl_glut.h"
 #include "imgui_impl_opengl2.h"
 
+#include <glm/glm.hpp>
+
+// Per-frame parameters of ray_marching_1p.comp
+// . std140 layout of its RayMarchingParameters uniform block, member by member
+// . the features are shader defines, see RayCasting1Pass::UpdateShaderVariant
+struct RayMarchingParameters
+{
+  glm::mat4 u_CameraLookAt;
+  glm::mat4 ProjectionMatrix;
+
+  glm::vec3 CameraEye;
+  float u_TanCameraFovY;
+  glm::vec3 WorldEyePos;
+  float u_CameraAspectRatio;
+  glm::vec3 LightSourcePosition;
+  float StepSize;
+  glm::vec3 BlinnPhongIspecular;
+  float BlinnPhongKa;
+
+  float BlinnPhongKd;
+  float BlinnPhongKs;
+  float BlinnPhongShininess;
+  int ProxyUseNear;
+};
+static_assert(sizeof(RayMarchingParameters) == 208, "RayMarchingParameters must match the std140 layout");
+
 class RayCasting1Pass : public BaseVolumeRenderer
 {
 public:
@@ -58,6 +89,12 @@ public:
   }
 
   virtual void FillParameterSpace(ParameterSpace& pspace) override;
+  virtual void FillVariantSpace (ParameterSpace& pspace) override;
+
+  virtual void FillTuningSpace (ParameterSpace& pspace) override;
+  virtual void ApplyTuningParameters () override;
+
+  virtual bool OnTransferFunctionChanged () override;
 
   float m_u_step_size;
 
@@ -67,13 +104,50 @@ private:
   void CreateRenderingPass ();
   void DestroyRenderingPass ();
   void RecreateRenderingPass ();
+
+  // Features compiled into ray_marching_1p.comp, the variant is swapped on the next Bind
+  void UpdateShaderVariant (bool use_proxy);
+  // Submits the variants one interface toggle away from the current one, so
+  //   the toggle takes a program compiled in the background
+  void PrecompileNeighborVariants (bool use_proxy);
+
+  // Empty space skipping
+  // . the block min/max is kept between Clean/Init calls and is only
+  //   recomputed if the volume or the block size changes
+  void UpdateOccupancyGrid ();
+  void BindOccupancyUniforms ();
+
+  // Proxy geometry
+  // . boundary faces of the non-empty blocks, rebuilt with the occupancy
+  // . rasterized each frame into a (tnear, -tfar) texture with GL_MIN blending
+  void UpdateProxyGeometry ();
+  void DestroyProxyGeometry ();
+  void RenderProxyGeometry (vis::Camera* camera, int width, int height);
   
   gl::Texture1D* m_glsl_transfer_function;
 
   gl::ComputeShader*  cp_geometry_pass;
+  gl::ParameterBlock<RayMarchingParameters>* m_parameter_block;
 
 
   bool m_apply_gradient_shading;
+  // 0: front-to-back opacity, 1: transparency, 2: transparency with the emission scaled by the extinction
+  int m_composition;
+  // Features of the variant whose neighbors were submitted, -1 if none
+  int m_precompiled_variant;
+
+  vis::OccupancyGrid m_occupancy_grid;
+  gl::Texture3D* m_glsl_occupancy_distance;
+  bool m_apply_empty_space_skipping;
+  int m_occupancy_block_size;
+
+  gl::PipelineShader* ps_proxy_pass;
+  gl::FrameBufferObject* m_proxy_fbo;
+  gl::ArrayObject* m_proxy_vao;
+  gl::BufferObject* m_proxy_vbo;
+  gl::BufferObject* m_proxy_ibo;
+  GLsizei m_proxy_index_count;
+  bool m_apply_proxy_geometry;
   
 };
 
@@ -0,0 +1,408 @@
+#include "../../defines.h"
+#include "rc1pcpurenderer.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <vis_utils/camera.h>
+#include <vis_utils/taskgraph.h>
+
+#include <volvis_utils/utils.h>
+#include <math_utils/utils.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#include "imgui.h"
+
+RayCasting1PassCPU::RayCasting1PassCPU ()
+  : m_u_step_size(0.5f)
+  , m_vol_resolution(0)
+  , m_vol_voxel_size(1.0f)
+  , m_vol_grid_size(1.0f)
+  , m_num_threads(vis::TaskPool::Instance().GetMaxConcurrency())
+  , m_tile_size(32)
+  , m_apply_gradient_shading(false)
+  , m_stat_rays(0)
+  , m_stat_samples(0)
+  , m_stat_frame_ms(0.0)
+  , m_stat_steals(0)
+{
+  m_last_frame.width = 0;
+  m_last_frame.height = 0;
+}
+
+RayCasting1PassCPU::~RayCasting1PassCPU ()
+{
+  Clean();
+}
+
+void RayCasting1PassCPU::Clean ()
+{
+  m_volume.clear();
+  m_gradient.clear();
+  m_transfer_function.clear();
+  m_image.clear();
+  m_scaling_results.clear();
+
+  BaseVolumeRenderer::Clean();
+}
+
+bool RayCasting1PassCPU::Init (int swidth, int sheight)
+{
+  if (IsBuilt()) Clean();
+
+  if (m_ext_data_manager->GetCurrentVolumeTexture() == nullptr) return false;
+
+  ReadBackData();
+
+  // estimate initial integration step
+  glm::dvec3 sv = m_ext_data_manager->GetCurrentStructuredVolume()->GetScale();
+  m_u_step_size = float((0.5f / glm::sqrt(3.0f)) * glm::sqrt(sv.x * sv.x + sv.y * sv.y + sv.z * sv.z));
+
+  Reshape(swidth, sheight);
+
+  SetBuilt(true);
+  SetOutdated();
+  return true;
+}
+
+bool RayCasting1PassCPU::Update (vis::Camera* camera)
+{
+  FrameParameters fp;
+  fp.width = m_ext_rendering_parameters->GetScreenWidth();
+  fp.height = m_ext_rendering_parameters->GetScreenHeight();
+  fp.eye = camera->GetEye();
+  fp.lookat = glm::mat3(camera->LookAt());
+  fp.tan_fovy = (float)tan(DEGREE_TO_RADIANS(camera->GetFovY()) / 2.0);
+  fp.aspect_ratio = camera->GetAspectRatio();
+  fp.step_size = m_u_step_size;
+  fp.shading = m_apply_gradient_shading && !m_gradient.empty();
+  fp.ka = m_ext_rendering_parameters->GetBlinnPhongKambient();
+  fp.kd = m_ext_rendering_parameters->GetBlinnPhongKdiffuse();
+  fp.ks = m_ext_rendering_parameters->GetBlinnPhongKspecular();
+  fp.shininess = m_ext_rendering_parameters->GetBlinnPhongNshininess();
+  fp.ispecular = m_ext_rendering_parameters->GetLightSourceSpecular();
+  fp.light_position = m_ext_rendering_parameters->GetBlinnPhongLightingPosition();
+
+  auto t_start = std::chrono::high_resolution_clock::now();
+  RenderFrame(fp);
+  auto t_end = std::chrono::high_resolution_clock::now();
+  m_stat_frame_ms = std::chrono::duration<double, std::milli>(t_end - t_start).count();
+  m_last_frame = fp;
+
+  // Upload to the output texture of the screen
+  glBindTexture(GL_TEXTURE_2D, m_rdr_frame_to_screen.GetScreenOutputTexture()->GetTextureID());
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, fp.width, fp.height, GL_RGBA, GL_FLOAT, m_image.data());
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  gl::ExitOnGLError("RayCasting1PassCPU: After Update.");
+  return true;
+}
+
+void RayCasting1PassCPU::Redraw ()
+{
+  m_rdr_frame_to_screen.Draw();
+}
+
+void RayCasting1PassCPU::SetImGuiComponents ()
+{
+  ImGui::Separator();
+  ImGui::Text("Step Size: ");
+  if (ImGui::DragFloat("###RayCasting1PassCPUUIIntegrationStepSize", &m_u_step_size, 0.01f, 0.01f, 100.0f, "%.2f"))
+  {
+    m_u_step_size = std::max(std::min(m_u_step_size, 100.0f), 0.01f); //When entering with keyboard, ImGui does not take care of this.
+    SetOutdated();
+  }
+
+  if (!m_gradient.empty())
+  {
+    ImGui::Separator();
+    if (ImGui::Checkbox("Apply Gradient Shading###RayCasting1PassCPUUIGradientShading", &m_apply_gradient_shading))
+      SetOutdated();
+  }
+
+  ImGui::Separator();
+  ImGui::Text("Threads: ");
+  int max_threads = vis::TaskPool::Instance().GetMaxConcurrency();
+  if (ImGui::SliderInt("###RayCasting1PassCPUUIThreads", &m_num_threads, 1, max_threads))
+  {
+    m_num_threads = std::max(std::min(m_num_threads, max_threads), 1);
+    SetOutdated();
+  }
+
+  static const char* tile_sizes[] = { "8", "16", "32", "64" };
+  int tile_size_id = glm::clamp((int)glm::round(glm::log2((float)m_tile_size)) - 3, 0, 3);
+  ImGui::Text("Tile Size: ");
+  if (ImGui::Combo("###RayCasting1PassCPUUITileSize", &tile_size_id, tile_sizes, IM_ARRAYSIZE(tile_sizes)))
+  {
+    m_tile_size = 8 << tile_size_id;
+    SetOutdated();
+  }
+
+  double seconds = m_stat_frame_ms / 1000.0;
+  ImGui::Text("Frame: %.2f ms", m_stat_frame_ms);
+  ImGui::Text("%.2f Mrays/s, %.2f Msamples/s", seconds > 0.0 ? (double)m_stat_rays / seconds * 1e-6 : 0.0,
+    seconds > 0.0 ? (double)m_stat_samples / seconds * 1e-6 : 0.0);
+  // . the pool is shared, jobs of other loops running meanwhile are counted too
+  ImGui::Text("Stolen Tiles: %zu", m_stat_steals);
+
+  if (ImGui::Button("Measure Thread Scaling###RayCasting1PassCPUUIScaling"))
+    MeasureThreadScaling();
+
+  for (const ScalingResult& res : m_scaling_results)
+  {
+    ImGui::Text("%2d threads: %.2f ms (speedup %.2fx)", res.threads, res.frame_ms,
+      res.frame_ms > 0.0 ? m_scaling_results[0].frame_ms / res.frame_ms : 0.0);
+  }
+  ImGui::Separator();
+}
+
+void RayCasting1PassCPU::FillParameterSpace (ParameterSpace& pspace)
+{
+  pspace.ClearParameterDimensions();
+
+  // Thread counts 1, 2, 4, ... up to the number of hardware threads
+  std::vector<int> threads;
+  int max_threads = vis::TaskPool::Instance().GetMaxConcurrency();
+  for (int t = 1; t < max_threads; t *= 2) threads.push_back(t);
+  threads.push_back(max_threads);
+
+  pspace.AddParameterDimension(new ParameterRangeList<int>("Threads", &m_num_threads, threads));
+}
+
+void RayCasting1PassCPU::GetFrameStatistics (std::vector<std::pair<std::string, double>>& stats)
+{
+  stats.clear();
+  stats.push_back({ "Rays", (double)m_stat_rays });
+  stats.push_back({ "Samples", (double)m_stat_samples });
+}
+
+void RayCasting1PassCPU::ReadBackData ()
+{
+  vis::StructuredGridVolume* vol = m_ext_data_manager->GetCurrentStructuredVolume();
+  m_vol_resolution = glm::ivec3(vol->GetWidth(), vol->GetHeight(), vol->GetDepth());
+  m_vol_voxel_size = glm::vec3(vol->GetScale());
+  m_vol_grid_size = glm::vec3(m_vol_resolution) * m_vol_voxel_size;
+
+  size_t n_voxels = (size_t)m_vol_resolution.x * (size_t)m_vol_resolution.y * (size_t)m_vol_resolution.z;
+
+  // Normalized density, as seen by the shaders
+  m_volume.resize(n_voxels);
+  glBindTexture(GL_TEXTURE_3D, m_ext_data_manager->GetCurrentVolumeTexture()->GetTextureID());
+  glGetTexImage(GL_TEXTURE_3D, 0, GL_RED, GL_FLOAT, m_volume.data());
+  glBindTexture(GL_TEXTURE_3D, 0);
+
+  m_gradient.clear();
+  if (m_ext_data_manager->GetCurrentGradientTexture())
+  {
+    m_gradient.resize(n_voxels);
+    glBindTexture(GL_TEXTURE_3D, m_ext_data_manager->GetCurrentGradientTexture()->GetTextureID());
+    glGetTexImage(GL_TEXTURE_3D, 0, GL_RGB, GL_FLOAT, m_gradient.data());
+    glBindTexture(GL_TEXTURE_3D, 0);
+  }
+
+  // RGB + extinction, with the same precision of the GPU transfer function
+  gl::Texture1D* tf_texture = m_ext_data_manager->GetCurrentTransferFunction()->GenerateTexture_1D_RGBt();
+  m_transfer_function.resize(tf_texture->GetLength());
+  glBindTexture(GL_TEXTURE_1D, tf_texture->GetTextureID());
+  glGetTexImage(GL_TEXTURE_1D, 0, GL_RGBA, GL_FLOAT, m_transfer_function.data());
+  glBindTexture(GL_TEXTURE_1D, 0);
+  delete tf_texture;
+
+  gl::ExitOnGLError("RayCasting1PassCPU: Error on reading back the volume data.");
+}
+
+void RayCasting1PassCPU::RenderFrame (const FrameParameters& fp)
+{
+  m_image.assign((size_t)fp.width * (size_t)fp.height, glm::vec4(0.0f));
+  m_stat_rays = 0;
+  m_stat_samples = 0;
+
+  int tiles_x = (fp.width + m_tile_size - 1) / m_tile_size;
+  int tiles_y = (fp.height + m_tile_size - 1) / m_tile_size;
+
+  vis::TaskPool& pool = vis::TaskPool::Instance();
+  size_t steals = pool.GetNumberOfSteals();
+  pool.ParallelFor(tiles_x * tiles_y, [&](int tile_begin, int tile_end) {
+    for (int tile = tile_begin; tile < tile_end; tile++)
+      RenderTile(fp, tile);
+  }, 1, m_num_threads);
+  m_stat_steals = pool.GetNumberOfSteals() - steals;
+}
+
+void RayCasting1PassCPU::RenderTile (const FrameParameters& fp, int tile)
+{
+  int tiles_x = (fp.width + m_tile_size - 1) / m_tile_size;
+  int x0 = (tile % tiles_x) * m_tile_size;
+  int y0 = (tile / tiles_x) * m_tile_size;
+  int x1 = std::min(x0 + m_tile_size, fp.width);
+  int y1 = std::min(y0 + m_tile_size, fp.height);
+
+  glm::vec3 aabbmin = -m_vol_grid_size * 0.5f;
+  glm::vec3 aabbmax = m_vol_grid_size * 0.5f;
+
+  unsigned long long n_rays = 0, n_samples = 0;
+  for (int y = y0; y < y1; y++)
+  {
+    for (int x = x0; x < x1; x++)
+    {
+      // Same ray setup of ray_marching_1p.comp
+      glm::vec2 fpos = glm::vec2(x, y) + 0.5f;
+      glm::vec2 ver_pos = glm::vec2(fpos.x / float(fp.width), fpos.y / float(fp.height)) * 2.0f - 1.0f;
+      glm::vec3 dir = glm::normalize(glm::vec3(ver_pos.x * fp.tan_fovy * fp.aspect_ratio, ver_pos.y * fp.tan_fovy, -1.0f) * fp.lookat);
+
+      // Ray - bounding box
+      glm::vec3 inv_dir = glm::vec3(1.0f) / dir;
+      glm::vec3 tbbmin = inv_dir * (aabbmin - fp.eye);
+      glm::vec3 tbbmax = inv_dir * (aabbmax - fp.eye);
+      glm::vec3 tmin = glm::min(tbbmin, tbbmax);
+      glm::vec3 tmax = glm::max(tbbmin, tbbmax);
+      float tnear = std::max(std::max(tmin.x, tmin.y), tmin.z);
+      float tfar = std::min(std::min(tmax.x, tmax.y), tmax.z);
+      if (!(tfar > tnear)) continue;
+      tnear = std::max(tnear, 0.0f);
+
+      n_rays++;
+
+      float D = std::abs(tfar - tnear);
+      glm::vec4 dst(0.0f);
+      glm::vec3 tex_pos = fp.eye + dir * tnear + m_vol_grid_size * 0.5f;
+
+      for (float s = 0.0f; s < D;)
+      {
+        float h = std::min(fp.step_size, D - s);
+        glm::vec3 s_tex_pos = tex_pos + dir * (s + h * 0.5f);
+
+        glm::vec4 src = SampleTransferFunction(SampleVolume(s_tex_pos));
+        n_samples++;
+
+        if (src.a > 0.0f)
+        {
+          if (fp.shading)
+            src = glm::vec4(ShadeBlinnPhong(fp, s_tex_pos, glm::vec3(src)), src.a);
+
+          // Evaluate the current opacity
+          src.a = 1.0f - std::exp(-src.a * h);
+
+          // Front-to-back composition
+          src = glm::vec4(glm::vec3(src) * src.a, src.a);
+          dst = dst + (1.0f - dst.a) * src;
+
+          // Opacity threshold: 99%
+          if (dst.a > 0.99f) break;
+        }
+        s = s + h;
+      }
+
+      m_image[(size_t)y * fp.width + x] = dst;
+    }
+  }
+
+  m_stat_rays += n_rays;
+  m_stat_samples += n_samples;
+}
+
+float RayCasting1PassCPU::SampleVolume (const glm::vec3& tex_pos) const
+{
+  // Texel centers at (i + 0.5) / N
+  glm::vec3 p = tex_pos / m_vol_voxel_size - 0.5f;
+  glm::vec3 pf = glm::floor(p);
+  glm::vec3 f = p - pf;
+  glm::ivec3 i0 = glm::clamp(glm::ivec3(pf), glm::ivec3(0), m_vol_resolution - 1);
+  glm::ivec3 i1 = glm::clamp(glm::ivec3(pf) + 1, glm::ivec3(0), m_vol_resolution - 1);
+
+  size_t sx = 1, sy = (size_t)m_vol_resolution.x, sz = (size_t)m_vol_resolution.x * (size_t)m_vol_resolution.y;
+  auto v = [&](int x, int y, int z) { return m_volume[x * sx + y * sy + z * sz]; };
+
+  float c00 = glm::mix(v(i0.x, i0.y, i0.z), v(i1.x, i0.y, i0.z), f.x);
+  float c10 = glm::mix(v(i0.x, i1.y, i0.z), v(i1.x, i1.y, i0.z), f.x);
+  float c01 = glm::mix(v(i0.x, i0.y, i1.z), v(i1.x, i0.y, i1.z), f.x);
+  float c11 = glm::mix(v(i0.x, i1.y, i1.z), v(i1.x, i1.y, i1.z), f.x);
+  return glm::mix(glm::mix(c00, c10, f.y), glm::mix(c01, c11, f.y), f.z);
+}
+
+glm::vec3 RayCasting1PassCPU::SampleGradient (const glm::vec3& tex_pos) const
+{
+  glm::vec3 p = tex_pos / m_vol_voxel_size - 0.5f;
+  glm::vec3 pf = glm::floor(p);
+  glm::vec3 f = p - pf;
+  glm::ivec3 i0 = glm::clamp(glm::ivec3(pf), glm::ivec3(0), m_vol_resolution - 1);
+  glm::ivec3 i1 = glm::clamp(glm::ivec3(pf) + 1, glm::ivec3(0), m_vol_resolution - 1);
+
+  size_t sx = 1, sy = (size_t)m_vol_resolution.x, sz = (size_t)m_vol_resolution.x * (size_t)m_vol_resolution.y;
+  auto g = [&](int x, int y, int z) { return m_gradient[x * sx + y * sy + z * sz]; };
+
+  glm::vec3 c00 = glm::mix(g(i0.x, i0.y, i0.z), g(i1.x, i0.y, i0.z), f.x);
+  glm::vec3 c10 = glm::mix(g(i0.x, i1.y, i0.z), g(i1.x, i1.y, i0.z), f.x);
+  glm::vec3 c01 = glm::mix(g(i0.x, i0.y, i1.z), g(i1.x, i0.y, i1.z), f.x);
+  glm::vec3 c11 = glm::mix(g(i0.x, i1.y, i1.z), g(i1.x, i1.y, i1.z), f.x);
+  return glm::mix(glm::mix(c00, c10, f.y), glm::mix(c01, c11, f.y), f.z);
+}
+
+glm::vec4 RayCasting1PassCPU::SampleTransferFunction (float density) const
+{
+  int n = (int)m_transfer_function.size();
+  float p = density * (float)n - 0.5f;
+  float pf = std::floor(p);
+  float f = p - pf;
+  int i0 = glm::clamp((int)pf, 0, n - 1);
+  int i1 = glm::clamp((int)pf + 1, 0, n - 1);
+  return glm::mix(m_transfer_function[i0], m_transfer_function[i1], f);
+}
+
+glm::vec3 RayCasting1PassCPU::ShadeBlinnPhong (const FrameParameters& fp, const glm::vec3& tex_pos, const glm::vec3& clr) const
+{
+  glm::vec3 gradient_normal = SampleGradient(tex_pos);
+  if (gradient_normal == glm::vec3(0.0f)) return clr;
+
+  glm::vec3 wpos = tex_pos - m_vol_grid_size * 0.5f;
+
+  gradient_normal = glm::normalize(gradient_normal);
+
+  glm::vec3 light_direction = glm::normalize(fp.light_position - wpos);
+  glm::vec3 eye_direction = glm::normalize(fp.eye - wpos);
+  glm::vec3 halfway_vector = glm::normalize(eye_direction + light_direction);
+
+  float dot_diff = std::max(0.0f, glm::dot(gradient_normal, light_direction));
+  float dot_spec = std::max(0.0f, glm::dot(halfway_vector, gradient_normal));
+
+  return (clr * (fp.ka + fp.kd * dot_diff)) + fp.ispecular * fp.ks * std::pow(dot_spec, fp.shininess);
+}
+
+void RayCasting1PassCPU::MeasureThreadScaling ()
+{
+  if (!IsBuilt()) return;
+
+  m_scaling_results.clear();
+  int max_threads = vis::TaskPool::Instance().GetMaxConcurrency();
+  int num_threads = m_num_threads;
+  for (int t = 1; ; t = std::min(t * 2, max_threads))
+  {
+    m_num_threads = t;
+
+    // Best of a few frames, the first one also warms up the caches
+    double best_ms = -1.0;
+    for (int i = 0; i < 3; i++)
+    {
+      auto t_start = std::chrono::high_resolution_clock::now();
+      RenderFrame(m_last_frame);
+      auto t_end = std::chrono::high_resolution_clock::now();
+      double ms = std::chrono::duration<double, std::milli>(t_end - t_start).count();
+      if (best_ms < 0.0 || ms < best_ms) best_ms = ms;
+    }
+
+    ScalingResult res;
+    res.threads = t;
+    res.frame_ms = best_ms;
+    m_scaling_results.push_back(res);
+
+    printf("RayCasting1PassCPU: %d threads, %.2f ms/frame, %.2f Mrays/s, speedup %.2fx\n", t, best_ms,
+      (double)m_stat_rays / (best_ms / 1000.0) * 1e-6, m_scaling_results[0].frame_ms / best_ms);
+
+    if (t == max_threads) break;
+  }
+  m_num_threads = num_threads;
+  SetOutdated();
+}
@@ -0,0 +1,120 @@
+/**
+ * 1-Pass - Ray Casting - CPU
+ * . Structured Datasets
+ * . Same emission-absorption model as RayCasting1Pass (ray_marching_1p.comp):
+ *   step size, transfer function lookup (extinction in alpha), front-to-back
+ *   composition, early ray termination and Blinn-Phong gradient shading.
+ * . Screen-space tiles are rendered on the shared work-stealing pool
+ *   (vis::TaskPool) and the image is uploaded to the screen output texture.
+ * . The volume, gradient and transfer function are read back from the same
+ *   textures used by the GPU renderers, and are sampled with the same
+ *   GL_LINEAR/GL_CLAMP_TO_EDGE rules, so the image is a deterministic
+ *   reference of the GPU ray caster.
+**/
+#ifndef SINGLE_PASS_VOLUME_RENDERING_RAY_CASTING_CPU_H
+#define SINGLE_PASS_VOLUME_RENDERING_RAY_CASTING_CPU_H
+
+#include <gl_utils/texture1d.h>
+#include <gl_utils/texture3d.h>
+
+#include "../../volrenderbase.h"
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <vector>
+
+class RayCasting1PassCPU : public BaseVolumeRenderer
+{
+public:
+  RayCasting1PassCPU ();
+  virtual ~RayCasting1PassCPU ();
+
+  //////////////////////////////////////////
+  // Virtual base functions
+  virtual const char* GetName () { return "1-Pass - Ray Casting - CPU"; }
+  virtual const char* GetAbbreviationName () { return "s_1rccpu"; }
+
+  virtual void Clean ();
+
+  virtual bool Init (int shader_width, int shader_height);
+  virtual bool Update (vis::Camera* camera);
+  virtual void Redraw ();
+
+  virtual void SetImGuiComponents ();
+
+  virtual vis::GRID_VOLUME_DATA_TYPE GetDataTypeSupport ()
+  {
+    return vis::GRID_VOLUME_DATA_TYPE::STRUCTURED;
+  }
+
+  virtual void FillParameterSpace (ParameterSpace& pspace) override;
+
+  virtual void GetFrameStatistics (std::vector<std::pair<std::string, double>>& stats) override;
+
+  float m_u_step_size;
+
+protected:
+
+private:
+  // Values of a frame shared by all tiles
+  struct FrameParameters
+  {
+    int width, height;
+    glm::vec3 eye;
+    glm::mat3 lookat;
+    float tan_fovy;
+    float aspect_ratio;
+    float step_size;
+    bool shading;
+    float ka, kd, ks, shininess;
+    glm::vec3 ispecular;
+    glm::vec3 light_position;
+  };
+
+  void ReadBackData ();
+  void RenderFrame (const FrameParameters& fp);
+  void RenderTile (const FrameParameters& fp, int tile);
+
+  // Texture lookups with GL_LINEAR and GL_CLAMP_TO_EDGE
+  // . tex_pos in [0, VolumeGridSize], density in [0, 1]
+  float SampleVolume (const glm::vec3& tex_pos) const;
+  glm::vec3 SampleGradient (const glm::vec3& tex_pos) const;
+  glm::vec4 SampleTransferFunction (float density) const;
+
+  glm::vec3 ShadeBlinnPhong (const FrameParameters& fp, const glm::vec3& tex_pos, const glm::vec3& clr) const;
+
+  // Measures the current frame with 1, 2, 4, ... threads
+  void MeasureThreadScaling ();
+
+  std::vector<float> m_volume;
+  std::vector<glm::vec3> m_gradient;
+  std::vector<glm::vec4> m_transfer_function;
+  glm::ivec3 m_vol_resolution;
+  glm::vec3 m_vol_voxel_size;
+  glm::vec3 m_vol_grid_size;
+
+  std::vector<glm::vec4> m_image;
+  FrameParameters m_last_frame;
+
+  // Tiles rendered at the same time on vis::TaskPool
+  int m_num_threads;
+  int m_tile_size;
+
+  bool m_apply_gradient_shading;
+
+  // Statistics of the last frame
+  std::atomic<unsigned long long> m_stat_rays;
+  std::atomic<unsigned long long> m_stat_samples;
+  double m_stat_frame_ms;
+  size_t m_stat_steals;
+
+  struct ScalingResult
+  {
+    int threads;
+    double frame_ms;
+  };
+  std::vector<ScalingResult> m_scaling_results;
+};
+
+#endif
@@ -552,6 +552,16 @@ void RC1PConeTracingDirOcclusionShading::SetImGuiComponents ()
 
 /////////////////////////////////
 // protected/private functions
+bool RC1PConeTracingDirOcclusionShading::OnTransferFunctionChanged ()
+{
+  if (!m_ext_data_manager->GetCurrentTransferFunction()->UpdateTexture_1D_RGBt(m_glsl_transfer_function))
+    return false;
+
+  // Rebinds the extinction coefficient volume, the light cache is computed again by Update
+  GenerateExtCoefVolume();
+  return true;
+}
+
 void RC1PConeTracingDirOcclusionShading::PreComputeLightCache (vis::Camera* camera)
 {
   cp_lightcache_shader->Bind();
@@ -749,10 +759,21 @@ void RC1PConeTracingDirOcclusionShading::GenerateExtCoefVolume ()
   GLuint64 startTime, stopTime;
   unsigned int queryID[2];
 
-  glsl_ext_coef_volume = ext_coef_vol_gen.BuildMipMappedTexture(
-    m_ext_data_manager->GetCurrentVolumeTexture(),
-    m_ext_data_manager->GetCurrentTransferFunction()->GenerateTexture_1D_RGBA(),
-    glm::vec3(m_ext_data_manager->GetCurrentStructuredVolume()->GetScale()));
+  // Shared with the other renderers using the same volume, transfer function and resolution
+  std::string parameters = "same size";
+  if (ext_coef_vol_gen.IsUsingCustomExtCoefVolumeResolution())
+  {
+    glm::ivec3 res = ext_coef_vol_gen.GetCustomExtCoefVolumeResolution();
+    parameters = std::to_string(res.x) + "x" + std::to_string(res.y) + "x" + std::to_string(res.z);
+  }
+  glsl_ext_coef_volume = m_ext_data_manager->GetPreprocessingRegistry().Acquire<gl::Texture3D>(
+    m_ext_data_manager->GetPreprocessingKey("ExtinctionCoefficientVolume", true, parameters),
+    [&] () {
+      return ext_coef_vol_gen.BuildMipMappedTexture(
+        m_ext_data_manager->GetCurrentVolumeTexture(),
+        m_ext_data_manager->GetCurrentTransferFunction()->GenerateTexture_1D_RGBA(),
+        glm::vec3(m_ext_data_manager->GetCurrentStructuredVolume()->GetScale()));
+    });
 
   // request binding of extinction coefficient volume
   bind_volume_of_gaussians = true;
@@ -765,7 +786,7 @@ void RC1PConeTracingDirOcclusionShading::GenerateExtCoefVolume ()
 
 void RC1PConeTracingDirOcclusionShading::DestroyExtCoefVolume ()
 {
-  if (glsl_ext_coef_volume) delete glsl_ext_coef_volume;
+  m_ext_data_manager->GetPreprocessingRegistry().Release(glsl_ext_coef_volume);
   glsl_ext_coef_volume = nullptr;
 
   gl::ExitOnGLError("Could not destroy gaussian data!");
@@ -58,6 +58,8 @@ public:
   
   virtual void SetImGuiComponents ();
 
+  virtual bool OnTransferFunctionChanged () override;
+
   virtual vis::GRID_VOLUME_DATA_TYPE GetDataTypeSupport ()
   {
     return vis::GRID_VOLUME_DATA_TYPE::STRUCTURED;
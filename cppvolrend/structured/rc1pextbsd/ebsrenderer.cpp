@@ -10,6 +10,7 @@
 
 #include <volvis_utils/utils.h>
 #include <gl_utils/computeshader.h>
+#include <gl_utils/memoryregistry.h>
 
 #include <random>
 
@@ -17,10 +18,12 @@
 // public functions
 /////////////////////////////////
 RC1PExtinctionBasedShading::RC1PExtinctionBasedShading ()
-  : m_glsl_transfer_function(nullptr)
+  : glsl_sat3d_tex(nullptr)
+  , m_parameter_block(nullptr)
+  , m_precompiled_variant(-1)
+  , m_glsl_transfer_function(nullptr)
   , m_u_step_size(0.5f)
   , m_apply_gradient_shading(false)
-  , glsl_sat3d_tex(nullptr)
   , transfer_function_changed(false)
 {
 
@@ -92,8 +95,7 @@ bool RC1PExtinctionBasedShading::Init (int swidth, int sheight)
   st_w = m_ext_data_manager->GetCurrentStructuredVolume()->GetWidth();
   st_h = m_ext_data_manager->GetCurrentStructuredVolume()->GetHeight();
   st_d = m_ext_data_manager->GetCurrentStructuredVolume()->GetDepth();
-  glsl_sat3d_tex = GenerateExtinctionSAT3DTex(m_ext_data_manager->GetCurrentStructuredVolume(),
-                                              m_ext_data_manager->GetCurrentTransferFunction());
+  glsl_sat3d_tex = AcquireSummedAreaTable();
 
   // Get the current Diagonal of the Volume
   vis::StructuredGridVolume* vold = m_ext_data_manager->GetCurrentStructuredVolume();
@@ -135,49 +137,12 @@ bool RC1PExtinctionBasedShading::Update (vis::Camera* camera)
   }
   else // image space
   {
+    UpdateShaderVariant();
     cp_geometry_pass->Bind();
+    PrecompileNeighborVariants();
 
     cp_geometry_pass->SetUniformTexture3D("TexVolumeSAT3D", glsl_sat3d_tex->GetTextureID(), 4);
     cp_geometry_pass->BindUniform("TexVolumeSAT3D");
-
-    cp_geometry_pass->SetUniform("u_sat_width", (int)glsl_sat3d_tex->GetWidth());
-    cp_geometry_pass->BindUniform("u_sat_width");
-    cp_geometry_pass->SetUniform("u_sat_height", (int)glsl_sat3d_tex->GetHeight());
-    cp_geometry_pass->BindUniform("u_sat_height");
-    cp_geometry_pass->SetUniform("u_sat_depth", (int)glsl_sat3d_tex->GetDepth());
-    cp_geometry_pass->BindUniform("u_sat_depth");
-
-    // Ambient Occlusion
-    cp_geometry_pass->SetUniform("AmbOccShells", ambient_occlusion_shells);
-    cp_geometry_pass->BindUniform("AmbOccShells");
-
-    cp_geometry_pass->SetUniform("AmbOccRadius", ambient_occlusion_radius);
-    cp_geometry_pass->BindUniform("AmbOccRadius");
-
-    // Directional Shadows
-    cp_geometry_pass->SetUniform("DirSdwConeSamples", dir_shadow_cone_samples);
-    cp_geometry_pass->BindUniform("DirSdwConeSamples");
-
-    cp_geometry_pass->SetUniform("DirSdwConeAngle", (float)(dir_shadow_cone_angle * glm::pi<double>() / 180.0));
-    cp_geometry_pass->BindUniform("DirSdwConeAngle");
-
-    cp_geometry_pass->SetUniform("DirSdwSampleInterval", dir_shadow_sample_interval);
-    cp_geometry_pass->BindUniform("DirSdwSampleInterval");
-
-    cp_geometry_pass->SetUniform("DirSdwInitialStep", dir_shadow_initial_step);
-    cp_geometry_pass->BindUniform("DirSdwInitialStep");
-
-    cp_geometry_pass->SetUniform("DirSdwUserInterfaceWeight", dir_shadow_user_interface_weight);
-    cp_geometry_pass->BindUniform("DirSdwUserInterfaceWeight");
-
-    cp_geometry_pass->SetUniform("DirSdwConeMaxDistance", dir_cone_max_distance);
-    cp_geometry_pass->BindUniform("DirSdwConeMaxDistance");
-
-    cp_geometry_pass->SetUniform("LightCamForward", m_ext_rendering_parameters->GetBlinnPhongLightSourceCameraForward());
-    cp_geometry_pass->BindUniform("LightCamForward");
-
-    cp_geometry_pass->SetUniform("TypeOfShadow", type_of_shadow);
-    cp_geometry_pass->BindUniform("TypeOfShadow");
   }
 
   cp_geometry_pass->Bind();
@@ -194,50 +159,92 @@ bool RC1PExtinctionBasedShading::Update (vis::Camera* camera)
       m_ext_rendering_parameters->GetScreenHeight(), 0);
   }
 
-  cp_geometry_pass->SetUniform("CameraEye", camera->GetEye());
-  cp_geometry_pass->BindUniform("CameraEye");
+  if (m_parameter_block)
+  {
+    ExtinctionShadingParameters& params = m_parameter_block->values;
+    params.u_sat_width = (int)glsl_sat3d_tex->GetWidth();
+    params.u_sat_height = (int)glsl_sat3d_tex->GetHeight();
+    params.u_sat_depth = (int)glsl_sat3d_tex->GetDepth();
+
+    // Ambient Occlusion
+    params.AmbOccShells = ambient_occlusion_shells;
+    params.AmbOccRadius = ambient_occlusion_radius;
+
+    // Directional Shadows
+    params.DirSdwConeSamples = dir_shadow_cone_samples;
+    params.DirSdwConeAngle = (float)(dir_shadow_cone_angle * glm::pi<double>() / 180.0);
+    params.DirSdwSampleInterval = dir_shadow_sample_interval;
+    params.DirSdwInitialStep = dir_shadow_initial_step;
+    params.DirSdwUserInterfaceWeight = dir_shadow_user_interface_weight;
+    params.DirSdwConeMaxDistance = dir_cone_max_distance;
+    params.LightCamForward = m_ext_rendering_parameters->GetBlinnPhongLightSourceCameraForward();
+
+    params.CameraEye = camera->GetEye();
+    params.ViewMatrix = camera->LookAt();
+    params.ProjectionMatrix = camera->Projection();
+    params.fov_y_tangent = (float)tan((camera->GetFovY() / 2.0) * glm::pi<double>() / 180.0);
+    params.aspect_ratio = camera->GetAspectRatio();
+
+    params.StepSize = m_u_step_size;
+
+    params.Kambient = m_ext_rendering_parameters->GetBlinnPhongKambient();
+    params.Kdiffuse = m_ext_rendering_parameters->GetBlinnPhongKdiffuse();
+    params.Kspecular = m_ext_rendering_parameters->GetBlinnPhongKspecular();
+    params.Nshininess = m_ext_rendering_parameters->GetBlinnPhongNshininess();
+    params.Ispecular = m_ext_rendering_parameters->GetLightSourceSpecular();
+
+    params.WorldEyePos = camera->GetEye();
+    params.WorldLightingPos = m_ext_rendering_parameters->GetBlinnPhongLightingPosition();
+
+    m_parameter_block->Upload();
+  }
+  else
+  {
+    cp_geometry_pass->SetUniform("CameraEye", camera->GetEye());
+    cp_geometry_pass->BindUniform("CameraEye");
 
-  cp_geometry_pass->SetUniform("ViewMatrix", camera->LookAt());
-  cp_geometry_pass->BindUniform("ViewMatrix");
+    cp_geometry_pass->SetUniform("ViewMatrix", camera->LookAt());
+    cp_geometry_pass->BindUniform("ViewMatrix");
 
-  cp_geometry_pass->SetUniform("ProjectionMatrix", camera->Projection());
-  cp_geometry_pass->BindUniform("ProjectionMatrix");
+    cp_geometry_pass->SetUniform("ProjectionMatrix", camera->Projection());
+    cp_geometry_pass->BindUniform("ProjectionMatrix");
 
-  cp_geometry_pass->SetUniform("fov_y_tangent", (float)tan((camera->GetFovY() / 2.0) * glm::pi<double>() / 180.0));
-  cp_geometry_pass->BindUniform("fov_y_tangent");
+    cp_geometry_pass->SetUniform("fov_y_tangent", (float)tan((camera->GetFovY() / 2.0) * glm::pi<double>() / 180.0));
+    cp_geometry_pass->BindUniform("fov_y_tangent");
 
-  cp_geometry_pass->SetUniform("aspect_ratio", camera->GetAspectRatio());
-  cp_geometry_pass->BindUniform("aspect_ratio");
+    cp_geometry_pass->SetUniform("aspect_ratio", camera->GetAspectRatio());
+    cp_geometry_pass->BindUniform("aspect_ratio");
 
-  cp_geometry_pass->SetUniform("ApplyOcclusion", apply_ambient_occlusion ? 1 : 0);
-  cp_geometry_pass->BindUniform("ApplyOcclusion");
+    cp_geometry_pass->SetUniform("ApplyOcclusion", apply_ambient_occlusion ? 1 : 0);
+    cp_geometry_pass->BindUniform("ApplyOcclusion");
 
-  cp_geometry_pass->SetUniform("ApplyShadow", apply_directional_shadows ? 1 : 0);
-  cp_geometry_pass->BindUniform("ApplyShadow");
+    cp_geometry_pass->SetUniform("ApplyShadow", apply_directional_shadows ? 1 : 0);
+    cp_geometry_pass->BindUniform("ApplyShadow");
 
-  cp_geometry_pass->SetUniform("StepSize", m_u_step_size);
-  cp_geometry_pass->BindUniform("StepSize");
+    cp_geometry_pass->SetUniform("StepSize", m_u_step_size);
+    cp_geometry_pass->BindUniform("StepSize");
 
-  cp_geometry_pass->SetUniform("ApplyPhongShading", (m_apply_gradient_shading && m_ext_data_manager->GetCurrentGradientTexture()) ? 1 : 0);
-  cp_geometry_pass->BindUniform("ApplyPhongShading");
+    cp_geometry_pass->SetUniform("ApplyPhongShading", (m_apply_gradient_shading && m_ext_data_manager->GetCurrentGradientTexture()) ? 1 : 0);
+    cp_geometry_pass->BindUniform("ApplyPhongShading");
 
-  cp_geometry_pass->SetUniform("Kambient", m_ext_rendering_parameters->GetBlinnPhongKambient());
-  cp_geometry_pass->BindUniform("Kambient");
-  cp_geometry_pass->SetUniform("Kdiffuse", m_ext_rendering_parameters->GetBlinnPhongKdiffuse());
-  cp_geometry_pass->BindUniform("Kdiffuse");
-  cp_geometry_pass->SetUniform("Kspecular", m_ext_rendering_parameters->GetBlinnPhongKspecular());
-  cp_geometry_pass->BindUniform("Kspecular");
-  cp_geometry_pass->SetUniform("Nshininess", m_ext_rendering_parameters->GetBlinnPhongNshininess());
-  cp_geometry_pass->BindUniform("Nshininess");
+    cp_geometry_pass->SetUniform("Kambient", m_ext_rendering_parameters->GetBlinnPhongKambient());
+    cp_geometry_pass->BindUniform("Kambient");
+    cp_geometry_pass->SetUniform("Kdiffuse", m_ext_rendering_parameters->GetBlinnPhongKdiffuse());
+    cp_geometry_pass->BindUniform("Kdiffuse");
+    cp_geometry_pass->SetUniform("Kspecular", m_ext_rendering_parameters->GetBlinnPhongKspecular());
+    cp_geometry_pass->BindUniform("Kspecular");
+    cp_geometry_pass->SetUniform("Nshininess", m_ext_rendering_parameters->GetBlinnPhongNshininess());
+    cp_geometry_pass->BindUniform("Nshininess");
 
-  cp_geometry_pass->SetUniform("Ispecular", m_ext_rendering_parameters->GetLightSourceSpecular());
-  cp_geometry_pass->BindUniform("Ispecular");
+    cp_geometry_pass->SetUniform("Ispecular", m_ext_rendering_parameters->GetLightSourceSpecular());
+    cp_geometry_pass->BindUniform("Ispecular");
 
-  cp_geometry_pass->SetUniform("WorldEyePos", camera->GetEye());
-  cp_geometry_pass->BindUniform("WorldEyePos");
+    cp_geometry_pass->SetUniform("WorldEyePos", camera->GetEye());
+    cp_geometry_pass->BindUniform("WorldEyePos");
 
-  cp_geometry_pass->SetUniform("WorldLightingPos", m_ext_rendering_parameters->GetBlinnPhongLightingPosition());
-  cp_geometry_pass->BindUniform("WorldLightingPos");
+    cp_geometry_pass->SetUniform("WorldLightingPos", m_ext_rendering_parameters->GetBlinnPhongLightingPosition());
+    cp_geometry_pass->BindUniform("WorldLightingPos");
+  }
 
   cp_geometry_pass->BindUniforms();
 
@@ -251,6 +258,7 @@ void RC1PExtinctionBasedShading::Redraw ()
   m_rdr_frame_to_screen.ClearTexture();
 
   cp_geometry_pass->Bind();
+  if (m_parameter_block) m_parameter_block->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
   cp_geometry_pass->Dispatch();
@@ -264,6 +272,7 @@ void RC1PExtinctionBasedShading::MultiSampleRedraw ()
   m_rdr_frame_to_screen.ClearTexture();
 
   cp_geometry_pass->Bind();
+  if (m_parameter_block) m_parameter_block->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
   cp_geometry_pass->Dispatch();
@@ -277,6 +286,7 @@ void RC1PExtinctionBasedShading::DownScalingRedraw ()
   m_rdr_frame_to_screen.ClearTexture();
 
   cp_geometry_pass->Bind();
+  if (m_parameter_block) m_parameter_block->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
   cp_geometry_pass->Dispatch();
@@ -290,6 +300,7 @@ void RC1PExtinctionBasedShading::UpScalingRedraw ()
   m_rdr_frame_to_screen.ClearTexture();
 
   cp_geometry_pass->Bind();
+  if (m_parameter_block) m_parameter_block->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
   cp_geometry_pass->Dispatch();
@@ -348,8 +359,7 @@ void RC1PExtinctionBasedShading::SetImGuiComponents ()
   if (ImGui::Button("Update SAT3D Resolution"))
   {
     DestroySummedAreaTable();
-    glsl_sat3d_tex = GenerateExtinctionSAT3DTex(m_ext_data_manager->GetCurrentStructuredVolume(),
-                                                m_ext_data_manager->GetCurrentTransferFunction());
+    glsl_sat3d_tex = AcquireSummedAreaTable();
 
     SetOutdated();
   }
@@ -425,6 +435,12 @@ void RC1PExtinctionBasedShading::SetImGuiComponents ()
     }
   }
   ImGui::PopID();
+
+  if (!m_pre_illum_str_vol.IsActive())
+  {
+    ImGui::Separator();
+    ImGui::Text("Shader Variants: %d", cp_geometry_pass->GetNumberOfVariants());
+  }
 }
 
 void RC1PExtinctionBasedShading::FillParameterSpace(ParameterSpace& pspace)
@@ -434,10 +450,30 @@ void RC1PExtinctionBasedShading::FillParameterSpace(ParameterSpace& pspace)
   pspace.AddParameterDimension(new ParameterRangeFloat("AmbientOccRadius", &ambient_occlusion_radius, 0.1f, 1.5f, 0.1f));
 }
 
+void RC1PExtinctionBasedShading::FillVariantSpace (ParameterSpace& pspace)
+{
+  pspace.ClearParameterDimensions();
+  // Shader variants only in image space
+  pspace.AddParameterDimension(new ParameterRangeList<bool>("DirectionalShadows", &apply_directional_shadows, { false, true }));
+}
+
 
 /////////////////////////////////
 // protected/private functions
 /////////////////////////////////
+bool RC1PExtinctionBasedShading::OnTransferFunctionChanged ()
+{
+  if (!m_ext_data_manager->GetCurrentTransferFunction()->UpdateTexture_1D_RGBt(m_glsl_transfer_function))
+    return false;
+
+  // The summed area table is bound by Update, the light cache is computed again there
+  DestroySummedAreaTable();
+  glsl_sat3d_tex = AcquireSummedAreaTable();
+
+  SetOutdated();
+  return true;
+}
+
 void RC1PExtinctionBasedShading::PreComputeLightCache (vis::Camera* camera)
 {
   vis::StructuredGridVolume* vol = m_ext_data_manager->GetCurrentStructuredVolume();
@@ -567,15 +603,21 @@ void RC1PExtinctionBasedShading::CreateRenderingPass ()
   glm::vec3 vol_aabb = vol_resolution * vol_voxelsize;
   
   cp_geometry_pass = new gl::ComputeShader();
+  m_precompiled_variant = -1;
 
   if (m_pre_illum_str_vol.IsActive())
     cp_geometry_pass->SetShaderFile(CPPVOLREND_DIR"structured/_common_shaders/obj_ray_marching.comp");
   else
     cp_geometry_pass->SetShaderFile(CPPVOLREND_DIR"structured/rc1pextbsd/ebs_ray_bbox_marching.comp");
   
+  if (!m_pre_illum_str_vol.IsActive())
+    UpdateShaderVariant();
   cp_geometry_pass->LoadAndLink();
   cp_geometry_pass->Bind();
 
+  if (!m_pre_illum_str_vol.IsActive())
+    m_parameter_block = new gl::ParameterBlock<ExtinctionShadingParameters>(0);
+
   cp_geometry_pass->SetUniform("VolumeScales", vol_voxelsize);
   cp_geometry_pass->SetUniform("VolumeScaledSizes", vol_aabb);
 
@@ -608,16 +650,72 @@ void RC1PExtinctionBasedShading::CreateRenderingPass ()
   }
 }
 
+void RC1PExtinctionBasedShading::UpdateShaderVariant ()
+{
+  cp_geometry_pass->SetFlag("AMBIENT_OCCLUSION", apply_ambient_occlusion);
+  cp_geometry_pass->SetFlag("DIRECTIONAL_SHADOWS", apply_directional_shadows);
+  cp_geometry_pass->SetFlag("DIRECTIONAL_LIGHT", type_of_shadow == 1);
+  cp_geometry_pass->SetFlag("GRADIENT_SHADING", m_apply_gradient_shading && m_ext_data_manager->GetCurrentGradientTexture());
+}
+
+void RC1PExtinctionBasedShading::PrecompileNeighborVariants ()
+{
+  int variant = (apply_ambient_occlusion ? 1 : 0) | (apply_directional_shadows ? 2 : 0)
+              | (type_of_shadow == 1 ? 4 : 0) | (m_apply_gradient_shading ? 8 : 0);
+  if (variant == m_precompiled_variant) return;
+  m_precompiled_variant = variant;
+
+  bool ambient_occlusion = apply_ambient_occlusion;
+  bool directional_shadows = apply_directional_shadows;
+  int shadow = type_of_shadow;
+  bool gradient_shading = m_apply_gradient_shading;
+  auto submit = [&] () {
+    UpdateShaderVariant();
+    cp_geometry_pass->PrecompileVariant(GetName());
+  };
+
+  apply_ambient_occlusion = !ambient_occlusion;
+  submit();
+  apply_ambient_occlusion = ambient_occlusion;
+
+  apply_directional_shadows = !directional_shadows;
+  submit();
+  apply_directional_shadows = directional_shadows;
+
+  type_of_shadow = (shadow == 1) ? 0 : 1;
+  submit();
+  type_of_shadow = shadow;
+
+  m_apply_gradient_shading = !gradient_shading;
+  submit();
+  m_apply_gradient_shading = gradient_shading;
+
+  UpdateShaderVariant();
+}
+
 void RC1PExtinctionBasedShading::DestroyRenderingShaders ()
 {
   if (cp_geometry_pass != nullptr) delete cp_geometry_pass;
   cp_geometry_pass = nullptr;
+
+  if (m_parameter_block != nullptr) delete m_parameter_block;
+  m_parameter_block = nullptr;
+}
+
+gl::Texture3D* RC1PExtinctionBasedShading::AcquireSummedAreaTable ()
+{
+  // Shared with the other renderers using the same volume and transfer function
+  return m_ext_data_manager->GetPreprocessingRegistry().Acquire<gl::Texture3D>(
+    m_ext_data_manager->GetPreprocessingKey("ExtinctionSAT3D", true),
+    [&] () {
+      return GenerateExtinctionSAT3DTex(m_ext_data_manager->GetCurrentStructuredVolume(),
+                                        m_ext_data_manager->GetCurrentTransferFunction());
+    });
 }
 
 void RC1PExtinctionBasedShading::DestroySummedAreaTable ()
 {
-  if (glsl_sat3d_tex != nullptr)
-    delete glsl_sat3d_tex;
+  m_ext_data_manager->GetPreprocessingRegistry().Release(glsl_sat3d_tex);
   glsl_sat3d_tex = nullptr;
 }
 
@@ -628,6 +726,10 @@ gl::Texture3D* RC1PExtinctionBasedShading::GenerateExtinctionSAT3DTex (vis::Stru
   int sat_w = (vol->GetWidth() + 2);
   int sat_h = (vol->GetHeight() + 2);
   int sat_d = (vol->GetDepth() + 2);
+
+  // The lookups of the shader are in volume coordinates, so the SAT is not reduced
+  if (!gl::MemoryRegistry::Instance().Fits(gl::MemoryRegistry::GetTextureBytes(GL_R32F, sat_w, sat_h, sat_d)))
+    printf("RC1PExtinctionBasedShading: the SAT of %dx%dx%d exceeds the GPU memory budget\n", sat_w, sat_h, sat_d);
   
   double min_value = +9999;
   double max_value = -9999;
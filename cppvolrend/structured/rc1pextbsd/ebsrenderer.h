@@ -34,6 +34,7 @@
 #include <gl_utils/bufferobject.h>
 
 #include <gl_utils/computeshader.h>
+#include <gl_utils/uniformblock.h>
 
 #include "../../volrenderbase.h"
 #include "../../utils/preillumination.h"
@@ -42,6 +43,46 @@
 #include "imgui_impl_glut.h"
 #include "imgui_impl_opengl2.h"
 
+#include <glm/glm.hpp>
+
+// Per-frame parameters of ebs_ray_bbox_marching.comp (image space mode)
+// . std140 layout of its ExtinctionShadingParameters uniform block, member by member
+struct ExtinctionShadingParameters
+{
+  glm::mat4 ViewMatrix;
+  glm::mat4 ProjectionMatrix;
+
+  glm::vec3 CameraEye;
+  float fov_y_tangent;
+  glm::vec3 WorldEyePos;
+  float aspect_ratio;
+  glm::vec3 WorldLightingPos;
+  float StepSize;
+  glm::vec3 Ispecular;
+  float Kambient;
+  glm::vec3 LightCamForward;
+  float Kdiffuse;
+
+  float Kspecular;
+  float Nshininess;
+  float AmbOccRadius;
+  float DirSdwConeAngle;
+
+  float DirSdwSampleInterval;
+  float DirSdwInitialStep;
+  float DirSdwUserInterfaceWeight;
+  float DirSdwConeMaxDistance;
+
+  int AmbOccShells;
+  int DirSdwConeSamples;
+  int u_sat_width;
+  int u_sat_height;
+
+  int u_sat_depth;
+  int _pad[3];
+};
+static_assert(sizeof(ExtinctionShadingParameters) == 272, "ExtinctionShadingParameters must match the std140 layout");
+
 class RC1PExtinctionBasedShading : public BaseVolumeRenderer
 {
 public:
@@ -65,6 +106,9 @@ public:
   
   virtual void SetImGuiComponents ();
   virtual void FillParameterSpace(ParameterSpace& pspace) override;
+  virtual void FillVariantSpace (ParameterSpace& pspace) override;
+
+  virtual bool OnTransferFunctionChanged () override;
 
   virtual vis::GRID_VOLUME_DATA_TYPE GetDataTypeSupport ()
   {
@@ -84,12 +128,22 @@ protected:
 
   // Rendering shaders
   gl::ComputeShader* cp_geometry_pass;
+  // Only in image space mode: obj_ray_marching.comp uses named uniforms
+  gl::ParameterBlock<ExtinctionShadingParameters>* m_parameter_block;
 
   glm::mat4 ProjectionMatrix, ViewMatrix;
   void CreateRenderingPass ();
+  // Features compiled into ebs_ray_bbox_marching.comp, the variant is swapped on the next Bind
+  void UpdateShaderVariant ();
+  // Submits the variants one interface toggle away from the current one, so
+  //   the toggle takes a program compiled in the background
+  void PrecompileNeighborVariants ();
+  // Features of the variant whose neighbors were submitted, -1 if none
+  int m_precompiled_variant;
 
 private:
   void DestroyRenderingShaders ();
+  gl::Texture3D* AcquireSummedAreaTable ();
   void DestroySummedAreaTable ();
 
   gl::Texture3D* GenerateExtinctionSAT3DTex (vis::StructuredGridVolume* vol, vis::TransferFunction* tf);
@@ -16,6 +16,7 @@ RayCasting1PassIsoAdapt::RayCasting1PassIsoAdapt()
   ,m_u_step_size_small(0.05f)
   ,m_u_step_size_large(1.0f)
   ,m_u_step_size_range(0.1f)
+  ,m_analytic_roots(false)
   ,m_u_color(0.66f, 0.6f, 0.05f, 1.0f)
   ,m_apply_gradient_shading(false)
 {
@@ -82,6 +83,7 @@ bool RayCasting1PassIsoAdapt::Init(int swidth, int sheight)
   // - load shaders
   cp_geometry_pass = new gl::ComputeShader();
   cp_geometry_pass->AddShaderFile(CPPVOLREND_DIR"structured/_common_shaders/ray_bbox_intersection.comp");
+  cp_geometry_pass->AddShaderFile(CPPVOLREND_DIR"structured/_common_shaders/trilinear_iso_root.comp");
   cp_geometry_pass->AddShaderFile(CPPVOLREND_DIR"structured/rc1pisoadapt/ray_marching_1p_iso_adapt.comp");
   cp_geometry_pass->LoadAndLink();
   cp_geometry_pass->Bind();
@@ -153,6 +155,7 @@ bool RayCasting1PassIsoAdapt::Update(vis::Camera* camera)
   cp_geometry_pass->SetUniform("StepSizeSmall", m_u_step_size_small);
   cp_geometry_pass->SetUniform("StepSizeLarge", m_u_step_size_large);
   cp_geometry_pass->SetUniform("StepSizeRange", m_u_step_size_range);
+  cp_geometry_pass->SetUniform("AnalyticRoots", m_analytic_roots ? 1 : 0);
   cp_geometry_pass->SetUniform("Color", m_u_color);
   cp_geometry_pass->SetUniform("ApplyGradientPhongShading", (m_apply_gradient_shading && m_ext_data_manager->GetCurrentGradientTexture()) ? 1 : 0);
 
@@ -194,6 +197,8 @@ void RayCasting1PassIsoAdapt::FillParameterSpace(ParameterSpace & pspace)
   pspace.AddParameterDimension(new ParameterRangeFloat("StepSizeSmall", &m_u_step_size_small, 0.01f, 0.25f, 0.05f));
   pspace.AddParameterDimension(new ParameterRangeFloat("StepSizeLarge", &m_u_step_size_large, 0.25f, 2.0f, 0.25f));
   pspace.AddParameterDimension(new ParameterRangeFloat("StepSizeRange", &m_u_step_size_range, 0.05f, 0.26f, 0.05f));
+  //Both modes use the steps, the evaluation compares their time and image error
+  pspace.AddParameterDimension(new ParameterRangeList<bool>("AnalyticRoots", &m_analytic_roots, { false, true }));
 }
 
 
@@ -214,6 +219,11 @@ void RayCasting1PassIsoAdapt::SetImGuiComponents()
     SetOutdated();
   }
 
+  if (ImGui::Checkbox("Analytic Cell Roots###RayCasting1PassIsoAdaptUIAnalyticRoots", &m_analytic_roots))
+  {
+    SetOutdated();
+  }
+
   ImGui::Text("Step Size Small: ");
   if (ImGui::DragFloat("###RayCasting1PassIsoAdaptUIIntegrationStepSizeSmall", &m_u_step_size_small, 0.005f, 0.01f, 1.0f, "%.2f"))
   {
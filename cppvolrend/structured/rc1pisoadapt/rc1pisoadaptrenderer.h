@@ -39,6 +39,11 @@ protected:
   /// Withing this range around the isovalue, the small step size will be chosen.
   /// Outside of this range, the large step size will be used.
   float m_u_step_size_range;
+
+  /// Find the exact first root of the trilinear interpolant in the cells
+  /// crossed by a step, instead of interpolating between its samples. Only
+  /// the steps with a sign change or in the small step range are solved.
+  bool m_analytic_roots;
   
   glm::vec4 m_u_color;
   bool m_apply_gradient_shading;
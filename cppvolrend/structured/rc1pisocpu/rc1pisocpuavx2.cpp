@@ -0,0 +1,52 @@
+#include "rc1pisocpuavx2.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+void SampleVolume8AVX2 (const float* volume, const int* resolution, const float* voxel_size,
+                        const float* x, const float* y, const float* z, float* density)
+{
+  const __m256 half = _mm256_set1_ps(0.5f);
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i one = _mm256_set1_epi32(1);
+
+  // Grid coordinates, with the texel centers at integer positions
+  __m256 gx = _mm256_sub_ps(_mm256_div_ps(_mm256_loadu_ps(x), _mm256_set1_ps(voxel_size[0])), half);
+  __m256 gy = _mm256_sub_ps(_mm256_div_ps(_mm256_loadu_ps(y), _mm256_set1_ps(voxel_size[1])), half);
+  __m256 gz = _mm256_sub_ps(_mm256_div_ps(_mm256_loadu_ps(z), _mm256_set1_ps(voxel_size[2])), half);
+
+  __m256 pfx = _mm256_floor_ps(gx);
+  __m256 pfy = _mm256_floor_ps(gy);
+  __m256 pfz = _mm256_floor_ps(gz);
+  __m256 fx = _mm256_sub_ps(gx, pfx);
+  __m256 fy = _mm256_sub_ps(gy, pfy);
+  __m256 fz = _mm256_sub_ps(gz, pfz);
+
+  auto clamp = [&](__m256i i, int n) { return _mm256_max_epi32(_mm256_min_epi32(i, _mm256_set1_epi32(n - 1)), zero); };
+
+  __m256i ix = _mm256_cvttps_epi32(pfx);
+  __m256i iy = _mm256_cvttps_epi32(pfy);
+  __m256i iz = _mm256_cvttps_epi32(pfz);
+
+  // Voxel offsets of the two corners of each axis (32-bit indices)
+  __m256i sy = _mm256_set1_epi32(resolution[0]);
+  __m256i sz = _mm256_set1_epi32(resolution[0] * resolution[1]);
+  __m256i x0 = clamp(ix, resolution[0]);
+  __m256i x1 = clamp(_mm256_add_epi32(ix, one), resolution[0]);
+  __m256i y0 = _mm256_mullo_epi32(clamp(iy, resolution[1]), sy);
+  __m256i y1 = _mm256_mullo_epi32(clamp(_mm256_add_epi32(iy, one), resolution[1]), sy);
+  __m256i z0 = _mm256_mullo_epi32(clamp(iz, resolution[2]), sz);
+  __m256i z1 = _mm256_mullo_epi32(clamp(_mm256_add_epi32(iz, one), resolution[2]), sz);
+
+  auto v = [&](__m256i xo, __m256i yo, __m256i zo) {
+    return _mm256_i32gather_ps(volume, _mm256_add_epi32(_mm256_add_epi32(xo, yo), zo), 4);
+  };
+  auto lerp = [](__m256 a, __m256 b, __m256 w) { return _mm256_add_ps(a, _mm256_mul_ps(w, _mm256_sub_ps(b, a))); };
+
+  __m256 c00 = lerp(v(x0, y0, z0), v(x1, y0, z0), fx);
+  __m256 c10 = lerp(v(x0, y1, z0), v(x1, y1, z0), fx);
+  __m256 c01 = lerp(v(x0, y0, z1), v(x1, y0, z1), fx);
+  __m256 c11 = lerp(v(x0, y1, z1), v(x1, y1, z1), fx);
+  _mm256_storeu_ps(density, lerp(lerp(c00, c10, fy), lerp(c01, c11, fy), fz));
+}
+#endif
@@ -0,0 +1,17 @@
+/**
+ * AVX2 kernels of the CPU isosurface ray caster (RayCasting1PassIsoCPU)
+ * . Only this file is compiled with AVX2 (CPPVOLREND_AVX2), the renderer calls
+ *   it if the CPU supports AVX2.
+ * . Plain types only: inline functions (glm, std) instantiated here would be
+ *   compiled with AVX2 and could be the ones kept by the linker.
+**/
+#ifndef SINGLE_PASS_ISOSURFACE_RAY_CASTING_CPU_AVX2_H
+#define SINGLE_PASS_ISOSURFACE_RAY_CASTING_CPU_AVX2_H
+
+// Trilinear samples of 8 lanes with gathers, same operations as RayCasting1PassIsoCPU::SampleVolume
+// . volume: resolution[0] * resolution[1] * resolution[2] values, x first
+// . x, y, z: texture positions in [0, resolution * voxel_size]
+void SampleVolume8AVX2 (const float* volume, const int* resolution, const float* voxel_size,
+                        const float* x, const float* y, const float* z, float* density);
+
+#endif
@@ -0,0 +1,717 @@
+#include "../../defines.h"
+#include "rc1pisocpurenderer.h"
+#include "rc1pisocpuavx2.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <vis_utils/camera.h>
+#include <vis_utils/taskgraph.h>
+
+#include <volvis_utils/utils.h>
+#include <math_utils/utils.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+#include "imgui.h"
+
+namespace
+{
+  // The CPU runs AVX2, and the OS saves the AVX registers
+  bool HasAVX2 ()
+  {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+  }
+}
+
+RayCasting1PassIsoCPU::RayCasting1PassIsoCPU ()
+  : m_u_isovalue(0.5f)
+  , m_u_step_size_small(0.05f)
+  , m_u_step_size_large(1.0f)
+  , m_u_step_size_range(0.1f)
+  , m_u_color(0.66f, 0.6f, 0.05f, 1.0f)
+  , m_apply_gradient_shading(false)
+  , m_vol_resolution(0)
+  , m_vol_voxel_size(1.0f)
+  , m_vol_grid_size(1.0f)
+  , m_num_blocks_per_axis(32)
+  , m_block_grid(0)
+  , m_block_voxels(1)
+  , m_block_size(1.0f)
+  , m_active_blocks_isovalue(-1.0f)
+  , m_number_of_active_blocks(0)
+  , m_num_threads(vis::TaskPool::Instance().GetMaxConcurrency())
+  , m_tile_size(32)
+  , m_packet_width(8)
+#ifdef USING_AVX2
+  , m_use_avx2(HasAVX2())
+#else
+  , m_use_avx2(false)
+#endif
+  , m_stat_rays(0)
+  , m_stat_packet_steps(0)
+  , m_stat_lane_samples(0)
+  , m_stat_block_skips(0)
+  , m_stat_frame_ms(0.0)
+{
+  m_last_frame.width = 0;
+  m_last_frame.height = 0;
+}
+
+RayCasting1PassIsoCPU::~RayCasting1PassIsoCPU ()
+{
+  Clean();
+}
+
+void RayCasting1PassIsoCPU::Clean ()
+{
+  m_volume.clear();
+  m_gradient.clear();
+  m_block_interval_index.Clear();
+  m_active_block_mask.clear();
+  m_active_blocks_isovalue = -1.0f;
+  m_number_of_active_blocks = 0;
+  m_image.clear();
+  m_benchmark_results.clear();
+
+  BaseVolumeRenderer::Clean();
+}
+
+bool RayCasting1PassIsoCPU::Init (int swidth, int sheight)
+{
+  if (IsBuilt()) Clean();
+
+  if (m_ext_data_manager->GetCurrentVolumeTexture() == nullptr) return false;
+
+  ReadBackData();
+  BuildBlocks();
+
+  Reshape(swidth, sheight);
+
+  SetBuilt(true);
+  SetOutdated();
+  return true;
+}
+
+bool RayCasting1PassIsoCPU::Update (vis::Camera* camera)
+{
+  // Only the active blocks must be queried again when the isovalue changes
+  if (m_active_blocks_isovalue != m_u_isovalue)
+    UpdateActiveBlocks();
+
+  FrameParameters fp;
+  fp.width = m_ext_rendering_parameters->GetScreenWidth();
+  fp.height = m_ext_rendering_parameters->GetScreenHeight();
+  fp.eye = camera->GetEye();
+  fp.lookat = glm::mat3(camera->LookAt());
+  fp.tan_fovy = (float)tan(DEGREE_TO_RADIANS(camera->GetFovY()) / 2.0);
+  fp.aspect_ratio = camera->GetAspectRatio();
+  fp.packet_width = m_packet_width;
+  fp.isovalue = m_u_isovalue;
+  fp.step_size_small = m_u_step_size_small;
+  fp.step_size_large = m_u_step_size_large;
+  fp.step_size_range = m_u_step_size_range;
+  fp.color = m_u_color;
+  fp.shading = m_apply_gradient_shading && !m_gradient.empty();
+  fp.ka = m_ext_rendering_parameters->GetBlinnPhongKambient();
+  fp.kd = m_ext_rendering_parameters->GetBlinnPhongKdiffuse();
+  fp.ks = m_ext_rendering_parameters->GetBlinnPhongKspecular();
+  fp.shininess = m_ext_rendering_parameters->GetBlinnPhongNshininess();
+  fp.ispecular = m_ext_rendering_parameters->GetLightSourceSpecular();
+  fp.light_position = m_ext_rendering_parameters->GetBlinnPhongLightingPosition();
+
+  auto t_start = std::chrono::high_resolution_clock::now();
+  RenderFrame(fp);
+  auto t_end = std::chrono::high_resolution_clock::now();
+  m_stat_frame_ms = std::chrono::duration<double, std::milli>(t_end - t_start).count();
+  m_last_frame = fp;
+
+  // Upload to the output texture of the screen
+  glBindTexture(GL_TEXTURE_2D, m_rdr_frame_to_screen.GetScreenOutputTexture()->GetTextureID());
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, fp.width, fp.height, GL_RGBA, GL_FLOAT, m_image.data());
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  gl::ExitOnGLError("RayCasting1PassIsoCPU: After Update.");
+  return true;
+}
+
+void RayCasting1PassIsoCPU::Redraw ()
+{
+  m_rdr_frame_to_screen.Draw();
+}
+
+void RayCasting1PassIsoCPU::SetImGuiComponents ()
+{
+  ImGui::Separator();
+
+  ImGui::Text("Isovalue: ");
+  if (ImGui::DragFloat("###RayCasting1PassIsoCPUUIIsovalue", &m_u_isovalue, 0.01f, 0.01f, 100.0f, "%.2f"))
+  {
+    m_u_isovalue = std::max(std::min(m_u_isovalue, 100.0f), 0.01f); //When entering with keyboard, ImGui does not take care of the min/max.
+    SetOutdated();
+  }
+  ImGui::Text("Active Blocks: %zu/%zu (%.3f ms)", m_number_of_active_blocks,
+    m_block_interval_index.GetNumberOfIntervals(), m_block_interval_index.GetLastQueryTime());
+
+  if (ImGui::ColorEdit4("Color###RayCasting1PassIsoCPUUIColor", &m_u_color[0]))
+  {
+    SetOutdated();
+  }
+
+  ImGui::Text("Step Size Small: ");
+  if (ImGui::DragFloat("###RayCasting1PassIsoCPUUIIntegrationStepSizeSmall", &m_u_step_size_small, 0.005f, 0.01f, 1.0f, "%.2f"))
+  {
+    m_u_step_size_small = std::max(std::min(m_u_step_size_small, 1.0f), 0.01f);
+    SetOutdated();
+  }
+
+  ImGui::Text("Step Size Large: ");
+  if (ImGui::DragFloat("###RayCasting1PassIsoCPUUIIntegrationStepSizeLarge", &m_u_step_size_large, 0.01f, 0.05f, 5.0f, "%.2f"))
+  {
+    m_u_step_size_large = std::max(std::min(m_u_step_size_large, 5.0f), 0.05f);
+    SetOutdated();
+  }
+
+  ImGui::Text("Step Size Range: ");
+  if (ImGui::DragFloat("###RayCasting1PassIsoCPUUIIntegrationStepSizeRange", &m_u_step_size_range, 0.01f, 0.05f, 0.5f, "%.2f"))
+  {
+    m_u_step_size_range = std::max(std::min(m_u_step_size_range, 0.5f), 0.05f);
+    SetOutdated();
+  }
+
+  ImGui::Text("Blocks Per Axis: ");
+  if (ImGui::SliderInt("###RayCasting1PassIsoCPUUIBlocksPerAxis", &m_num_blocks_per_axis, 4, 64))
+  {
+    m_num_blocks_per_axis = std::max(std::min(m_num_blocks_per_axis, 64), 4);
+    BuildBlocks();
+    SetOutdated();
+  }
+
+  if (!m_gradient.empty())
+  {
+    ImGui::Separator();
+    if (ImGui::Checkbox("Apply Gradient Shading###RayCasting1PassIsoCPUUIGradientShading", &m_apply_gradient_shading))
+      SetOutdated();
+  }
+
+  ImGui::Separator();
+  static const char* packet_modes[] = { "Single Rays", "8-wide Packets", "16-wide Packets" };
+  int packet_mode_id = m_packet_width == 1 ? 0 : (m_packet_width == 8 ? 1 : 2);
+  ImGui::Text("Packets: ");
+  if (ImGui::Combo("###RayCasting1PassIsoCPUUIPacketWidth", &packet_mode_id, packet_modes, IM_ARRAYSIZE(packet_modes)))
+  {
+    m_packet_width = packet_mode_id == 0 ? 1 : (packet_mode_id == 1 ? 8 : 16);
+    SetOutdated();
+  }
+  ImGui::Text(m_use_avx2 ? "SIMD: AVX2" : "SIMD: none (scalar lanes)");
+
+  ImGui::Text("Threads: ");
+  int max_threads = vis::TaskPool::Instance().GetMaxConcurrency();
+  if (ImGui::SliderInt("###RayCasting1PassIsoCPUUIThreads", &m_num_threads, 1, max_threads))
+  {
+    m_num_threads = std::max(std::min(m_num_threads, max_threads), 1);
+    SetOutdated();
+  }
+
+  double seconds = m_stat_frame_ms / 1000.0;
+  ImGui::Text("Frame: %.2f ms", m_stat_frame_ms);
+  ImGui::Text("%.2f Mrays/s", seconds > 0.0 ? (double)m_stat_rays / seconds * 1e-6 : 0.0);
+  ImGui::Text("Lane Occupancy: %.1f%%", m_stat_packet_steps > 0 ?
+    100.0 * (double)m_stat_lane_samples / ((double)m_stat_packet_steps * (double)m_last_frame.packet_width) : 0.0);
+  ImGui::Text("Packet Block Skips: %llu", m_stat_block_skips.load());
+
+  if (ImGui::Button("Benchmark Packet Modes###RayCasting1PassIsoCPUUIBenchmark"))
+    BenchmarkPacketModes();
+
+  for (const BenchmarkResult& res : m_benchmark_results)
+  {
+    ImGui::Text("width %2d, %2d threads: %.2f ms, %.2f Mrays/s", res.packet_width, res.threads,
+      res.frame_ms, res.mrays_per_second);
+  }
+  ImGui::Separator();
+}
+
+void RayCasting1PassIsoCPU::FillParameterSpace (ParameterSpace& pspace)
+{
+  pspace.ClearParameterDimensions();
+
+  // Thread counts 1, 2, 4, ... up to the number of hardware threads
+  std::vector<int> threads;
+  int max_threads = vis::TaskPool::Instance().GetMaxConcurrency();
+  for (int t = 1; t < max_threads; t *= 2) threads.push_back(t);
+  threads.push_back(max_threads);
+
+  pspace.AddParameterDimension(new ParameterRangeList<int>("PacketWidth", &m_packet_width, { 1, 8, 16 }));
+  pspace.AddParameterDimension(new ParameterRangeList<int>("Threads", &m_num_threads, threads));
+}
+
+void RayCasting1PassIsoCPU::GetFrameStatistics (std::vector<std::pair<std::string, double>>& stats)
+{
+  stats.clear();
+  stats.push_back({ "Rays", (double)m_stat_rays });
+  stats.push_back({ "PacketSteps", (double)m_stat_packet_steps });
+  stats.push_back({ "LaneSamples", (double)m_stat_lane_samples });
+  stats.push_back({ "BlockSkips", (double)m_stat_block_skips });
+  stats.push_back({ "ActiveBlocks", (double)m_number_of_active_blocks });
+}
+
+void RayCasting1PassIsoCPU::ReadBackData ()
+{
+  vis::StructuredGridVolume* vol = m_ext_data_manager->GetCurrentStructuredVolume();
+  m_vol_resolution = glm::ivec3(vol->GetWidth(), vol->GetHeight(), vol->GetDepth());
+  m_vol_voxel_size = glm::vec3(vol->GetScale());
+  m_vol_grid_size = glm::vec3(m_vol_resolution) * m_vol_voxel_size;
+
+  size_t n_voxels = (size_t)m_vol_resolution.x * (size_t)m_vol_resolution.y * (size_t)m_vol_resolution.z;
+
+  // Normalized density, as seen by the shaders
+  m_volume.resize(n_voxels);
+  glBindTexture(GL_TEXTURE_3D, m_ext_data_manager->GetCurrentVolumeTexture()->GetTextureID());
+  glGetTexImage(GL_TEXTURE_3D, 0, GL_RED, GL_FLOAT, m_volume.data());
+  glBindTexture(GL_TEXTURE_3D, 0);
+
+  m_gradient.clear();
+  if (m_ext_data_manager->GetCurrentGradientTexture())
+  {
+    m_gradient.resize(n_voxels);
+    glBindTexture(GL_TEXTURE_3D, m_ext_data_manager->GetCurrentGradientTexture()->GetTextureID());
+    glGetTexImage(GL_TEXTURE_3D, 0, GL_RGB, GL_FLOAT, m_gradient.data());
+    glBindTexture(GL_TEXTURE_3D, 0);
+  }
+
+  gl::ExitOnGLError("RayCasting1PassIsoCPU: Error on reading back the volume data.");
+}
+
+void RayCasting1PassIsoCPU::BuildBlocks ()
+{
+  if (m_volume.empty()) return;
+
+  // Blocks with the same number of voxels, the last one of each axis may be smaller
+  m_block_grid = glm::min(glm::ivec3(m_num_blocks_per_axis), m_vol_resolution);
+  m_block_voxels = (m_vol_resolution + m_block_grid - 1) / m_block_grid;
+  m_block_grid = (m_vol_resolution + m_block_voxels - 1) / m_block_voxels;
+  m_block_size = glm::vec3(m_block_voxels) * m_vol_voxel_size;
+
+  int n_blocks = m_block_grid.x * m_block_grid.y * m_block_grid.z;
+  std::vector<float> min_values(n_blocks);
+  std::vector<float> max_values(n_blocks);
+
+  // Preprocessing, on every thread of the pool
+  vis::TaskPool::Instance().ParallelFor(n_blocks, [&](int block_begin, int block_end) {
+    for (int block = block_begin; block < block_end; block++)
+    {
+      glm::ivec3 b(block % m_block_grid.x, (block / m_block_grid.x) % m_block_grid.y, block / (m_block_grid.x * m_block_grid.y));
+
+      // A sample inside the block interpolates the voxels up to one voxel outside of it
+      glm::ivec3 v0 = glm::max(b * m_block_voxels - 1, glm::ivec3(0));
+      glm::ivec3 v1 = glm::min((b + 1) * m_block_voxels + 1, m_vol_resolution);
+
+      float vmin = std::numeric_limits<float>::max();
+      float vmax = std::numeric_limits<float>::lowest();
+      for (int z = v0.z; z < v1.z; z++)
+      {
+        for (int y = v0.y; y < v1.y; y++)
+        {
+          const float* row = &m_volume[((size_t)z * m_vol_resolution.y + y) * m_vol_resolution.x];
+          for (int x = v0.x; x < v1.x; x++)
+          {
+            vmin = std::min(vmin, row[x]);
+            vmax = std::max(vmax, row[x]);
+          }
+        }
+      }
+      min_values[block] = vmin;
+      max_values[block] = vmax;
+    }
+  });
+
+  // Same tolerance of CustomRayCasting1PassIsodfsAdapt
+  m_block_interval_index.Build(min_values, max_values, 0.001f);
+  UpdateActiveBlocks();
+}
+
+void RayCasting1PassIsoCPU::UpdateActiveBlocks ()
+{
+  m_number_of_active_blocks = m_block_interval_index.QueryBitmask(m_u_isovalue, m_active_block_mask);
+  m_active_blocks_isovalue = m_u_isovalue;
+}
+
+void RayCasting1PassIsoCPU::RenderFrame (const FrameParameters& fp)
+{
+  m_image.assign((size_t)fp.width * (size_t)fp.height, glm::vec4(0.0f));
+  m_stat_rays = 0;
+  m_stat_packet_steps = 0;
+  m_stat_lane_samples = 0;
+  m_stat_block_skips = 0;
+
+  int tiles_x = (fp.width + m_tile_size - 1) / m_tile_size;
+  int tiles_y = (fp.height + m_tile_size - 1) / m_tile_size;
+
+  vis::TaskPool::Instance().ParallelFor(tiles_x * tiles_y, [&](int tile_begin, int tile_end) {
+    for (int tile = tile_begin; tile < tile_end; tile++)
+      RenderTile(fp, tile);
+  }, 1, m_num_threads);
+}
+
+void RayCasting1PassIsoCPU::RenderTile (const FrameParameters& fp, int tile)
+{
+  int tiles_x = (fp.width + m_tile_size - 1) / m_tile_size;
+  int x0 = (tile % tiles_x) * m_tile_size;
+  int y0 = (tile / tiles_x) * m_tile_size;
+  int x1 = std::min(x0 + m_tile_size, fp.width);
+  int y1 = std::min(y0 + m_tile_size, fp.height);
+
+  // Pixel footprint of a packet: 1x1, 4x2 or 4x4
+  int packet_w = fp.packet_width == 1 ? 1 : 4;
+  int packet_h = fp.packet_width / packet_w;
+
+  TraceStatistics stats = { 0, 0, 0, 0 };
+  int px[16], py[16];
+  for (int y = y0; y < y1; y += packet_h)
+  {
+    for (int x = x0; x < x1; x += packet_w)
+    {
+      // Lanes outside of the tile are left empty
+      int n_lanes = 0;
+      for (int j = y; j < std::min(y + packet_h, y1); j++)
+      {
+        for (int i = x; i < std::min(x + packet_w, x1); i++)
+        {
+          px[n_lanes] = i;
+          py[n_lanes] = j;
+          n_lanes++;
+        }
+      }
+
+      if (fp.packet_width == 16)
+        TracePacket<16>(fp, px, py, n_lanes, stats);
+      else if (fp.packet_width == 8)
+        TracePacket<8>(fp, px, py, n_lanes, stats);
+      else
+        TracePacket<1>(fp, px, py, n_lanes, stats);
+    }
+  }
+
+  m_stat_rays += stats.rays;
+  m_stat_packet_steps += stats.packet_steps;
+  m_stat_lane_samples += stats.lane_samples;
+  m_stat_block_skips += stats.block_skips;
+}
+
+template<int W>
+void RayCasting1PassIsoCPU::TracePacket (const FrameParameters& fp, const int* px, const int* py, int n_lanes, TraceStatistics& stats)
+{
+  glm::vec3 aabbmin = -m_vol_grid_size * 0.5f;
+  glm::vec3 aabbmax = m_vol_grid_size * 0.5f;
+
+  // Ray origin in texture space
+  glm::vec3 org = fp.eye + m_vol_grid_size * 0.5f;
+
+  // Lanes in structure of arrays layout
+  alignas(32) float dx[W], dy[W], dz[W];
+  alignas(32) float sx[W], sy[W], sz[W];
+  alignas(32) float t[W], tfar[W], h[W];
+  alignas(32) float prev_density[W], density[W];
+  glm::vec4 dst[W];
+  bool alive[W];
+
+  auto sample_lanes = [&](float* out) {
+    if (W >= 8)
+    {
+      for (int l = 0; l < W; l += 8) SampleVolume8(sx + l, sy + l, sz + l, out + l);
+    }
+    else
+    {
+      for (int l = 0; l < W; l++) out[l] = SampleVolume(glm::vec3(sx[l], sy[l], sz[l]));
+    }
+  };
+
+  for (int l = 0; l < W; l++)
+  {
+    dst[l] = glm::vec4(0.0f);
+    alive[l] = false;
+    dx[l] = dy[l] = dz[l] = 0.0f;
+    t[l] = tfar[l] = 0.0f;
+    if (l >= n_lanes) continue;
+
+    // Same ray setup of custom_ray_marching_1p_iso_adapt.comp
+    glm::vec2 fpos = glm::vec2(px[l], py[l]) + 0.5f;
+    glm::vec2 ver_pos = glm::vec2(fpos.x / float(fp.width), fpos.y / float(fp.height)) * 2.0f - 1.0f;
+    glm::vec3 dir = glm::normalize(glm::vec3(ver_pos.x * fp.tan_fovy * fp.aspect_ratio, ver_pos.y * fp.tan_fovy, -1.0f) * fp.lookat);
+
+    // Ray - bounding box
+    glm::vec3 inv_dir = glm::vec3(1.0f) / dir;
+    glm::vec3 tbbmin = inv_dir * (aabbmin - fp.eye);
+    glm::vec3 tbbmax = inv_dir * (aabbmax - fp.eye);
+    glm::vec3 tmin = glm::min(tbbmin, tbbmax);
+    glm::vec3 tmax = glm::max(tbbmin, tbbmax);
+    float tnear = std::max(std::max(tmin.x, tmin.y), tmin.z);
+    float tout = std::min(std::min(tmax.x, tmax.y), tmax.z);
+    if (!(tout > tnear)) continue;
+
+    dx[l] = dir.x; dy[l] = dir.y; dz[l] = dir.z;
+    t[l] = std::max(tnear, 0.0f);
+    tfar[l] = tout;
+    alive[l] = true;
+    stats.rays++;
+  }
+
+  // Density at the entry point
+  for (int l = 0; l < W; l++)
+  {
+    sx[l] = org.x + dx[l] * t[l];
+    sy[l] = org.y + dy[l] * t[l];
+    sz[l] = org.z + dz[l] * t[l];
+  }
+  sample_lanes(prev_density);
+
+  // Large steps inside the active blocks are limited by the block size
+  float step_size_large = std::min(fp.step_size_large, glm::length(m_block_size) * 0.5f);
+  // Moves the skipped rays inside the next block
+  float skip_offset = 1e-3f * std::min(std::min(m_vol_voxel_size.x, m_vol_voxel_size.y), m_vol_voxel_size.z);
+
+  while (true)
+  {
+    // Packet-level block culling: the packet samples if any live lane is in an active block
+    bool any_alive = false, any_active = false;
+    for (int l = 0; l < W && !any_active; l++)
+    {
+      if (!alive[l]) continue;
+      any_alive = true;
+      any_active = IsBlockActive(glm::vec3(org.x + dx[l] * t[l], org.y + dy[l] * t[l], org.z + dz[l] * t[l]));
+    }
+    if (!any_alive) break;
+
+    stats.packet_steps++;
+
+    if (!any_active)
+    {
+      // Every live lane jumps to the exit of its block
+      for (int l = 0; l < W; l++)
+      {
+        if (!alive[l]) continue;
+        glm::vec3 dir(dx[l], dy[l], dz[l]);
+        t[l] += GetBlockExit(org + dir * t[l], dir) + skip_offset;
+        if (t[l] >= tfar[l]) alive[l] = false;
+      }
+      for (int l = 0; l < W; l++)
+      {
+        sx[l] = org.x + dx[l] * t[l];
+        sy[l] = org.y + dy[l] * t[l];
+        sz[l] = org.z + dz[l] * t[l];
+      }
+      sample_lanes(prev_density);
+      for (int l = 0; l < W; l++) if (alive[l]) stats.lane_samples++;
+      stats.block_skips++;
+      continue;
+    }
+
+    // Adaptive step: small near the isovalue, large otherwise
+    for (int l = 0; l < W; l++)
+    {
+      h[l] = 0.0f;
+      if (alive[l])
+      {
+        float step = std::abs(prev_density[l] - fp.isovalue) < fp.step_size_range ? fp.step_size_small : step_size_large;
+        h[l] = std::min(step, tfar[l] - t[l]);
+      }
+      sx[l] = org.x + dx[l] * (t[l] + h[l]);
+      sy[l] = org.y + dy[l] * (t[l] + h[l]);
+      sz[l] = org.z + dz[l] * (t[l] + h[l]);
+    }
+    sample_lanes(density);
+
+    for (int l = 0; l < W; l++)
+    {
+      if (!alive[l]) continue;
+      stats.lane_samples++;
+
+      float d0 = prev_density[l];
+      float d1 = density[l];
+      if ((d0 <= fp.isovalue && fp.isovalue < d1) || (d0 >= fp.isovalue && fp.isovalue > d1))
+      {
+        // Refine the hit by linear interpolation
+        float s = (fp.isovalue - d0) / (d1 - d0);
+        glm::vec3 s_tex_pos = org + glm::vec3(dx[l], dy[l], dz[l]) * (t[l] + s * h[l]);
+
+        glm::vec4 src = fp.color;
+        if (fp.shading)
+          src = glm::vec4(ShadeBlinnPhong(fp, s_tex_pos, glm::vec3(src)), src.a);
+
+        // Front-to-back composition
+        src = glm::vec4(glm::vec3(src) * src.a, src.a);
+        dst[l] = dst[l] + (1.0f - dst[l].a) * src;
+
+        // Opacity threshold: 99%
+        if (dst[l].a > 0.99f) alive[l] = false;
+      }
+
+      prev_density[l] = d1;
+      t[l] += h[l];
+      if (t[l] >= tfar[l]) alive[l] = false;
+    }
+  }
+
+  for (int l = 0; l < n_lanes; l++)
+    m_image[(size_t)py[l] * fp.width + px[l]] = dst[l];
+}
+
+float RayCasting1PassIsoCPU::SampleVolume (const glm::vec3& tex_pos) const
+{
+  // Texel centers at (i + 0.5) / N
+  glm::vec3 p = tex_pos / m_vol_voxel_size - 0.5f;
+  glm::vec3 pf = glm::floor(p);
+  glm::vec3 f = p - pf;
+  glm::ivec3 i0 = glm::clamp(glm::ivec3(pf), glm::ivec3(0), m_vol_resolution - 1);
+  glm::ivec3 i1 = glm::clamp(glm::ivec3(pf) + 1, glm::ivec3(0), m_vol_resolution - 1);
+
+  size_t sx = 1, sy = (size_t)m_vol_resolution.x, sz = (size_t)m_vol_resolution.x * (size_t)m_vol_resolution.y;
+  auto v = [&](int x, int y, int z) { return m_volume[x * sx + y * sy + z * sz]; };
+  // Same operation order of SampleVolume8, so single rays and packets give the same image
+  auto lerp = [](float a, float b, float w) { return a + w * (b - a); };
+
+  float c00 = lerp(v(i0.x, i0.y, i0.z), v(i1.x, i0.y, i0.z), f.x);
+  float c10 = lerp(v(i0.x, i1.y, i0.z), v(i1.x, i1.y, i0.z), f.x);
+  float c01 = lerp(v(i0.x, i0.y, i1.z), v(i1.x, i0.y, i1.z), f.x);
+  float c11 = lerp(v(i0.x, i1.y, i1.z), v(i1.x, i1.y, i1.z), f.x);
+  return lerp(lerp(c00, c10, f.y), lerp(c01, c11, f.y), f.z);
+}
+
+void RayCasting1PassIsoCPU::SampleVolume8 (const float* x, const float* y, const float* z, float* density) const
+{
+#ifdef USING_AVX2
+  if (m_use_avx2)
+  {
+    SampleVolume8AVX2(m_volume.data(), &m_vol_resolution[0], &m_vol_voxel_size[0], x, y, z, density);
+    return;
+  }
+#endif
+  for (int l = 0; l < 8; l++) density[l] = SampleVolume(glm::vec3(x[l], y[l], z[l]));
+}
+
+glm::vec3 RayCasting1PassIsoCPU::SampleGradient (const glm::vec3& tex_pos) const
+{
+  glm::vec3 p = tex_pos / m_vol_voxel_size - 0.5f;
+  glm::vec3 pf = glm::floor(p);
+  glm::vec3 f = p - pf;
+  glm::ivec3 i0 = glm::clamp(glm::ivec3(pf), glm::ivec3(0), m_vol_resolution - 1);
+  glm::ivec3 i1 = glm::clamp(glm::ivec3(pf) + 1, glm::ivec3(0), m_vol_resolution - 1);
+
+  size_t sx = 1, sy = (size_t)m_vol_resolution.x, sz = (size_t)m_vol_resolution.x * (size_t)m_vol_resolution.y;
+  auto g = [&](int x, int y, int z) { return m_gradient[x * sx + y * sy + z * sz]; };
+
+  glm::vec3 c00 = glm::mix(g(i0.x, i0.y, i0.z), g(i1.x, i0.y, i0.z), f.x);
+  glm::vec3 c10 = glm::mix(g(i0.x, i1.y, i0.z), g(i1.x, i1.y, i0.z), f.x);
+  glm::vec3 c01 = glm::mix(g(i0.x, i0.y, i1.z), g(i1.x, i0.y, i1.z), f.x);
+  glm::vec3 c11 = glm::mix(g(i0.x, i1.y, i1.z), g(i1.x, i1.y, i1.z), f.x);
+  return glm::mix(glm::mix(c00, c10, f.y), glm::mix(c01, c11, f.y), f.z);
+}
+
+glm::vec3 RayCasting1PassIsoCPU::ShadeBlinnPhong (const FrameParameters& fp, const glm::vec3& tex_pos, const glm::vec3& clr) const
+{
+  glm::vec3 gradient_normal = SampleGradient(tex_pos);
+  if (gradient_normal == glm::vec3(0.0f)) return clr;
+
+  glm::vec3 wpos = tex_pos - m_vol_grid_size * 0.5f;
+
+  gradient_normal = glm::normalize(gradient_normal);
+
+  glm::vec3 light_direction = glm::normalize(fp.light_position - wpos);
+  glm::vec3 eye_direction = glm::normalize(fp.eye - wpos);
+  glm::vec3 halfway_vector = glm::normalize(eye_direction + light_direction);
+
+  float dot_diff = std::max(0.0f, glm::dot(gradient_normal, light_direction));
+  float dot_spec = std::max(0.0f, glm::dot(halfway_vector, gradient_normal));
+
+  return (clr * (fp.ka + fp.kd * dot_diff)) + fp.ispecular * fp.ks * std::pow(dot_spec, fp.shininess);
+}
+
+bool RayCasting1PassIsoCPU::IsBlockActive (const glm::vec3& tex_pos) const
+{
+  glm::ivec3 b = glm::clamp(glm::ivec3(glm::floor(tex_pos / m_block_size)), glm::ivec3(0), m_block_grid - 1);
+  unsigned int id = (unsigned int)(b.x + m_block_grid.x * (b.y + m_block_grid.y * b.z));
+  return (m_active_block_mask[id >> 5] & (1u << (id & 31u))) != 0u;
+}
+
+float RayCasting1PassIsoCPU::GetBlockExit (const glm::vec3& tex_pos, const glm::vec3& dir) const
+{
+  glm::ivec3 b = glm::clamp(glm::ivec3(glm::floor(tex_pos / m_block_size)), glm::ivec3(0), m_block_grid - 1);
+
+  // Distance to the nearest face crossed by the ray
+  float exit = std::numeric_limits<float>::max();
+  for (int a = 0; a < 3; a++)
+  {
+    if (dir[a] > 0.0f)
+      exit = std::min(exit, ((float)(b[a] + 1) * m_block_size[a] - tex_pos[a]) / dir[a]);
+    else if (dir[a] < 0.0f)
+      exit = std::min(exit, ((float)b[a] * m_block_size[a] - tex_pos[a]) / dir[a]);
+  }
+  return std::max(exit, 0.0f);
+}
+
+void RayCasting1PassIsoCPU::BenchmarkPacketModes ()
+{
+  if (!IsBuilt() || m_last_frame.width == 0) return;
+
+  m_benchmark_results.clear();
+  int max_threads = vis::TaskPool::Instance().GetMaxConcurrency();
+  int num_threads = m_num_threads;
+  const int packet_widths[] = { 1, 8, 16 };
+  for (int packet_width : packet_widths)
+  {
+    FrameParameters fp = m_last_frame;
+    fp.packet_width = packet_width;
+
+    for (int t = 1; ; t = std::min(t * 2, max_threads))
+    {
+      m_num_threads = t;
+
+      // Best of a few frames, the first one also warms up the caches
+      double best_ms = -1.0;
+      for (int i = 0; i < 3; i++)
+      {
+        auto t_start = std::chrono::high_resolution_clock::now();
+        RenderFrame(fp);
+        auto t_end = std::chrono::high_resolution_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(t_end - t_start).count();
+        if (best_ms < 0.0 || ms < best_ms) best_ms = ms;
+      }
+
+      BenchmarkResult res;
+      res.packet_width = packet_width;
+      res.threads = t;
+      res.frame_ms = best_ms;
+      res.mrays_per_second = (double)m_stat_rays / (best_ms / 1000.0) * 1e-6;
+      m_benchmark_results.push_back(res);
+
+      printf("RayCasting1PassIsoCPU: packet width %2d, %2d threads, %.2f ms/frame, %.2f Mrays/s, speedup %.2fx\n",
+        packet_width, t, best_ms, res.mrays_per_second, m_benchmark_results[0].frame_ms / best_ms);
+
+      if (t == max_threads) break;
+    }
+  }
+  m_num_threads = num_threads;
+  SetOutdated();
+}
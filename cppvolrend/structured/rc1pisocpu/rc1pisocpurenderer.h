@@ -0,0 +1,163 @@
+/**
+ * 1-Pass - Isosurface Ray Casting - CPU SIMD
+ * . Structured Datasets
+ * . CPU port of the adaptive step isosurface ray caster with empty space
+ *   skipping (CustomRayCasting1PassIsodfsAdapt): blocks whose [min, max]
+ *   does not contain the isovalue are skipped, small/large steps are taken
+ *   inside the other blocks and hits are refined by linear interpolation.
+ * . Rays are traced in packets of 8 (4x2 pixels) or 16 (4x4 pixels) lanes:
+ *   . the packet skips a block only if no live lane is in an active block,
+ *     so all lanes take the same branch;
+ *   . trilinear samples of a packet are computed 8 lanes at a time with
+ *     AVX2 gathers (scalar lanes if the build or the CPU has no AVX2).
+ * . Packet width 1 traces single rays, for comparison.
+ * . Screen tiles are rendered on the shared work-stealing pool (vis::TaskPool).
+**/
+#ifndef SINGLE_PASS_ISOSURFACE_RAY_CASTING_CPU_H
+#define SINGLE_PASS_ISOSURFACE_RAY_CASTING_CPU_H
+
+#include "../../volrenderbase.h"
+
+#include <volvis_utils/blockintervalindex.h>
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <vector>
+
+class RayCasting1PassIsoCPU : public BaseVolumeRenderer
+{
+public:
+  RayCasting1PassIsoCPU ();
+  virtual ~RayCasting1PassIsoCPU ();
+
+  //////////////////////////////////////////
+  // Virtual base functions
+  virtual const char* GetName () { return "1-Pass - Isosurface Ray Casting - CPU SIMD"; }
+  virtual const char* GetAbbreviationName () { return "s_1rcisocpu"; }
+
+  virtual void Clean ();
+
+  virtual bool Init (int shader_width, int shader_height);
+  virtual bool Update (vis::Camera* camera);
+  virtual void Redraw ();
+
+  virtual void SetImGuiComponents ();
+
+  virtual vis::GRID_VOLUME_DATA_TYPE GetDataTypeSupport ()
+  {
+    return vis::GRID_VOLUME_DATA_TYPE::STRUCTURED;
+  }
+
+  virtual void FillParameterSpace (ParameterSpace& pspace) override;
+
+  virtual void GetFrameStatistics (std::vector<std::pair<std::string, double>>& stats) override;
+
+protected:
+  float m_u_isovalue;
+  float m_u_step_size_small;
+  float m_u_step_size_large;
+  float m_u_step_size_range;
+  glm::vec4 m_u_color;
+  bool m_apply_gradient_shading;
+
+private:
+  // Values of a frame shared by all packets
+  struct FrameParameters
+  {
+    int width, height;
+    glm::vec3 eye;
+    glm::mat3 lookat;
+    float tan_fovy;
+    float aspect_ratio;
+    // 1: single rays, 8 or 16: ray packets
+    int packet_width;
+    float isovalue;
+    float step_size_small;
+    float step_size_large;
+    float step_size_range;
+    glm::vec4 color;
+    bool shading;
+    float ka, kd, ks, shininess;
+    glm::vec3 ispecular;
+    glm::vec3 light_position;
+  };
+
+  // Counters of a tile, added to the frame statistics
+  struct TraceStatistics
+  {
+    unsigned long long rays;
+    unsigned long long packet_steps;
+    unsigned long long lane_samples;
+    unsigned long long block_skips;
+  };
+
+  void ReadBackData ();
+  // Block [min, max] of the volume, including the voxels shared with the
+  // neighbor blocks by the trilinear interpolation
+  void BuildBlocks ();
+  void UpdateActiveBlocks ();
+
+  void RenderFrame (const FrameParameters& fp);
+  void RenderTile (const FrameParameters& fp, int tile);
+
+  template<int W>
+  void TracePacket (const FrameParameters& fp, const int* px, const int* py, int n_lanes, TraceStatistics& stats);
+
+  // Same GL_LINEAR/GL_CLAMP_TO_EDGE lookups of the shaders, tex_pos in [0, VolumeGridSize]
+  float SampleVolume (const glm::vec3& tex_pos) const;
+  void SampleVolume8 (const float* x, const float* y, const float* z, float* density) const;
+  glm::vec3 SampleGradient (const glm::vec3& tex_pos) const;
+  glm::vec3 ShadeBlinnPhong (const FrameParameters& fp, const glm::vec3& tex_pos, const glm::vec3& clr) const;
+
+  bool IsBlockActive (const glm::vec3& tex_pos) const;
+  float GetBlockExit (const glm::vec3& tex_pos, const glm::vec3& dir) const;
+
+  // Renders the current view with each packet width and 1, 2, 4, ... threads
+  void BenchmarkPacketModes ();
+
+  std::vector<float> m_volume;
+  std::vector<glm::vec3> m_gradient;
+  glm::ivec3 m_vol_resolution;
+  glm::vec3 m_vol_voxel_size;
+  glm::vec3 m_vol_grid_size;
+
+  // Empty space skipping blocks
+  int m_num_blocks_per_axis;
+  glm::ivec3 m_block_grid;
+  glm::ivec3 m_block_voxels;
+  glm::vec3 m_block_size;
+  vis::BlockIntervalIndex m_block_interval_index;
+  std::vector<unsigned int> m_active_block_mask;
+  float m_active_blocks_isovalue;
+  size_t m_number_of_active_blocks;
+
+  std::vector<glm::vec4> m_image;
+  FrameParameters m_last_frame;
+
+  // Tiles rendered at the same time on vis::TaskPool
+  int m_num_threads;
+  int m_tile_size;
+  // 1: single rays, 8 or 16: ray packets
+  int m_packet_width;
+  // AVX2 kernels compiled (CPPVOLREND_AVX2) and supported by the CPU
+  bool m_use_avx2;
+
+  // Statistics of the last frame
+  std::atomic<unsigned long long> m_stat_rays;
+  std::atomic<unsigned long long> m_stat_packet_steps;
+  std::atomic<unsigned long long> m_stat_lane_samples;
+  std::atomic<unsigned long long> m_stat_block_skips;
+  double m_stat_frame_ms;
+
+  struct BenchmarkResult
+  {
+    int packet_width;
+    int threads;
+    double frame_ms;
+    double mrays_per_second;
+  };
+  std::vector<BenchmarkResult> m_benchmark_results;
+};
+
+#endif
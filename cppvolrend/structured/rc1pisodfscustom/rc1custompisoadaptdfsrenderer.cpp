@@ -50,6 +50,13 @@ void CustomRayCasting1PassIsodfsAdapt::ComputeBlocksFromVolume(
                 int endX = std::min(startX + blockSizeX, static_cast<int>(volumeWidth));
                 int endY = std::min(startY + blockSizeY, static_cast<int>(volumeHeight));
                 int endZ = std::min(startZ + blockSizeZ, static_cast<int>(volumeDepth));
+                // A sample inside the block interpolates the voxels up to one voxel outside of it
+                startX = std::max(startX - 1, 0);
+                startY = std::max(startY - 1, 0);
+                startZ = std::max(startZ - 1, 0);
+                endX = std::min(endX + 1, static_cast<int>(volumeWidth));
+                endY = std::min(endY + 1, static_cast<int>(volumeHeight));
+                endZ = std::min(endZ + 1, static_cast<int>(volumeDepth));
                 // 初始化块的 min 和 max 值
                 double minValue = std::numeric_limits<float>::max();
                 double maxValue = std::numeric_limits<float>::lowest();
@@ -156,6 +163,10 @@ void CustomRayCasting1PassIsodfsAdapt::Clean()
     if (cp_shader_rendering) delete cp_shader_rendering;
     cp_shader_rendering = nullptr;
 
+    if (m_ssbo_active_blocks) delete m_ssbo_active_blocks;
+    m_ssbo_active_blocks = nullptr;
+    m_active_blocks_isovalue = -1.0f;
+
     gl::ExitOnGLError("Could not destroy shaders");
 
     BaseVolumeRenderer::Clean();
@@ -186,12 +197,6 @@ bool CustomRayCasting1PassIsodfsAdapt::Init(int swidth, int sheight)
     auto* volume = m_ext_data_manager->GetCurrentStructuredVolume();
     if (!volume) return false;
 
-    // 初始化块分割
-    glm::vec3 numBlocks(32, 32, 32);
-    std::vector<float> minValues;
-    std::vector<float> maxValues;
-    ComputeBlocksFromVolume(volume, numBlocks, minValues, maxValues, vol_voxelsize);
-
 
     // - 加载着色器
     cp_shader_rendering = new gl::ComputeShader();
@@ -214,7 +219,6 @@ bool CustomRayCasting1PassIsodfsAdapt::Init(int swidth, int sheight)
     cp_shader_rendering->SetUniform("VolumeGridResolution", vol_resolution);
     cp_shader_rendering->SetUniform("VolumeVoxelSize", vol_voxelsize);
     cp_shader_rendering->SetUniform("VolumeGridSize", vol_aabb);
-    cp_shader_rendering->SetUniform("numBlocks", numBlocks);
 
 
 
@@ -223,38 +227,8 @@ bool CustomRayCasting1PassIsodfsAdapt::Init(int swidth, int sheight)
     std::cout << "vol_aabb=" << vol_aabb.x << "  " << vol_aabb.y << "  " << vol_aabb.z << std::endl;
 
 
-    // 1) 准备好OpenGL纹理ID
-    GLuint texIDBlockMin, texIDBlockMax;
-    glGenTextures(1, &texIDBlockMin);
-    glGenTextures(1, &texIDBlockMax);
-
-    // 2) 上传 blockMin 的数据
-    glBindTexture(GL_TEXTURE_3D, texIDBlockMin);
-    glTexImage3D(GL_TEXTURE_3D, 0, GL_R32F,
-        (GLsizei)numBlocks.x, (GLsizei)numBlocks.y, (GLsizei)numBlocks.z,
-        0, GL_RED, GL_FLOAT, minValues.data());
-    // 设置过滤方式
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    // 解除绑定
-    glBindTexture(GL_TEXTURE_3D, 0);
-
-    // 3) 上传 blockMax 的数据
-    glBindTexture(GL_TEXTURE_3D, texIDBlockMax);
-    glTexImage3D(GL_TEXTURE_3D, 0, GL_R32F,
-        (GLsizei)numBlocks.x, (GLsizei)numBlocks.y, (GLsizei)numBlocks.z,
-        0, GL_RED, GL_FLOAT, maxValues.data());
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glBindTexture(GL_TEXTURE_3D, 0);
-
-
-
-    // cp_shader_rendering->Bind(); // 如果需要的话
-    cp_shader_rendering->SetUniformTexture3D("TexBlockMin", texIDBlockMin, 3);
-    cp_shader_rendering->SetUniformTexture3D("TexBlockMax", texIDBlockMax, 4);
-
-
+    // 初始化块分割
+    BuildBlocks();
 
     cp_shader_rendering->Unbind();
     gl::ExitOnGLError("CustomRayCasting1PassIsodfsAdapt: Error on Preparing Models and Shaders");
@@ -272,6 +246,64 @@ bool CustomRayCasting1PassIsodfsAdapt::Init(int swidth, int sheight)
 }
 
 
+void CustomRayCasting1PassIsodfsAdapt::BuildBlocks()
+{
+    auto* volume = m_ext_data_manager->GetCurrentStructuredVolume();
+    if (!volume || !cp_shader_rendering) return;
+
+    glm::vec3 vol_voxelsize = glm::vec3(volume->GetScaleX(), volume->GetScaleY(), volume->GetScaleZ());
+
+    // Blocks of m_block_size voxels, the last block of an axis may be smaller
+    glm::vec3 numBlocks(
+        (float)((volume->GetWidth() + m_block_size - 1) / m_block_size),
+        (float)((volume->GetHeight() + m_block_size - 1) / m_block_size),
+        (float)((volume->GetDepth() + m_block_size - 1) / m_block_size));
+    // Shared with the other block-based renderers of the same volume
+    // . the ranges include a one voxel apron, which the key tells apart from the plain ranges
+    vis::PreprocessingRegistry& preprocessing = m_ext_data_manager->GetPreprocessingRegistry();
+    vis::BlockMinMax* blocks = preprocessing.Acquire<vis::BlockMinMax>(
+        m_ext_data_manager->GetPreprocessingKey("BlockMinMax", false,
+            std::to_string((int)numBlocks.x) + "x" + std::to_string((int)numBlocks.y) + "x" + std::to_string((int)numBlocks.z) + "+apron"),
+        [&]() {
+            vis::BlockMinMax* computed = new vis::BlockMinMax();
+            ComputeBlocksFromVolume(volume, numBlocks, computed->min_values, computed->max_values, vol_voxelsize);
+            return computed;
+        });
+    std::vector<float> minValues = blocks->min_values;
+    std::vector<float> maxValues = blocks->max_values;
+    preprocessing.Release(blocks);
+
+    // 建立区间索引 (与着色器中原来的容差 0.001 一致)
+    m_block_interval_index.Build(minValues, maxValues, 0.001f);
+
+    // 由 Update() 中的 BindUniforms() 绑定
+    cp_shader_rendering->SetUniform("numBlocks", numBlocks);
+    // Same voxels per block as ComputeBlocksFromVolume, the shader indexes the blocks with it
+    cp_shader_rendering->SetUniform("BlockVoxels", glm::vec3(
+        (float)((volume->GetWidth() + (int)numBlocks.x - 1) / (int)numBlocks.x),
+        (float)((volume->GetHeight() + (int)numBlocks.y - 1) / (int)numBlocks.y),
+        (float)((volume->GetDepth() + (int)numBlocks.z - 1) / (int)numBlocks.z)));
+
+    // 活动块位掩码 (每个块一位), 等值变化时只更新这个缓冲区
+    if (m_ssbo_active_blocks) delete m_ssbo_active_blocks;
+    m_ssbo_active_blocks = new gl::BufferObject(gl::BufferObject::TYPES::SHADERSTORAGEBUFFEROBJECT);
+    m_ssbo_active_blocks->SetBufferData(m_block_interval_index.GetBitmaskSize() * sizeof(unsigned int), nullptr, GL_DYNAMIC_DRAW);
+    m_ssbo_active_blocks->Unbind();
+    UpdateActiveBlocks();
+}
+
+
+void CustomRayCasting1PassIsodfsAdapt::UpdateActiveBlocks()
+{
+    if (!m_ssbo_active_blocks) return;
+
+    m_number_of_active_blocks = m_block_interval_index.QueryBitmask(m_u_isovalue, m_active_block_mask);
+    m_ssbo_active_blocks->SetBufferSubData(0, m_active_block_mask.size() * sizeof(unsigned int), m_active_block_mask.data());
+    m_ssbo_active_blocks->Unbind();
+    m_active_blocks_isovalue = m_u_isovalue;
+}
+
+
 void CustomRayCasting1PassIsodfsAdapt::ReloadShaders()
 {
     cp_shader_rendering->Reload();
@@ -281,6 +313,10 @@ void CustomRayCasting1PassIsodfsAdapt::ReloadShaders()
 
 bool CustomRayCasting1PassIsodfsAdapt::Update(vis::Camera* camera)
 {
+    // 等值改变时只需重新查询活动块
+    if (m_active_blocks_isovalue != m_u_isovalue)
+        UpdateActiveBlocks();
+
     cp_shader_rendering->Bind();
 
     /////////////////////////////
@@ -338,6 +374,7 @@ void CustomRayCasting1PassIsodfsAdapt::Redraw()
 
     cp_shader_rendering->Bind();
     m_rdr_frame_to_screen.BindImageTexture();
+    m_ssbo_active_blocks->BindBase(5);
 
     cp_shader_rendering->Dispatch();
     gl::ComputeShader::Unbind();
@@ -355,6 +392,37 @@ void CustomRayCasting1PassIsodfsAdapt::FillParameterSpace(ParameterSpace& pspace
 }
 
 
+void CustomRayCasting1PassIsodfsAdapt::FillTuningSpace(ParameterSpace& pspace)
+{
+    pspace.ClearParameterDimensions();
+    // 步长不参与调优: 只看速度的话最大步长总是最快
+    pspace.AddParameterDimension(new ParameterRangeList<int>("BlockSize", &m_block_size, { 4, 8, 16, 32 }));
+}
+
+
+void CustomRayCasting1PassIsodfsAdapt::ApplyTuningParameters()
+{
+    BuildBlocks();
+    SetOutdated();
+}
+
+
+std::string CustomRayCasting1PassIsodfsAdapt::GetTuningKey()
+{
+    // 最佳块大小取决于等值, 按 0.1 宽的等值区间分别保存
+    char band[32];
+    snprintf(band, sizeof(band), "/iso%.1f", std::floor(m_u_isovalue * 10.0f) / 10.0f);
+    return std::string(GetAbbreviationName()) + band;
+}
+
+void CustomRayCasting1PassIsodfsAdapt::GetFrameStatistics(std::vector<std::pair<std::string, double>>& stats)
+{
+    stats.clear();
+    stats.push_back({ "ActiveBlocks", (double)m_number_of_active_blocks });
+    stats.push_back({ "TotalBlocks", (double)m_block_interval_index.GetNumberOfIntervals() });
+}
+
+
 void CustomRayCasting1PassIsodfsAdapt::SetImGuiComponents()
 {
     ImGui::Separator();
@@ -365,6 +433,8 @@ void CustomRayCasting1PassIsodfsAdapt::SetImGuiComponents()
         m_u_isovalue = std::max(std::min(m_u_isovalue, 100.0f), 0.01f); // 当通过键盘输入时，ImGui 不会处理最小值/最大值。
         SetOutdated();
     }
+    ImGui::Text("Active Blocks: %zu/%zu (%.3f ms)", m_number_of_active_blocks,
+        m_block_interval_index.GetNumberOfIntervals(), m_block_interval_index.GetLastQueryTime());
 
     if (ImGui::ColorEdit4("Color", &m_u_color[0]))
     {
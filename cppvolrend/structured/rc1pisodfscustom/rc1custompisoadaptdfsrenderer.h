@@ -7,6 +7,9 @@
 
 #include "../../volrenderbase.h"
 
+#include <gl_utils/bufferobject.h>
+#include <volvis_utils/blockintervalindex.h>
+
 class CustomRayCasting1PassIsodfsAdapt : public BaseVolumeRenderer
 {
 public:
@@ -26,6 +29,13 @@ public:
 
     virtual void FillParameterSpace(ParameterSpace& pspace) override;
 
+    virtual void FillTuningSpace(ParameterSpace& pspace) override;
+    virtual void ApplyTuningParameters() override;
+    virtual std::string GetTuningKey() override;
+
+    /// Active blocks of the current isovalue. The blocks skipped by each ray are not counted on the GPU.
+    virtual void GetFrameStatistics(std::vector<std::pair<std::string, double>>& stats) override;
+
     virtual void SetImGuiComponents();
     void ComputeBlocksFromVolume(vis::StructuredGridVolume* volume,
         glm::vec3 numBlocks,
@@ -36,11 +46,21 @@ public:
     void LightingPass();
     void RenderQuad();
     void CreateGBuffers(int width, int height);
-    GLuint m_texBlockMin = 0;  
-    GLuint m_texBlockMax = 0;  
 
-    glm::vec3 m_blockSize = glm::vec3(8, 8, 8); 
-    glm::vec3 m_blockGridRes;                   
+    /// Interval index over the block [min, max] ranges, queried on isovalue changes.
+    vis::BlockIntervalIndex m_block_interval_index;
+    /// One bit per block, set if the block may contain the isovalue.
+    std::vector<unsigned int> m_active_block_mask;
+    gl::BufferObject* m_ssbo_active_blocks = nullptr;
+    float m_active_blocks_isovalue = -1.0f;
+    size_t m_number_of_active_blocks = 0;
+    void UpdateActiveBlocks();
+
+    /// Voxels along each axis of a block.
+    int m_block_size = 8;
+    /// Computes the block [min, max], the interval index and the active block buffer.
+    void BuildBlocks();
+
 
     gl::ComputeShader* cp_geometry_pass;
     gl::ComputeShader* cp_lighting_pass;
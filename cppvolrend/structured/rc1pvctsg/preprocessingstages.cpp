@@ -1,5 +1,10 @@
 #include "preprocessingstages.h"
 
+#include <gl_utils/memoryregistry.h>
+#include <vis_utils/taskgraph.h>
+
+#include <mutex>
+
 VCTPreProcessing::VCTPreProcessing ()
 {
   use_glsl_to_precompute_data = false;
@@ -44,20 +49,26 @@ void VCTPreProcessing::PreProcessSuperVoxels (vis::StructuredGridVolume* vol)
   int h = vol->GetHeight();
   int d = vol->GetDepth();
 
+  // Slices of each level are computed on the shared pool
+  vis::TaskPool& pool = vis::TaskPool::Instance();
+
   tree_spr_voxel.push_back(new SuperVoxelLevel(glm::ivec3(w, h, d)));
-  for (int x = 0; x < w; x++)
-  {
-    for (int y = 0; y < h; y++)
+  pool.ParallelFor(d, [&] (int z_begin, int z_end) {
+    for (int z = z_begin; z < z_end; z++)
     {
-      for (int z = 0; z < d; z++)
+      for (int y = 0; y < h; y++)
       {
-        tree_spr_voxel[0]->sv_data[x + (y * w) + (z * w * h)].mean = vol->GetNormalizedSample(x,y,z) * 255.0;
-        tree_spr_voxel[0]->sv_data[x + (y * w) + (z * w * h)].stdv = 0.0;
+        for (int x = 0; x < w; x++)
+        {
+          tree_spr_voxel[0]->sv_data[x + (y * w) + (z * w * h)].mean = vol->GetNormalizedSample(x,y,z) * 255.0;
+          tree_spr_voxel[0]->sv_data[x + (y * w) + (z * w * h)].stdv = 0.0;
+        }
       }
     }
-  }
+  });
 
   double max_stddev = 0.0;
+  std::mutex max_stddev_mutex;
 
   int vw = w;
   int vh = h;
@@ -70,45 +81,51 @@ void VCTPreProcessing::PreProcessSuperVoxels (vis::StructuredGridVolume* vol)
   {
     tree_spr_voxel.push_back(new SuperVoxelLevel(glm::ivec3(w, h, d)));
 
-    for (int iw = 0; iw < w; iw++)
-    {
-      for (int ih = 0; ih < h; ih++)
+    pool.ParallelFor(d, [&] (int d_begin, int d_end) {
+      double chunk_max_stddev = 0.0;
+      for (int id = d_begin; id < d_end; id++)
       {
-        for (int id = 0; id < d; id++)
+        for (int ih = 0; ih < h; ih++)
         {
-          int lw = iw * 2;
-          int lh = ih * 2;
-          int ld = id * 2;
-
-          double vm0 = GetMeanFromSuperVoxel(mm_level - 1, lw    , lh    , ld    , vw, vh, vd);
-          double vm1 = GetMeanFromSuperVoxel(mm_level - 1, lw    , lh    , ld + 1, vw, vh, vd);
-          double vm2 = GetMeanFromSuperVoxel(mm_level - 1, lw    , lh + 1, ld    , vw, vh, vd);
-          double vm3 = GetMeanFromSuperVoxel(mm_level - 1, lw    , lh + 1, ld + 1, vw, vh, vd);
-          double vm4 = GetMeanFromSuperVoxel(mm_level - 1, lw + 1, lh    , ld    , vw, vh, vd);
-          double vm5 = GetMeanFromSuperVoxel(mm_level - 1, lw + 1, lh    , ld + 1, vw, vh, vd);
-          double vm6 = GetMeanFromSuperVoxel(mm_level - 1, lw + 1, lh + 1, ld    , vw, vh, vd);
-          double vm7 = GetMeanFromSuperVoxel(mm_level - 1, lw + 1, lh + 1, ld + 1, vw, vh, vd);
-          double vmn = (vm0 + vm1 + vm2 + vm3 + vm4 + vm5 + vm6 + vm7) / 8.0;
-
-          tree_spr_voxel[mm_level]->sv_data[iw + (ih * w) + (id * w * h)].mean = vmn;
-
-          double vstdd = glm::sqrt(
-            (pow(vm0 - vmn, 2.0)
-              + pow(vm1 - vmn, 2.0)
-              + pow(vm2 - vmn, 2.0)
-              + pow(vm3 - vmn, 2.0)
-              + pow(vm4 - vmn, 2.0)
-              + pow(vm5 - vmn, 2.0)
-              + pow(vm6 - vmn, 2.0)
-              + pow(vm7 - vmn, 2.0)) / 8.0
-          );
-
-          tree_spr_voxel[mm_level]->sv_data[iw + (ih * w) + (id * w * h)].stdv = vstdd;
-
-          max_stddev = glm::max(vstdd, max_stddev);
+          for (int iw = 0; iw < w; iw++)
+          {
+            int lw = iw * 2;
+            int lh = ih * 2;
+            int ld = id * 2;
+
+            double vm0 = GetMeanFromSuperVoxel(mm_level - 1, lw    , lh    , ld    , vw, vh, vd);
+            double vm1 = GetMeanFromSuperVoxel(mm_level - 1, lw    , lh    , ld + 1, vw, vh, vd);
+            double vm2 = GetMeanFromSuperVoxel(mm_level - 1, lw    , lh + 1, ld    , vw, vh, vd);
+            double vm3 = GetMeanFromSuperVoxel(mm_level - 1, lw    , lh + 1, ld + 1, vw, vh, vd);
+            double vm4 = GetMeanFromSuperVoxel(mm_level - 1, lw + 1, lh    , ld    , vw, vh, vd);
+            double vm5 = GetMeanFromSuperVoxel(mm_level - 1, lw + 1, lh    , ld + 1, vw, vh, vd);
+            double vm6 = GetMeanFromSuperVoxel(mm_level - 1, lw + 1, lh + 1, ld    , vw, vh, vd);
+            double vm7 = GetMeanFromSuperVoxel(mm_level - 1, lw + 1, lh + 1, ld + 1, vw, vh, vd);
+            double vmn = (vm0 + vm1 + vm2 + vm3 + vm4 + vm5 + vm6 + vm7) / 8.0;
+
+            tree_spr_voxel[mm_level]->sv_data[iw + (ih * w) + (id * w * h)].mean = vmn;
+
+            double vstdd = glm::sqrt(
+              (pow(vm0 - vmn, 2.0)
+                + pow(vm1 - vmn, 2.0)
+                + pow(vm2 - vmn, 2.0)
+                + pow(vm3 - vmn, 2.0)
+                + pow(vm4 - vmn, 2.0)
+                + pow(vm5 - vmn, 2.0)
+                + pow(vm6 - vmn, 2.0)
+                + pow(vm7 - vmn, 2.0)) / 8.0
+            );
+
+            tree_spr_voxel[mm_level]->sv_data[iw + (ih * w) + (id * w * h)].stdv = vstdd;
+
+            chunk_max_stddev = glm::max(vstdd, chunk_max_stddev);
+          }
         }
       }
-    }
+
+      std::lock_guard<std::mutex> lock(max_stddev_mutex);
+      max_stddev = glm::max(chunk_max_stddev, max_stddev);
+    });
 
     vw = w;
     vh = h;
@@ -139,6 +156,8 @@ void VCTPreProcessing::PreProcessSuperVoxels (vis::StructuredGridVolume* vol)
     glTexImage3D(GL_TEXTURE_3D, i, GL_RG16F, w, h, d, 0, GL_RG, GL_FLOAT, sdata);
     delete[] sdata;
   }
+  gl::MemoryRegistry::Instance().RegisterTexture(glsl_supervoxel_meanstddev->GetTextureID(), GL_RG16F,
+    vol->GetWidth(), vol->GetHeight(), vol->GetDepth(), mm_level);
 
   maximum_standard_deviation = max_stddev;
   printf("Super Voxels Computed! Maximum Standard Deviation %g\n", max_stddev);
@@ -184,13 +203,15 @@ void VCTPreProcessing::PreProcessPreIntegrationTable (vis::StructuredGridVolume*
   int h = glm::ceil(maximum_standard_deviation);
 
   GLfloat* preintegrationvalues = new GLfloat[w * h];
-  for (int iw = 0; iw < w; iw++)
-  {
-    for (int ih = 0; ih < h; ih++)
+  vis::TaskPool::Instance().ParallelFor(h, [&] (int h_begin, int h_end) {
+    for (int ih = h_begin; ih < h_end; ih++)
     {
-      preintegrationvalues[iw + (ih * w)] = (float)OpacityGaussianEvaluation(iw, ih, vol, tf);
+      for (int iw = 0; iw < w; iw++)
+      {
+        preintegrationvalues[iw + (ih * w)] = (float)OpacityGaussianEvaluation(iw, ih, vol, tf);
+      }
     }
-  }
+  });
 
   glsl_preintegration_lookup = new gl::Texture2D(w, h);
   glsl_preintegration_lookup->GenerateTexture(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
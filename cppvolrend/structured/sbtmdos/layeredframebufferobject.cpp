@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <gl_utils/utils.h>
+#include <gl_utils/memoryregistry.h>
 
 #include <GL/glew.h>
 
@@ -60,6 +61,7 @@ bool LayeredFrameBufferObject::GenerateAttachments(unsigned int screen_width, un
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+    gl::MemoryRegistry::Instance().RegisterTexture(m_color_attachments[i], GL_RGBA16F, width, height);
   }
 
   for (int i = 0; i < GetCurrentNumberOfAttachments(); i++)
@@ -88,7 +90,10 @@ bool LayeredFrameBufferObject::GenerateAttachments(unsigned int screen_width, un
 void LayeredFrameBufferObject::DestroyAttachments ()
 {
   for (int i = 0; i < GetCurrentNumberOfAttachments(); i++)
+  {
+    gl::MemoryRegistry::Instance().Unregister(gl::MemoryRegistry::TEXTURE, m_color_attachments[i]);
     glDeleteTextures(1, &m_color_attachments[i]);
+  }
 }
 
 bool LayeredFrameBufferObject::Resize (unsigned int screen_width, unsigned int screen_height)
@@ -0,0 +1,253 @@
+#include "autotuner.h"
+#include "../volrenderbase.h"
+
+#include <math_utils/utils.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+
+AutoTuner::AutoTuner()
+  :m_renderer(NULL)
+  ,m_path_frames(60)
+  ,m_warmup_frames(5)
+  ,m_running(false)
+  ,m_curr_sample(0)
+  ,m_curr_frame(0)
+  ,m_accum_time_ms(0.0)
+  ,m_best_result(-1)
+{
+}
+
+AutoTuner::~AutoTuner()
+{
+}
+
+bool AutoTuner::ReadCache(const std::string& filepath)
+{
+  m_cache_filepath = filepath;
+  m_cache.clear();
+
+  std::ifstream file(filepath);
+  if (!file.is_open()) return false;
+
+  std::string line;
+  while (std::getline(file, line))
+  {
+    //key|config|time_ms
+    size_t p0 = line.find('|');
+    size_t p1 = line.rfind('|');
+    if (p0 == std::string::npos || p1 == p0) continue;
+
+    Result res;
+    res.config = line.substr(p0 + 1, p1 - p0 - 1);
+    std::istringstream iss(line.substr(p1 + 1));
+    if (!(iss >> res.time_ms)) continue;
+
+    m_cache[line.substr(0, p0)] = res;
+  }
+
+  printf("AutoTuner: %zu cached configurations read from \"%s\".\n", m_cache.size(), filepath.c_str());
+  return true;
+}
+
+bool AutoTuner::WriteCache()
+{
+  if (m_cache_filepath.empty()) return false;
+
+  std::ofstream file(m_cache_filepath);
+  if (!file.is_open())
+  {
+    printf("AutoTuner: Could not write \"%s\".\n", m_cache_filepath.c_str());
+    return false;
+  }
+
+  for(auto it=m_cache.begin();it!=m_cache.end();it++)
+  {
+    file << it->first << "|" << it->second.config << "|" << std::to_string(it->second.time_ms) << "\n";
+  }
+  return true;
+}
+
+bool AutoTuner::Start(BaseVolumeRenderer* renderer, vis::Camera* camera, const std::string& dataset_name)
+{
+  if (m_running || !renderer || !camera) return false;
+
+  renderer->FillTuningSpace(m_pspace);
+  if (m_pspace.GetNumSamplePoints() == 0) return false;
+
+  m_renderer = renderer;
+  m_key = GetKey(renderer, dataset_name);
+  m_camera_data = camera->GetData();
+
+  m_results.clear();
+  m_best_result = -1;
+
+  m_curr_sample = 0;
+  m_curr_frame = 0;
+  m_accum_time_ms = 0.0;
+
+  m_pspace.StartEvaluation();
+  m_renderer->ApplyTuningParameters();
+
+  m_running = true;
+  return true;
+}
+
+void AutoTuner::Abort(vis::Camera* camera)
+{
+  if (!m_running) return;
+
+  m_pspace.EndEvaluation();
+  m_renderer->ApplyTuningParameters();
+  m_running = false;
+
+  if (camera) camera->SetData(&m_camera_data);
+  m_renderer->SetOutdated();
+}
+
+void AutoTuner::PreRender(vis::Camera* camera)
+{
+  if (!m_running) return;
+
+  //One orbit around the up vector, with the radius of the initial camera.
+  //The warm-up frames are rendered at the first position of the path.
+  int path_frame = std::max(0, m_curr_frame - m_warmup_frames);
+  float angle = 2.0f * glm::pi<float>() * (float)path_frame / (float)m_path_frames;
+
+  vis::CameraData cdata = m_camera_data;
+  cdata.eye = cdata.center + RodriguesRotation(m_camera_data.eye - m_camera_data.center, angle, m_camera_data.up);
+  camera->SetData(&cdata);
+
+  m_renderer->SetOutdated();
+}
+
+bool AutoTuner::PostRender(double gpu_time_ms, vis::Camera* camera)
+{
+  if (!m_running) return false;
+
+  if (m_curr_frame >= m_warmup_frames) m_accum_time_ms += gpu_time_ms;
+
+  m_curr_frame++;
+  if (m_curr_frame < m_warmup_frames + m_path_frames) return false;
+
+  //Store the result of the current sample point
+  Result res;
+  res.config = GetCurrentConfiguration();
+  res.time_ms = m_accum_time_ms / (double)m_path_frames;
+  m_results.push_back(res);
+  if (m_best_result < 0 || res.time_ms < m_results[m_best_result].time_ms)
+  {
+    m_best_result = (int)m_results.size() - 1;
+  }
+  printf("AutoTuner: [%s] %s -> %.3f ms\n", m_key.c_str(), res.config.c_str(), res.time_ms);
+
+  //Next sample point
+  if (m_pspace.IncrEvaluation())
+  {
+    m_curr_sample++;
+    m_curr_frame = 0;
+    m_accum_time_ms = 0.0;
+    m_renderer->ApplyTuningParameters();
+    return false;
+  }
+
+  m_pspace.EndEvaluation();
+  Finish();
+
+  camera->SetData(&m_camera_data);
+  m_renderer->SetOutdated();
+  return true;
+}
+
+bool AutoTuner::ApplyCachedConfiguration(BaseVolumeRenderer* renderer, const std::string& dataset_name)
+{
+  if (m_running || !renderer) return false;
+
+  m_applied_key = GetKey(renderer, dataset_name);
+  const Result* res = GetCachedResult(m_applied_key);
+  if (!res) return false;
+
+  renderer->FillTuningSpace(m_pspace);
+  if (!ApplyConfiguration(renderer, res->config)) return false;
+
+  printf("AutoTuner: Cached configuration applied: %s\n", res->config.c_str());
+  return true;
+}
+
+bool AutoTuner::UpdateCachedConfiguration(BaseVolumeRenderer* renderer, const std::string& dataset_name)
+{
+  if (m_running || !renderer) return false;
+  if (GetKey(renderer, dataset_name) == m_applied_key) return false;
+
+  return ApplyCachedConfiguration(renderer, dataset_name);
+}
+
+const AutoTuner::Result* AutoTuner::GetCachedResult(const std::string& key) const
+{
+  auto it = m_cache.find(key);
+  if (it == m_cache.end()) return NULL;
+  return &it->second;
+}
+
+std::string AutoTuner::GetKey(BaseVolumeRenderer* renderer, const std::string& dataset_name)
+{
+  return dataset_name + "/" + renderer->GetTuningKey();
+}
+
+std::string AutoTuner::GetDimensionValue(const std::string& name) const
+{
+  int i = m_pspace.GetDimensionIndex(name);
+  return i >= 0 ? m_pspace.GetDimensionValue(i) : std::string();
+}
+
+std::string AutoTuner::GetCurrentConfiguration() const
+{
+  std::string config;
+  for(int i=0;i<m_pspace.GetNumDimensions();i++)
+  {
+    if (i > 0) config += ";";
+    config += m_pspace.GetDimensionName(i) + "=" + m_pspace.GetDimensionValue(i);
+  }
+  return config;
+}
+
+bool AutoTuner::ApplyConfiguration(BaseVolumeRenderer* renderer, const std::string& config)
+{
+  //Param=Value;Param=Value
+  std::istringstream iss(config);
+  std::string entry;
+  bool applied = false;
+  bool changed = false;
+  while (std::getline(iss, entry, ';'))
+  {
+    size_t p = entry.find('=');
+    if (p == std::string::npos) continue;
+    const std::string name = entry.substr(0, p);
+    const std::string previous = GetDimensionValue(name);
+    if (!m_pspace.SetDimensionValue(name, entry.substr(p + 1))) continue;
+    applied = true;
+    changed |= GetDimensionValue(name) != previous;
+  }
+
+  //Tuning parameters may rebuild structures (e.g. block sizes): only when a value differs
+  if (changed) renderer->ApplyTuningParameters();
+  return applied;
+}
+
+void AutoTuner::Finish()
+{
+  m_running = false;
+  if (m_best_result < 0) return;
+
+  //Apply and store the fastest configuration
+  const Result& best = m_results[m_best_result];
+  ApplyConfiguration(m_renderer, best.config);
+
+  m_cache[m_key] = best;
+  m_applied_key = m_key;
+  WriteCache();
+
+  printf("AutoTuner: [%s] best configuration: %s (%.3f ms)\n", m_key.c_str(), best.config.c_str(), best.time_ms);
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "parameterspace.h"
+
+#include <vis_utils/camera.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+class BaseVolumeRenderer;
+
+/** Automatic tuning of the performance parameters of a volume renderer.
+*
+*   The renderer exposes its tunable parameters with FillTuningSpace()
+*   (e.g. the block size of the empty space skipping). For each sample point
+*   of that space, a short fixed camera path (one orbit around the up vector)
+*   is rendered and the GPU time of each frame is accumulated.
+*   The fastest configuration is applied and stored in a cache file, indexed
+*   by dataset name and renderer tuning key, so it can be restored in later
+*   sessions without tuning again.
+*
+*   The tuner is driven by the rendering loop:
+*   PreRender() -> render and measure the GPU time -> PostRender().
+*/
+class AutoTuner
+{
+//Construction / Deconstruction
+public:
+  AutoTuner();
+  virtual ~AutoTuner();
+
+//Types
+public:
+  ///Result of a tuned configuration
+  struct Result
+  {
+    ///"Param=Value" pairs separated by ';'
+    std::string config;
+    ///Mean GPU time per frame in milliseconds
+    double time_ms;
+  };
+
+//Functions
+public:
+  ///Reads the cache file. Entries are written as "key|Param=Value;...|time_ms".
+  bool ReadCache(const std::string& filepath);
+
+  ///Writes all cached entries to the file given to ReadCache().
+  bool WriteCache();
+
+  ///Starts tuning the current configuration of @c renderer.
+  /// Returns false if the renderer does not expose tunable parameters.
+  bool Start(BaseVolumeRenderer* renderer, vis::Camera* camera, const std::string& dataset_name);
+
+  ///Stops tuning and restores the values and camera from before Start().
+  void Abort(vis::Camera* camera);
+
+  ///Test whether a tuning is in progress.
+  bool IsRunning() const {return m_running;};
+
+  ///Places the camera for the next frame of the path.
+  void PreRender(vis::Camera* camera);
+
+  ///Accumulates the GPU time of the frame rendered after PreRender().
+  /// Returns true when the tuning has finished at this frame.
+  bool PostRender(double gpu_time_ms, vis::Camera* camera);
+
+  ///Applies the cached configuration of the current renderer state, if any.
+  bool ApplyCachedConfiguration(BaseVolumeRenderer* renderer, const std::string& dataset_name);
+
+  ///Applies the cached configuration again if the tuning key of the renderer changed
+  /// since the last one applied (e.g. the isovalue moved to another band).
+  bool UpdateCachedConfiguration(BaseVolumeRenderer* renderer, const std::string& dataset_name);
+
+  ///Number of frames of the camera path, warm-up frames are not measured.
+  void SetPathFrames(int frames) {m_path_frames = frames;};
+  int GetPathFrames() const {return m_path_frames;};
+  void SetWarmUpFrames(int frames) {m_warmup_frames = frames;};
+  int GetWarmUpFrames() const {return m_warmup_frames;};
+
+  ///Progress of the running tuning
+  int GetCurrentSample() const {return m_curr_sample;};
+  int GetNumSamples() const {return m_pspace.GetNumSamplePoints();};
+
+  ///Results of the last tuning, in evaluation order
+  const std::vector<Result>& GetLastResults() const {return m_results;};
+  ///Index of the best result in GetLastResults(), -1 if none
+  int GetLastBestResult() const {return m_best_result;};
+
+  ///Returns the cached entry for a key, or NULL.
+  const Result* GetCachedResult(const std::string& key) const;
+
+protected:
+  std::string GetKey(BaseVolumeRenderer* renderer, const std::string& dataset_name);
+  std::string GetCurrentConfiguration() const;
+  ///Value of a tuning dimension, empty if there is none with this name
+  std::string GetDimensionValue(const std::string& name) const;
+  ///Sets the values, ApplyTuningParameters() is only called if one of them changed
+  bool ApplyConfiguration(BaseVolumeRenderer* renderer, const std::string& config);
+  void Finish();
+
+//Attributes
+protected:
+  ///Cache of the best configurations
+  std::map<std::string, Result> m_cache;
+  std::string m_cache_filepath;
+
+  ///Tuning space of the current renderer
+  ParameterSpace m_pspace;
+  BaseVolumeRenderer* m_renderer;
+  std::string m_key;
+  ///Key of the last configuration applied or looked up in the cache
+  std::string m_applied_key;
+
+  ///Camera before the tuning started
+  vis::CameraData m_camera_data;
+
+  int m_path_frames;
+  int m_warmup_frames;
+
+  bool m_running;
+  int m_curr_sample;
+  int m_curr_frame;
+  double m_accum_time_ms;
+
+  std::vector<Result> m_results;
+  int m_best_result;
+};
@@ -0,0 +1,91 @@
+#include "benchmarkjob.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+BenchmarkJob::BenchmarkJob()
+  :m_width(0)
+  ,m_height(0)
+  ,m_frames(100)
+  ,m_warmup_frames(5)
+  ,m_save_images(true)
+  ,m_sweep_renderer_space(false)
+{
+}
+
+BenchmarkJob::~BenchmarkJob()
+{
+}
+
+bool BenchmarkJob::Read(const std::string& filepath)
+{
+  std::ifstream file(filepath);
+  if (!file.is_open())
+  {
+    fprintf(stderr, "BenchmarkJob: could not open \"%s\"\n", filepath.c_str());
+    return false;
+  }
+
+  std::string line;
+  int line_number = 0;
+  while (std::getline(file, line))
+  {
+    line_number++;
+
+    //Windows line endings
+    line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
+
+    std::istringstream iss(line);
+    std::string keyword;
+    if (!(iss >> keyword) || keyword[0] == '#') continue;
+
+    //Everything after the keyword, names may contain spaces
+    std::string value;
+    std::getline(iss >> std::ws, value);
+    value.erase(value.find_last_not_of(" \t") + 1);
+
+    bool ok = true;
+    if (value.empty())                 ok = false;
+    else if (keyword == "output")      m_output_dir = value;
+    else if (keyword == "width")       m_width = std::max(atoi(value.c_str()), 0);
+    else if (keyword == "height")      m_height = std::max(atoi(value.c_str()), 0);
+    else if (keyword == "frames")      m_frames = std::max(atoi(value.c_str()), 1);
+    else if (keyword == "warmup")      m_warmup_frames = std::max(atoi(value.c_str()), 0);
+    else if (keyword == "save-images") m_save_images = atoi(value.c_str()) != 0;
+    else if (keyword == "sweep")       m_sweep_renderer_space = atoi(value.c_str()) != 0;
+    else if (keyword == "dataset")     m_datasets.push_back(value);
+    else if (keyword == "tf")          m_transfer_functions.push_back(value);
+    else if (keyword == "renderer")    m_renderers.push_back(value);
+    else if (keyword == "camera")      m_camera_states.push_back(value);
+    else if (keyword == "lights")      m_light_source_lists.push_back(value);
+    else if (keyword == "param")
+    {
+      Parameter param;
+      std::istringstream values(value);
+      values >> param.name;
+      std::string v;
+      while (values >> v) param.values.push_back(v);
+      ok = !param.values.empty();
+      if (ok) m_parameters.push_back(param);
+    }
+    else ok = false;
+
+    if (!ok)
+    {
+      fprintf(stderr, "BenchmarkJob: %s:%d: invalid line \"%s\"\n", filepath.c_str(), line_number, line.c_str());
+      return false;
+    }
+  }
+
+  return true;
+}
+
+size_t BenchmarkJob::GetNumScenes() const
+{
+  return std::max(m_datasets.size(), (size_t)1) * std::max(m_transfer_functions.size(), (size_t)1)
+       * std::max(m_renderers.size(), (size_t)1) * std::max(m_camera_states.size(), (size_t)1)
+       * std::max(m_light_source_lists.size(), (size_t)1);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/** Description of a batch benchmark: the cross product of datasets,
+*   transfer functions, volume renderers, light source lists, camera states
+*   and renderer parameter values is rendered unattended.
+*
+*   The job file has one keyword per line, lines starting with '#' are
+*   comments. Names are the rest of the line, as in #list_structured_datasets,
+*   #list_camera_states and #list_light_sources, and keywords can be repeated:
+*
+*     output      bench_bonsai
+*     width       1024
+*     height      768
+*     frames      50
+*     warmup      5
+*     save-images 1
+*     dataset     Bonsai
+*     tf          Bonsai
+*     renderer    s_1rc
+*     renderer    iso
+*     camera      Initial State
+*     lights      Result Engine
+*     param       StepSizeSmall 0.05 0.1
+*     param       NumBlocksPerAxis 16 32
+*     sweep       1
+*
+*   Missing datasets, transfer functions, renderers, camera states or light
+*   lists use the current ones of the RenderingManager.
+*   A "param" only applies to the renderers with an evaluation, tuning or
+*   variant dimension of that name (see BaseVolumeRenderer::FillParameterSpace(),
+*   FillTuningSpace() and FillVariantSpace(), the tuning ones are applied with
+*   ApplyTuningParameters()). Shader variants, e.g. "param Composition 0 1 2",
+*   are only swept this way: "sweep 1" and --eval leave them as they are.
+*   A "param" that no renderer of the job has, or an invalid value, is an
+*   error. With "sweep 1", renderers without any matching "param" run their
+*   whole evaluation space.
+*/
+class BenchmarkJob
+{
+//Construction / Deconstruction
+public:
+  BenchmarkJob();
+  virtual ~BenchmarkJob();
+
+//Types
+public:
+  ///Values of a renderer parameter, in the order they are rendered
+  struct Parameter
+  {
+    std::string name;
+    std::vector<std::string> values;
+  };
+
+//Functions
+public:
+  ///Reads the job file. Prints the offending line and returns false on errors.
+  bool Read(const std::string& filepath);
+
+  ///Number of configurations without renderer parameters
+  size_t GetNumScenes() const;
+
+//Attributes
+public:
+  std::string m_output_dir;
+  int m_width;
+  int m_height;
+  int m_frames;
+  int m_warmup_frames;
+  bool m_save_images;
+  bool m_sweep_renderer_space;
+
+  std::vector<std::string> m_datasets;
+  std::vector<std::string> m_transfer_functions;
+  std::vector<std::string> m_renderers;
+  std::vector<std::string> m_camera_states;
+  std::vector<std::string> m_light_source_lists;
+  std::vector<Parameter> m_parameters;
+};
@@ -0,0 +1,59 @@
+#include "boundedtaskqueue.h"
+
+#include <vis_utils/taskgraph.h>
+
+#include <algorithm>
+#include <chrono>
+
+BoundedTaskQueue::BoundedTaskQueue(int capacity)
+  :m_capacity((size_t)std::max(capacity, 1))
+  ,m_queued(0)
+  ,m_running(0)
+{
+}
+
+BoundedTaskQueue::~BoundedTaskQueue()
+{
+  WaitIdle();
+}
+
+void BoundedTaskQueue::Push(std::function<void()> task)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (m_queued >= m_capacity) Help(lock, m_cv_space);
+  m_queued++;
+  lock.unlock();
+
+  vis::TaskPool::Instance().Submit([this, task]()
+  {
+    {
+      std::lock_guard<std::mutex> task_lock(m_mutex);
+      m_queued--;
+      m_running++;
+    }
+    m_cv_space.notify_one();
+
+    task();
+
+    {
+      std::lock_guard<std::mutex> task_lock(m_mutex);
+      m_running--;
+    }
+    m_cv_idle.notify_all();
+  });
+}
+
+void BoundedTaskQueue::WaitIdle()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (m_queued > 0 || m_running > 0) Help(lock, m_cv_idle);
+}
+
+void BoundedTaskQueue::Help(std::unique_lock<std::mutex>& lock, std::condition_variable& cv)
+{
+  lock.unlock();
+  bool ran = vis::TaskPool::Instance().RunOne();
+  lock.lock();
+  //The timeout covers a notification sent while the lock was released
+  if (!ran) cv.wait_for(lock, std::chrono::milliseconds(1));
+}
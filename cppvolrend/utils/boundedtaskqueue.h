@@ -0,0 +1,46 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+/** Tasks run in the background on the shared work-stealing pool (vis::TaskPool),
+*   e.g. encoding and writing images while the rendering goes on. They may
+*   start in any order.
+*
+*   The queue holds at most a given number of tasks that have not started:
+*   Push() waits when it is full, so a slow disk limits the memory used by the
+*   queued images instead of growing without bound.
+*/
+class BoundedTaskQueue
+{
+//Construction / Deconstruction
+public:
+  BoundedTaskQueue(int capacity = 8);
+  ///Waits for all the tasks.
+  virtual ~BoundedTaskQueue();
+
+//Functions
+public:
+  ///Adds a task, waits while the queue is full.
+  void Push(std::function<void()> task);
+
+  ///Waits until all the pushed tasks have finished.
+  void WaitIdle();
+
+protected:
+  ///Runs a job of the pool meanwhile, which may have no worker thread, or waits on cv.
+  void Help(std::unique_lock<std::mutex>& lock, std::condition_variable& cv);
+
+//Attributes
+protected:
+  size_t m_capacity;
+
+  std::mutex m_mutex;
+  std::condition_variable m_cv_space;
+  std::condition_variable m_cv_idle;
+  ///Tasks submitted to the pool that have not started
+  size_t m_queued;
+  ///Tasks that are running
+  int m_running;
+};
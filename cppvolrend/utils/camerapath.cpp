@@ -0,0 +1,101 @@
+#include "camerapath.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+
+namespace
+{
+  //Rotation from the camera axes to the world axes, the camera looks along -z
+  glm::quat GetOrientation(const vis::CameraData& data)
+  {
+    glm::vec3 forward = glm::normalize(data.center - data.eye);
+    glm::vec3 right = glm::normalize(glm::cross(forward, data.up));
+    glm::vec3 up = glm::cross(right, forward);
+    return glm::quat_cast(glm::mat3(right, up, -forward));
+  }
+
+  glm::vec3 CatmullRom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float t)
+  {
+    float t2 = t * t;
+    float t3 = t2 * t;
+    return 0.5f * ((2.0f * p1) + (p2 - p0) * t
+                 + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2
+                 + (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+  }
+}
+
+CameraPath::CameraPath()
+{
+}
+
+CameraPath::~CameraPath()
+{
+}
+
+void CameraPath::AddKeyframe(const vis::CameraData& keyframe, const std::string& name)
+{
+  m_keyframes.push_back(keyframe);
+  m_names.push_back(name);
+}
+
+void CameraPath::RemoveLastKeyframe()
+{
+  if (m_keyframes.empty()) return;
+  m_keyframes.pop_back();
+  m_names.pop_back();
+}
+
+void CameraPath::Clear()
+{
+  m_keyframes.clear();
+  m_names.clear();
+}
+
+vis::CameraData CameraPath::Evaluate(float t) const
+{
+  if (m_keyframes.empty()) return vis::CameraData();
+  if (m_keyframes.size() == 1) return m_keyframes[0];
+
+  //Segment [i, i + 1] and the parameter inside it
+  const int n_segments = (int)m_keyframes.size() - 1;
+  float s = std::max(std::min(t, 1.0f), 0.0f) * (float)n_segments;
+  int i = std::min((int)s, n_segments - 1);
+  float u = s - (float)i;
+
+  const vis::CameraData& k1 = m_keyframes[i];
+  const vis::CameraData& k2 = m_keyframes[i + 1];
+
+  //Mirrored end points, so the spline keeps its direction at the first and last keyframes
+  glm::vec3 p0 = i > 0 ? m_keyframes[i - 1].eye : 2.0f * k1.eye - k2.eye;
+  glm::vec3 p3 = i + 2 < (int)m_keyframes.size() ? m_keyframes[i + 2].eye : 2.0f * k2.eye - k1.eye;
+  glm::vec3 eye = CatmullRom(p0, k1.eye, k2.eye, p3, u);
+
+  //Shortest rotation between the keyframes
+  glm::quat q1 = GetOrientation(k1);
+  glm::quat q2 = GetOrientation(k2);
+  if (glm::dot(q1, q2) < 0.0f) q2 = -q2;
+  glm::mat3 axes = glm::mat3_cast(glm::normalize(glm::slerp(q1, q2, u)));
+
+  //Keep looking at the center, with the up vector of the interpolated orientation
+  glm::vec3 center = glm::mix(k1.center, k2.center, u);
+  glm::vec3 forward = center - eye;
+  if (glm::length(forward) < 1e-6f) forward = -axes[2];
+  forward = glm::normalize(forward);
+  glm::vec3 up = axes[1] - glm::dot(axes[1], forward) * forward;
+  if (glm::length(up) < 1e-6f) up = -axes[2] - glm::dot(-axes[2], forward) * forward;
+
+  vis::CameraData data = k1;
+  data.cam_setup_name = "";
+  data.eye = eye;
+  data.center = center;
+  data.up = glm::normalize(up);
+  return data;
+}
+
+vis::CameraData CameraPath::GetFrame(int frame, int n_frames) const
+{
+  if (n_frames <= 1) return Evaluate(0.0f);
+  return Evaluate((float)frame / (float)(n_frames - 1));
+}
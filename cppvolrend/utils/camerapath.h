@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vis_utils/camera.h>
+
+#include <string>
+#include <vector>
+
+/** Camera flythrough through keyframes, e.g. the camera states of
+*   data/#list_camera_states, for repeatable motion in performance tests.
+*
+*   The path goes through all the keyframes, spending the same number of
+*   frames between each pair of consecutive keyframes:
+*   . the eye position follows a Catmull-Rom spline through the eyes of the
+*     keyframes (the first and last segments use a mirrored end point);
+*   . the center is interpolated linearly and the camera looks at it;
+*   . the up vector is the one of the orientation (right, up, forward)
+*     interpolated with quaternion slerp, so rolls between keyframes are smooth.
+*/
+class CameraPath
+{
+//Construction / Deconstruction
+public:
+  CameraPath();
+  virtual ~CameraPath();
+
+//Functions
+public:
+  void AddKeyframe(const vis::CameraData& keyframe, const std::string& name);
+  void RemoveLastKeyframe();
+  void Clear();
+
+  int GetNumKeyframes() const {return (int)m_keyframes.size();};
+  const std::string& GetKeyframeName(int i) const {return m_names[i];};
+
+  ///Camera at t in [0, 1], from the first to the last keyframe.
+  vis::CameraData Evaluate(float t) const;
+
+  ///Camera at a frame of a playback of n_frames frames, the first and last frames are at the first and last keyframes.
+  vis::CameraData GetFrame(int frame, int n_frames) const;
+
+//Attributes
+protected:
+  std::vector<vis::CameraData> m_keyframes;
+  std::vector<std::string> m_names;
+};
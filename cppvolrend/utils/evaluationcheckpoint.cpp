@@ -0,0 +1,186 @@
+#include "evaluationcheckpoint.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <sstream>
+
+EvaluationCheckpoint::EvaluationCheckpoint()
+  :m_cursor(-1)
+{
+}
+
+EvaluationCheckpoint::~EvaluationCheckpoint()
+{
+  Close();
+}
+
+void EvaluationCheckpoint::SetIdentity(const std::string& key, const std::string& value)
+{
+  for (auto& kv : m_identity)
+  {
+    if (kv.first == key)
+    {
+      kv.second = value;
+      return;
+    }
+  }
+  m_identity.push_back(std::make_pair(key, value));
+}
+
+void EvaluationCheckpoint::ClearIdentity()
+{
+  m_identity.clear();
+  m_completed.clear();
+  m_completed_set.clear();
+  m_cursor = -1;
+}
+
+bool EvaluationCheckpoint::Create(const std::string& filepath)
+{
+  Close();
+
+  //Written next to the old checkpoint and renamed, so a crash leaves one of both
+  const std::string tmppath = filepath + ".tmp";
+  {
+    std::ofstream file(tmppath, std::ios_base::out | std::ios_base::trunc);
+    if (!file.is_open())
+    {
+      fprintf(stderr, "EvaluationCheckpoint: could not write \"%s\"\n", tmppath.c_str());
+      return false;
+    }
+    for (const auto& kv : m_identity) file << kv.first << " " << kv.second << "\n";
+    file << "journal\n";
+    for (int id : m_completed) file << "done " << id << "\n";
+    if (!file.good()) return false;
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmppath, filepath, ec);
+  if (ec)
+  {
+    fprintf(stderr, "EvaluationCheckpoint: could not replace \"%s\"\n", filepath.c_str());
+    return false;
+  }
+
+  m_journal.open(filepath, std::ios_base::out | std::ios_base::app);
+  return m_journal.is_open();
+}
+
+bool EvaluationCheckpoint::Read(const std::string& filepath)
+{
+  Close();
+  m_completed.clear();
+  m_completed_set.clear();
+  m_cursor = -1;
+
+  std::ifstream file(filepath);
+  if (!file.is_open())
+  {
+    fprintf(stderr, "EvaluationCheckpoint: could not open \"%s\"\n", filepath.c_str());
+    return false;
+  }
+
+  std::vector<std::pair<std::string, std::string>> identity;
+  bool in_journal = false;
+  std::string line;
+  while (std::getline(file, line))
+  {
+    //Windows line endings
+    line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
+
+    std::istringstream iss(line);
+    std::string key;
+    if (!(iss >> key)) continue;
+
+    if (!in_journal)
+    {
+      if (key == "journal")
+      {
+        in_journal = true;
+        continue;
+      }
+      std::string value;
+      std::getline(iss >> std::ws, value);
+      identity.push_back(std::make_pair(key, value));
+      continue;
+    }
+
+    //A last line without line break may have been cut by a crash
+    if (file.eof()) break;
+    int id;
+    if (!(iss >> id) || id < 0) continue;
+    if (key == "start")
+    {
+      m_cursor = id;
+    }
+    else if (key == "done" && m_completed_set.insert(id).second)
+    {
+      m_completed.push_back(id);
+    }
+  }
+
+  if (!in_journal)
+  {
+    fprintf(stderr, "EvaluationCheckpoint: \"%s\" is not a checkpoint\n", filepath.c_str());
+    return false;
+  }
+
+  for (const auto& kv : m_identity)
+  {
+    auto it = std::find_if(identity.begin(), identity.end(),
+      [&kv](const std::pair<std::string, std::string>& o) {return o.first == kv.first;});
+    const std::string previous = it != identity.end() ? it->second : "";
+    if (previous != kv.second)
+    {
+      fprintf(stderr, "EvaluationCheckpoint: the checkpoint has %s \"%s\", the current one is \"%s\"\n",
+        kv.first.c_str(), previous.c_str(), kv.second.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+void EvaluationCheckpoint::Close()
+{
+  if (m_journal.is_open()) m_journal.close();
+}
+
+void EvaluationCheckpoint::MarkStarted(int sample_id)
+{
+  m_cursor = sample_id;
+  if (m_journal.is_open()) m_journal << "start " << sample_id << std::endl;
+}
+
+void EvaluationCheckpoint::MarkCompleted(int sample_id)
+{
+  if (!m_completed_set.insert(sample_id).second) return;
+  m_completed.push_back(sample_id);
+  if (m_journal.is_open()) m_journal << "done " << sample_id << std::endl;
+}
+
+void EvaluationCheckpoint::ForgetCompleted(int sample_id)
+{
+  if (m_completed_set.erase(sample_id) == 0) return;
+  m_completed.erase(std::find(m_completed.begin(), m_completed.end(), sample_id));
+}
+
+bool EvaluationCheckpoint::KeepLines(const std::string& filepath, const std::vector<bool>& keep)
+{
+  std::vector<std::string> lines;
+  {
+    std::ifstream file(filepath);
+    if (!file.is_open()) return false;
+    std::string line;
+    for (size_t i = 0; i < keep.size() && std::getline(file, line); i++)
+    {
+      if (keep[i]) lines.push_back(line);
+    }
+  }
+
+  std::ofstream file(filepath, std::ios_base::out | std::ios_base::trunc);
+  if (!file.is_open()) return false;
+  for (const std::string& line : lines) file << line << "\n";
+  return file.good();
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <fstream>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+/** Checkpoint of a long-running evaluation, so that it can be resumed
+*   after the application crashed or the GPU driver was reset (e.g. by the
+*   Windows TDR on long shaders).
+*
+*   The checkpoint file starts with the identity of the run, one key and
+*   value per line (renderer, dataset, camera, frame counts, ...), followed
+*   by a journal that is appended and flushed while the evaluation runs:
+*
+*     renderer   1-Pass - Ray Casting
+*     dataset    Bonsai
+*     ...
+*     journal
+*     start 0
+*     done 0
+*     start 1
+*
+*   Samples are identified by their index in the evaluation order. The last
+*   "start" is the cursor of the evaluation, i.e. the sample that was being
+*   rendered when the run stopped. An incomplete last line is ignored.
+*/
+class EvaluationCheckpoint
+{
+//Construction / Deconstruction
+public:
+  EvaluationCheckpoint();
+  virtual ~EvaluationCheckpoint();
+
+//Functions
+public:
+  ///Identity of the run, keys must not contain spaces. Resuming requires the same values.
+  void SetIdentity(const std::string& key, const std::string& value);
+  void ClearIdentity();
+
+  ///Writes the identity and the completed samples to a new checkpoint file
+  /// (replacing an existing one) and keeps it open for the journal.
+  bool Create(const std::string& filepath);
+
+  ///Reads the completed samples of an existing checkpoint with the same identity.
+  /// Prints the first difference and returns false otherwise.
+  /// Call Create() afterwards to continue the journal.
+  bool Read(const std::string& filepath);
+
+  void Close();
+  bool IsOpen() const {return m_journal.is_open();};
+
+  ///Journal entries, written to disk immediately
+  void MarkStarted(int sample_id);
+  void MarkCompleted(int sample_id);
+
+  ///Removes a completed sample, e.g. when its output was lost.
+  void ForgetCompleted(int sample_id);
+
+  bool IsCompleted(int sample_id) const {return m_completed_set.count(sample_id) > 0;};
+  int GetNumCompleted() const {return (int)m_completed.size();};
+  ///Completed samples, in the order they were completed
+  const std::vector<int>& GetCompleted() const {return m_completed;};
+  ///Last started sample, -1 if none
+  int GetCursor() const {return m_cursor;};
+
+  ///Rewrites a text file keeping only some of its lines, e.g. the rows of a
+  /// results file whose samples are completed. Missing lines are not kept.
+  static bool KeepLines(const std::string& filepath, const std::vector<bool>& keep);
+
+//Attributes
+protected:
+  std::vector<std::pair<std::string, std::string>> m_identity;
+  std::vector<int> m_completed;
+  std::set<int> m_completed_set;
+  int m_cursor;
+  std::ofstream m_journal;
+};
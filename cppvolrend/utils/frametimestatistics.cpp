@@ -0,0 +1,52 @@
+#include "frametimestatistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+FrameTimeStatistics::FrameTimeStatistics()
+{
+}
+
+FrameTimeStatistics::~FrameTimeStatistics()
+{
+}
+
+void FrameTimeStatistics::Add(const std::vector<double>& times_ms)
+{
+  m_times.insert(m_times.end(), times_ms.begin(), times_ms.end());
+}
+
+FrameTimeStatistics::Summary FrameTimeStatistics::Summarize() const
+{
+  Summary summary = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  if (m_times.empty()) return summary;
+
+  std::vector<double> sorted(m_times);
+  std::sort(sorted.begin(), sorted.end());
+
+  double sum = 0.0;
+  for (double t : sorted) sum += t;
+  summary.mean = sum / sorted.size();
+
+  //Sample standard deviation
+  double squares = 0.0;
+  for (double t : sorted) squares += (t - summary.mean) * (t - summary.mean);
+  summary.stddev = sorted.size() > 1 ? std::sqrt(squares / (sorted.size() - 1)) : 0.0;
+
+  summary.min = sorted.front();
+  summary.max = sorted.back();
+  summary.median = GetPercentile(sorted, 50.0);
+  summary.p95 = GetPercentile(sorted, 95.0);
+  summary.p99 = GetPercentile(sorted, 99.0);
+  return summary;
+}
+
+double FrameTimeStatistics::GetPercentile(const std::vector<double>& sorted_times, double p)
+{
+  if (sorted_times.empty()) return 0.0;
+
+  const double rank = std::max(std::min(p, 100.0), 0.0) / 100.0 * (sorted_times.size() - 1);
+  const size_t lower = (size_t)rank;
+  const size_t upper = std::min(lower + 1, sorted_times.size() - 1);
+  return sorted_times[lower] + (rank - lower) * (sorted_times[upper] - sorted_times[lower]);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/** Distribution of the frame times of an evaluation sample.
+*
+*   Percentiles interpolate linearly between the closest ranks, so the median
+*   of an even number of frames is the mean of the two middle frames.
+*/
+class FrameTimeStatistics
+{
+//Construction / Deconstruction
+public:
+  FrameTimeStatistics();
+  virtual ~FrameTimeStatistics();
+
+//Types
+public:
+  struct Summary
+  {
+    double mean;
+    double min;
+    double median;
+    double p95;
+    double p99;
+    double max;
+    double stddev;
+  };
+
+//Functions
+public:
+  void Clear() {m_times.clear();};
+  void Add(double time_ms) {m_times.push_back(time_ms);};
+  void Add(const std::vector<double>& times_ms);
+  size_t GetNumberOfFrames() const {return m_times.size();};
+
+  ///All zero without frames
+  Summary Summarize() const;
+
+  ///p in [0, 100] of sorted times
+  static double GetPercentile(const std::vector<double>& sorted_times, double p);
+
+//Attributes
+protected:
+  std::vector<double> m_times;
+};
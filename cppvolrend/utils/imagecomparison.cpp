@@ -0,0 +1,202 @@
+#include "imagecomparison.h"
+
+#include <vis_utils/taskgraph.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace
+{
+  //SSIM window of Wang et al.
+  const int SSIM_RADIUS = 5;
+  const float SSIM_SIGMA = 1.5f;
+  const float SSIM_C1 = (0.01f * 255.0f) * (0.01f * 255.0f);
+  const float SSIM_C2 = (0.03f * 255.0f) * (0.03f * 255.0f);
+}
+
+ImageComparison::ImageComparison()
+  :m_width(0)
+  ,m_height(0)
+  ,m_radius(0)
+  ,m_band_rows(16)
+{
+}
+
+ImageComparison::~ImageComparison()
+{
+}
+
+void ImageComparison::SetReference(const unsigned char* rgb, int width, int height)
+{
+  m_width = width;
+  m_height = height;
+  m_reference.assign(rgb, rgb + (size_t)width * height * 3);
+
+  //Images smaller than the window use a truncated window
+  m_radius = std::max(std::min(SSIM_RADIUS, (std::min(width, height) - 1) / 2), 0);
+  m_weights.resize(2 * m_radius + 1);
+  float sum = 0.0f;
+  for (int k = -m_radius; k <= m_radius; k++)
+  {
+    m_weights[k + m_radius] = std::exp(-(float)(k * k) / (2.0f * SSIM_SIGMA * SSIM_SIGMA));
+    sum += m_weights[k + m_radius];
+  }
+  for (float& w : m_weights) w /= sum;
+
+  const int ow = m_width - 2 * m_radius;
+  const size_t h_size = (size_t)(m_band_rows + 2 * m_radius) * ow;
+  m_scratch.resize(vis::TaskPool::Instance().GetMaxConcurrency());
+  for (Scratch& s : m_scratch)
+  {
+    s.x.resize(m_width);
+    s.y.resize(m_width);
+    s.h_mx.resize(h_size); s.h_my.resize(h_size); s.h_xx.resize(h_size); s.h_yy.resize(h_size); s.h_xy.resize(h_size);
+    s.v_mx.resize(ow); s.v_my.resize(ow); s.v_xx.resize(ow); s.v_yy.resize(ow); s.v_xy.resize(ow);
+  }
+}
+
+void ImageComparison::ClearReference()
+{
+  m_reference.clear();
+  m_scratch.clear();
+  m_width = m_height = 0;
+}
+
+ImageComparison::Scores ImageComparison::Compare(const unsigned char* rgb)
+{
+  Scores scores = {0.0, 0.0, 0.0};
+  if (!HasReference()) return scores;
+
+  const int n_bands = (m_height + m_band_rows - 1) / m_band_rows;
+  std::vector<BandSums> sums(n_bands, BandSums{0.0, 0.0, 0.0});
+  vis::TaskPool::Instance().ParallelFor(n_bands, [&](int band_begin, int band_end)
+  {
+    //-1 when run by the thread calling Compare()
+    Scratch& scratch = m_scratch[vis::TaskPool::GetCurrentWorker() + 1];
+    for (int band = band_begin; band < band_end; band++)
+      CompareBand(rgb, band, scratch, sums[band]);
+  });
+
+  //Bands are added in order, so the scores do not depend on the scheduling
+  BandSums total = {0.0, 0.0, 0.0};
+  for (const BandSums& s : sums)
+  {
+    total.ssim += s.ssim;
+    total.squared_error += s.squared_error;
+    total.absolute_error += s.absolute_error;
+  }
+
+  const double n_values = (double)m_width * m_height * 3.0;
+  const double n_windows = (double)(m_width - 2 * m_radius) * (m_height - 2 * m_radius) * 3.0;
+  const double mse = total.squared_error / n_values;
+
+  scores.ssim = total.ssim / n_windows;
+  scores.psnr = mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : std::numeric_limits<double>::infinity();
+  scores.mae = total.absolute_error / n_values / 255.0;
+  return scores;
+}
+
+void ImageComparison::CompareBand(const unsigned char* rgb, int band, Scratch& s, BandSums& sums) const
+{
+  const int r = m_radius;
+  const int taps = 2 * r + 1;
+  const int ow = m_width - 2 * r;
+  const int oh = m_height - 2 * r;
+  const size_t row_bytes = (size_t)m_width * 3;
+
+  //Errors of all the rows of the band
+  const int e0 = band * m_band_rows;
+  const int e1 = std::min(e0 + m_band_rows, m_height);
+  long long squared_error = 0, absolute_error = 0;
+  for (int y = e0; y < e1; y++)
+  {
+    const unsigned char* a = rgb + y * row_bytes;
+    const unsigned char* b = &m_reference[y * row_bytes];
+    for (size_t i = 0; i < row_bytes; i++)
+    {
+      const int d = (int)a[i] - (int)b[i];
+      squared_error += d * d;
+      absolute_error += std::abs(d);
+    }
+  }
+  sums.squared_error = (double)squared_error;
+  sums.absolute_error = (double)absolute_error;
+
+  //SSIM of the windows centered at the rows [o0, o1) + r
+  const int o0 = e0;
+  const int o1 = std::min(e0 + m_band_rows, oh);
+  if (o1 <= o0) return;
+  const int n_rows = o1 - o0 + 2 * r;
+
+  double ssim = 0.0;
+  for (int c = 0; c < 3; c++)
+  {
+    //Horizontal pass: filtered mean, squares and product of each row
+    for (int j = 0; j < n_rows; j++)
+    {
+      const unsigned char* a = rgb + (o0 + j) * row_bytes + c;
+      const unsigned char* b = &m_reference[(o0 + j) * row_bytes + c];
+      for (int x = 0; x < m_width; x++)
+      {
+        s.x[x] = (float)a[3 * x];
+        s.y[x] = (float)b[3 * x];
+      }
+
+      float* mx = &s.h_mx[j * ow];
+      float* my = &s.h_my[j * ow];
+      float* xx = &s.h_xx[j * ow];
+      float* yy = &s.h_yy[j * ow];
+      float* xy = &s.h_xy[j * ow];
+      std::fill(mx, mx + ow, 0.0f); std::fill(my, my + ow, 0.0f);
+      std::fill(xx, xx + ow, 0.0f); std::fill(yy, yy + ow, 0.0f); std::fill(xy, xy + ow, 0.0f);
+      for (int k = 0; k < taps; k++)
+      {
+        const float w = m_weights[k];
+        const float* px = &s.x[k];
+        const float* py = &s.y[k];
+        for (int x = 0; x < ow; x++)
+        {
+          mx[x] += w * px[x];
+          my[x] += w * py[x];
+          xx[x] += w * px[x] * px[x];
+          yy[x] += w * py[x] * py[x];
+          xy[x] += w * px[x] * py[x];
+        }
+      }
+    }
+
+    //Vertical pass and SSIM of each window
+    for (int o = o0; o < o1; o++)
+    {
+      std::fill(s.v_mx.begin(), s.v_mx.end(), 0.0f); std::fill(s.v_my.begin(), s.v_my.end(), 0.0f);
+      std::fill(s.v_xx.begin(), s.v_xx.end(), 0.0f); std::fill(s.v_yy.begin(), s.v_yy.end(), 0.0f);
+      std::fill(s.v_xy.begin(), s.v_xy.end(), 0.0f);
+      for (int k = 0; k < taps; k++)
+      {
+        const float w = m_weights[k];
+        const size_t offset = (size_t)(o - o0 + k) * ow;
+        for (int x = 0; x < ow; x++)
+        {
+          s.v_mx[x] += w * s.h_mx[offset + x];
+          s.v_my[x] += w * s.h_my[offset + x];
+          s.v_xx[x] += w * s.h_xx[offset + x];
+          s.v_yy[x] += w * s.h_yy[offset + x];
+          s.v_xy[x] += w * s.h_xy[offset + x];
+        }
+      }
+
+      for (int x = 0; x < ow; x++)
+      {
+        const float mx = s.v_mx[x], my = s.v_my[x];
+        const float sxx = s.v_xx[x] - mx * mx;
+        const float syy = s.v_yy[x] - my * my;
+        const float sxy = s.v_xy[x] - mx * my;
+        ssim += ((2.0f * mx * my + SSIM_C1) * (2.0f * sxy + SSIM_C2))
+              / ((mx * mx + my * my + SSIM_C1) * (sxx + syy + SSIM_C2));
+      }
+    }
+  }
+  sums.ssim = ssim;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vector>
+
+/** Full-reference quality metrics of 8-bit RGB images, as read back from the frame buffer.
+*
+*   . SSIM: mean structural similarity of the R, G and B channels, with the
+*     11x11 Gaussian window (sigma 1.5) and constants K1 = 0.01, K2 = 0.03 of
+*     Wang et al. Only windows that are completely inside the image are used.
+*   . PSNR: peak signal to noise ratio in dB, infinite for identical images.
+*   . MAE: mean absolute error of all channels, in [0, 1].
+*
+*   The image is split into bands of rows that are compared on the shared
+*   work-stealing pool (vis::TaskPool). The filters run over contiguous rows of floats so that the
+*   compiler can vectorize the inner loops.
+*/
+class ImageComparison
+{
+//Construction / Deconstruction
+public:
+  ImageComparison();
+  virtual ~ImageComparison();
+
+//Types
+public:
+  struct Scores
+  {
+    double ssim;
+    double psnr;
+    double mae;
+  };
+
+//Functions
+public:
+  ///Copies the reference image, 3 bytes per pixel, rows bottom to top as glReadPixels.
+  void SetReference(const unsigned char* rgb, int width, int height);
+  void ClearReference();
+  bool HasReference() const {return !m_reference.empty();};
+  int GetWidth() const {return m_width;};
+  int GetHeight() const {return m_height;};
+
+  ///Compares an image of the size of the reference.
+  Scores Compare(const unsigned char* rgb);
+
+protected:
+  ///Sums of the rows of a band
+  struct BandSums
+  {
+    double ssim;
+    double squared_error;
+    double absolute_error;
+  };
+
+  ///Rows of the filtered statistics of a thread: the caller of Compare(), then each worker of the pool
+  struct Scratch
+  {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> h_mx, h_my, h_xx, h_yy, h_xy;
+    std::vector<float> v_mx, v_my, v_xx, v_yy, v_xy;
+  };
+
+  void CompareBand(const unsigned char* rgb, int band, Scratch& scratch, BandSums& sums) const;
+
+//Attributes
+protected:
+  std::vector<unsigned char> m_reference;
+  int m_width;
+  int m_height;
+
+  ///Gaussian weights of the SSIM window, 2 * m_radius + 1 taps
+  std::vector<float> m_weights;
+  int m_radius;
+  int m_band_rows;
+
+  std::vector<Scratch> m_scratch;
+};
@@ -45,6 +45,43 @@ const std::string ParameterSpace::GetDimensionValue(const int idx) const
   return m_dimensions[idx]->GetValueStr();
 }
 
+int ParameterSpace::GetDimensionIndex(const std::string& name) const
+{
+  for(int i=0;i<(int)m_dimensions.size();i++)
+  {
+    if (m_dimensions[i]->GetName() == name) return i;
+  }
+  return -1;
+}
+
+bool ParameterSpace::SetDimensionValue(const std::string& name, const std::string& value)
+{
+  for(auto it=m_dimensions.begin();it!=m_dimensions.end();it++)
+  {
+    if ((*it)->GetName() == name) return (*it)->SetValueStr(value);
+  }
+  return false;
+}
+
+std::vector<int> ParameterSpace::GetNumSteps() const
+{
+  std::vector<int> numsteps;
+  for(auto it=m_dimensions.begin();it!=m_dimensions.end();it++)
+  {
+    numsteps.push_back((*it)->NumSteps());
+  }
+  return numsteps;
+}
+
+void ParameterSpace::SetSamplePoint(const std::vector<int>& steps)
+{
+  assert(steps.size() == m_dimensions.size());
+  for(size_t i=0;i<m_dimensions.size();i++)
+  {
+    m_dimensions[i]->SetStep(steps[i]);
+  }
+}
+
 int ParameterSpace::ComputeNumSamplePoints()
 {
   m_numsamples_cached = 0;
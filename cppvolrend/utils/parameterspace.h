@@ -4,6 +4,7 @@
 #include <cassert>
 #include <vector>
 #include <string>
+#include <sstream>
 
 /** Describes a parameter range to be used as a dimension for a parameter space.
 * 
@@ -37,6 +38,9 @@ public:
   ///Returns the number of steps in this range.
   virtual int NumSteps() const = 0;
 
+  ///Sets the parameter to the value of a step in [0, NumSteps()).
+  virtual void SetStep(const int step) = 0;
+
   ///Store the current value to be restored later with RestoreCurrentValue()
   virtual void SaveCurrentValue() = 0;
 
@@ -49,6 +53,10 @@ public:
   ///Returns the current value as a string
   virtual std::string GetValueStr() const = 0;
 
+  ///Sets the parameter from a string, e.g., written before by GetValueStr().
+  ///Returns false if the string could not be parsed.
+  virtual bool SetValueStr(const std::string& value) = 0;
+
 //Attributes
 protected:
   ///Name of this range
@@ -143,12 +151,30 @@ public:
     return 1 + (int)ceil((m_end - m_start) / m_incr);
   }
 
+  ///Sets the parameter to the value of a step in [0, NumSteps()).
+  virtual void SetStep(const int step) override
+  {
+    assert(m_curr && step >= 0 && step < NumSteps());
+    *m_curr = (T)(m_start + step * m_incr);
+  }
+
   ///Returns the current value as a string
   virtual std::string GetValueStr() const override
   {
     return std::to_string(*m_curr);
   }
 
+  ///Sets the parameter from a string
+  virtual bool SetValueStr(const std::string& value) override
+  {
+    assert(m_curr);
+    std::istringstream iss(value);
+    T v;
+    if (!(iss >> v)) return false;
+    *m_curr = v;
+    return true;
+  }
+
 //Attributes
 protected:
   T m_start;
@@ -164,6 +190,111 @@ using ParameterRangeDouble = ParameterRangeNumeric<double>;
 using ParameterRangeInt = ParameterRangeNumeric<int>;
 
 
+/** Describes a parameter range given by an explicit list of values,
+*   e.g., block sizes 4, 8, 16, 32 that cannot be written as start + i * incr.
+* 
+*   @see ParameterRangeBase
+*/
+template<typename T>
+class ParameterRangeList : public ParameterRangeBase
+{
+//Construction / Deconstruction
+public:
+  /** Creates a parameter range that goes through @c values in the given order.
+  *   The variable pointed to by @c param will be affected by this range.
+  */
+  ParameterRangeList(const std::string& name, T* param, const std::vector<T>& values)
+    :ParameterRangeBase(name)
+    ,m_values(values)
+    ,m_index(0)
+    ,m_curr(param)
+  {
+    //We do not accept empty lists.
+    if (m_values.empty() || !param)
+    {
+      throw;
+    }
+  }
+
+  virtual ~ParameterRangeList()
+  {}
+
+//Functions
+public:
+  ///Reset the internal counter to point to the beginning of the parameter range.
+  virtual void Start() override
+  {
+    assert(m_curr);
+    m_index = 0;
+    *m_curr = m_values[m_index];
+  }
+
+  ///Test whether the internal counter reached the end of the parameter range.
+  virtual bool End() const override
+  {
+    return m_index >= (int)m_values.size();
+  }
+
+  ///Increase the internal counter by one step.
+  virtual void Incr() override
+  {
+    assert(m_curr);
+    m_index++;
+    if (!End()) *m_curr = m_values[m_index];
+  }
+
+  ///Store the current value to be restored later with RestoreCurrentValue()
+  virtual void SaveCurrentValue() override
+  {
+    m_previousvalue = *m_curr;
+  }
+
+  ///Restores the current value from the last call to SaveCurrentValue()
+  virtual void RestoreCurrentValue() override
+  {
+    *m_curr = m_previousvalue;
+  }
+
+  ///Returns the number of steps in this range.
+  virtual int NumSteps() const override
+  {
+    return (int)m_values.size();
+  }
+
+  ///Sets the parameter to the value of a step in [0, NumSteps()).
+  virtual void SetStep(const int step) override
+  {
+    assert(m_curr && step >= 0 && step < NumSteps());
+    m_index = step;
+    *m_curr = m_values[m_index];
+  }
+
+  ///Returns the current value as a string
+  virtual std::string GetValueStr() const override
+  {
+    return std::to_string(*m_curr);
+  }
+
+  ///Sets the parameter from a string
+  virtual bool SetValueStr(const std::string& value) override
+  {
+    assert(m_curr);
+    std::istringstream iss(value);
+    T v;
+    if (!(iss >> v)) return false;
+    *m_curr = v;
+    return true;
+  }
+
+//Attributes
+protected:
+  std::vector<T> m_values;
+  int m_index;
+  T m_previousvalue;
+  T* m_curr;
+};
+
+
 /** Defines a parameter space for evaluation of an algorithm.
 * 
 */
@@ -194,9 +325,23 @@ public:
   /// This can be used as the content of a csv file.
   const std::string GetDimensionValue(const int idx) const;
 
+  ///Index of the dimension with the given name, -1 if there is none.
+  int GetDimensionIndex(const std::string& name) const;
+
+  ///Sets the value of the dimension with the given name from a string.
+  /// Returns false if there is no such dimension or the value is invalid.
+  bool SetDimensionValue(const std::string& name, const std::string& value);
+
   ///The number of sample points of the parameter space.
   int GetNumSamplePoints() const {return m_numsamples_cached;};
 
+  ///The number of steps of each dimension.
+  std::vector<int> GetNumSteps() const;
+
+  ///Sets all dimensions to a sample point given by one step per dimension,
+  /// e.g., during an evaluation that does not go through all sample points.
+  void SetSamplePoint(const std::vector<int>& steps);
+
   ///Starts an evaluation
   void StartEvaluation();
 
@@ -0,0 +1,148 @@
+#include "paretosearch.h"
+
+#include <algorithm>
+#include <numeric>
+
+ParetoSearch::ParetoSearch()
+  :m_max_samples(0)
+  ,m_waiting_result(false)
+{
+}
+
+ParetoSearch::~ParetoSearch()
+{
+}
+
+void ParetoSearch::Start(const std::vector<int>& num_steps, int max_samples)
+{
+  m_num_steps = num_steps;
+  m_max_samples = max_samples;
+  m_samples.clear();
+  m_queue.clear();
+  m_visited.clear();
+  m_waiting_result = false;
+
+  //Largest power of two with at least 3 coarse steps, when the dimension has them
+  m_stride.assign(m_num_steps.size(), 1);
+  for (size_t d = 0; d < m_num_steps.size(); d++)
+  {
+    while (m_stride[d] * 4 <= m_num_steps[d] - 1) m_stride[d] *= 2;
+  }
+
+  //Coarse grid, the last step of each dimension is always included
+  std::vector<std::vector<int>> axes(m_num_steps.size());
+  for (size_t d = 0; d < m_num_steps.size(); d++)
+  {
+    for (int s = 0; s < m_num_steps[d]; s += m_stride[d]) axes[d].push_back(s);
+    if (axes[d].back() != m_num_steps[d] - 1) axes[d].push_back(m_num_steps[d] - 1);
+  }
+
+  std::vector<int> index(m_num_steps.size(), 0);
+  std::vector<int> steps(m_num_steps.size());
+  bool done = m_num_steps.empty();
+  while (!done)
+  {
+    for (size_t d = 0; d < index.size(); d++) steps[d] = axes[d][index[d]];
+    AddCandidate(steps);
+
+    //Increase the last dimension first, as ParameterSpace::IncrEvaluation()
+    int d = (int)index.size() - 1;
+    while (d >= 0 && ++index[d] == (int)axes[d].size())
+    {
+      index[d] = 0;
+      d--;
+    }
+    done = d < 0;
+  }
+}
+
+bool ParetoSearch::NextSample(std::vector<int>& steps)
+{
+  if (m_max_samples > 0 && (int)m_samples.size() >= m_max_samples) return false;
+
+  if (m_queue.empty()) Refine();
+  if (m_queue.empty()) return false;
+
+  m_current = m_queue.front();
+  m_queue.erase(m_queue.begin());
+  m_waiting_result = true;
+
+  steps = m_current;
+  return true;
+}
+
+void ParetoSearch::AddResult(double time_ms, double error)
+{
+  if (!m_waiting_result) return;
+  m_waiting_result = false;
+
+  Sample sample;
+  sample.steps = m_current;
+  sample.time_ms = time_ms;
+  sample.error = error;
+  m_samples.push_back(sample);
+}
+
+std::vector<bool> ParetoSearch::GetParetoFlags() const
+{
+  //Sweep by increasing time: a sample is on the front if it has less error than all faster samples
+  std::vector<size_t> order(m_samples.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [this](size_t a, size_t b)
+  {
+    if (m_samples[a].time_ms != m_samples[b].time_ms) return m_samples[a].time_ms < m_samples[b].time_ms;
+    return m_samples[a].error < m_samples[b].error;
+  });
+
+  std::vector<bool> flags(m_samples.size(), false);
+  bool first = true;
+  double best_error = 0.0;
+  for (size_t i : order)
+  {
+    if (first || m_samples[i].error < best_error)
+    {
+      flags[i] = true;
+      best_error = m_samples[i].error;
+      first = false;
+    }
+  }
+  return flags;
+}
+
+int ParetoSearch::GetMaxStride() const
+{
+  return m_stride.empty() ? 1 : *std::max_element(m_stride.begin(), m_stride.end());
+}
+
+void ParetoSearch::Refine()
+{
+  //At a stride of 1, rounds are repeated until the front has no new neighbors
+  bool finest = false;
+  while (m_queue.empty() && !finest)
+  {
+    finest = GetMaxStride() == 1;
+    for (int& s : m_stride) s = std::max(s / 2, 1);
+
+    const std::vector<bool> flags = GetParetoFlags();
+    for (size_t i = 0; i < m_samples.size(); i++)
+    {
+      if (!flags[i]) continue;
+
+      std::vector<int> steps = m_samples[i].steps;
+      for (size_t d = 0; d < steps.size(); d++)
+      {
+        const int s = steps[d];
+        steps[d] = s - m_stride[d];
+        if (steps[d] >= 0) AddCandidate(steps);
+        steps[d] = s + m_stride[d];
+        if (steps[d] < m_num_steps[d]) AddCandidate(steps);
+        steps[d] = s;
+      }
+    }
+  }
+}
+
+void ParetoSearch::AddCandidate(const std::vector<int>& steps)
+{
+  if (m_visited.insert(steps).second) m_queue.push_back(steps);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <set>
+#include <vector>
+
+/** Adaptive search of the Pareto front of frame time against image error
+*   in a parameter space, instead of rendering all of its sample points.
+*
+*   Sample points are given by one step per dimension of a ParameterSpace.
+*   The search is coarse-to-fine:
+*   . a coarse grid is evaluated first, with a stride of about half of the
+*     steps of each dimension, including the first and last steps;
+*   . then, each round evaluates the axis neighbors of the current Pareto
+*     front at half of the previous stride. Samples that are dominated by
+*     the front are not refined further;
+*   . with a stride of 1, rounds are repeated while the front moves, and the
+*     search ends when the front has no unevaluated neighbors or when the
+*     sample budget is used.
+*
+*   The search is driven by the evaluation loop:
+*   NextSample() -> render, measure and compare -> AddResult().
+*/
+class ParetoSearch
+{
+//Construction / Deconstruction
+public:
+  ParetoSearch();
+  virtual ~ParetoSearch();
+
+//Types
+public:
+  struct Sample
+  {
+    std::vector<int> steps;
+    ///Both objectives are minimized
+    double time_ms;
+    double error;
+  };
+
+//Functions
+public:
+  ///Starts a search in a space with the given number of steps per dimension.
+  /// max_samples <= 0 does not limit the number of samples.
+  void Start(const std::vector<int>& num_steps, int max_samples);
+
+  ///Returns false when the search has finished.
+  bool NextSample(std::vector<int>& steps);
+
+  ///Result of the sample returned by the last NextSample().
+  void AddResult(double time_ms, double error);
+
+  ///Evaluated samples, in evaluation order
+  const std::vector<Sample>& GetSamples() const {return m_samples;};
+
+  ///Flags the evaluated samples that are on the Pareto front.
+  std::vector<bool> GetParetoFlags() const;
+
+  ///Current stride of the refinement, 1 at the finest level
+  int GetMaxStride() const;
+
+protected:
+  ///Adds the candidates of the next round to the queue.
+  void Refine();
+  void AddCandidate(const std::vector<int>& steps);
+
+//Attributes
+protected:
+  std::vector<int> m_num_steps;
+  std::vector<int> m_stride;
+  int m_max_samples;
+
+  std::vector<Sample> m_samples;
+  std::vector<std::vector<int>> m_queue;
+  ///Sample points that are evaluated or in the queue
+  std::set<std::vector<int>> m_visited;
+  std::vector<int> m_current;
+  bool m_waiting_result;
+};
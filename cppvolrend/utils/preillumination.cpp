@@ -1,5 +1,7 @@
 #include "preillumination.h"
 
+#include <gl_utils/memoryregistry.h>
+
 #include "imgui.h"
 #include "imgui_impl_glut.h"
 #include "imgui_impl_opengl2.h"
@@ -65,10 +67,22 @@ void PreIlluminationStructuredVolume::GenerateLightCacheTexture ()
   
   if(IsActive())
   {
+    // Halve the resolution while the cache does not fit in the GPU memory budget
+    glm::ivec3 res = m_light_cache_resolution;
+    gl::MemoryRegistry& registry = gl::MemoryRegistry::Instance();
+    while (!registry.Fits(gl::MemoryRegistry::GetTextureBytes(m_tex_internal_format, res.x, res.y, res.z))
+      && (res.x > 1 || res.y > 1 || res.z > 1))
+    {
+      res = glm::max(res / 2, glm::ivec3(1));
+    }
+    if (res != m_light_cache_resolution)
+    {
+      printf("PreIlluminationStructuredVolume: light cache of %dx%dx%d reduced to %dx%dx%d to fit the GPU memory budget\n",
+        m_light_cache_resolution.x, m_light_cache_resolution.y, m_light_cache_resolution.z, res.x, res.y, res.z);
+    }
+
     // Initialize extinction coefficient volume texture 3D
-    m_tex_glsl_light_vol_cache = new gl::Texture3D(m_light_cache_resolution.x,
-                                                   m_light_cache_resolution.y,
-                                                   m_light_cache_resolution.z);
+    m_tex_glsl_light_vol_cache = new gl::Texture3D(res.x, res.y, res.z);
 
     // Set initial texture parameters
     m_tex_glsl_light_vol_cache->GenerateTexture(GL_LINEAR, GL_LINEAR,
@@ -99,6 +113,11 @@ glm::bvec2 PreIlluminationStructuredVolume::SetImGuiComponents ()
   
   if (IsActive())
   {
+    if (m_tex_glsl_light_vol_cache && (int)m_tex_glsl_light_vol_cache->GetWidth() != m_light_cache_resolution.x)
+    {
+      ImGui::Text("Reduced to %dx%dx%d by the GPU memory budget", m_tex_glsl_light_vol_cache->GetWidth(),
+        m_tex_glsl_light_vol_cache->GetHeight(), m_tex_glsl_light_vol_cache->GetDepth());
+    }
     ImGui::BulletText("Resolution:");
     ImGui::PushItemWidth(100.0f);
     ImGui::BeginGroup();
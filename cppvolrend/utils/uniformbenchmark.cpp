@@ -0,0 +1,285 @@
+#include "uniformbenchmark.h"
+#include "frametimestatistics.h"
+
+#include <gl_utils/shader.h>
+#include <gl_utils/uniformblock.h>
+#include <gl_utils/utils.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+namespace
+{
+  //Fixed parameter set, the one of the 1-pass ray caster when the benchmark was written,
+  //so the results stay comparable when the renderer parameters change
+  struct BenchmarkParameters
+  {
+    glm::mat4 u_CameraLookAt;
+    glm::mat4 ProjectionMatrix;
+
+    glm::vec3 CameraEye;
+    float u_TanCameraFovY;
+    glm::vec3 WorldEyePos;
+    float u_CameraAspectRatio;
+    glm::vec3 LightSourcePosition;
+    float StepSize;
+    glm::vec3 BlinnPhongIspecular;
+    float BlinnPhongKa;
+
+    float BlinnPhongKd;
+    float BlinnPhongKs;
+    float BlinnPhongShininess;
+    int ApplyGradientPhongShading;
+
+    int ApplyEmptySpaceSkipping;
+    int ApplyProxyGeometry;
+    int ProxyUseNear;
+    int ApplyOcclusion;
+
+    int ApplyShadow;
+    int _pad[3];
+  };
+  static_assert(sizeof(BenchmarkParameters) == 240, "BenchmarkParameters must match the std140 layout");
+
+  //Members of BenchmarkParameters, MEMBER is "uniform" or empty inside the block
+  const char* s_parameter_members =
+    "MEMBER mat4 u_CameraLookAt;\n"
+    "MEMBER mat4 ProjectionMatrix;\n"
+    "MEMBER vec3 CameraEye;\n"
+    "MEMBER float u_TanCameraFovY;\n"
+    "MEMBER vec3 WorldEyePos;\n"
+    "MEMBER float u_CameraAspectRatio;\n"
+    "MEMBER vec3 LightSourcePosition;\n"
+    "MEMBER float StepSize;\n"
+    "MEMBER vec3 BlinnPhongIspecular;\n"
+    "MEMBER float BlinnPhongKa;\n"
+    "MEMBER float BlinnPhongKd;\n"
+    "MEMBER float BlinnPhongKs;\n"
+    "MEMBER float BlinnPhongShininess;\n"
+    "MEMBER int ApplyGradientPhongShading;\n"
+    "MEMBER int ApplyEmptySpaceSkipping;\n"
+    "MEMBER int ApplyProxyGeometry;\n"
+    "MEMBER int ProxyUseNear;\n"
+    "MEMBER int ApplyOcclusion;\n"
+    "MEMBER int ApplyShadow;\n";
+
+  //Every parameter is read, so none of them is optimized out
+  const char* s_kernel =
+    "layout (local_size_x = 1, local_size_y = 1, local_size_z = 1) in;\n"
+    "layout (std430, binding = 0) buffer BenchmarkOutput { float Sum; };\n"
+    "void main ()\n"
+    "{\n"
+    "  Sum = (u_CameraLookAt * ProjectionMatrix)[0][0] + dot(CameraEye, WorldEyePos + LightSourcePosition + BlinnPhongIspecular)\n"
+    "      + u_TanCameraFovY + u_CameraAspectRatio + StepSize + BlinnPhongKa + BlinnPhongKd + BlinnPhongKs + BlinnPhongShininess\n"
+    "      + float(ApplyGradientPhongShading + ApplyEmptySpaceSkipping + ApplyProxyGeometry + ProxyUseNear + ApplyOcclusion + ApplyShadow);\n"
+    "}\n";
+
+  //gl::Shader compiled from a source string
+  class InlineComputeShader : public gl::Shader
+  {
+  public:
+    InlineComputeShader(const std::string& source) : m_source(source) {}
+
+    virtual bool LoadAndLink()
+    {
+      GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+      const char* src = m_source.c_str();
+      glShaderSource(shader, 1, &src, NULL);
+      glCompileShader(shader);
+
+      shader_program = glCreateProgram();
+      glAttachShader(shader_program, shader);
+      glLinkProgram(shader_program);
+      glDeleteShader(shader);
+
+      GLint linked = 0;
+      glGetProgramiv(shader_program, GL_LINK_STATUS, &linked);
+      if (!linked)
+      {
+        GLchar log[4096];
+        glGetProgramInfoLog(shader_program, 4095, NULL, log);
+        fprintf(stderr, "UniformBenchmark: could not link the kernel\n%s\n", log);
+      }
+      return linked != 0;
+    }
+
+    virtual bool Reload() { return false; }
+
+  private:
+    std::string m_source;
+  };
+
+  //Parameters of a frame orbiting the volume
+  void FillParameters(BenchmarkParameters& params, int frame)
+  {
+    float angle = 0.01f * (float)frame;
+    glm::vec3 eye = glm::vec3(400.0f * std::cos(angle), 50.0f, 400.0f * std::sin(angle));
+
+    params.u_CameraLookAt = glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    params.ProjectionMatrix = glm::frustum(-0.27f, 0.27f, -0.27f, 0.27f, 1.0f, 2000.0f);
+    params.CameraEye = eye;
+    params.u_TanCameraFovY = 0.27f;
+    params.WorldEyePos = eye;
+    params.u_CameraAspectRatio = 1.0f;
+    params.LightSourcePosition = glm::vec3(0.0f, 1000.0f, 0.0f);
+    params.StepSize = 0.5f;
+    params.BlinnPhongIspecular = glm::vec3(1.0f);
+    params.BlinnPhongKa = 0.5f;
+    params.BlinnPhongKd = 0.5f;
+    params.BlinnPhongKs = 0.8f;
+    params.BlinnPhongShininess = 20.0f;
+    params.ApplyGradientPhongShading = 0;
+    params.ApplyEmptySpaceSkipping = 1;
+    params.ApplyProxyGeometry = 1;
+    params.ProxyUseNear = 1;
+    params.ApplyOcclusion = 1;
+    params.ApplyShadow = 1;
+  }
+
+  void SetNamedUniforms(gl::Shader* shader, const BenchmarkParameters& params)
+  {
+    shader->SetUniform("u_CameraLookAt", params.u_CameraLookAt);
+    shader->BindUniform("u_CameraLookAt");
+    shader->SetUniform("ProjectionMatrix", params.ProjectionMatrix);
+    shader->BindUniform("ProjectionMatrix");
+    shader->SetUniform("CameraEye", params.CameraEye);
+    shader->BindUniform("CameraEye");
+    shader->SetUniform("u_TanCameraFovY", params.u_TanCameraFovY);
+    shader->BindUniform("u_TanCameraFovY");
+    shader->SetUniform("WorldEyePos", params.WorldEyePos);
+    shader->BindUniform("WorldEyePos");
+    shader->SetUniform("u_CameraAspectRatio", params.u_CameraAspectRatio);
+    shader->BindUniform("u_CameraAspectRatio");
+    shader->SetUniform("LightSourcePosition", params.LightSourcePosition);
+    shader->BindUniform("LightSourcePosition");
+    shader->SetUniform("StepSize", params.StepSize);
+    shader->BindUniform("StepSize");
+    shader->SetUniform("BlinnPhongIspecular", params.BlinnPhongIspecular);
+    shader->BindUniform("BlinnPhongIspecular");
+    shader->SetUniform("BlinnPhongKa", params.BlinnPhongKa);
+    shader->BindUniform("BlinnPhongKa");
+    shader->SetUniform("BlinnPhongKd", params.BlinnPhongKd);
+    shader->BindUniform("BlinnPhongKd");
+    shader->SetUniform("BlinnPhongKs", params.BlinnPhongKs);
+    shader->BindUniform("BlinnPhongKs");
+    shader->SetUniform("BlinnPhongShininess", params.BlinnPhongShininess);
+    shader->BindUniform("BlinnPhongShininess");
+    shader->SetUniform("ApplyGradientPhongShading", params.ApplyGradientPhongShading);
+    shader->BindUniform("ApplyGradientPhongShading");
+    shader->SetUniform("ApplyEmptySpaceSkipping", params.ApplyEmptySpaceSkipping);
+    shader->BindUniform("ApplyEmptySpaceSkipping");
+    shader->SetUniform("ApplyProxyGeometry", params.ApplyProxyGeometry);
+    shader->BindUniform("ApplyProxyGeometry");
+    shader->SetUniform("ProxyUseNear", params.ProxyUseNear);
+    shader->BindUniform("ProxyUseNear");
+    shader->SetUniform("ApplyOcclusion", params.ApplyOcclusion);
+    shader->BindUniform("ApplyOcclusion");
+    shader->SetUniform("ApplyShadow", params.ApplyShadow);
+    shader->BindUniform("ApplyShadow");
+  }
+
+  UniformBenchmark::Result Summarize(const FrameTimeStatistics& times, double bytes_per_frame)
+  {
+    FrameTimeStatistics::Summary summary = times.Summarize();
+    UniformBenchmark::Result result;
+    result.mean_us = summary.mean;
+    result.median_us = summary.median;
+    result.p95_us = summary.p95;
+    result.bytes_per_frame = bytes_per_frame;
+    return result;
+  }
+}
+
+UniformBenchmark::UniformBenchmark()
+  :m_named({0.0, 0.0, 0.0, 0.0})
+  ,m_block({0.0, 0.0, 0.0, 0.0})
+  ,m_frames(0)
+{
+}
+
+UniformBenchmark::~UniformBenchmark()
+{
+}
+
+void UniformBenchmark::Run(int warmup, int frames)
+{
+  typedef std::chrono::high_resolution_clock Clock;
+  m_frames = frames;
+
+  const std::string header = "#version 430\n";
+  InlineComputeShader named(header + "#define MEMBER uniform\n" + s_parameter_members + s_kernel);
+  InlineComputeShader block(header + "#define MEMBER\nlayout (std140, binding = 0) uniform BenchmarkParameters\n{\n"
+    + s_parameter_members + "};\n" + s_kernel);
+  if (!named.LoadAndLink() || !block.LoadAndLink()) return;
+
+  GLuint output;
+  glGenBuffers(1, &output);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, output);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(float), NULL, GL_DYNAMIC_DRAW);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, output);
+
+  //Named uniforms
+  {
+    BenchmarkParameters params;
+    FrameTimeStatistics times;
+    for (int f = 0; f < warmup + frames; f++)
+    {
+      FillParameters(params, f);
+      Clock::time_point start = Clock::now();
+
+      named.Bind();
+      SetNamedUniforms(&named, params);
+      named.BindUniforms();
+      glDispatchCompute(1, 1, 1);
+      gl::Shader::Unbind();
+
+      if (f >= warmup) times.Add(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+    glFinish();
+    m_named = Summarize(times, (double)(sizeof(BenchmarkParameters) - sizeof(params._pad)));
+  }
+
+  //Uniform block
+  {
+    gl::ParameterBlock<BenchmarkParameters> parameter_block(0);
+    FrameTimeStatistics times;
+    size_t bytes = 0;
+    for (int f = 0; f < warmup + frames; f++)
+    {
+      FillParameters(parameter_block.values, f);
+      Clock::time_point start = Clock::now();
+
+      block.Bind();
+      parameter_block.Upload();
+      glDispatchCompute(1, 1, 1);
+      gl::Shader::Unbind();
+
+      if (f >= warmup)
+      {
+        times.Add(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        bytes += parameter_block.GetLastUploadBytes();
+      }
+    }
+    glFinish();
+    m_block = Summarize(times, frames > 0 ? (double)bytes / (double)frames : 0.0);
+  }
+
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+  glDeleteBuffers(1, &output);
+  gl::ExitOnGLError("UniformBenchmark: After Run.");
+}
+
+void UniformBenchmark::Print() const
+{
+  printf("Per-frame parameter submission of the 1-pass ray caster (%d frames)\n", m_frames);
+  printf("  %-16s %10s %10s %10s %12s\n", "", "mean (us)", "median", "p95", "bytes/frame");
+  printf("  %-16s %10.2f %10.2f %10.2f %12.1f\n", "Named uniforms", m_named.mean_us, m_named.median_us, m_named.p95_us, m_named.bytes_per_frame);
+  printf("  %-16s %10.2f %10.2f %10.2f %12.1f\n", "Uniform block", m_block.mean_us, m_block.median_us, m_block.p95_us, m_block.bytes_per_frame);
+  if (m_block.mean_us > 0.0)
+    printf("  Speedup: %.2fx\n", m_named.mean_us / m_block.mean_us);
+}
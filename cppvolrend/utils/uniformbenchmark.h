@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+
+/** CPU time to submit the per-frame parameters of the 1-pass ray caster.
+*
+*   The same compute kernel is compiled twice, with a fixed parameter set
+*   (the RayMarchingParameters of the renderer when the benchmark was written)
+*   as named uniforms and as a std140 uniform block. Each frame orbits the
+*   camera, writes the parameters and dispatches a single work group:
+*   . Named: gl::Shader::SetUniform and BindUniform per parameter, as the
+*     renderers did before gl::ParameterBlock
+*   . Block: the struct is filled and gl::ParameterBlock::Upload writes the
+*     bytes that changed
+*   Only the submission is timed, the GPU is synchronized between variants.
+*/
+class UniformBenchmark
+{
+//Construction / Deconstruction
+public:
+  UniformBenchmark();
+  virtual ~UniformBenchmark();
+
+//Types
+public:
+  struct Result
+  {
+    double mean_us;
+    double median_us;
+    double p95_us;
+    ///Bytes written to the GPU per frame, uniform values for the named variant
+    double bytes_per_frame;
+  };
+
+//Functions
+public:
+  ///Requires a current OpenGL 4.3 context
+  void Run(int warmup, int frames);
+  void Print() const;
+
+  const Result& GetNamedResult() const {return m_named;};
+  const Result& GetBlockResult() const {return m_block;};
+
+//Attributes
+protected:
+  Result m_named;
+  Result m_block;
+  int m_frames;
+};
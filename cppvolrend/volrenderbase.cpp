@@ -74,6 +74,36 @@ void BaseVolumeRenderer::FillParameterSpace(ParameterSpace& pspace)
   pspace.ClearParameterDimensions();
 }
 
+void BaseVolumeRenderer::FillVariantSpace (ParameterSpace& pspace)
+{
+  pspace.ClearParameterDimensions();
+}
+
+void BaseVolumeRenderer::FillTuningSpace (ParameterSpace& pspace)
+{
+  pspace.ClearParameterDimensions();
+}
+
+void BaseVolumeRenderer::ApplyTuningParameters ()
+{
+  SetOutdated();
+}
+
+std::string BaseVolumeRenderer::GetTuningKey ()
+{
+  return GetAbbreviationName();
+}
+
+void BaseVolumeRenderer::GetFrameStatistics (std::vector<std::pair<std::string, double>>& stats)
+{
+  stats.clear();
+}
+
+bool BaseVolumeRenderer::OnTransferFunctionChanged ()
+{
+  return false;
+}
+
 void BaseVolumeRenderer::PrepareRender (vis::Camera* camera)
 {
   if (IsOutdated())
@@ -58,6 +58,35 @@ public:
   virtual vis::GRID_VOLUME_DATA_TYPE GetDataTypeSupport () = 0;
   
   virtual void FillParameterSpace(ParameterSpace& pspace);
+  // Features compiled as shader variants, e.g. the composition. They change
+  //   the image, so they are only swept when a benchmark job asks for them.
+  //   Empty by default
+  virtual void FillVariantSpace (ParameterSpace& pspace);
+
+  //////////////////////////////////////////
+  // Auto-tuning
+  // . Parameters explored by the auto-tuner, e.g. the block size of the
+  //   empty space skipping. Empty by default (renderer is not tunable).
+  virtual void FillTuningSpace (ParameterSpace& pspace);
+  // . Called after the auto-tuner changed the tuning parameters, so the
+  //   renderer can rebuild the structures that depend on them.
+  virtual void ApplyTuningParameters ();
+  // . Identifies the tuned configuration. Renderers whose best setting
+  //   depends on the current state (e.g. isovalue band) extend it.
+  virtual std::string GetTuningKey ();
+
+  //////////////////////////////////////////
+  // Frame statistics
+  // . Named counters of the last rendered frame (e.g. skipped blocks),
+  //   recorded for each frame of a camera path trace. Empty by default.
+  virtual void GetFrameStatistics (std::vector<std::pair<std::string, double>>& stats);
+
+  //////////////////////////////////////////
+  // Data changes
+  // . Called instead of Clean + Init when only the transfer function changed,
+  //   so the renderer updates its transfer function texture and the structures
+  //   computed from it. Returns false (default) if it must be rebuilt.
+  virtual bool OnTransferFunctionChanged ();
 
   void PrepareRender (vis::Camera* camera);
     
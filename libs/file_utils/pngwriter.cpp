@@ -0,0 +1,269 @@
+#include "pngwriter.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+  // CRC-32 of the chunks (ISO 3309), the table is built once
+  unsigned int UpdateCrc (unsigned int crc, const unsigned char* data, size_t n)
+  {
+    static const std::array<unsigned int, 256> table = [] () {
+      std::array<unsigned int, 256> t;
+      for (unsigned int i = 0; i < 256; i++)
+      {
+        unsigned int c = i;
+        for (int k = 0; k < 8; k++)
+          c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        t[i] = c;
+      }
+      return t;
+    } ();
+
+    for (size_t i = 0; i < n; i++)
+      crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc;
+  }
+
+  void AppendBigEndian (std::vector<unsigned char>& out, unsigned int v)
+  {
+    out.push_back((v >> 24) & 0xFF);
+    out.push_back((v >> 16) & 0xFF);
+    out.push_back((v >> 8) & 0xFF);
+    out.push_back(v & 0xFF);
+  }
+
+  // Length, type, data and CRC of the type and data
+  void AppendChunk (std::vector<unsigned char>& out, const char* type, const std::vector<unsigned char>& data)
+  {
+    AppendBigEndian(out, (unsigned int)data.size());
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    AppendBigEndian(out, UpdateCrc(0xFFFFFFFFu, &out[start], out.size() - start) ^ 0xFFFFFFFFu);
+  }
+
+  // Deflate bits are packed from the least significant bit of each byte
+  class BitWriter
+  {
+  public:
+    BitWriter (std::vector<unsigned char>& out) : m_out(out), m_bits(0), m_count(0) {}
+
+    void Write (unsigned int value, int n)
+    {
+      m_bits |= value << m_count;
+      m_count += n;
+      while (m_count >= 8)
+      {
+        m_out.push_back(m_bits & 0xFF);
+        m_bits >>= 8;
+        m_count -= 8;
+      }
+    }
+
+    // Huffman codes are packed from their most significant bit
+    void WriteCode (unsigned int code, int n)
+    {
+      unsigned int reversed = 0;
+      for (int i = 0; i < n; i++)
+        reversed |= ((code >> i) & 1) << (n - 1 - i);
+      Write(reversed, n);
+    }
+
+    void Flush ()
+    {
+      if (m_count > 0) m_out.push_back(m_bits & 0xFF);
+      m_bits = 0;
+      m_count = 0;
+    }
+
+  private:
+    std::vector<unsigned char>& m_out;
+    unsigned int m_bits;
+    int m_count;
+  };
+
+  // Fixed Huffman code of a literal/length symbol
+  void WriteLiteralLength (BitWriter& bw, int symbol)
+  {
+    if (symbol < 144)      bw.WriteCode(0x30 + symbol, 8);
+    else if (symbol < 256) bw.WriteCode(0x190 + (symbol - 144), 9);
+    else if (symbol < 280) bw.WriteCode(symbol - 256, 7);
+    else                   bw.WriteCode(0xC0 + (symbol - 280), 8);
+  }
+
+  void WriteMatch (BitWriter& bw, int length, int distance)
+  {
+    static const int length_base[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                         35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    static const int length_extra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                          3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    static const int distance_base[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                           257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                           8193, 12289, 16385, 24577 };
+    static const int distance_extra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                            7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    int l = 28;
+    while (length_base[l] > length) l--;
+    WriteLiteralLength(bw, 257 + l);
+    bw.Write(length - length_base[l], length_extra[l]);
+
+    int d = 29;
+    while (distance_base[d] > distance) d--;
+    bw.WriteCode(d, 5);
+    bw.Write(distance - distance_base[d], distance_extra[d]);
+  }
+
+  // zlib stream of a single deflate block with the fixed codes
+  void Compress (const std::vector<unsigned char>& data, std::vector<unsigned char>& out)
+  {
+    const int WINDOW = 32768, MIN_MATCH = 3, MAX_MATCH = 258, MAX_PROBES = 32;
+    const int HASH_BITS = 15;
+
+    // Compression method 8 with a 32K window, check bits of the header
+    out.push_back(0x78);
+    out.push_back(0x01);
+
+    BitWriter bw(out);
+    // Final block, fixed Huffman codes
+    bw.Write(1, 1);
+    bw.Write(1, 2);
+
+    const int n = (int)data.size();
+    std::vector<int> head(1 << HASH_BITS, -1);
+    std::vector<int> prev(WINDOW, -1);
+    auto hash = [&] (int i) {
+      return (int)(((data[i] << 10) ^ (data[i + 1] << 5) ^ data[i + 2]) & ((1 << HASH_BITS) - 1));
+    };
+    auto insert = [&] (int i) {
+      if (i + MIN_MATCH > n) return;
+      int h = hash(i);
+      prev[i % WINDOW] = head[h];
+      head[h] = i;
+    };
+
+    int i = 0;
+    while (i < n)
+    {
+      int best_length = 0, best_distance = 0;
+      if (i + MIN_MATCH <= n)
+      {
+        const int max_length = std::min(MAX_MATCH, n - i);
+        int candidate = head[hash(i)];
+        for (int probe = 0; probe < MAX_PROBES && candidate >= 0 && i - candidate <= WINDOW; probe++)
+        {
+          int length = 0;
+          while (length < max_length && data[candidate + length] == data[i + length]) length++;
+          if (length > best_length)
+          {
+            best_length = length;
+            best_distance = i - candidate;
+            if (length == max_length) break;
+          }
+          int next = prev[candidate % WINDOW];
+          // The slot was reused by a newer position
+          if (next >= candidate) break;
+          candidate = next;
+        }
+      }
+
+      if (best_length >= MIN_MATCH)
+      {
+        WriteMatch(bw, best_length, best_distance);
+        for (int k = 0; k < best_length; k++) insert(i + k);
+        i += best_length;
+      }
+      else
+      {
+        WriteLiteralLength(bw, data[i]);
+        insert(i);
+        i++;
+      }
+    }
+    WriteLiteralLength(bw, 256);
+    bw.Flush();
+
+    // Adler-32 of the uncompressed data
+    unsigned int a = 1, b = 0;
+    for (int k = 0; k < n; k++)
+    {
+      a = (a + data[k]) % 65521;
+      b = (b + a) % 65521;
+    }
+    AppendBigEndian(out, (b << 16) | a);
+  }
+
+  unsigned char Paeth (int a, int b, int c)
+  {
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return (unsigned char)a;
+    return (unsigned char)(pb <= pc ? b : c);
+  }
+}
+
+bool WritePNGFile (const std::string& filename, int width, int height, int channels,
+                   const unsigned char* data, bool bottom_to_top)
+{
+  if (width <= 0 || height <= 0 || (channels != 3 && channels != 4) || !data) return false;
+
+  // Filter type byte and the filtered bytes of each row
+  const size_t stride = (size_t)width * channels;
+  std::vector<unsigned char> filtered((stride + 1) * height);
+  std::vector<unsigned char> candidate(stride);
+  for (int y = 0; y < height; y++)
+  {
+    const unsigned char* row = data + stride * (bottom_to_top ? height - 1 - y : y);
+    const unsigned char* up = (y == 0) ? nullptr : data + stride * (bottom_to_top ? height - y : y - 1);
+    unsigned char* dst = &filtered[(stride + 1) * y];
+
+    // 1: Sub, 2: Up, 4: Paeth
+    long best_sum = -1;
+    for (int filter : { 1, 2, 4 })
+    {
+      long sum = 0;
+      for (size_t x = 0; x < stride; x++)
+      {
+        int a = (x >= (size_t)channels) ? row[x - channels] : 0;
+        int b = up ? up[x] : 0;
+        int c = (up && x >= (size_t)channels) ? up[x - channels] : 0;
+        int predictor = (filter == 1) ? a : (filter == 2) ? b : Paeth(a, b, c);
+        candidate[x] = (unsigned char)(row[x] - predictor);
+        sum += (candidate[x] < 128) ? candidate[x] : 256 - candidate[x];
+      }
+      if (best_sum < 0 || sum < best_sum)
+      {
+        best_sum = sum;
+        dst[0] = (unsigned char)filter;
+        std::copy(candidate.begin(), candidate.end(), dst + 1);
+      }
+    }
+  }
+
+  std::vector<unsigned char> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+  std::vector<unsigned char> header;
+  AppendBigEndian(header, (unsigned int)width);
+  AppendBigEndian(header, (unsigned int)height);
+  // Bit depth, color type (2: RGB, 6: RGBA), compression, filter and interlace methods
+  header.push_back(8);
+  header.push_back(channels == 4 ? 6 : 2);
+  header.push_back(0);
+  header.push_back(0);
+  header.push_back(0);
+  AppendChunk(png, "IHDR", header);
+
+  std::vector<unsigned char> compressed;
+  Compress(filtered, compressed);
+  AppendChunk(png, "IDAT", compressed);
+  AppendChunk(png, "IEND", std::vector<unsigned char>());
+
+  FILE* file = fopen(filename.c_str(), "wb");
+  if (!file) return false;
+  bool written = fwrite(png.data(), 1, png.size(), file) == png.size();
+  return (fclose(file) == 0) && written;
+}
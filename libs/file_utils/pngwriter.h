@@ -0,0 +1,21 @@
+/**
+ * PNG file writer
+ *
+ * Writes 8 bit RGB and RGBA images without external libraries, for the builds
+ *   without the IM library (CPPVOLREND_IM off, e.g. the headless build).
+ * Each row takes the PNG filter (Sub, Up or Paeth) with the smallest sum of
+ *   residuals, and the image data is compressed with the fixed Huffman codes
+ *   of deflate, with matches found through hash chains of 3 bytes.
+**/
+#ifndef FILE_UTILS_PNGWRITER_H
+#define FILE_UTILS_PNGWRITER_H
+
+#include <string>
+
+// channels: 3 (RGB) or 4 (RGBA)
+// bottom_to_top: the first row of data is the bottom of the image, as read by glReadPixels
+// Returns false if the file could not be written
+bool WritePNGFile (const std::string& filename, int width, int height, int channels,
+                   const unsigned char* data, bool bottom_to_top = true);
+
+#endif
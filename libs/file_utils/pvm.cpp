@@ -224,7 +224,7 @@ unsigned char* DDSV3::readPVMvolume (const char* filename,
     else return(NULL);
 
     ptr = &data[5];
-    if (sscanf_s((char*)ptr, "%d %d %d\n%g %g %g\n", width, height, depth, &sx, &sy, &sz) != 6) ERRORMSG();
+    if (sscanf((char*)ptr, "%d %d %d\n%g %g %g\n", width, height, depth, &sx, &sy, &sz) != 6) ERRORMSG();
     if (*width < 1 || *height < 1 || *depth < 1 || sx <= 0.0f || sy <= 0.0f || sz <= 0.0f) ERRORMSG();
     ptr = (unsigned char*)strchr((char*)ptr, '\n') + 1;
   }
@@ -234,7 +234,7 @@ unsigned char* DDSV3::readPVMvolume (const char* filename,
     while (*ptr == '#')
       while (*ptr++ != '\n');
 
-    if (sscanf_s((char*)ptr, "%d %d %d\n", width, height, depth) != 3) ERRORMSG();
+    if (sscanf((char*)ptr, "%d %d %d\n", width, height, depth) != 3) ERRORMSG();
     if (*width < 1 || *height < 1 || *depth < 1) ERRORMSG();
   }
 
@@ -246,7 +246,7 @@ unsigned char* DDSV3::readPVMvolume (const char* filename,
   }
 
   ptr = (unsigned char*)strchr((char*)ptr, '\n') + 1;
-  if (sscanf_s((char *)ptr, "%d\n", &numc) != 1) ERRORMSG();
+  if (sscanf((char *)ptr, "%d\n", &numc) != 1) ERRORMSG();
   if (numc<1) ERRORMSG();
 
   if (components != NULL) *components = numc;
@@ -331,7 +331,7 @@ unsigned char* DDSV3::readPNMimage (const char* filename,
   memcpy(str, data, 3);
   str[3] = '\0';
 
-  if (sscanf_s(str, "P%1d\n", &pnmtype) != 1) return(NULL);
+  if (sscanf(str, "P%1d\n", &pnmtype) != 1) return(NULL);
 
   ptr1 = data + 3;
   while (*ptr1 == '\n' || *ptr1 == '#')
@@ -360,7 +360,7 @@ unsigned char* DDSV3::readPNMimage (const char* filename,
   memcpy(str, ptr1, ptr2 - ptr1);
   str[ptr2 - ptr1] = '\0';
 
-  if (sscanf_s(str, "%d %d\n%d\n", width, height, &maxval) != 3) ERRORMSG();
+  if (sscanf(str, "%d %d\n%d\n", width, height, &maxval) != 3) ERRORMSG();
 
   if (*width<1 || *height<1) ERRORMSG();
 
@@ -523,7 +523,6 @@ unsigned char* DDSV3::readDDSfile (const char *filename, unsigned int *bytes)
   int version = 1;
 
   FILE *file;
-  errno_t err;
 
   int cnt;
 
@@ -531,7 +530,7 @@ unsigned char* DDSV3::readDDSfile (const char *filename, unsigned int *bytes)
   unsigned int size;
 
 
-  if ((err = fopen_s(&file, filename, "rb")) != 0) return(NULL);
+  if ((file = fopen(filename, "rb")) == NULL) return(NULL);
 
   for (cnt = 0; DDS_ID[cnt] != '\0'; cnt++)
   {
@@ -545,7 +544,7 @@ unsigned char* DDSV3::readDDSfile (const char *filename, unsigned int *bytes)
 
   if (version == 0)
   {
-    if ((err = fopen_s(&file, filename, "rb")) != 0) return(NULL);
+    if ((file = fopen(filename, "rb")) == NULL) return(NULL);
 
     for (cnt = 0; DDS_ID2[cnt] != '\0'; cnt++)
     {
@@ -609,11 +608,10 @@ unsigned char* DDSV3::readRAWfiled (FILE *file, unsigned int *bytes)
 unsigned char* DDSV3::readRAWfile (const char *filename, unsigned int *bytes)
 {
   FILE* file;
-  errno_t err;
 
   unsigned char* data;
 
-  if ((err = fopen_s(&file, filename, "rb")) != 0) return(NULL);
+  if ((file = fopen(filename, "rb")) == NULL) return(NULL);
 
   data = readRAWfiled(file, bytes);
 
@@ -11,9 +11,8 @@ IRAWLoader::IRAWLoader (std::string filename, size_t bytes_per_pixel, size_t num
   m_typesize = type_size;
 
   FILE *fp;
-  errno_t err;
 
-  if((err = fopen_s(&fp, filename.c_str(), "rb")) != 0)
+  if((fp = fopen(filename.c_str(), "rb")) == NULL)
   {
     std::cout << "IRAWLoader: opening .raw file failed" << std::endl;
     exit(EXIT_FAILURE);
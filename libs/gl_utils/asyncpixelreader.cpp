@@ -0,0 +1,96 @@
+#include "asyncpixelreader.h"
+#include "profiler.h"
+
+#include <cstring>
+
+namespace gl
+{
+  AsyncPixelReader::AsyncPixelReader (int n_buffers)
+    : buffers(n_buffers < 1 ? 1 : n_buffers, Buffer{ 0, 0, 0, 0, 0 })
+    , next(0)
+  {
+  }
+
+  AsyncPixelReader::~AsyncPixelReader ()
+  {
+    Destroy();
+  }
+
+  void AsyncPixelReader::ReadPixels (int width, int height, bool alpha)
+  {
+    PROFILE_ZONE("ReadPixels");
+    // the caller must Collect the oldest read first
+    if (IsFull()) return;
+
+    Buffer& b = buffers[next];
+    if (!b.pbo) glGenBuffers(1, &b.pbo);
+
+    GLsizeiptr size = (GLsizeiptr)(alpha ? 4 : 3) * width * height;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, b.pbo);
+    if (size != b.size)
+    {
+      glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+      b.size = size;
+    }
+
+    glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    // with a bound pixel pack buffer, the last argument is an offset into the buffer
+    glReadPixels(0, 0, width, height, (alpha ? GL_RGBA : GL_RGB), GL_UNSIGNED_BYTE, 0);
+    glPopClientAttrib();
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    b.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    b.width = width;
+    b.height = height;
+    // the fence must reach the GPU, or waiting on it may never return
+    glFlush();
+
+    pending.push_back(next);
+    next = (next + 1) % (int)buffers.size();
+  }
+
+  bool AsyncPixelReader::Collect (std::vector<unsigned char>& pixels, int& width, int& height, bool wait)
+  {
+    if (pending.empty()) return false;
+    PROFILE_ZONE("Collect Pixels");
+
+    Buffer& b = buffers[pending.front()];
+    GLenum status = glClientWaitSync(b.fence, 0, 0);
+    while (wait && status == GL_TIMEOUT_EXPIRED)
+      status = glClientWaitSync(b.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+    if (status == GL_TIMEOUT_EXPIRED) return false;
+
+    glDeleteSync(b.fence);
+    b.fence = 0;
+    pending.pop_front();
+
+    width = b.width;
+    height = b.height;
+
+    // black pixels if the buffer cannot be mapped, the read is consumed anyway
+    pixels.assign((size_t)b.size, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, b.pbo);
+    void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, b.size, GL_MAP_READ_BIT);
+    if (data)
+    {
+      memcpy(pixels.data(), data, (size_t)b.size);
+      glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    return true;
+  }
+
+  void AsyncPixelReader::Destroy ()
+  {
+    for (Buffer& b : buffers)
+    {
+      if (b.fence) glDeleteSync(b.fence);
+      if (b.pbo) glDeleteBuffers(1, &b.pbo);
+      b = Buffer{ 0, 0, 0, 0, 0 };
+    }
+    pending.clear();
+    next = 0;
+  }
+}
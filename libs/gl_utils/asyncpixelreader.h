@@ -0,0 +1,56 @@
+/**
+ * Asynchronous read back of the frame buffer.
+ *
+ * glReadPixels writes into a pixel pack buffer and returns without waiting
+ * for the GPU. A fence marks the end of the copy: the pixels are mapped and
+ * copied to the application when the fence is signaled, usually one or more
+ * frames later.
+**/
+#ifndef GL_UTILS_ASYNC_PIXEL_READER_H
+#define GL_UTILS_ASYNC_PIXEL_READER_H
+
+#include <GL/glew.h>
+
+#include <deque>
+#include <vector>
+
+namespace gl
+{
+  class AsyncPixelReader
+  {
+  public:
+    AsyncPixelReader (int n_buffers = 2);
+    ~AsyncPixelReader ();
+
+    // All the buffers have a read in flight: Collect the oldest one before the next ReadPixels
+    bool IsFull () { return (int)pending.size() == (int)buffers.size(); }
+    int GetNumberOfPendingReads () { return (int)pending.size(); }
+
+    // Starts reading the GL_RGB(A)/GL_UNSIGNED_BYTE pixels of the current read buffer
+    void ReadPixels (int width, int height, bool alpha);
+
+    // Copies the pixels of the oldest pending read, rows bottom to top as glReadPixels.
+    // Returns false if there is no pending read, or if it is not finished and wait is false.
+    // Each read is returned once, in the order of the ReadPixels calls.
+    bool Collect (std::vector<unsigned char>& pixels, int& width, int& height, bool wait);
+
+    // Deletes the buffers, they are created again by the next ReadPixels
+    void Destroy ();
+
+  protected:
+  private:
+    struct Buffer
+    {
+      GLuint pbo;
+      GLsizeiptr size;
+      GLsync fence;
+      int width, height;
+    };
+    std::vector<Buffer> buffers;
+    // reads in flight, oldest first
+    std::deque<int> pending;
+    int next;
+  };
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include "bufferobject.h"
+#include "memoryregistry.h"
 
 namespace gl
 {
@@ -16,6 +17,7 @@ namespace gl
 
   BufferObject::~BufferObject ()
   {
+    MemoryRegistry::Instance().Unregister(MemoryRegistry::BUFFER, m_id);
     glDeleteBuffers(1, &m_id);
     gl::ExitOnGLError("ERROR: Could not destroy the buffer object");
   }
@@ -35,9 +37,23 @@ namespace gl
   {
     Bind();
     glBufferData(m_target, size, data, usage);
+    MemoryRegistry::Instance().RegisterBuffer(m_id, (size_t)size);
     gl::ExitOnGLError("ERROR: Could not set Buffer Object data");
   }
 
+  void BufferObject::SetBufferSubData (GLintptr offset, GLsizeiptr size, const GLvoid *data)
+  {
+    Bind();
+    glBufferSubData(m_target, offset, size, data);
+    gl::ExitOnGLError("ERROR: Could not update Buffer Object data");
+  }
+
+  void BufferObject::BindBase (GLuint index)
+  {
+    glBindBufferBase(m_target, index, m_id);
+    gl::ExitOnGLError("ERROR: Could not bind the Buffer Object base");
+  }
+
   GLuint BufferObject::GetID ()
   {
     return m_id;
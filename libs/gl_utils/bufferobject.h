@@ -16,6 +16,7 @@ namespace gl
     {
       VERTEXBUFFEROBJECT = GL_ARRAY_BUFFER,
       INDEXBUFFEROBJECT = GL_ELEMENT_ARRAY_BUFFER,
+      SHADERSTORAGEBUFFEROBJECT = GL_SHADER_STORAGE_BUFFER,
     };
 
     BufferObject (GLenum target);
@@ -27,6 +28,10 @@ namespace gl
     //VBO: Bind the VBO to a VAO
     //IBO: Bind the IBO to the VAO
     void SetBufferData (GLsizeiptr size, const GLvoid *data, GLenum usage);
+    void SetBufferSubData (GLintptr offset, GLsizeiptr size, const GLvoid *data);
+
+    //SSBO/UBO: Bind the buffer to an indexed binding point
+    void BindBase (GLuint index);
 
     GLuint GetID ();
 
@@ -1,6 +1,11 @@
 #include "computeshader.h"
+#include "programcache.h"
+#include "profiler.h"
+#include "programcompiler.h"
 #include <gl_utils/utils.h>
 
+#include <chrono>
+
 namespace gl
 {
   ComputeShader::ComputeShader ()
@@ -29,22 +34,67 @@ namespace gl
 
   bool ComputeShader::LoadAndLink ()
   {
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+    // The first program of each shader is compiled in the background in the next sessions
+    ProgramCompiler& compiler = ProgramCompiler::Instance();
+    if (shader_program == -1 && variant_programs.empty())
+    {
+      ProgramCompiler::Stages stages;
+      GetStages(stages);
+      compiler.Record(stages, GetDefinesKey());
+    }
+
+    ProgramCache::Sources sources;
+    for (int i = 0; i < vec_compute_shader_names.size(); i++)
+    {
+      char* shader_source = gl::TextFileRead(vec_compute_shader_names[i].c_str());
+      sources.push_back(std::make_pair((GLenum)GL_COMPUTE_SHADER, InjectDefines(shader_source)));
+      free(shader_source);
+    }
+
+    ProgramCache& cache = ProgramCache::Instance();
+    std::string key = cache.ComputeKey(sources);
+
     // Creates a compute shader and the respective program that contains the shader.
     if (shader_program == -1)
+    {
+      // Already submitted to the driver, e.g. at startup
+      GLuint program = compiler.Take(key);
+      if (program != 0)
+      {
+        shader_program = program;
+        cache.AddBuildTime(true, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+        return true;
+      }
       shader_program = glCreateProgram();
+    }
 
-    for (int i = 0; i < vec_compute_shader_names.size(); i++)
+    // Linked binary of the same sources from a previous run
+    bool use_cache = cache.IsEnabled();
+    if (use_cache && cache.Load(shader_program, key))
+    {
+      cache.AddBuildTime(true, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+      return true;
+    }
+
+    for (int i = 0; i < sources.size(); i++)
     {
       GLuint new_shader = glCreateShader(GL_COMPUTE_SHADER);
       
-      CompileShader(new_shader, vec_compute_shader_names[i]);
+      CompileShader(new_shader, sources[i].second);
       
       vec_compute_shader_ids.push_back(new_shader);
-      assert(vec_compute_shader_ids[i] == new_shader);
+      assert(vec_compute_shader_ids.back() == new_shader);
     
       glAttachShader(shader_program, new_shader);
     }
+
+    // Queried once every stage is submitted, so a parallel compiler builds them together
+    for (int i = 0; i < vec_compute_shader_ids.size(); i++)
+      CheckCompileStatus(vec_compute_shader_ids[i], vec_compute_shader_names[i]);
     
+    if (use_cache) glProgramParameteri(shader_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(shader_program);
     glValidateProgram(shader_program);
 
@@ -62,7 +112,18 @@ namespace gl
       exit(41);
     }
 
+    // The program keeps its binary, the shaders are released so each variant owns only its program
+    for (int i = 0; i < vec_compute_shader_ids.size(); i++)
+    {
+      glDetachShader(shader_program, vec_compute_shader_ids[i]);
+      glDeleteShader(vec_compute_shader_ids[i]);
+    }
+    vec_compute_shader_ids.clear();
+
     gl::ExitOnGLError("gl::ComputeShader >> Unable to load and link shaders.");
+
+    if (use_cache) cache.Store(shader_program, key);
+    cache.AddBuildTime(false, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
     
     return true;
   }
@@ -78,6 +139,8 @@ namespace gl
     }
     vec_compute_shader_ids.clear();
 
+    // The other combinations are linked again from the new sources when used
+    ClearVariants();
     LoadAndLink();
 
     Bind();
@@ -102,6 +165,13 @@ namespace gl
     vec_compute_shader_names.push_back(filepath);
   }
 
+  void ComputeShader::GetStages (std::vector<std::pair<GLenum, std::string>>& stages)
+  {
+    stages.clear();
+    for (int i = 0; i < vec_compute_shader_names.size(); i++)
+      stages.push_back(std::make_pair((GLenum)GL_COMPUTE_SHADER, vec_compute_shader_names[i]));
+  }
+
   void ComputeShader::RecomputeNumberOfGroups (GLuint w, GLuint h, GLuint d, GLuint t_x, GLuint t_y, GLuint t_z)
   {
     num_groups_x = 1;
@@ -119,6 +189,8 @@ namespace gl
 
   void ComputeShader::Dispatch ()
   {
+    PROFILE_ZONE("Dispatch");
+    PROFILE_GPU_ZONE("Dispatch");
     glDispatchCompute(num_groups_x, num_groups_y, num_groups_z);
     gl::ExitOnGLError("ComputeShader: After glDispatchCompute.");
     glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
@@ -135,22 +207,23 @@ namespace gl
   }
 
 
-  void ComputeShader::CompileShader (GLuint shader_id, std::string filename)
+  void ComputeShader::CompileShader (GLuint shader_id, const std::string& source)
   {
-    char* shader_source = gl::TextFileRead(filename.c_str());
-    const char* const_shader_source = shader_source;
+    const char* const_shader_source = source.c_str();
 
     // Second parameters can be > 1 if const_shader_source is an array.
     glShaderSource(shader_id, 1, &const_shader_source, NULL);
-    free(shader_source);
 
     glCompileShader(shader_id);
+  }
 
+  void ComputeShader::CheckCompileStatus (GLuint shader_id, std::string filename)
+  {
     // Check compilation status
     int rvalue;
     glGetShaderiv(shader_id, GL_COMPILE_STATUS, &rvalue);
     if (!rvalue) {
-      fprintf(stderr, "Error in compiling the compute shader\n");
+      fprintf(stderr, "Error in compiling the compute shader \"%s\"\n", filename.c_str());
       GLchar log[10240];
       GLsizei length;
       glGetShaderInfoLog(shader_id, 10239, &length, log);
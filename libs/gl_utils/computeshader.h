@@ -43,12 +43,15 @@ namespace gl
                            GLenum format, GLboolean layered = GL_TRUE, GLint layer = 0);
 
   protected:
+    virtual void GetStages (std::vector<std::pair<GLenum, std::string>>& stages);
 
   private:
     std::vector<std::string> vec_compute_shader_names;
     std::vector<GLuint> vec_compute_shader_ids;
 
-    void CompileShader (GLuint shader_id, std::string filename);
+    void CompileShader (GLuint shader_id, const std::string& source);
+    // Exits with the compiler log if the shader did not compile
+    void CheckCompileStatus (GLuint shader_id, std::string filename);
 
     GLuint num_groups_x;
     GLuint num_groups_y;
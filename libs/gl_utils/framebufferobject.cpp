@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <gl_utils/utils.h>
+#include <gl_utils/memoryregistry.h>
 
 #include <GL/glew.h>
 
@@ -66,6 +67,7 @@ namespace gl
       {
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
       }
+      MemoryRegistry::Instance().RegisterTexture(m_color_attachments[i], bits == 16 ? GL_RGBA16F : GL_RGBA32F, width, height);
     }
 
     if (use_depth_buffer)
@@ -77,6 +79,7 @@ namespace gl
       glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
       glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
       glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+      MemoryRegistry::Instance().RegisterTexture(m_depth_attachment, GL_DEPTH_COMPONENT, width, height);
     }
 
     for (int i = 0; i < GetCurrentNumberOfAttachments(); i++)
@@ -110,10 +113,14 @@ namespace gl
   void FrameBufferObject::DestroyAttachments()
   {
     for (int i = 0; i < GetCurrentNumberOfAttachments(); i++)
+    {
+      MemoryRegistry::Instance().Unregister(MemoryRegistry::TEXTURE, m_color_attachments[i]);
       glDeleteTextures(1, &m_color_attachments[i]);
+    }
 
     if (use_depth_buffer)
     {
+      MemoryRegistry::Instance().Unregister(MemoryRegistry::TEXTURE, m_depth_attachment);
       glDeleteTextures(1, &m_depth_attachment);
     }
   }
@@ -0,0 +1,211 @@
+#include "memoryregistry.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace gl
+{
+  MemoryRegistry::ScopedTag::ScopedTag (const std::string& tag)
+  {
+    MemoryRegistry::Instance().PushTag(tag);
+  }
+
+  MemoryRegistry::ScopedTag::~ScopedTag ()
+  {
+    MemoryRegistry::Instance().PopTag();
+  }
+
+  MemoryRegistry& MemoryRegistry::Instance ()
+  {
+    static MemoryRegistry registry;
+    return registry;
+  }
+
+  MemoryRegistry::MemoryRegistry ()
+    : total_bytes(0), peak_bytes(0), budget_bytes(0)
+  {
+  }
+
+  size_t MemoryRegistry::GetTexelBytes (GLint internalformat)
+  {
+    switch (internalformat)
+    {
+    case GL_R8: case GL_R8I: case GL_R8UI: case GL_RED: case GL_ALPHA: case GL_LUMINANCE:
+      return 1;
+    case GL_R16: case GL_R16F: case GL_R16I: case GL_R16UI: case GL_RG8: case GL_RG: case GL_DEPTH_COMPONENT16:
+      return 2;
+    case GL_RGB8: case GL_RGB:
+      return 3;
+    case GL_R32F: case GL_R32I: case GL_R32UI: case GL_RG16: case GL_RG16F: case GL_RGBA8: case GL_RGBA:
+    case GL_DEPTH_COMPONENT: case GL_DEPTH_COMPONENT24: case GL_DEPTH_COMPONENT32F: case GL_DEPTH24_STENCIL8:
+      return 4;
+    case GL_RGB16F:
+      return 6;
+    case GL_RG32F: case GL_RGBA16: case GL_RGBA16F:
+      return 8;
+    case GL_RGB32F:
+      return 12;
+    case GL_RGBA32F: case GL_RGBA32I: case GL_RGBA32UI:
+      return 16;
+    }
+    return 4;
+  }
+
+  const char* MemoryRegistry::GetFormatName (GLint internalformat)
+  {
+    switch (internalformat)
+    {
+    case 0:                     return "buffer";
+    case GL_R8:                 return "R8";
+    case GL_R16:                return "R16";
+    case GL_R16F:               return "R16F";
+    case GL_R32F:               return "R32F";
+    case GL_R32I:               return "R32I";
+    case GL_R32UI:              return "R32UI";
+    case GL_RG16F:              return "RG16F";
+    case GL_RG32F:              return "RG32F";
+    case GL_RGB8:               return "RGB8";
+    case GL_RGB16F:             return "RGB16F";
+    case GL_RGB32F:             return "RGB32F";
+    case GL_RGBA8:              return "RGBA8";
+    case GL_RGBA16F:            return "RGBA16F";
+    case GL_RGBA32F:            return "RGBA32F";
+    case GL_RED:                return "RED";
+    case GL_RGB:                return "RGB";
+    case GL_RGBA:               return "RGBA";
+    case GL_DEPTH_COMPONENT:    return "DEPTH";
+    case GL_DEPTH_COMPONENT24:  return "DEPTH24";
+    case GL_DEPTH_COMPONENT32F: return "DEPTH32F";
+    }
+    return "other";
+  }
+
+  size_t MemoryRegistry::GetTextureBytes (GLint internalformat, int width, int height, int depth, int levels)
+  {
+    size_t texels = 0;
+    for (int l = 0; l < levels; l++)
+      texels += (size_t)std::max(width >> l, 1) * (size_t)std::max(height >> l, 1) * (size_t)std::max(depth >> l, 1);
+    return texels * GetTexelBytes(internalformat);
+  }
+
+  void MemoryRegistry::RegisterTexture (GLuint id, GLint internalformat, int width, int height, int depth, int levels, const char* tag)
+  {
+    Allocation allocation;
+    allocation.kind = TEXTURE;
+    allocation.id = id;
+    allocation.internalformat = internalformat;
+    allocation.width = width;
+    allocation.height = height;
+    allocation.depth = depth;
+    allocation.levels = levels;
+    allocation.bytes = GetTextureBytes(internalformat, width, height, depth, levels);
+    if (tag) allocation.tag = tag;
+    Insert(allocation);
+  }
+
+  void MemoryRegistry::RegisterBuffer (GLuint id, size_t bytes, const char* tag)
+  {
+    Allocation allocation;
+    allocation.kind = BUFFER;
+    allocation.id = id;
+    allocation.internalformat = 0;
+    allocation.width = (int)bytes;
+    allocation.height = 1;
+    allocation.depth = 1;
+    allocation.levels = 1;
+    allocation.bytes = bytes;
+    if (tag) allocation.tag = tag;
+    Insert(allocation);
+  }
+
+  void MemoryRegistry::RegisterProgram (GLuint id, size_t bytes, const char* tag)
+  {
+    Allocation allocation;
+    allocation.kind = PROGRAM;
+    allocation.id = id;
+    allocation.internalformat = 0;
+    allocation.width = (int)bytes;
+    allocation.height = 1;
+    allocation.depth = 1;
+    allocation.levels = 1;
+    allocation.bytes = bytes;
+    if (tag) allocation.tag = tag;
+    Insert(allocation);
+  }
+
+  void MemoryRegistry::Unregister (KIND kind, GLuint id)
+  {
+    auto it = allocations.find(std::make_pair((int)kind, id));
+    if (it == allocations.end()) return;
+    total_bytes -= it->second.bytes;
+    allocations.erase(it);
+  }
+
+  void MemoryRegistry::PushTag (const std::string& tag)
+  {
+    tags.push_back(tag);
+  }
+
+  void MemoryRegistry::PopTag ()
+  {
+    if (!tags.empty()) tags.pop_back();
+  }
+
+  std::string MemoryRegistry::GetCurrentTag ()
+  {
+    return tags.empty() ? "Untagged" : tags.back();
+  }
+
+  std::map<std::string, size_t> MemoryRegistry::GetBytesPerTag ()
+  {
+    std::map<std::string, size_t> bytes;
+    for (auto& it : allocations)
+      bytes[it.second.tag] += it.second.bytes;
+    return bytes;
+  }
+
+  std::vector<MemoryRegistry::Allocation> MemoryRegistry::GetAllocations ()
+  {
+    std::vector<Allocation> ret;
+    ret.reserve(allocations.size());
+    for (auto& it : allocations)
+      ret.push_back(it.second);
+
+    std::sort(ret.begin(), ret.end(), [](const Allocation& a, const Allocation& b)
+    {
+      if (a.tag != b.tag) return a.tag < b.tag;
+      return a.bytes > b.bytes;
+    });
+    return ret;
+  }
+
+  size_t MemoryRegistry::GetAvailableBytes ()
+  {
+    if (!HasBudget()) return std::numeric_limits<size_t>::max();
+    return budget_bytes > total_bytes ? budget_bytes - total_bytes : 0;
+  }
+
+  bool MemoryRegistry::Fits (size_t bytes, size_t freed_bytes)
+  {
+    if (!HasBudget()) return true;
+    size_t used = total_bytes - std::min(freed_bytes, total_bytes);
+    return used + bytes <= budget_bytes;
+  }
+
+  void MemoryRegistry::Insert (const Allocation& allocation)
+  {
+    Allocation a = allocation;
+    auto key = std::make_pair((int)a.kind, a.id);
+    auto it = allocations.find(key);
+    if (it != allocations.end())
+    {
+      if (a.tag.empty()) a.tag = it->second.tag;
+      total_bytes -= it->second.bytes;
+    }
+    if (a.tag.empty()) a.tag = GetCurrentTag();
+
+    allocations[key] = a;
+    total_bytes += a.bytes;
+    peak_bytes = std::max(peak_bytes, total_bytes);
+  }
+}
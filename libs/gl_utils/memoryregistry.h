@@ -0,0 +1,109 @@
+/**
+ * Registry of the GPU memory allocated by the application.
+ *
+ * Every texture and buffer storage is recorded with its format, dimensions,
+ * size in bytes and an owner tag, so the memory used by the volume, the
+ * transfer function and each renderer can be inspected and compared.
+ * gl::Texture1D/2D/3D, gl::BufferObject and gl::FrameBufferObject register
+ * themselves; objects created with raw gl calls are registered by their owner.
+ * gl::ProgramCompiler registers the programs it holds until they are taken.
+ *
+ * The sizes are computed from the formats: drivers may add padding, mipmaps
+ * of GL_GENERATE_MIPMAP are not counted.
+ *
+ * An optional budget limits the memory of the optional structures (e.g. light
+ * caches), which choose a lower resolution when they do not fit.
+**/
+#ifndef GL_UTILS_MEMORY_REGISTRY_H
+#define GL_UTILS_MEMORY_REGISTRY_H
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gl
+{
+  class MemoryRegistry
+  {
+  public:
+    enum KIND
+    {
+      TEXTURE,
+      BUFFER,
+      PROGRAM,
+    };
+
+    struct Allocation
+    {
+      KIND kind;
+      GLuint id;
+      // 0 for buffers and programs
+      GLint internalformat;
+      int width, height, depth;
+      int levels;
+      size_t bytes;
+      std::string tag;
+    };
+
+    // Allocations made while a ScopedTag is alive get its tag
+    class ScopedTag
+    {
+    public:
+      ScopedTag (const std::string& tag);
+      ~ScopedTag ();
+    };
+
+    static MemoryRegistry& Instance ();
+
+    // Bytes of a texel of a sized or unsized internal format, 4 if unknown
+    static size_t GetTexelBytes (GLint internalformat);
+    static const char* GetFormatName (GLint internalformat);
+    // Halving each dimension per mipmap level
+    static size_t GetTextureBytes (GLint internalformat, int width, int height, int depth, int levels = 1);
+
+    // Registering an id again replaces its allocation (e.g. glTexImage on the same texture).
+    // Without a tag, a replaced allocation keeps its tag, a new one gets the current tag.
+    void RegisterTexture (GLuint id, GLint internalformat, int width, int height = 1, int depth = 1, int levels = 1, const char* tag = nullptr);
+    void RegisterBuffer (GLuint id, size_t bytes, const char* tag = nullptr);
+    // Size of the linked binary (GL_PROGRAM_BINARY_LENGTH), the driver may keep more
+    void RegisterProgram (GLuint id, size_t bytes, const char* tag = nullptr);
+    void Unregister (KIND kind, GLuint id);
+
+    void PushTag (const std::string& tag);
+    void PopTag ();
+    std::string GetCurrentTag ();
+
+    size_t GetTotalBytes () { return total_bytes; }
+    size_t GetPeakBytes () { return peak_bytes; }
+    void ResetPeak () { peak_bytes = total_bytes; }
+    std::map<std::string, size_t> GetBytesPerTag ();
+    // Sorted by tag, then by size
+    std::vector<Allocation> GetAllocations ();
+
+    // 0 disables the budget
+    void SetBudget (size_t bytes) { budget_bytes = bytes; }
+    size_t GetBudget () { return budget_bytes; }
+    bool HasBudget () { return budget_bytes > 0; }
+    // Bytes left in the budget, the largest size_t without budget
+    size_t GetAvailableBytes ();
+    // freed_bytes: memory that is released before the new allocation is made
+    bool Fits (size_t bytes, size_t freed_bytes = 0);
+
+  protected:
+  private:
+    MemoryRegistry ();
+    void Insert (const Allocation& allocation);
+
+    std::map<std::pair<int, GLuint>, Allocation> allocations;
+    std::vector<std::string> tags;
+    size_t total_bytes;
+    size_t peak_bytes;
+    size_t budget_bytes;
+  };
+}
+
+#endif
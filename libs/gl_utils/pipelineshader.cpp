@@ -1,8 +1,11 @@
 #include "pipelineshader.h"
+#include "programcache.h"
+#include "programcompiler.h"
 #include "utils.h"
 
 #include <GL/glew.h>
 
+#include <chrono>
 #include <cstdio>
 #include <iostream>
 #include <cerrno>
@@ -114,51 +117,93 @@ PipelineShader::~PipelineShader()
 
 bool PipelineShader::LoadAndLink()
 {
-  if (shader_program == -1)
-    shader_program = glCreateProgram();
+  std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
 
-  for (unsigned int i = 0; i < vec_vertex_shaders_names.size(); i++)
+  // The first program of each shader is compiled in the background in the next sessions
+  ProgramCompiler& compiler = ProgramCompiler::Instance();
+  if (shader_program == -1 && variant_programs.empty())
   {
-    GLuint new_shader = glCreateShader(GL_VERTEX_SHADER);
-    CompileShader(new_shader, vec_vertex_shaders_names[i]);
-
-    vec_vertex_shaders_ids.push_back(new_shader);
-    assert(vec_vertex_shaders_ids[i] == new_shader);
-
-    glAttachShader(shader_program, new_shader);
+    ProgramCompiler::Stages stages;
+    GetStages(stages);
+    compiler.Record(stages, GetDefinesKey());
   }
 
-  for (unsigned int i = 0; i < vec_fragment_shaders_names.size(); i++)
+  ProgramCache::Sources sources;
+  auto read_sources = [this, &sources](GLenum type, const std::vector<std::string>& names)
   {
-    GLuint new_shader = glCreateShader(GL_FRAGMENT_SHADER);
-    CompileShader(new_shader, vec_fragment_shaders_names[i]);
+    for (unsigned int i = 0; i < names.size(); i++)
+    {
+      char* shader_source = TextFileRead(names[i].c_str());
+      sources.push_back(std::make_pair(type, InjectDefines(shader_source)));
+      free(shader_source);
+    }
+  };
+  read_sources(GL_VERTEX_SHADER, vec_vertex_shaders_names);
+  read_sources(GL_FRAGMENT_SHADER, vec_fragment_shaders_names);
+  read_sources(GL_GEOMETRY_SHADER, vec_geometry_shaders_names);
 
-    vec_fragment_shaders_ids.push_back(new_shader);
-    assert(vec_fragment_shaders_ids[i] == new_shader);
+  ProgramCache& cache = ProgramCache::Instance();
+  std::string key = cache.ComputeKey(sources);
 
-    glAttachShader(shader_program, new_shader);
+  if (shader_program == -1)
+  {
+    // Already submitted to the driver, e.g. at startup
+    GLuint program = compiler.Take(key);
+    if (program != 0)
+    {
+      shader_program = program;
+      cache.AddBuildTime(true, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+      return true;
+    }
+    shader_program = glCreateProgram();
   }
 
-  for (unsigned int i = 0; i < vec_geometry_shaders_names.size(); i++)
+  // Linked binary of the same sources from a previous run
+  bool use_cache = cache.IsEnabled();
+  if (use_cache && cache.Load(shader_program, key))
   {
-    GLuint new_shader = glCreateShader(GL_GEOMETRY_SHADER);
-    CompileShader(new_shader, vec_geometry_shaders_names[i]);
+    cache.AddBuildTime(true, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+    return true;
+  }
 
-    vec_geometry_shaders_ids.push_back(new_shader);
-    assert(vec_geometry_shaders_ids[i] == new_shader);
+  for (unsigned int i = 0; i < sources.size(); i++)
+  {
+    GLuint new_shader = glCreateShader(sources[i].first);
+    const char* const_shader_source = sources[i].second.c_str();
+    glShaderSource(new_shader, 1, &const_shader_source, NULL);
+    glCompileShader(new_shader);
+
+    if (sources[i].first == GL_VERTEX_SHADER)
+      vec_vertex_shaders_ids.push_back(new_shader);
+    else if (sources[i].first == GL_FRAGMENT_SHADER)
+      vec_fragment_shaders_ids.push_back(new_shader);
+    else
+      vec_geometry_shaders_ids.push_back(new_shader);
 
     glAttachShader(shader_program, new_shader);
   }
 
+  if (use_cache) glProgramParameteri(shader_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
   glLinkProgram(shader_program);
 
   gl::ExitOnGLError("GLShader: Unable to load and link shaders.");
+
+  GLint linked = GL_FALSE;
+  glGetProgramiv(shader_program, GL_LINK_STATUS, &linked);
+
+  // The program keeps its binary, the shaders are released so each variant owns only its program
+  Clear();
+  if (use_cache && linked == GL_TRUE) cache.Store(shader_program, key);
+  cache.AddBuildTime(false, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+
   return true;
 }
 
 bool PipelineShader::Reload()
 {
   Clear();
+  // The other combinations are linked again from the new sources when used
+  ClearVariants();
 
   LoadAndLink();
   Bind();
@@ -221,4 +266,15 @@ void PipelineShader::SetGeometryShaderPrimitives(GS_INPUT in, GS_OUTPUT out)
   glProgramParameteriEXT(shader_program, GL_GEOMETRY_VERTICES_OUT_EXT, temp);
 }
 
+void PipelineShader::GetStages (std::vector<std::pair<GLenum, std::string>>& stages)
+{
+  stages.clear();
+  for (unsigned int i = 0; i < vec_vertex_shaders_names.size(); i++)
+    stages.push_back(std::make_pair((GLenum)GL_VERTEX_SHADER, vec_vertex_shaders_names[i]));
+  for (unsigned int i = 0; i < vec_fragment_shaders_names.size(); i++)
+    stages.push_back(std::make_pair((GLenum)GL_FRAGMENT_SHADER, vec_fragment_shaders_names[i]));
+  for (unsigned int i = 0; i < vec_geometry_shaders_names.size(); i++)
+    stages.push_back(std::make_pair((GLenum)GL_GEOMETRY_SHADER, vec_geometry_shaders_names[i]));
+}
+
 }
\ No newline at end of file
@@ -76,6 +76,9 @@ namespace gl
     void SetGeometryShaderPrimitives(GLenum in, GLenum out);
     void SetGeometryShaderPrimitives(PipelineShader::GS_INPUT in, PipelineShader::GS_OUTPUT out);
 
+  protected:
+    virtual void GetStages (std::vector<std::pair<GLenum, std::string>>& stages);
+
   private:
     std::vector<std::string> vec_vertex_shaders_names;
     std::vector<std::string> vec_fragment_shaders_names;
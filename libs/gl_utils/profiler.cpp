@@ -0,0 +1,336 @@
+#include "profiler.h"
+
+#include <cstdio>
+
+namespace gl
+{
+  namespace
+  {
+    thread_local void* t_buffer = nullptr;
+
+    void WriteEscaped (FILE* file, const char* s)
+    {
+      for (; *s; s++)
+      {
+        if (*s == '"' || *s == '\\') fputc('\\', file);
+        if ((unsigned char)*s >= 0x20) fputc(*s, file);
+      }
+    }
+  }
+
+  Profiler::CPUZone::CPUZone (const char* _name)
+    : name(nullptr), start_us(0.0)
+  {
+    Profiler& profiler = Profiler::Instance();
+    if (!profiler.IsCapturing()) return;
+    name = _name;
+    start_us = profiler.GetTime();
+  }
+
+  Profiler::CPUZone::CPUZone (const std::string& _name)
+    : name(nullptr), start_us(0.0)
+  {
+    Profiler& profiler = Profiler::Instance();
+    if (!profiler.IsCapturing()) return;
+    name = profiler.Intern(_name);
+    start_us = profiler.GetTime();
+  }
+
+  Profiler::CPUZone::~CPUZone ()
+  {
+    if (!name) return;
+    Profiler& profiler = Profiler::Instance();
+    double end_us = profiler.GetTime();
+    profiler.Record(profiler.GetThreadBuffer(), name, start_us, end_us - start_us);
+  }
+
+  Profiler::GPUZone::GPUZone (const char* name)
+    : query(-1)
+  {
+    Profiler& profiler = Profiler::Instance();
+    if (profiler.IsCapturing()) query = profiler.BeginGPUZone(name);
+  }
+
+  Profiler::GPUZone::GPUZone (const std::string& name)
+    : query(-1)
+  {
+    Profiler& profiler = Profiler::Instance();
+    if (profiler.IsCapturing()) query = profiler.BeginGPUZone(profiler.Intern(name));
+  }
+
+  Profiler::GPUZone::~GPUZone ()
+  {
+    if (query >= 0) Profiler::Instance().EndGPUZone(query);
+  }
+
+  Profiler& Profiler::Instance ()
+  {
+    static Profiler profiler;
+    return profiler;
+  }
+
+  Profiler::Profiler ()
+    : creation(std::chrono::steady_clock::now())
+    , capturing(false)
+    , stop_requested(false)
+    , capture_frames(0)
+    , captured_frames(0)
+    , buffer_size(64 * 1024)
+    , frame_start_us(0.0)
+    , gpu_first_query(0)
+    , gpu_offset_us(0.0)
+  {
+    gpu_buffer.next = gpu_buffer.count = 0;
+    gpu_buffer.tid = 0;
+    gpu_buffer.name = "GPU";
+  }
+
+  Profiler::~Profiler ()
+  {
+    // Queries are released with the context, which is already destroyed here
+  }
+
+  void Profiler::Start (const std::string& filepath, int n_frames)
+  {
+    if (IsCapturing()) Finish();
+
+    {
+      std::lock_guard<std::mutex> lock(buffers_mutex);
+      for (std::unique_ptr<ThreadBuffer>& buffer : buffers)
+      {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        buffer->next = buffer->count = 0;
+        if (!buffer->zones.empty() && buffer->zones.size() != buffer_size) buffer->zones.assign(buffer_size, Zone());
+      }
+    }
+    gpu_buffer.next = gpu_buffer.count = 0;
+    if (gpu_buffer.zones.size() != buffer_size) gpu_buffer.zones.assign(buffer_size, Zone());
+
+    // Zones not ended by the last capture
+    for (const GPUQuery& q : gpu_queries)
+    {
+      free_queries.push_back(q.begin);
+      free_queries.push_back(q.end);
+    }
+    gpu_first_query += (long long)gpu_queries.size();
+    gpu_queries.clear();
+
+    capture_file = filepath;
+    capture_frames = n_frames;
+    captured_frames = 0;
+    stop_requested = false;
+    CalibrateGPUTime();
+    frame_start_us = GetTime();
+    capturing = true;
+  }
+
+  void Profiler::Stop ()
+  {
+    stop_requested = true;
+  }
+
+  bool Profiler::Finish ()
+  {
+    if (!IsCapturing()) return false;
+    capturing = false;
+    stop_requested = false;
+
+    ReadBackGPUZones(true);
+    bool written = Write(capture_file);
+    if (written)
+    {
+      last_file = capture_file;
+      printf("gl::Profiler: %d frames written to \"%s\"\n", captured_frames, capture_file.c_str());
+    }
+    else
+      fprintf(stderr, "gl::Profiler: could not write \"%s\"\n", capture_file.c_str());
+    return written;
+  }
+
+  void Profiler::EndFrame ()
+  {
+    if (!IsCapturing()) return;
+
+    // From the previous frame boundary, on the track of the context thread
+    double now_us = GetTime();
+    Record(GetThreadBuffer(), "Frame", frame_start_us, now_us - frame_start_us);
+    frame_start_us = now_us;
+
+    captured_frames++;
+    ReadBackGPUZones(false);
+    CalibrateGPUTime();
+
+    if (stop_requested || (capture_frames > 0 && captured_frames >= capture_frames))
+      Finish();
+  }
+
+  void Profiler::SetThreadName (const std::string& name)
+  {
+    ThreadBuffer* buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    buffer->name = name;
+  }
+
+  double Profiler::GetTime ()
+  {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - creation).count();
+  }
+
+  Profiler::ThreadBuffer* Profiler::GetThreadBuffer ()
+  {
+    if (t_buffer) return (ThreadBuffer*)t_buffer;
+
+    // Kept until the end of the application, so the zones of finished threads are written too
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+    buffer->next = buffer->count = 0;
+    buffer->tid = (int)buffers.size() + 1;
+    buffer->name = "Thread " + std::to_string(buffer->tid);
+    t_buffer = buffer.get();
+    buffers.push_back(std::move(buffer));
+    return (ThreadBuffer*)t_buffer;
+  }
+
+  void Profiler::Record (ThreadBuffer* buffer, const char* name, double start_us, double duration_us)
+  {
+    // Only contended while the capture is written
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    if (buffer->zones.empty()) buffer->zones.assign(buffer_size, Zone());
+    if (buffer->zones.empty()) return;
+
+    Zone& zone = buffer->zones[buffer->next];
+    zone.name = name;
+    zone.start_us = start_us;
+    zone.duration_us = duration_us;
+    buffer->next = (buffer->next + 1) % buffer->zones.size();
+    if (buffer->count < buffer->zones.size()) buffer->count++;
+  }
+
+  const char* Profiler::Intern (const std::string& name)
+  {
+    // Nodes of the set are not moved, the pointers stay valid
+    std::lock_guard<std::mutex> lock(names_mutex);
+    return names.insert(name).first->c_str();
+  }
+
+  long long Profiler::BeginGPUZone (const char* name)
+  {
+    if (free_queries.size() < 2)
+    {
+      GLuint queries[32];
+      glGenQueries(32, queries);
+      free_queries.insert(free_queries.end(), queries, queries + 32);
+    }
+
+    GPUQuery q;
+    q.name = name;
+    q.end = free_queries.back();
+    free_queries.pop_back();
+    q.begin = free_queries.back();
+    free_queries.pop_back();
+    q.ended = false;
+    q.offset_us = gpu_offset_us;
+
+    // Timestamps, unlike GL_TIME_ELAPSED, can be nested
+    glQueryCounter(q.begin, GL_TIMESTAMP);
+    gpu_queries.push_back(q);
+    return gpu_first_query + (long long)gpu_queries.size() - 1;
+  }
+
+  void Profiler::EndGPUZone (long long query)
+  {
+    // Discarded by a new capture
+    if (query < gpu_first_query || query >= gpu_first_query + (long long)gpu_queries.size()) return;
+
+    GPUQuery& q = gpu_queries[(size_t)(query - gpu_first_query)];
+    glQueryCounter(q.end, GL_TIMESTAMP);
+    q.ended = true;
+  }
+
+  void Profiler::ReadBackGPUZones (bool wait)
+  {
+    // In the order they began, the queries of a zone are done after the ones of the zones before
+    while (!gpu_queries.empty())
+    {
+      GPUQuery& q = gpu_queries.front();
+      if (!q.ended)
+      {
+        if (!wait) return;
+        // Not ended when the capture finished
+        free_queries.push_back(q.begin);
+        free_queries.push_back(q.end);
+        gpu_queries.pop_front();
+        gpu_first_query++;
+        continue;
+      }
+
+      if (!wait)
+      {
+        GLint available = 0;
+        glGetQueryObjectiv(q.end, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) return;
+      }
+
+      GLuint64 begin_ns = 0, end_ns = 0;
+      glGetQueryObjectui64v(q.begin, GL_QUERY_RESULT, &begin_ns);
+      glGetQueryObjectui64v(q.end, GL_QUERY_RESULT, &end_ns);
+      Record(&gpu_buffer, q.name, begin_ns / 1000.0 + q.offset_us, (end_ns - begin_ns) / 1000.0);
+
+      free_queries.push_back(q.begin);
+      free_queries.push_back(q.end);
+      gpu_queries.pop_front();
+      gpu_first_query++;
+    }
+  }
+
+  void Profiler::CalibrateGPUTime ()
+  {
+    // GPU time when the previous commands reached the GPU, close enough to the CPU time of the call
+    GLint64 gpu_ns = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpu_ns);
+    gpu_offset_us = GetTime() - gpu_ns / 1000.0;
+  }
+
+  bool Profiler::Write (const std::string& filepath)
+  {
+    FILE* file = fopen(filepath.c_str(), "w");
+    if (!file) return false;
+
+    std::vector<ThreadBuffer*> tracks;
+    tracks.push_back(&gpu_buffer);
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    for (std::unique_ptr<ThreadBuffer>& buffer : buffers)
+      tracks.push_back(buffer.get());
+
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    bool first = true;
+    for (ThreadBuffer* track : tracks)
+    {
+      std::lock_guard<std::mutex> buffer_lock(track->mutex);
+      if (track->count == 0) continue;
+
+      fprintf(file, "%s{\"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"name\": \"thread_name\", \"args\": {\"name\": \"",
+        first ? "" : ",\n", track->tid);
+      WriteEscaped(file, track->name.c_str());
+      fprintf(file, "\"}},\n{\"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"name\": \"thread_sort_index\", \"args\": {\"sort_index\": %d}}",
+        track->tid, track->tid);
+      first = false;
+
+      // Oldest first
+      size_t size = track->zones.size();
+      for (size_t i = 0; i < track->count; i++)
+      {
+        const Zone& zone = track->zones[(track->next + size - track->count + i) % size];
+        fprintf(file, ",\n{\"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"cat\": \"%s\", \"name\": \"",
+          track->tid, track == &gpu_buffer ? "gpu" : "cpu");
+        WriteEscaped(file, zone.name);
+        fprintf(file, "\", \"ts\": %.3f, \"dur\": %.3f}", zone.start_us, zone.duration_us);
+      }
+    }
+    fprintf(file, "\n]}\n");
+
+    bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+  }
+}
@@ -0,0 +1,165 @@
+/**
+ * Scoped-zone profiler, written as Chrome trace events.
+ *
+ * PROFILE_ZONE(name) measures the scope on the CPU, PROFILE_GPU_ZONE(name)
+ *   measures the commands issued in the scope with timestamp queries (context
+ *   thread only). Zones are only recorded during a capture: each thread writes
+ *   them in its own ring buffer, so the oldest zones of a thread are dropped if
+ *   a capture is longer than the buffer. GPU zones are read back at the end of
+ *   the frames, without waiting for the GPU.
+ *
+ * The capture is written in the trace event format (JSON) that Perfetto
+ *   (ui.perfetto.dev) and chrome://tracing open: one track per thread, and a
+ *   "GPU" track with the GPU zones, in the same time base.
+ *
+ * The macros are empty if USING_PROFILER is not defined (CPPVOLREND_PROFILER
+ *   CMake option), removing the zones from the code.
+**/
+#ifndef GL_UTILS_PROFILER_H
+#define GL_UTILS_PROFILER_H
+
+#include <GL/glew.h>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#ifdef USING_PROFILER
+#define GL_PROFILER_CONCAT_(a, b) a##b
+#define GL_PROFILER_CONCAT(a, b) GL_PROFILER_CONCAT_(a, b)
+#define PROFILE_ZONE(name) gl::Profiler::CPUZone GL_PROFILER_CONCAT(profile_zone_, __COUNTER__)(name)
+#define PROFILE_GPU_ZONE(name) gl::Profiler::GPUZone GL_PROFILER_CONCAT(profile_gpu_zone_, __COUNTER__)(name)
+#else
+#define PROFILE_ZONE(name)
+#define PROFILE_GPU_ZONE(name)
+#endif
+
+namespace gl
+{
+  class Profiler
+  {
+  public:
+    // Names given as const char* must outlive the capture (e.g. literals),
+    //   std::string names are copied
+    class CPUZone
+    {
+    public:
+      CPUZone (const char* name);
+      CPUZone (const std::string& name);
+      ~CPUZone ();
+    private:
+      const char* name;
+      double start_us;
+    };
+
+    class GPUZone
+    {
+    public:
+      GPUZone (const char* name);
+      GPUZone (const std::string& name);
+      ~GPUZone ();
+    private:
+      long long query;
+    };
+
+    static Profiler& Instance ();
+
+    // Records the zones until n_frames EndFrame calls, or until Stop if 0, then writes filepath
+    // . the context must be current
+    void Start (const std::string& filepath, int n_frames = 0);
+    // The capture ends at the next EndFrame
+    void Stop ();
+    // Ends the capture now and writes it, false if it could not be written
+    bool Finish ();
+
+    // Called once per frame on the context thread, records the "Frame" zone since the last call
+    void EndFrame ();
+
+    bool IsCapturing () { return capturing.load(std::memory_order_relaxed); }
+    int GetCapturedFrames () { return captured_frames; }
+    int GetCaptureFrames () { return capture_frames; }
+    std::string GetLastFile () { return last_file; }
+
+    // Name of the track of the calling thread
+    void SetThreadName (const std::string& name);
+    // Zones kept per thread, from the next capture
+    void SetBufferSize (size_t n_zones) { buffer_size = n_zones; }
+
+    // Microseconds since the profiler was created
+    double GetTime ();
+
+  protected:
+  private:
+    Profiler ();
+    ~Profiler ();
+
+    struct Zone
+    {
+      const char* name;
+      double start_us;
+      double duration_us;
+    };
+
+    struct ThreadBuffer
+    {
+      std::mutex mutex;
+      std::vector<Zone> zones;
+      // Ring: next zone written, and number of valid zones
+      size_t next;
+      size_t count;
+      int tid;
+      std::string name;
+    };
+
+    struct GPUQuery
+    {
+      const char* name;
+      GLuint begin, end;
+      bool ended;
+      // CPU - GPU time when the zone began
+      double offset_us;
+    };
+
+    ThreadBuffer* GetThreadBuffer ();
+    void Record (ThreadBuffer* buffer, const char* name, double start_us, double duration_us);
+    const char* Intern (const std::string& name);
+
+    long long BeginGPUZone (const char* name);
+    void EndGPUZone (long long query);
+    // Zones whose queries are available, all of them if wait
+    void ReadBackGPUZones (bool wait);
+    void CalibrateGPUTime ();
+
+    bool Write (const std::string& filepath);
+
+    std::chrono::steady_clock::time_point creation;
+    std::atomic<bool> capturing;
+    std::atomic<bool> stop_requested;
+    int capture_frames;
+    int captured_frames;
+    std::string capture_file;
+    std::string last_file;
+    size_t buffer_size;
+    double frame_start_us;
+
+    std::mutex buffers_mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+    std::mutex names_mutex;
+    std::unordered_set<std::string> names;
+
+    // Context thread only
+    ThreadBuffer gpu_buffer;
+    std::deque<GPUQuery> gpu_queries;
+    long long gpu_first_query;
+    std::vector<GLuint> free_queries;
+    double gpu_offset_us;
+  };
+}
+
+#endif
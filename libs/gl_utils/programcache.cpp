@@ -0,0 +1,178 @@
+#include "programcache.h"
+#include "utils.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+namespace gl
+{
+  namespace
+  {
+    const char s_magic[8] = { 'C', 'V', 'R', 'P', 'R', 'O', 'G', '1' };
+
+    // FNV-1a, 64 bits
+    void Hash (uint64_t& h, const void* data, size_t size)
+    {
+      const unsigned char* bytes = (const unsigned char*)data;
+      for (size_t i = 0; i < size; i++)
+      {
+        h ^= bytes[i];
+        h *= 1099511628211ull;
+      }
+    }
+
+    std::string GetString (GLenum name)
+    {
+      const GLubyte* str = glGetString(name);
+      return str ? std::string((const char*)str) : std::string();
+    }
+  }
+
+  ProgramCache& ProgramCache::Instance ()
+  {
+    static ProgramCache cache;
+    return cache;
+  }
+
+  ProgramCache::ProgramCache ()
+    : enabled(true), n_binary_formats(-1)
+  {
+    ResetStatistics();
+  }
+
+  void ProgramCache::SetDirectory (const std::string& _directory)
+  {
+    directory = _directory;
+    if (directory.empty()) return;
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec)
+    {
+      fprintf(stderr, "gl::ProgramCache: could not create \"%s\", the cache is disabled\n", directory.c_str());
+      directory.clear();
+    }
+  }
+
+  bool ProgramCache::IsEnabled ()
+  {
+    if (!enabled || directory.empty()) return false;
+
+    if (n_binary_formats < 0)
+    {
+      GLint n = 0;
+      glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &n);
+      n_binary_formats = n;
+      if (n_binary_formats == 0)
+        printf("gl::ProgramCache: the driver has no program binary formats, shaders are always compiled\n");
+    }
+    return n_binary_formats > 0;
+  }
+
+  std::string ProgramCache::ComputeKey (const Sources& sources)
+  {
+    // Also used to match programs compiled in the background when the cache is disabled
+    if (driver.empty())
+      driver = GetString(GL_VENDOR) + "\n" + GetString(GL_RENDERER) + "\n" + GetString(GL_VERSION);
+
+    uint64_t h = 14695981039346656037ull;
+    Hash(h, driver.data(), driver.size() + 1);
+    for (const std::pair<GLenum, std::string>& source : sources)
+    {
+      Hash(h, &source.first, sizeof(GLenum));
+      Hash(h, source.second.data(), source.second.size() + 1);
+    }
+
+    char key[17];
+    snprintf(key, sizeof(key), "%016llx", (unsigned long long)h);
+    return key;
+  }
+
+  bool ProgramCache::Load (GLuint program, const std::string& key)
+  {
+    if (!IsEnabled()) return false;
+
+    std::ifstream file(GetFilePath(key), std::ios::in | std::ios::binary);
+    if (!file) return false;
+
+    char magic[sizeof(s_magic)];
+    uint32_t format = 0, length = 0;
+    file.read(magic, sizeof(magic));
+    file.read((char*)&format, sizeof(format));
+    file.read((char*)&length, sizeof(length));
+    if (!file || std::string(magic, sizeof(magic)) != std::string(s_magic, sizeof(s_magic))) return false;
+
+    std::vector<char> binary(length);
+    file.read(binary.data(), length);
+    if (!file) return false;
+
+    // An error left by a previous call is reported as such, not taken for one of glProgramBinary
+    gl::ExitOnGLError("gl::ProgramCache >> Error left by a previous call before glProgramBinary.");
+    glProgramBinary(program, (GLenum)format, binary.data(), (GLsizei)length);
+    // The format is not supported anymore (GL_INVALID_ENUM)
+    if (glGetError() != GL_NO_ERROR) return false;
+
+    // A driver update may reject the binary: compiled again by the caller
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    return linked == GL_TRUE;
+  }
+
+  void ProgramCache::Store (GLuint program, const std::string& key)
+  {
+    if (!IsEnabled()) return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    gl::ExitOnGLError("gl::ProgramCache >> Error left by a previous call before glGetProgramBinary.");
+    glGetProgramBinary(program, length, NULL, &format, binary.data());
+    if (glGetError() != GL_NO_ERROR) return;
+
+    // Written next to the final file and renamed, so a crash never leaves a truncated binary
+    const std::string filepath = GetFilePath(key);
+    const std::string tmppath = filepath + ".tmp";
+    {
+      std::ofstream file(tmppath, std::ios::out | std::ios::binary | std::ios::trunc);
+      if (!file) return;
+      uint32_t format32 = (uint32_t)format, length32 = (uint32_t)length;
+      file.write(s_magic, sizeof(s_magic));
+      file.write((const char*)&format32, sizeof(format32));
+      file.write((const char*)&length32, sizeof(length32));
+      file.write(binary.data(), length);
+      if (!file) return;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmppath, filepath, ec);
+  }
+
+  void ProgramCache::AddBuildTime (bool from_cache, double ms)
+  {
+    if (from_cache)
+    {
+      hits++;
+      hit_ms += ms;
+    }
+    else
+    {
+      misses++;
+      miss_ms += ms;
+    }
+  }
+
+  void ProgramCache::ResetStatistics ()
+  {
+    hits = misses = 0;
+    hit_ms = miss_ms = 0.0;
+  }
+
+  std::string ProgramCache::GetFilePath (const std::string& key)
+  {
+    return (std::filesystem::path(directory) / (key + ".bin")).string();
+  }
+}
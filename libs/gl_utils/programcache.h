@@ -0,0 +1,74 @@
+/**
+ * On-disk cache of linked shader programs.
+ *
+ * The binary of a program (glGetProgramBinary) is stored in a file named by
+ * a hash of the sources of its stages and of the vendor, renderer and
+ * version strings of the driver, so a program is only compiled again when a
+ * shader file, a define or the driver changes.
+ * gl::ComputeShader and gl::PipelineShader look up the cache before
+ * compiling. When a binary is missing, or the driver rejects it
+ * (glProgramBinary fails to link), the program is compiled from source and
+ * the binary is written again.
+ *
+ * The cache is disabled until a directory is set, and when the driver has no
+ * program binary formats.
+**/
+#ifndef GL_UTILS_PROGRAM_CACHE_H
+#define GL_UTILS_PROGRAM_CACHE_H
+
+#include <GL/glew.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gl
+{
+  class ProgramCache
+  {
+  public:
+    // Source of each stage of a program (e.g. GL_COMPUTE_SHADER)
+    typedef std::vector<std::pair<GLenum, std::string>> Sources;
+
+    static ProgramCache& Instance ();
+
+    // Creates the directory if needed, empty to disable the cache
+    void SetDirectory (const std::string& directory);
+    std::string GetDirectory () { return directory; }
+    void SetEnabled (bool enabled) { this->enabled = enabled; }
+    bool IsEnabled ();
+
+    // Hash of the sources and of the current driver
+    std::string ComputeKey (const Sources& sources);
+
+    // Replaces the linked state of program with the cached binary, false if there is none or it was rejected
+    bool Load (GLuint program, const std::string& key);
+    // program must be linked after glProgramParameteri(GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE)
+    void Store (GLuint program, const std::string& key);
+
+    // Programs built since the last ResetStatistics, from the cache or compiled
+    // . the shaders report the time spent in LoadAndLink
+    void AddBuildTime (bool from_cache, double ms);
+    int GetNumberOfHits () { return hits; }
+    int GetNumberOfMisses () { return misses; }
+    double GetHitTime () { return hit_ms; }
+    double GetMissTime () { return miss_ms; }
+    void ResetStatistics ();
+
+  protected:
+  private:
+    ProgramCache ();
+    std::string GetFilePath (const std::string& key);
+
+    std::string directory;
+    bool enabled;
+    // -1 until the formats are queried with a current context
+    int n_binary_formats;
+    std::string driver;
+
+    int hits, misses;
+    double hit_ms, miss_ms;
+  };
+}
+
+#endif
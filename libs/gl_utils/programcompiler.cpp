@@ -0,0 +1,267 @@
+#include "programcompiler.h"
+#include "memoryregistry.h"
+#include "shader.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace gl
+{
+  ProgramCompiler& ProgramCompiler::Instance ()
+  {
+    static ProgramCompiler compiler;
+    return compiler;
+  }
+
+  ProgramCompiler::ProgramCompiler ()
+    : parallel(false)
+  {
+  }
+
+  ProgramCompiler::~ProgramCompiler ()
+  {
+    // Programs never taken are deleted by Release, the context is already destroyed here
+  }
+
+  void ProgramCompiler::Initialize ()
+  {
+    // 0xFFFFFFFF: as many threads as the driver wants
+    if (GLEW_KHR_parallel_shader_compile)
+    {
+      glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+      parallel = true;
+    }
+    else if (GLEW_ARB_parallel_shader_compile)
+    {
+      glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+      parallel = true;
+    }
+    if (!parallel)
+      printf("gl::ProgramCompiler: no parallel shader compile extension, programs are compiled when submitted\n");
+
+    records.clear();
+    std::ifstream file(GetRecordsPath());
+    std::string line;
+    while (file && std::getline(file, line))
+    {
+      // owner, then "S" type file and "D" define per stage and define
+      std::vector<std::string> fields;
+      std::stringstream ss(line);
+      std::string field;
+      while (std::getline(ss, field, '\t')) fields.push_back(field);
+      if (fields.size() < 4) continue;
+
+      ProgramRecord record;
+      for (size_t i = 1; i < fields.size(); i++)
+      {
+        if (fields[i] == "S" && i + 2 < fields.size())
+        {
+          record.stages.push_back(std::make_pair((GLenum)std::strtoul(fields[i + 1].c_str(), NULL, 10), fields[i + 2]));
+          i += 2;
+        }
+        else if (fields[i] == "D" && i + 1 < fields.size())
+        {
+          record.defines += fields[i + 1] + "\n";
+          i += 1;
+        }
+      }
+      if (!record.stages.empty()) records[fields[0]].push_back(record);
+    }
+  }
+
+  bool ProgramCompiler::ReadSources (const Stages& stages, const std::string& defines, ProgramCache::Sources& sources)
+  {
+    sources.clear();
+    for (const std::pair<GLenum, std::string>& stage : stages)
+    {
+      char* shader_source = TextFileRead(stage.second.c_str());
+      if (!shader_source) return false;
+      sources.push_back(std::make_pair(stage.first, Shader::InsertDefines(shader_source, defines)));
+      free(shader_source);
+    }
+    return true;
+  }
+
+  void ProgramCompiler::Submit (const ProgramCache::Sources& sources, const std::string& owner)
+  {
+    ProgramCache& cache = ProgramCache::Instance();
+    std::string key = cache.ComputeKey(sources);
+    if (submitted.find(key) != submitted.end()) return;
+
+    Submission submission;
+    submission.program = glCreateProgram();
+    submission.owner = owner;
+    submission.from_cache = cache.Load(submission.program, key);
+
+    if (!submission.from_cache)
+    {
+      // Every stage is submitted before anything is queried
+      std::vector<GLuint> shaders;
+      for (const std::pair<GLenum, std::string>& source : sources)
+      {
+        GLuint shader = glCreateShader(source.first);
+        const char* const_shader_source = source.second.c_str();
+        glShaderSource(shader, 1, &const_shader_source, NULL);
+        glCompileShader(shader);
+        glAttachShader(submission.program, shader);
+        shaders.push_back(shader);
+      }
+
+      if (cache.IsEnabled()) glProgramParameteri(submission.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+      glLinkProgram(submission.program);
+
+      // The linked program does not need them, deleted once the driver is done
+      for (GLuint shader : shaders)
+      {
+        glDetachShader(submission.program, shader);
+        glDeleteShader(shader);
+      }
+    }
+
+    // Registered under the owner with no size until it is linked
+    submission.measured = false;
+    MemoryRegistry::Instance().RegisterProgram(submission.program, 0, owner.empty() ? nullptr : owner.c_str());
+    if (submission.from_cache || !parallel) Measure(submission);
+
+    submitted[key] = submission;
+    gl::ExitOnGLError("gl::ProgramCompiler >> Unable to submit a program.");
+  }
+
+  GLuint ProgramCompiler::Take (const std::string& key)
+  {
+    std::map<std::string, Submission>::iterator it = submitted.find(key);
+    if (it == submitted.end()) return 0;
+
+    Submission submission = it->second;
+    submitted.erase(it);
+    // Owned by the shader from now on
+    MemoryRegistry::Instance().Unregister(MemoryRegistry::PROGRAM, submission.program);
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(submission.program, GL_LINK_STATUS, &linked);
+    if (linked != GL_TRUE)
+    {
+      // Compiled again by the shader, which reports the errors
+      glDeleteProgram(submission.program);
+      return 0;
+    }
+
+    if (!submission.from_cache) ProgramCache::Instance().Store(submission.program, key);
+    return submission.program;
+  }
+
+  void ProgramCompiler::Release (const std::string& owner)
+  {
+    for (std::map<std::string, Submission>::iterator it = submitted.begin(); it != submitted.end();)
+    {
+      if (!owner.empty() && it->second.owner != owner)
+      {
+        ++it;
+        continue;
+      }
+      MemoryRegistry::Instance().Unregister(MemoryRegistry::PROGRAM, it->second.program);
+      glDeleteProgram(it->second.program);
+      it = submitted.erase(it);
+    }
+  }
+
+  void ProgramCompiler::Record (const Stages& stages, const std::string& defines)
+  {
+    // Only the programs of a renderer are precompiled
+    std::string owner = MemoryRegistry::Instance().GetCurrentTag();
+    if (owner.empty()) return;
+
+    std::vector<ProgramRecord>& owner_records = records[owner];
+    for (const ProgramRecord& record : owner_records)
+      if (record.stages == stages && record.defines == defines) return;
+
+    ProgramRecord record;
+    record.stages = stages;
+    record.defines = defines;
+    owner_records.push_back(record);
+    WriteRecords();
+  }
+
+  int ProgramCompiler::Precompile (const std::string& owner)
+  {
+    int n = 0;
+    for (std::map<std::string, std::vector<ProgramRecord>>::iterator it = records.begin(); it != records.end(); ++it)
+    {
+      if (!owner.empty() && it->first != owner) continue;
+      for (const ProgramRecord& record : it->second)
+      {
+        ProgramCache::Sources sources;
+        if (!ReadSources(record.stages, record.defines, sources)) continue;
+        Submit(sources, it->first);
+        n++;
+      }
+    }
+    return n;
+  }
+
+  bool ProgramCompiler::HasRecords (const std::string& owner)
+  {
+    std::map<std::string, std::vector<ProgramRecord>>::iterator it = records.find(owner);
+    return it != records.end() && !it->second.empty();
+  }
+
+  int ProgramCompiler::GetNumberOfCompiling (const std::string& owner)
+  {
+    if (!parallel) return 0;
+
+    int n = 0;
+    for (std::map<std::string, Submission>::iterator it = submitted.begin(); it != submitted.end(); ++it)
+    {
+      if (!owner.empty() && it->second.owner != owner) continue;
+      GLint done = GL_TRUE;
+      glGetProgramiv(it->second.program, GL_COMPLETION_STATUS_KHR, &done);
+      if (done != GL_TRUE) n++;
+      else if (!it->second.measured) Measure(it->second);
+    }
+    return n;
+  }
+
+  void ProgramCompiler::Measure (Submission& submission)
+  {
+    GLint bytes = 0;
+    glGetProgramiv(submission.program, GL_PROGRAM_BINARY_LENGTH, &bytes);
+    // Keeps the tag given at the submission
+    MemoryRegistry::Instance().RegisterProgram(submission.program, (size_t)std::max(bytes, 0));
+    submission.measured = true;
+  }
+
+  std::string ProgramCompiler::GetRecordsPath ()
+  {
+    std::string directory = ProgramCache::Instance().GetDirectory();
+    if (directory.empty()) return std::string();
+    return (std::filesystem::path(directory) / "programs.txt").string();
+  }
+
+  void ProgramCompiler::WriteRecords ()
+  {
+    std::string filepath = GetRecordsPath();
+    if (filepath.empty()) return;
+
+    std::ofstream file(filepath, std::ios::out | std::ios::trunc);
+    for (std::map<std::string, std::vector<ProgramRecord>>::iterator it = records.begin(); it != records.end(); ++it)
+    {
+      for (const ProgramRecord& record : it->second)
+      {
+        file << it->first;
+        for (const std::pair<GLenum, std::string>& stage : record.stages)
+          file << "\tS\t" << stage.first << "\t" << stage.second;
+
+        std::stringstream defines(record.defines);
+        std::string define;
+        while (std::getline(defines, define))
+          if (!define.empty()) file << "\tD\t" << define;
+        file << "\n";
+      }
+    }
+  }
+}
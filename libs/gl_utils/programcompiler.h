@@ -0,0 +1,103 @@
+/**
+ * Shader programs compiled in the background.
+ *
+ * With GL_KHR_parallel_shader_compile (or the ARB extension) the driver
+ * compiles and links on its own threads: glCompileShader and glLinkProgram
+ * return immediately and only a status query, or the first use, waits. The
+ * compiler submits programs without querying them and polls
+ * GL_COMPLETION_STATUS_KHR, so the application keeps drawing meanwhile.
+ * Without the extension the programs are compiled when submitted.
+ *
+ * gl::ComputeShader and gl::PipelineShader record the first program they link
+ * (files and defines) under the current gl::MemoryRegistry tag, which is the
+ * renderer being initialized. The records are kept in the program cache
+ * directory, so the next session can submit the programs of every renderer at
+ * startup, and a renderer can be initialized only once its programs are linked.
+ * LoadAndLink takes a submitted program with the same sources instead of
+ * compiling it again. Until they are taken, the programs are registered in
+ * gl::MemoryRegistry under the tag of their owner, and Release deletes the
+ * ones no renderer took.
+**/
+#ifndef GL_UTILS_PROGRAM_COMPILER_H
+#define GL_UTILS_PROGRAM_COMPILER_H
+
+#include <GL/glew.h>
+
+#include "programcache.h"
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gl
+{
+  class ProgramCompiler
+  {
+  public:
+    // Type (e.g. GL_COMPUTE_SHADER) and file of each stage
+    typedef std::vector<std::pair<GLenum, std::string>> Stages;
+
+    static ProgramCompiler& Instance ();
+
+    // Requires a current context and the cache directory: asks the driver
+    //   for compiler threads and reads the recorded programs
+    void Initialize ();
+    bool IsParallel () { return parallel; }
+
+    // Sources of the stages with the defines inserted after #version, false if a file is missing
+    static bool ReadSources (const Stages& stages, const std::string& defines, ProgramCache::Sources& sources);
+
+    // Starts compiling and linking, the program belongs to owner until it is taken
+    void Submit (const ProgramCache::Sources& sources, const std::string& owner = "");
+    // The linked program submitted with these sources, 0 if there is none or it failed
+    // . waits if it is still compiling
+    GLuint Take (const std::string& key);
+    // Deletes the programs of owner (every owner if empty) that were not taken
+    // . requires the context, at a renderer switch and before it is destroyed
+    void Release (const std::string& owner = "");
+
+    // Called by the shaders with the files and defines of their first program
+    void Record (const Stages& stages, const std::string& defines);
+    // Submits the recorded programs of owner, or of every owner if empty
+    int Precompile (const std::string& owner = "");
+    bool HasRecords (const std::string& owner);
+
+    // Submitted programs of owner (every owner if empty) the driver is still compiling
+    int GetNumberOfCompiling (const std::string& owner = "");
+    int GetNumberOfSubmitted () { return (int)submitted.size(); }
+
+  protected:
+  private:
+    ProgramCompiler ();
+    ~ProgramCompiler ();
+
+    struct ProgramRecord
+    {
+      Stages stages;
+      std::string defines;
+    };
+
+    struct Submission
+    {
+      GLuint program;
+      std::string owner;
+      bool from_cache;
+      // The size is registered once linked, querying it before would wait
+      bool measured;
+    };
+
+    void Measure (Submission& submission);
+
+    std::string GetRecordsPath ();
+    void WriteRecords ();
+
+    bool parallel;
+    // Recorded programs by owner
+    std::map<std::string, std::vector<ProgramRecord>> records;
+    // Submitted programs by ProgramCache::ComputeKey
+    std::map<std::string, Submission> submitted;
+  };
+}
+
+#endif
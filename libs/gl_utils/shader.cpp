@@ -4,7 +4,10 @@
 #include <iostream>
 #include <cerrno>
 
+#include <gl_utils/profiler.h>
 #include <gl_utils/utils.h>
+#include <gl_utils/memoryregistry.h>
+#include <gl_utils/programcompiler.h>
 
 namespace gl
 {
@@ -234,15 +237,125 @@ namespace gl
     ClearUniforms();
     uniform_variables.clear();
   
+    ClearVariants();
     glDeleteProgram(shader_program);
     shader_program = -1;
   }
   
   void Shader::Bind ()
   {
+    std::string key = GetDefinesKey();
+    if (shader_program != -1 && key != variant_key)
+    {
+      variant_programs[variant_key] = shader_program;
+
+      std::map<std::string, GLuint>::iterator it = variant_programs.find(key);
+      if (it != variant_programs.end())
+      {
+        shader_program = it->second;
+        variant_key = key;
+      }
+      else
+      {
+        shader_program = -1;
+        LoadAndLink();
+        variant_programs[variant_key] = shader_program;
+      }
+
+      // Locations and values are state of each program
+      glUseProgram(shader_program);
+      for (std::map<std::string, UniformVariable>::iterator it = uniform_variables.begin(); it != uniform_variables.end(); ++it)
+        it->second.location = glGetUniformLocation(shader_program, it->first.c_str());
+      BindUniforms();
+    }
+
     glUseProgram(shader_program);
     gl::ExitOnGLError("Error at Shader::Bind()");
   }
+
+  void Shader::SetDefine (std::string name, std::string value)
+  {
+    defines[name] = value;
+  }
+
+  void Shader::ClearDefine (std::string name)
+  {
+    defines.erase(name);
+  }
+
+  void Shader::SetFlag (std::string name, bool enabled)
+  {
+    if (enabled) SetDefine(name);
+    else ClearDefine(name);
+  }
+
+  bool Shader::IsDefined (std::string name)
+  {
+    return defines.find(name) != defines.end();
+  }
+
+  int Shader::GetNumberOfVariants ()
+  {
+    int n = (int)variant_programs.size();
+    if (shader_program != -1 && variant_programs.find(variant_key) == variant_programs.end())
+      n++;
+    return n;
+  }
+
+  void Shader::GetStages (std::vector<std::pair<GLenum, std::string>>& stages)
+  {
+    stages.clear();
+  }
+
+  void Shader::PrecompileVariant (const std::string& owner)
+  {
+    ProgramCompiler& compiler = ProgramCompiler::Instance();
+    std::string key = GetDefinesKey();
+    if (!compiler.IsParallel() || key == variant_key || variant_programs.find(key) != variant_programs.end())
+      return;
+
+    ProgramCompiler::Stages stages;
+    GetStages(stages);
+    ProgramCache::Sources sources;
+    if (stages.empty() || !ProgramCompiler::ReadSources(stages, key, sources)) return;
+
+    // Submit ignores sources already submitted, so it is only compiled once
+    compiler.Submit(sources, owner.empty() ? MemoryRegistry::Instance().GetCurrentTag() : owner);
+  }
+
+  std::string Shader::GetDefinesKey ()
+  {
+    std::string key;
+    for (std::map<std::string, std::string>::iterator it = defines.begin(); it != defines.end(); ++it)
+      key += "#define " + it->first + (it->second.empty() ? "" : " " + it->second) + "\n";
+    return key;
+  }
+
+  std::string Shader::InsertDefines (const std::string& source, const std::string& defines)
+  {
+    if (defines.empty()) return source;
+
+    // #version must remain the first directive
+    size_t version = source.find("#version");
+    if (version == std::string::npos) return defines + source;
+
+    size_t eol = source.find('\n', version);
+    if (eol == std::string::npos) return source + "\n" + defines;
+    return source.substr(0, eol + 1) + defines + source.substr(eol + 1);
+  }
+
+  std::string Shader::InjectDefines (const std::string& source)
+  {
+    variant_key = GetDefinesKey();
+    return InsertDefines(source, variant_key);
+  }
+
+  void Shader::ClearVariants ()
+  {
+    for (std::map<std::string, GLuint>::iterator it = variant_programs.begin(); it != variant_programs.end(); ++it)
+      if (it->second != shader_program) glDeleteProgram(it->second);
+    variant_programs.clear();
+  }
   
   GLuint Shader::GetProgramID ()
   {
@@ -263,6 +376,7 @@ namespace gl
   
   void Shader::BindUniforms ()
   {
+    PROFILE_ZONE("BindUniforms");
     for (std::map<std::string, UniformVariable>::iterator it = uniform_variables.begin(); it != uniform_variables.end(); ++it)
       uniform_variables[it->first].Bind();
     gl::ExitOnGLError("Error at BindUniforms()");
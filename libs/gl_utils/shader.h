@@ -11,6 +11,7 @@
 
 #include <map>
 #include <iostream>
+#include <string>
 #include <vector>
 
 #include <glm/glm.hpp>
@@ -78,8 +79,32 @@ namespace gl
     virtual bool LoadAndLink () = 0;
     virtual bool Reload () = 0;
   
+    // Links the variant of the current defines if they changed since the last Bind
     void Bind ();
     GLuint GetProgramID ();
+
+    ////////////////////////////////////////////////
+    // Permutations
+    // . the defines are inserted after the #version line of every source, so
+    //   features toggled in the interface are compiled in or out instead of
+    //   branching on uniforms
+    // . each combination is linked on the first Bind that needs it and kept
+    //   (and cached on disk by gl::ProgramCache), switching back only swaps
+    //   the program and binds the uniforms again
+    void SetDefine (std::string name, std::string value = "");
+    void ClearDefine (std::string name);
+    // Defines name if enabled, clears it otherwise
+    void SetFlag (std::string name, bool enabled);
+    bool IsDefined (std::string name);
+    int GetNumberOfVariants ();
+    // Submits the combination of the current defines to gl::ProgramCompiler,
+    //   so the Bind that switches to it takes the linked program instead of
+    //   compiling it. Nothing without parallel compilation, which would only
+    //   move the wait here
+    void PrecompileVariant (const std::string& owner = "");
+
+    // Inserts the lines of defines after the #version line of source
+    static std::string InsertDefines (const std::string& source, const std::string& defines);
   
     ////////////////////////////////////////////////
     // Uniforms functions
@@ -120,6 +145,22 @@ namespace gl
     protected:
       GLuint shader_program;
       std::map<std::string, UniformVariable> uniform_variables;
+
+      // Sorted by name, so a combination has a single key
+      std::map<std::string, std::string> defines;
+      // Linked programs of the combinations already used, by GetDefinesKey
+      std::map<std::string, GLuint> variant_programs;
+      // Defines shader_program was linked with
+      std::string variant_key;
+
+      std::string GetDefinesKey ();
+      // Must be applied by LoadAndLink to each source, also sets variant_key
+      std::string InjectDefines (const std::string& source);
+      // Deletes the programs of the other combinations, e.g. when the sources are reloaded
+      void ClearVariants ();
+      // Type (e.g. GL_COMPUTE_SHADER) and file of each stage, none if the
+      //   sources are not files
+      virtual void GetStages (std::vector<std::pair<GLenum, std::string>>& stages);
   
       void SetUniformTexture (std::string name,
                               GLuint texture_unit_id,
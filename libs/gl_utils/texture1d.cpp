@@ -1,4 +1,5 @@
 #include "texture1d.h"
+#include "memoryregistry.h"
 #include <GL/glew.h>
 #include <cassert>
 
@@ -13,6 +14,7 @@ namespace gl
 
   Texture1D::~Texture1D ()
   {
+    MemoryRegistry::Instance().Unregister(MemoryRegistry::TEXTURE, m_textureID);
     glDeleteTextures(1, &m_textureID);
   }
 
@@ -37,6 +39,7 @@ namespace gl
 
     // Set Data
     glTexImage1D(GL_TEXTURE_1D, 0, internalformat, m_length, 0, format, type, data);
+    MemoryRegistry::Instance().RegisterTexture(m_textureID, internalformat, m_length);
     #if _DEBUG
       printf("texture1d.cpp: Texture generated with id %d!\n", m_textureID);
     #endif
@@ -49,6 +52,20 @@ namespace gl
     return true;
   }
 
+  bool Texture1D::UpdateData (GLvoid* data, GLenum format, GLenum type)
+  {
+    if (m_textureID == -1)
+      return false;
+
+    glBindTexture(GL_TEXTURE_1D, m_textureID);
+    glTexSubImage1D(GL_TEXTURE_1D, 0, 0, m_length, format, type, data);
+    glBindTexture(GL_TEXTURE_1D, 0);
+
+    assert(glGetError() == GL_NO_ERROR);
+
+    return true;
+  }
+
   GLuint Texture1D::GetTextureID ()
   {
     return m_textureID;
@@ -62,6 +79,7 @@ namespace gl
   void Texture1D::DestroyTexture ()
   {
     GLint temp_texture = m_textureID;
+    MemoryRegistry::Instance().Unregister(MemoryRegistry::TEXTURE, m_textureID);
     glDeleteTextures(1, &m_textureID);
     #if _DEBUG
     printf("lqc: Texture1D with id %d destroyed!\n", temp_texture);
@@ -33,6 +33,8 @@ namespace gl
     , GLint wrap_s_param);
 
     bool SetData (GLvoid* data, GLint internalformat, GLenum format, GLenum type);
+    // Replaces the texels with glTexSubImage1D, keeping the texture and its format
+    bool UpdateData (GLvoid* data, GLenum format, GLenum type);
     
     GLuint GetTextureID ();
 
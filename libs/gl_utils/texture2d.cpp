@@ -1,4 +1,5 @@
 #include "texture2d.h"
+#include "memoryregistry.h"
 
 #include <cassert>
 
@@ -16,6 +17,7 @@ namespace gl
 
   Texture2D::~Texture2D ()
   {
+    MemoryRegistry::Instance().Unregister(MemoryRegistry::TEXTURE, m_textureID);
     glDeleteTextures(1, &m_textureID);
   }
 
@@ -42,6 +44,7 @@ namespace gl
     // Set Data
     // For bigger textures: GL_PROXY_TEXTURE_2D
     glTexImage2D(GL_TEXTURE_2D, 0, internalformat, m_width, m_height, 0, format, type, data);
+    MemoryRegistry::Instance().RegisterTexture(m_textureID, internalformat, m_width, m_height);
     #if _DEBUG
         printf("texture2d.cpp: Texture generated with id %d!\n", m_textureID);
     #endif
@@ -73,6 +76,7 @@ namespace gl
   void Texture2D::DestroyTexture ()
   {
     GLint temp_texture = m_textureID;
+    MemoryRegistry::Instance().Unregister(MemoryRegistry::TEXTURE, m_textureID);
     glDeleteTextures(1, &m_textureID);
     printf("lqc: Texture2D with id %d destroyed!\n", temp_texture);
     m_textureID = -1;
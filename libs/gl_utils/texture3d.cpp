@@ -1,4 +1,6 @@
 #include "texture3d.h"
+#include "memoryregistry.h"
+#include <algorithm>
 #include <cassert>
 
 #include <GL/glew.h>
@@ -80,6 +82,7 @@ namespace gl
 
     // Set Data
     glTexImage3D(GL_TEXTURE_3D, 0, internalformat, m_width, m_height, m_depth, 0, format, type, data);
+    MemoryRegistry::Instance().RegisterTexture(m_textureID, internalformat, m_width, m_height, m_depth);
     #if _DEBUG
       printf("gl::Texture3D: Texture generated with id %d!\n", m_textureID);
     #endif
@@ -93,6 +96,61 @@ namespace gl
     return true;
   }
 
+  bool Texture3D::SetDataSlabs (GLint internalformat, GLenum format, GLenum type, size_t bytes_per_texel, size_t max_slab_bytes,
+    const std::function<void(void*, unsigned int, unsigned int)>& fill)
+  {
+    if (m_textureID == -1)
+      return false;
+
+    gl::ExitOnGLError("gl::Texture3D: Before Texture3D SetDataSlabs\n");
+
+    const size_t slice_bytes = (size_t)m_width * m_height * bytes_per_texel;
+    const unsigned int slab_slices = (unsigned int)glm::clamp<size_t>(max_slab_bytes / slice_bytes, 1, m_depth);
+
+    // Storage only, the slabs are written with glTexSubImage3D
+    glBindTexture(GL_TEXTURE_3D, m_textureID);
+    glTexImage3D(GL_TEXTURE_3D, 0, internalformat, m_width, m_height, m_depth, 0, format, type, NULL);
+    MemoryRegistry::Instance().RegisterTexture(m_textureID, internalformat, m_width, m_height, m_depth);
+
+    // Rows of 8 and 16 bit texels are not 4-byte aligned
+    GLint unpack_alignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpack_alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // While the driver transfers one buffer, the next slab is written to the other
+    bool mapped = true;
+    GLuint pbo[2];
+    glGenBuffers(2, pbo);
+    for (unsigned int z = 0, s = 0; z < m_depth; z += slab_slices, s++)
+    {
+      const unsigned int n_slices = std::min(slab_slices, m_depth - z);
+      const GLsizeiptr slab_bytes = (GLsizeiptr)(slice_bytes * n_slices);
+
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo[s % 2]);
+      // Orphan the storage of the buffer instead of waiting for its previous transfer
+      glBufferData(GL_PIXEL_UNPACK_BUFFER, slice_bytes * slab_slices, NULL, GL_STREAM_DRAW);
+      void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, slab_bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+      if (dst)
+      {
+        fill(dst, z, n_slices);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, z, m_width, m_height, n_slices, format, type, (GLvoid*)0);
+      }
+      else
+      {
+        mapped = false;
+      }
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDeleteBuffers(2, pbo);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, unpack_alignment);
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    gl::ExitOnGLError("gl::Texture3D: After Texture3D SetDataSlabs\n");
+    return mapped;
+  }
+
   GLuint Texture3D::GetTextureID ()
   {
     return m_textureID;
@@ -116,6 +174,7 @@ namespace gl
   void Texture3D::DestroyTexture ()
   {
     GLint temp_texture = m_textureID;
+    MemoryRegistry::Instance().Unregister(MemoryRegistry::TEXTURE, m_textureID);
     glDeleteTextures(1, &m_textureID);
 #if _DEBUG
     printf("gl::Texture3D: Texture id %d destroyed!\n", temp_texture);
@@ -5,6 +5,9 @@
 
 #include <glm/glm.hpp>
 
+#include <cstddef>
+#include <functional>
+
 namespace gl
 {
   class Texture3D
@@ -19,6 +22,14 @@ namespace gl
 
     bool SetData (GLvoid* data, GLint internalformat, GLenum format, GLenum type);
 
+    // Allocates the texture and uploads it in slabs of slices through two pixel
+    // unpack buffers, so no copy of the whole texture is made on the client side.
+    // . fill(dst, first_slice, n_slices) writes the texels of the slices, tightly
+    //   packed, to the mapped buffer. It runs while the previous slab is transferred
+    // . each slab has at most max_slab_bytes, and at least one slice
+    bool SetDataSlabs (GLint internalformat, GLenum format, GLenum type, size_t bytes_per_texel, size_t max_slab_bytes,
+      const std::function<void(void*, unsigned int, unsigned int)>& fill);
+
     GLuint GetTextureID ();
 
     unsigned int GetWidth ();
@@ -3,16 +3,20 @@
 namespace gl
 {
   Timer::Timer ()
+    : query(0)
+    , elapsed_time(0)
   {
   }
   
   Timer::~Timer ()
   {
+    if (query) glDeleteQueries(1, &query);
   }
 
   void Timer::Start ()
   {
-    glGenQueries(1, &query);
+    // the query object is reused between measurements
+    if (!query) glGenQueries(1, &query);
     glBeginQuery(GL_TIME_ELAPSED, query);
   }
 
@@ -33,4 +37,71 @@ namespace gl
     glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed_time);
     return elapsed_time / 1000000.0;
   }
+
+  PipelinedTimer::PipelinedTimer (int n_queries)
+    : queries(n_queries < 1 ? 1 : n_queries, 0)
+    , next(0)
+    , pending(0)
+  {
+  }
+
+  PipelinedTimer::~PipelinedTimer ()
+  {
+    if (queries[0]) glDeleteQueries((GLsizei)queries.size(), queries.data());
+  }
+
+  void PipelinedTimer::Start ()
+  {
+    if (!queries[0]) glGenQueries((GLsizei)queries.size(), queries.data());
+
+    // all the queries are in flight: the oldest one must be read back first
+    if (pending == (int)queries.size())
+    {
+      ReadBack(queries[next]);
+      pending--;
+    }
+    glBeginQuery(GL_TIME_ELAPSED, queries[next]);
+  }
+
+  void PipelinedTimer::End ()
+  {
+    glEndQuery(GL_TIME_ELAPSED);
+    next = (next + 1) % (int)queries.size();
+    pending++;
+
+    // read back the results that are already available, in order
+    while (pending > 0)
+    {
+      GLuint q = queries[(next - pending + (int)queries.size()) % (int)queries.size()];
+      GLint done = 0;
+      glGetQueryObjectiv(q, GL_QUERY_RESULT_AVAILABLE, &done);
+      if (!done) break;
+      ReadBack(q);
+      pending--;
+    }
+  }
+
+  void PipelinedTimer::Finish ()
+  {
+    while (pending > 0)
+    {
+      ReadBack(queries[(next - pending + (int)queries.size()) % (int)queries.size()]);
+      pending--;
+    }
+  }
+
+  void PipelinedTimer::Clear ()
+  {
+    // the results of reused queries are overwritten
+    pending = 0;
+    results.clear();
+  }
+
+  void PipelinedTimer::ReadBack (GLuint q)
+  {
+    // waits if the result is not available yet
+    GLuint64 elapsed = 0;
+    glGetQueryObjectui64v(q, GL_QUERY_RESULT, &elapsed);
+    results.push_back(elapsed / 1000000.0);
+  }
 }
\ No newline at end of file
@@ -11,6 +11,7 @@
 #define GL_UTILS_TIMER_H
 
 #include <GL/glew.h>
+#include <vector>
 
 namespace gl
 {
@@ -29,6 +30,37 @@ namespace gl
     GLuint query;
     GLuint64 elapsed_time;
   };
+
+  // Timer that measures every frame without waiting for the GPU:
+  // the queries are used round-robin and each result is read back when
+  // the query is reused, some frames later.
+  class PipelinedTimer
+  {
+  public:
+    PipelinedTimer (int n_queries = 3);
+    ~PipelinedTimer ();
+
+    void Start ();
+    void End ();
+
+    // Waits for the queries that were not read back yet
+    void Finish ();
+    // Discards the results and the queries that were not read back yet
+    void Clear ();
+
+    // Elapsed times of the finished queries, in miliseconds, in the order they were started
+    const std::vector<double>& GetResults () { return results; }
+
+  protected:
+  private:
+    void ReadBack (GLuint q);
+
+    std::vector<GLuint> queries;
+    // next query to Start, the oldest pending one is (next - pending)
+    int next;
+    int pending;
+    std::vector<double> results;
+  };
 }
 
 #endif
\ No newline at end of file
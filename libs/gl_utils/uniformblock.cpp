@@ -0,0 +1,116 @@
+#include "uniformblock.h"
+#include "memoryregistry.h"
+#include "profiler.h"
+
+#include <gl_utils/utils.h>
+
+#include <cstring>
+
+namespace gl
+{
+  UniformBlock::UniformBlock (size_t _block_size, int frames_in_flight)
+    : buffer(0), block_size(_block_size), mapped(nullptr), current(0), last_upload_bytes(0)
+  {
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    region_stride = (block_size + alignment - 1) / alignment * alignment;
+
+    // Without persistent mapping there is nothing to ring
+    if (!GLEW_ARB_buffer_storage) frames_in_flight = 1;
+    if (frames_in_flight < 1) frames_in_flight = 1;
+
+    shadow.assign(frames_in_flight, std::vector<unsigned char>(block_size, 0));
+    fences.assign(frames_in_flight, (GLsync)0);
+
+    std::vector<unsigned char> zeros(region_stride * frames_in_flight, 0);
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    if (GLEW_ARB_buffer_storage)
+    {
+      const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      glBufferStorage(GL_UNIFORM_BUFFER, zeros.size(), zeros.data(), flags);
+      mapped = (unsigned char*)glMapBufferRange(GL_UNIFORM_BUFFER, 0, zeros.size(), flags);
+    }
+    else
+    {
+      glBufferData(GL_UNIFORM_BUFFER, zeros.size(), zeros.data(), GL_DYNAMIC_DRAW);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    MemoryRegistry::Instance().RegisterBuffer(buffer, zeros.size());
+
+    gl::ExitOnGLError("gl::UniformBlock: Could not create the uniform buffer");
+  }
+
+  UniformBlock::~UniformBlock ()
+  {
+    for (GLsync& fence : fences)
+      if (fence) glDeleteSync(fence);
+
+    if (mapped)
+    {
+      glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+      glUnmapBuffer(GL_UNIFORM_BUFFER);
+      glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+    MemoryRegistry::Instance().Unregister(MemoryRegistry::BUFFER, buffer);
+    glDeleteBuffers(1, &buffer);
+  }
+
+  void UniformBlock::Upload (const void* data, GLuint binding)
+  {
+    PROFILE_ZONE("UniformBlock Upload");
+    const unsigned char* bytes = (const unsigned char*)data;
+    last_upload_bytes = 0;
+
+    // Same parameters of the bound region: nothing to write
+    if (memcmp(shadow[current].data(), bytes, block_size) != 0)
+    {
+      const int n_regions = (int)shadow.size();
+      if (n_regions > 1)
+      {
+        // The commands that read the current region were issued before this call
+        if (fences[current]) glDeleteSync(fences[current]);
+        fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        current = (current + 1) % n_regions;
+        if (fences[current])
+        {
+          glClientWaitSync(fences[current], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+          glDeleteSync(fences[current]);
+          fences[current] = (GLsync)0;
+        }
+      }
+
+      // Range of the bytes that differ from the contents of the region
+      std::vector<unsigned char>& region = shadow[current];
+      size_t first = 0, last = block_size;
+      while (first < block_size && region[first] == bytes[first]) first++;
+      while (last > first && region[last - 1] == bytes[last - 1]) last--;
+
+      if (last > first)
+      {
+        const size_t offset = current * region_stride + first;
+        if (mapped)
+        {
+          memcpy(mapped + offset, bytes + first, last - first);
+        }
+        else
+        {
+          glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+          glBufferSubData(GL_UNIFORM_BUFFER, offset, last - first, bytes + first);
+          glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        }
+        memcpy(region.data() + first, bytes + first, last - first);
+        last_upload_bytes = last - first;
+      }
+    }
+
+    // Other shaders may have used the binding point
+    Bind(binding);
+  }
+
+  void UniformBlock::Bind (GLuint binding)
+  {
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, current * region_stride, block_size);
+  }
+}
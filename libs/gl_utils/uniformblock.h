@@ -0,0 +1,81 @@
+/**
+ * Uniform buffer for the per-frame parameters of a shader.
+ *
+ * The parameters are a C++ struct with the std140 layout of a uniform block
+ * of the shader (vec3 followed by a scalar, mat4, ints and floats padded to
+ * 16 bytes), so a frame updates them with a single write instead of a
+ * glUniform call and a name lookup per parameter.
+ *
+ * The buffer has one region per frame in flight, persistently mapped when
+ * GL_ARB_buffer_storage is available:
+ * . Upload() compares the parameters with the bytes of the region that is
+ *   going to be written, and copies only the range that differs
+ * . when nothing changed, the region of the previous frame is bound again
+ * . a region is written again only after the GPU has finished the commands
+ *   issued while it was bound (fence)
+ * Without buffer storage, a single region is updated with glBufferSubData.
+**/
+#ifndef GL_UTILS_UNIFORM_BLOCK_H
+#define GL_UTILS_UNIFORM_BLOCK_H
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace gl
+{
+  class UniformBlock
+  {
+  public:
+    UniformBlock (size_t block_size, int frames_in_flight = 3);
+    ~UniformBlock ();
+
+    // Writes the bytes of data that changed and binds the region to the uniform block binding point
+    void Upload (const void* data, GLuint binding);
+    // Binds the region of the last Upload, e.g. when other shaders used the binding point since then
+    void Bind (GLuint binding);
+
+    size_t GetBlockSize () { return block_size; }
+    bool IsPersistentlyMapped () { return mapped != nullptr; }
+    // Bytes copied by the last Upload, 0 if the parameters did not change
+    size_t GetLastUploadBytes () { return last_upload_bytes; }
+
+  protected:
+  private:
+    GLuint buffer;
+    size_t block_size;
+    size_t region_stride;
+    unsigned char* mapped;
+
+    // Contents of each region, to find the range that differs from the new parameters
+    std::vector<std::vector<unsigned char>> shadow;
+    std::vector<GLsync> fences;
+    int current;
+    size_t last_upload_bytes;
+  };
+
+  // UniformBlock of a std140 struct T
+  template <typename T>
+  class ParameterBlock : public UniformBlock
+  {
+  public:
+    static_assert(sizeof(T) % 16 == 0, "std140 blocks are padded to 16 bytes");
+
+    ParameterBlock (GLuint binding, int frames_in_flight = 3)
+      : UniformBlock(sizeof(T), frames_in_flight), values(), binding(binding)
+    {
+    }
+
+    void Upload () { UniformBlock::Upload(&values, binding); }
+    void Bind () { UniformBlock::Bind(binding); }
+
+    // Parameters of the next Upload
+    T values;
+
+  private:
+    GLuint binding;
+  };
+}
+
+#endif
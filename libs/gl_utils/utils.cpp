@@ -73,12 +73,11 @@ namespace gl
   {
     GLuint shader_id = 0;
     FILE* file;
-    errno_t err;
 
     long file_size = -1;
     char* glsl_source;
 
-    if (((err = fopen_s(&file, file_name, "rb")) != 0) &&
+    if (((file = fopen(file_name, "rb")) != NULL) &&
       0 == fseek(file, 0, SEEK_END) &&
       -1 != (file_size = ftell(file)))
     {
@@ -165,7 +164,13 @@ namespace gl
 
           // wstring to string
           char* result = (char*) malloc (sizeof (char)* (wstr.size() + 1));
-          std::use_facet<std::ctype<wchar_t>>(std::locale(".1252")).narrow(wstr.data(), wstr.data() + wstr.size(), ' ', result);
+#ifdef _WIN32
+          std::locale narrow_locale(".1252");
+#else
+          // Code page names are not locales elsewhere, the non-ASCII characters become ' '
+          std::locale narrow_locale = std::locale::classic();
+#endif
+          std::use_facet<std::ctype<wchar_t>>(narrow_locale).narrow(wstr.data(), wstr.data() + wstr.size(), ' ', result);
           result[wstr.size()] = '\0';
 
           return result;
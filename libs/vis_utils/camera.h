@@ -148,6 +148,10 @@ namespace vis
     float GetTanFovY ();
   
     void SetData (CameraData* data);
+    CameraData GetData ()
+    {
+      return c_data;
+    }
   
     void GetCameraVectors (glm::vec3* forward, glm::vec3* up, glm::vec3* right);
   
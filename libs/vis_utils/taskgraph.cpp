@@ -0,0 +1,377 @@
+#include "taskgraph.h"
+
+#include <gl_utils/profiler.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+
+namespace vis
+{
+  namespace
+  {
+    thread_local int s_current_worker = -1;
+  }
+
+  TaskPool& TaskPool::Instance ()
+  {
+    static TaskPool pool;
+    return pool;
+  }
+
+  TaskPool::TaskPool ()
+    : pending(0), steals(0), next_queue(0), stop(false)
+  {
+    // The thread waiting for the tasks (e.g. the context thread) also runs them
+    int n_threads = std::max((int)std::thread::hardware_concurrency() - 1, 0);
+
+    for (int i = 0; i <= n_threads; i++)
+      queues.push_back(std::unique_ptr<JobQueue>(new JobQueue()));
+    for (int i = 0; i < n_threads; i++)
+      threads.push_back(std::thread(&TaskPool::WorkerLoop, this, i));
+  }
+
+  TaskPool::~TaskPool ()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    cv_jobs.notify_all();
+    for (std::thread& thread : threads)
+      thread.join();
+  }
+
+  int TaskPool::GetCurrentWorker ()
+  {
+    return s_current_worker;
+  }
+
+  void TaskPool::Submit (Job job)
+  {
+    // Jobs of other threads are spread among the workers, so they start stealing from each other
+    int queue = s_current_worker;
+    if (queue < 0)
+      queue = threads.empty() ? 0 : (int)(next_queue++ % (unsigned int)threads.size());
+
+    {
+      std::lock_guard<std::mutex> lock(queues[queue]->mutex);
+      queues[queue]->jobs.push_back(std::move(job));
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      pending++;
+    }
+    cv_jobs.notify_one();
+  }
+
+  bool TaskPool::RunOne ()
+  {
+    Job job;
+    if (!Pop(s_current_worker, job)) return false;
+    job();
+    return true;
+  }
+
+  void TaskPool::ParallelFor (int n, const std::function<void (int, int)>& body, int grain, int max_threads)
+  {
+    if (n <= 0) return;
+    grain = std::max(grain, 1);
+
+    int n_chunks = (n + grain - 1) / grain;
+    if (threads.empty() || n_chunks == 1 || max_threads == 1)
+    {
+      body(0, n);
+      return;
+    }
+
+    // One job per chunk, or max_threads jobs that take the chunks in order
+    int n_jobs = n_chunks;
+    if (max_threads > 0 && max_threads < GetMaxConcurrency()) n_jobs = std::min(n_chunks, max_threads);
+
+    std::atomic<int> next_chunk(0);
+    std::atomic<int> remaining(n_jobs);
+    std::exception_ptr exception;
+    std::mutex exception_mutex;
+    for (int j = 0; j < n_jobs; j++)
+    {
+      Submit([&, j] () {
+        try
+        {
+          if (n_jobs == n_chunks)
+            body(j * grain, std::min(n, (j + 1) * grain));
+          else
+            for (int c = next_chunk++; c < n_chunks; c = next_chunk++)
+              body(c * grain, std::min(n, (c + 1) * grain));
+        }
+        catch (...)
+        {
+          std::lock_guard<std::mutex> lock(exception_mutex);
+          if (!exception) exception = std::current_exception();
+        }
+        remaining--;
+      });
+    }
+
+    // Helps instead of blocking, so nested loops never wait on busy workers
+    while (remaining.load() > 0)
+    {
+      if (!RunOne()) std::this_thread::yield();
+    }
+
+    if (exception) std::rethrow_exception(exception);
+  }
+
+  void TaskPool::WorkerLoop (int worker)
+  {
+    s_current_worker = worker;
+#ifdef USING_PROFILER
+    gl::Profiler::Instance().SetThreadName("Worker " + std::to_string(worker));
+#endif
+    while (true)
+    {
+      Job job;
+      if (Pop(worker, job))
+      {
+        job();
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(mutex);
+      cv_jobs.wait(lock, [this] () { return stop || pending.load() > 0; });
+      if (stop) return;
+    }
+  }
+
+  bool TaskPool::Pop (int worker, Job& job)
+  {
+    int n_queues = (int)queues.size();
+
+    // Own jobs from the back, the most recent ones are still in cache
+    if (worker >= 0)
+    {
+      std::lock_guard<std::mutex> lock(queues[worker]->mutex);
+      if (!queues[worker]->jobs.empty())
+      {
+        job = std::move(queues[worker]->jobs.back());
+        queues[worker]->jobs.pop_back();
+        pending--;
+        return true;
+      }
+    }
+
+    // The oldest jobs of the others, usually the largest pieces of work
+    int first = worker >= 0 ? worker + 1 : 0;
+    for (int i = 0; i < n_queues; i++)
+    {
+      int victim = (first + i) % n_queues;
+      if (victim == worker) continue;
+
+      std::lock_guard<std::mutex> lock(queues[victim]->mutex);
+      if (!queues[victim]->jobs.empty())
+      {
+        job = std::move(queues[victim]->jobs.front());
+        queues[victim]->jobs.pop_front();
+        pending--;
+        if (worker >= 0) steals++;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  TaskGraph::TaskGraph (const std::string& _name)
+    : name(_name), n_finished(0), total_ms(0.0), critical_ms(0.0)
+  {
+  }
+
+  TaskGraph::~TaskGraph ()
+  {
+  }
+
+  TaskGraph::TaskID TaskGraph::AddTask (const std::string& task_name, std::function<void ()> work,
+                                        const std::vector<TaskID>& dependencies, bool on_context_thread)
+  {
+    TaskID id = (TaskID)tasks.size();
+
+    Task task;
+    task.name = task_name;
+    task.work = work;
+    task.context = on_context_thread;
+    for (TaskID dependency : dependencies)
+    {
+      if (dependency < 0 || dependency >= id) continue;
+      task.dependencies.push_back(dependency);
+      tasks[dependency].successors.push_back(id);
+    }
+    tasks.push_back(task);
+    return id;
+  }
+
+  bool TaskGraph::Run ()
+  {
+    int n_tasks = (int)tasks.size();
+
+    timings.assign(n_tasks, TaskTiming());
+    for (int i = 0; i < n_tasks; i++)
+    {
+      timings[i].name = tasks[i].name;
+      timings[i].start_ms = timings[i].end_ms = 0.0;
+      timings[i].thread = -1;
+      timings[i].context = tasks[i].context;
+      timings[i].critical = false;
+      timings[i].done = false;
+    }
+    failed.assign(n_tasks, 0);
+    remaining_dependencies.reset(new std::atomic<int>[n_tasks]);
+    for (int i = 0; i < n_tasks; i++)
+      remaining_dependencies[i] = (int)tasks[i].dependencies.size();
+    context_tasks.clear();
+    n_finished = 0;
+    error.clear();
+
+    run_start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < n_tasks; i++)
+      if (tasks[i].dependencies.empty()) Dispatch(i);
+
+    // Context tasks run here, the pool jobs are run while there is none
+    TaskPool& pool = TaskPool::Instance();
+    while (true)
+    {
+      TaskID context_task = -1;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (n_finished == n_tasks) break;
+        if (!context_tasks.empty())
+        {
+          context_task = context_tasks.front();
+          context_tasks.pop_front();
+        }
+      }
+
+      if (context_task >= 0)
+        Execute(context_task);
+      else if (!pool.RunOne())
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv_context.wait_for(lock, std::chrono::milliseconds(1),
+          [this, n_tasks] () { return n_finished == n_tasks || !context_tasks.empty(); });
+      }
+    }
+
+    total_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - run_start).count();
+    ComputeCriticalPath();
+    return error.empty();
+  }
+
+  std::string TaskGraph::GetCriticalPath ()
+  {
+    std::string path;
+    for (const TaskTiming& timing : timings)
+    {
+      if (!timing.critical) continue;
+      if (!path.empty()) path += " -> ";
+      path += timing.name;
+    }
+    return path;
+  }
+
+  void TaskGraph::PrintReport ()
+  {
+    printf("%s: %.1f ms, critical path %.1f ms (%s)\n", name.c_str(), total_ms, critical_ms, GetCriticalPath().c_str());
+    for (const TaskTiming& timing : timings)
+    {
+      char thread[32];
+      if (timing.thread < 0) snprintf(thread, sizeof(thread), timing.context ? "context" : "context (helping)");
+      else snprintf(thread, sizeof(thread), "worker %d", timing.thread);
+      printf("  %c %-24s %8.1f ms  [%8.1f, %8.1f] %s%s\n", timing.critical ? '*' : ' ', timing.name.c_str(),
+        timing.end_ms - timing.start_ms, timing.start_ms, timing.end_ms, thread, timing.done ? "" : " (not done)");
+    }
+    if (!error.empty()) printf("  %s\n", error.c_str());
+  }
+
+  void TaskGraph::Dispatch (TaskID id)
+  {
+    if (tasks[id].context)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        context_tasks.push_back(id);
+      }
+      cv_context.notify_one();
+    }
+    else
+      TaskPool::Instance().Submit([this, id] () { Execute(id); });
+  }
+
+  void TaskGraph::Execute (TaskID id)
+  {
+    TaskTiming& timing = timings[id];
+    timing.thread = TaskPool::GetCurrentWorker();
+    timing.start_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - run_start).count();
+
+    bool skip = false;
+    for (TaskID dependency : tasks[id].dependencies)
+      if (failed[dependency]) skip = true;
+
+    if (skip)
+      failed[id] = 1;
+    else
+    {
+      try
+      {
+        PROFILE_ZONE(tasks[id].name);
+        tasks[id].work();
+        timing.done = true;
+      }
+      catch (const std::exception& e)
+      {
+        failed[id] = 1;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error.empty()) error = tasks[id].name + ": " + e.what();
+      }
+      catch (...)
+      {
+        failed[id] = 1;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error.empty()) error = tasks[id].name + " failed";
+      }
+    }
+    timing.end_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - run_start).count();
+
+    for (TaskID successor : tasks[id].successors)
+      if (--remaining_dependencies[successor] == 0) Dispatch(successor);
+
+    // Notified with the lock held: Run may return, and the graph be destroyed, right after
+    std::lock_guard<std::mutex> lock(mutex);
+    n_finished++;
+    cv_context.notify_one();
+  }
+
+  void TaskGraph::ComputeCriticalPath ()
+  {
+    // Tasks are in topological order: dependencies are added before
+    int n_tasks = (int)tasks.size();
+    std::vector<double> path_ms(n_tasks, 0.0);
+    std::vector<TaskID> previous(n_tasks, -1);
+    TaskID last = -1;
+    for (int i = 0; i < n_tasks; i++)
+    {
+      for (TaskID dependency : tasks[i].dependencies)
+      {
+        if (path_ms[dependency] > path_ms[i])
+        {
+          path_ms[i] = path_ms[dependency];
+          previous[i] = dependency;
+        }
+      }
+      path_ms[i] += timings[i].end_ms - timings[i].start_ms;
+      if (last < 0 || path_ms[i] > path_ms[last]) last = i;
+    }
+
+    critical_ms = last >= 0 ? path_ms[last] : 0.0;
+    for (TaskID id = last; id >= 0; id = previous[id])
+      timings[id].critical = true;
+  }
+}
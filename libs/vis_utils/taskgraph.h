@@ -0,0 +1,156 @@
+/**
+ * Preprocessing task graph on a shared work-stealing thread pool.
+ *
+ * vis::TaskPool owns one worker thread per hardware thread but one, each with
+ * its own deque of jobs: a worker pops the jobs it queued from the back and,
+ * when its deque is empty, steals from the front of the others. ParallelFor
+ * splits a loop in chunks on the same deques, so a stage of a graph is also
+ * parallelised internally, and the thread waiting for the chunks runs them
+ * too.
+ *
+ * vis::TaskGraph runs named tasks once their dependencies are done. Tasks
+ * that call OpenGL are marked as context tasks and run on the thread calling
+ * Run, which must have the context current, while the other tasks run on the
+ * pool. The time of each task is recorded, with the critical path: the chain
+ * of dependencies that took the longest, which bounds the time of the graph.
+**/
+#ifndef VIS_UTILS_TASK_GRAPH_H
+#define VIS_UTILS_TASK_GRAPH_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vis
+{
+  class TaskPool
+  {
+  public:
+    typedef std::function<void ()> Job;
+
+    static TaskPool& Instance ();
+
+    int GetNumberOfThreads () { return (int)threads.size(); }
+    // Threads that run the chunks of a ParallelFor: the workers and the calling thread
+    int GetMaxConcurrency () { return (int)threads.size() + 1; }
+    // Index of the calling worker, -1 if it is not a worker of the pool
+    static int GetCurrentWorker ();
+
+    // Queued on the deque of the calling worker, or spread among the workers
+    void Submit (Job job);
+    // Runs one queued job on the calling thread, false if there is none
+    bool RunOne ();
+
+    // body(begin, end) over [0, n) in chunks of grain indices, returns when every chunk is done
+    // . max_threads > 0 runs at most that many chunks at a time (e.g. thread scaling measurements)
+    // . an exception thrown by a chunk is thrown again here
+    void ParallelFor (int n, const std::function<void (int, int)>& body, int grain = 1, int max_threads = 0);
+
+    size_t GetNumberOfSteals () { return steals.load(); }
+
+  protected:
+  private:
+    TaskPool ();
+    ~TaskPool ();
+
+    void WorkerLoop (int worker);
+    bool Pop (int worker, Job& job);
+
+    struct JobQueue
+    {
+      std::mutex mutex;
+      std::deque<Job> jobs;
+    };
+
+    std::vector<std::thread> threads;
+    // One per worker, and a last one for the jobs submitted by other threads
+    std::vector<std::unique_ptr<JobQueue>> queues;
+
+    std::mutex mutex;
+    std::condition_variable cv_jobs;
+    std::atomic<int> pending;
+    std::atomic<size_t> steals;
+    std::atomic<unsigned int> next_queue;
+    bool stop;
+  };
+
+  class TaskGraph
+  {
+  public:
+    typedef int TaskID;
+
+    struct TaskTiming
+    {
+      std::string name;
+      // From the start of Run
+      double start_ms, end_ms;
+      // Worker of the pool, -1 for the context thread
+      int thread;
+      bool context;
+      bool critical;
+      // False if the task or one of its dependencies failed
+      bool done;
+    };
+
+    TaskGraph (const std::string& name);
+    ~TaskGraph ();
+
+    // dependencies must be tasks added before
+    TaskID AddTask (const std::string& name, std::function<void ()> work,
+                    const std::vector<TaskID>& dependencies = std::vector<TaskID>(), bool on_context_thread = false);
+
+    // Runs every task and waits for them, the context tasks on the calling thread
+    // . false if a task threw, the tasks depending on it are not run
+    bool Run ();
+
+    // Last Run
+    const std::vector<TaskTiming>& GetTimings () { return timings; }
+    double GetTotalTime () { return total_ms; }
+    double GetCriticalPathTime () { return critical_ms; }
+    // Names of the critical tasks, "a -> b -> c"
+    std::string GetCriticalPath ();
+    std::string GetError () { return error; }
+    void PrintReport ();
+
+  protected:
+  private:
+    struct Task
+    {
+      std::string name;
+      std::function<void ()> work;
+      std::vector<TaskID> dependencies;
+      std::vector<TaskID> successors;
+      bool context;
+    };
+
+    void Dispatch (TaskID id);
+    void Execute (TaskID id);
+    void ComputeCriticalPath ();
+
+    std::string name;
+    std::vector<Task> tasks;
+
+    // State of Run
+    std::chrono::high_resolution_clock::time_point run_start;
+    std::unique_ptr<std::atomic<int>[]> remaining_dependencies;
+    std::vector<char> failed;
+    std::mutex mutex;
+    std::condition_variable cv_context;
+    std::deque<TaskID> context_tasks;
+    int n_finished;
+
+    std::vector<TaskTiming> timings;
+    double total_ms;
+    double critical_ms;
+    std::string error;
+  };
+}
+
+#endif
@@ -0,0 +1,177 @@
+#include "blockintervalindex.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace vis
+{
+  BlockIntervalIndex::BlockIntervalIndex ()
+    : m_root(-1)
+    , m_last_active_valid(false)
+    , m_time_build_ms(0.0)
+    , m_time_query_ms(0.0)
+  {
+  }
+
+  BlockIntervalIndex::~BlockIntervalIndex ()
+  {
+    Clear();
+  }
+
+  void BlockIntervalIndex::Clear ()
+  {
+    m_interval_min.clear();
+    m_interval_max.clear();
+    m_nodes.clear();
+    m_by_min.clear();
+    m_by_max.clear();
+    m_last_active.clear();
+    // The mask of the next query may hold bits of the old intervals
+    m_last_active_valid = false;
+    m_root = -1;
+  }
+
+  void BlockIntervalIndex::Build (const std::vector<float>& block_min,
+                                  const std::vector<float>& block_max,
+                                  float epsilon)
+  {
+    auto t_start = std::chrono::high_resolution_clock::now();
+
+    Clear();
+
+    size_t n = std::min(block_min.size(), block_max.size());
+    m_interval_min.resize(n);
+    m_interval_max.resize(n);
+    for (size_t i = 0; i < n; i++)
+    {
+      m_interval_min[i] = block_min[i] - epsilon;
+      m_interval_max[i] = block_max[i] + epsilon;
+    }
+
+    std::vector<unsigned int> ids(n);
+    for (size_t i = 0; i < n; i++)
+      ids[i] = (unsigned int)i;
+
+    m_by_min.reserve(n);
+    m_by_max.reserve(n);
+    m_root = BuildNode(ids);
+
+    auto t_end = std::chrono::high_resolution_clock::now();
+    m_time_build_ms = std::chrono::duration<double, std::milli>(t_end - t_start).count();
+
+    printf("vis::BlockIntervalIndex: %zu intervals indexed with %zu nodes in %.2f ms.\n",
+      n, m_nodes.size(), m_time_build_ms);
+  }
+
+  size_t BlockIntervalIndex::Query (float isovalue, std::vector<unsigned int>& active_blocks)
+  {
+    auto t_start = std::chrono::high_resolution_clock::now();
+
+    active_blocks.clear();
+    Stab(isovalue, [&](unsigned int id) { active_blocks.push_back(id); });
+
+    auto t_end = std::chrono::high_resolution_clock::now();
+    m_time_query_ms = std::chrono::duration<double, std::milli>(t_end - t_start).count();
+
+    return active_blocks.size();
+  }
+
+  size_t BlockIntervalIndex::QueryBitmask (float isovalue, std::vector<unsigned int>& bitmask)
+  {
+    auto t_start = std::chrono::high_resolution_clock::now();
+
+    // Only the words set by the previous query are cleared, the mask is not walked
+    if (!m_last_active_valid || bitmask.size() != GetBitmaskSize())
+      bitmask.assign(GetBitmaskSize(), 0u);
+    else
+      for (unsigned int id : m_last_active) bitmask[id >> 5] = 0u;
+
+    m_last_active.clear();
+    Stab(isovalue, [&](unsigned int id)
+    {
+      bitmask[id >> 5] |= (1u << (id & 31u));
+      m_last_active.push_back(id);
+    });
+    m_last_active_valid = true;
+    size_t n_active = m_last_active.size();
+
+    auto t_end = std::chrono::high_resolution_clock::now();
+    m_time_query_ms = std::chrono::duration<double, std::milli>(t_end - t_start).count();
+
+    return n_active;
+  }
+
+  int BlockIntervalIndex::BuildNode (std::vector<unsigned int>& ids)
+  {
+    if (ids.empty()) return -1;
+
+    // Center at the median of the interval midpoints. The interval holding
+    //   the median always crosses the center, so each level makes progress.
+    std::vector<float> mids(ids.size());
+    for (size_t i = 0; i < ids.size(); i++)
+      mids[i] = 0.5f * (m_interval_min[ids[i]] + m_interval_max[ids[i]]);
+    std::nth_element(mids.begin(), mids.begin() + mids.size() / 2, mids.end());
+    float center = mids[mids.size() / 2];
+
+    std::vector<unsigned int> ids_left, ids_right, ids_center;
+    for (unsigned int id : ids)
+    {
+      if (m_interval_max[id] < center)
+        ids_left.push_back(id);
+      else if (m_interval_min[id] > center)
+        ids_right.push_back(id);
+      else
+        ids_center.push_back(id);
+    }
+    // Release memory before going down the tree
+    std::vector<unsigned int>().swap(ids);
+
+    int node_id = (int)m_nodes.size();
+    m_nodes.push_back(Node());
+
+    Node node;
+    node.center = center;
+    node.first = (unsigned int)m_by_min.size();
+    node.count = (unsigned int)ids_center.size();
+
+    std::sort(ids_center.begin(), ids_center.end(),
+      [&](unsigned int a, unsigned int b) { return m_interval_min[a] < m_interval_min[b]; });
+    m_by_min.insert(m_by_min.end(), ids_center.begin(), ids_center.end());
+
+    std::sort(ids_center.begin(), ids_center.end(),
+      [&](unsigned int a, unsigned int b) { return m_interval_max[a] > m_interval_max[b]; });
+    m_by_max.insert(m_by_max.end(), ids_center.begin(), ids_center.end());
+
+    node.left = BuildNode(ids_left);
+    node.right = BuildNode(ids_right);
+
+    m_nodes[node_id] = node;
+    return node_id;
+  }
+
+  template<typename ReportFunction>
+  void BlockIntervalIndex::Stab (float isovalue, ReportFunction report)
+  {
+    int node_id = m_root;
+    while (node_id >= 0)
+    {
+      const Node& node = m_nodes[node_id];
+      unsigned int last = node.first + node.count;
+      if (isovalue < node.center)
+      {
+        // Every interval here ends after the center: only check the start
+        for (unsigned int i = node.first; i < last && m_interval_min[m_by_min[i]] <= isovalue; i++)
+          report(m_by_min[i]);
+        node_id = node.left;
+      }
+      else
+      {
+        // Every interval here starts before the center: only check the end
+        for (unsigned int i = node.first; i < last && m_interval_max[m_by_max[i]] >= isovalue; i++)
+          report(m_by_max[i]);
+        node_id = isovalue > node.center ? node.right : -1;
+      }
+    }
+  }
+}
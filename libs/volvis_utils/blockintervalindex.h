@@ -0,0 +1,84 @@
+/**
+ * Interval index over the [min, max] scalar ranges of volume blocks
+ * . Centered interval tree: a stabbing query for an isovalue returns the
+ *   k active blocks in O(log n + k), without testing every block.
+ * . The result can be written as a bitmask with one bit per block, to be
+ *   uploaded to the GPU so the shader skip test is a single bit fetch.
+ *
+ * . Computational Geometry: Algorithms and Applications (Section 10.1)
+ *   . de Berg, Cheong, van Kreveld, Overmars
+**/
+#ifndef VOL_VIS_UTILS_BLOCK_INTERVAL_INDEX_H
+#define VOL_VIS_UTILS_BLOCK_INTERVAL_INDEX_H
+
+#include <vector>
+#include <cstddef>
+
+namespace vis
+{
+  class BlockIntervalIndex
+  {
+  public:
+    BlockIntervalIndex ();
+    ~BlockIntervalIndex ();
+
+    void Clear ();
+
+    // Build the index. Each interval is enlarged by epsilon at both sides.
+    void Build (const std::vector<float>& block_min,
+                const std::vector<float>& block_max,
+                float epsilon = 0.0f);
+
+    // Collect the ids of the blocks whose interval contains the isovalue
+    size_t Query (float isovalue, std::vector<unsigned int>& active_blocks);
+
+    // Set one bit per active block, 32 blocks per unsigned int
+    // . bitmask is resized to GetBitmaskSize()
+    // . pass the bitmask of the previous call: only the bits it set are cleared,
+    //   the whole mask after a Build or Clear
+    size_t QueryBitmask (float isovalue, std::vector<unsigned int>& bitmask);
+
+    size_t GetNumberOfIntervals () { return m_interval_min.size(); }
+    size_t GetBitmaskSize () { return (m_interval_min.size() + 31) / 32; }
+
+    double GetBuildTime () { return m_time_build_ms; }
+    double GetLastQueryTime () { return m_time_query_ms; }
+
+  protected:
+
+  private:
+    struct Node
+    {
+      float center;
+      int left;
+      int right;
+      // Range of the intervals crossing the center at m_by_min/m_by_max
+      unsigned int first;
+      unsigned int count;
+    };
+
+    int BuildNode (std::vector<unsigned int>& ids);
+
+    template<typename ReportFunction>
+    void Stab (float isovalue, ReportFunction report);
+
+    std::vector<float> m_interval_min;
+    std::vector<float> m_interval_max;
+
+    std::vector<Node> m_nodes;
+    int m_root;
+
+    // Crossing intervals of each node, sorted by increasing min and decreasing max
+    std::vector<unsigned int> m_by_min;
+    std::vector<unsigned int> m_by_max;
+
+    // Blocks set by the last QueryBitmask, since the last Build or Clear
+    std::vector<unsigned int> m_last_active;
+    bool m_last_active_valid;
+
+    double m_time_build_ms;
+    double m_time_query_ms;
+  };
+}
+
+#endif
@@ -6,8 +6,12 @@
 **/
 #include <volvis_utils/datamanager.h>
 
+#include <chrono>
 #include <fstream>
+#include <stdexcept>
 #include <gl_utils/computeshader.h>
+#include <gl_utils/memoryregistry.h>
+#include <gl_utils/profiler.h>
 #include <vis_utils/defines.h>
 #include <volvis_utils/utils.h>
 
@@ -27,6 +31,13 @@ namespace vis
     , curr_gradient_comp_model(DataManager::STRUCTURED_GRADIENT_TYPE::NONE_GRADIENT)
     , curr_gl_tex_structured_volume(nullptr)
     , curr_gl_tex_structured_gradient(nullptr)
+    , m_time_volume_load_ms(0.0)
+    , m_time_gradient_ms(0.0)
+    , m_time_volume_upload_ms(0.0)
+    , m_volume_upload_bytes(0)
+    , m_volume_staging_bytes(0)
+    , m_load_total_ms(0.0)
+    , m_load_critical_ms(0.0)
   {
     m_path_to_data = "";
 #ifdef USE_DATA_PROVIDER
@@ -193,6 +204,12 @@ namespace vis
     return curr_gl_tex_structured_gradient;
   }
 
+  std::string DataManager::GetPreprocessingKey (const std::string& product, bool uses_transfer_function, const std::string& parameters)
+  {
+    return PreprocessingRegistry::MakeKey(product, GetCurrentVolumeName(),
+      uses_transfer_function ? GetCurrentTransferFunctionName() : std::string(), parameters);
+  }
+
   std::vector<std::string>& DataManager::GetUINameTransferFunctionList ()
   {
 #ifdef USE_DATA_PROVIDER
@@ -310,45 +327,128 @@ namespace vis
 
   bool DataManager::GenerateStructuredVolumeTexture ()
   {
-    // Read Volume
+    // The volume is uploaded on the context thread while the workers compute the gradient
+    vis::TaskGraph graph("Dataset load");
+
+    vis::TaskGraph::TaskID read = graph.AddTask("Read", [&] () {
 #ifdef USE_DATA_PROVIDER
-    curr_vr_volume = m_data_provider->LoadStructuredGrid(GetCurrentVolumeIndex());
+      curr_vr_volume = m_data_provider->LoadStructuredGrid(GetCurrentVolumeIndex());
 #else
-    vis::VolumeReader vr;
-    curr_vr_volume = vr.ReadStructuredVolume(stored_structured_datasets[GetCurrentVolumeIndex()].path);
-    curr_vr_volume->SetName(stored_structured_datasets[GetCurrentVolumeIndex()].name); 
+      vis::VolumeReader vr;
+      curr_vr_volume = vr.ReadStructuredVolume(stored_structured_datasets[GetCurrentVolumeIndex()].path);
+      if (curr_vr_volume == nullptr) throw std::runtime_error("could not read the volume");
+      curr_vr_volume->SetName(stored_structured_datasets[GetCurrentVolumeIndex()].name); 
 #endif
-
-    // Generate Volume Texture
-    curr_gl_tex_structured_volume = vis::GenerateRTexture(curr_vr_volume, 0, 0, 0, curr_vr_volume->GetWidth(),
-      curr_vr_volume->GetHeight(), curr_vr_volume->GetDepth());
+    });
+
+    vis::TaskGraph::TaskID volume_upload = graph.AddTask("Volume Upload", [&] () {
+      // Generate Volume Texture, in the type of the volume
+      gl::MemoryRegistry::ScopedTag memory_tag("Volume");
+      PROFILE_GPU_ZONE("Volume Upload");
+      vis::VolumeUploadStatistics upload;
+      curr_gl_tex_structured_volume = vis::GenerateNativeRTexture(curr_vr_volume, 64 * 1024 * 1024, &upload);
+      if (curr_gl_tex_structured_volume)
+      {
+        m_time_volume_upload_ms = upload.upload_ms;
+        m_volume_upload_bytes = upload.upload_bytes;
+        m_volume_staging_bytes = upload.staging_bytes;
+        printf("Volume upload: %.1f MB in %.1f ms (%.1f MB/s), %.1f MB of staging buffers\n",
+          upload.upload_bytes / (1024.0 * 1024.0), upload.upload_ms,
+          upload.upload_bytes / (1024.0 * 1024.0) / (upload.upload_ms / 1000.0), upload.staging_bytes / (1024.0 * 1024.0));
+      }
+      else
+      {
+        // Unknown data types, converted to float
+        curr_gl_tex_structured_volume = vis::GenerateRTexture(curr_vr_volume, 0, 0, 0, curr_vr_volume->GetWidth(),
+          curr_vr_volume->GetHeight(), curr_vr_volume->GetDepth());
+      }
+    }, { read }, true);
 
     // Generate gradient, if enabled
-    GenerateStructuredGradientTexture();
+    glm::vec3* gradients = nullptr;
+    std::vector<vis::TaskGraph::TaskID> gradient_tasks = AddGradientTasks(graph, read, volume_upload, gradients);
+
+    bool ret = graph.Run();
+    if (gradients) delete[] gradients;
+    SetLoadReport(graph);
 
-    return true;
+    m_time_volume_load_ms = graph.GetTimings()[volume_upload].end_ms;
+    m_time_gradient_ms = 0.0;
+    for (vis::TaskGraph::TaskID id : gradient_tasks)
+      m_time_gradient_ms += graph.GetTimings()[id].end_ms - graph.GetTimings()[id].start_ms;
+
+    return ret;
   }
 
   bool DataManager::GenerateStructuredGradientTexture ()
   {
-    if (curr_gradient_comp_model == STRUCTURED_GRADIENT_TYPE::SOBEL_FELDMAN_FILTER)
+    m_time_gradient_ms = 0.0;
+    if (curr_gradient_comp_model == STRUCTURED_GRADIENT_TYPE::NONE_GRADIENT)
     {
-      curr_gl_tex_structured_gradient = vis::GenerateSobelFeldmanGradientTexture(curr_vr_volume);
+      curr_gl_tex_structured_gradient = nullptr;
+      return false;
     }
-    else if (curr_gradient_comp_model == STRUCTURED_GRADIENT_TYPE::FINITE_DIFERENCES)
+
+    vis::TaskGraph graph("Gradient");
+    glm::vec3* gradients = nullptr;
+    AddGradientTasks(graph, -1, -1, gradients);
+
+    bool ret = graph.Run();
+    if (gradients) delete[] gradients;
+    m_time_gradient_ms = graph.GetTotalTime();
+    return ret;
+  }
+
+  std::vector<vis::TaskGraph::TaskID> DataManager::AddGradientTasks (vis::TaskGraph& graph,
+    vis::TaskGraph::TaskID read, vis::TaskGraph::TaskID volume_upload, glm::vec3*& gradients)
+  {
+    std::vector<vis::TaskGraph::TaskID> tasks;
+    STRUCTURED_GRADIENT_TYPE model = curr_gradient_comp_model;
+
+    if (model == STRUCTURED_GRADIENT_TYPE::SOBEL_FELDMAN_FILTER || model == STRUCTURED_GRADIENT_TYPE::FINITE_DIFERENCES)
     {
-      curr_gl_tex_structured_gradient = vis::GenerateGradientTexture(curr_vr_volume);
+      // Only needs the volume data, computed on the workers
+      tasks.push_back(graph.AddTask("Gradient", [this, model, &gradients] () {
+        if (model == STRUCTURED_GRADIENT_TYPE::SOBEL_FELDMAN_FILTER)
+          gradients = vis::ComputeSobelFeldmanGradients(curr_vr_volume);
+        else
+          gradients = vis::ComputeGradients(curr_vr_volume);
+      }, { read }));
+
+      tasks.push_back(graph.AddTask("Gradient Upload", [this, &gradients] () {
+        gl::MemoryRegistry::ScopedTag memory_tag("Gradient");
+        PROFILE_GPU_ZONE("Gradient Upload");
+        curr_gl_tex_structured_gradient = vis::GenerateGradientTexture(gradients,
+          curr_vr_volume->GetWidth(), curr_vr_volume->GetHeight(), curr_vr_volume->GetDepth());
+        delete[] gradients;
+        gradients = nullptr;
+      }, { tasks.back() }, true));
     }
-    else if (curr_gradient_comp_model == STRUCTURED_GRADIENT_TYPE::COMPUTE_SHADER_SOBEL)
+    else if (model == STRUCTURED_GRADIENT_TYPE::COMPUTE_SHADER_SOBEL)
     {
-      curr_gl_tex_structured_gradient = GenerateGradientWithComputeShader();
+      // Reads the volume texture
+      tasks.push_back(graph.AddTask("Gradient", [this] () {
+        gl::MemoryRegistry::ScopedTag memory_tag("Gradient");
+        curr_gl_tex_structured_gradient = GenerateGradientWithComputeShader();
+      }, { volume_upload }, true));
     }
     else
     {
       curr_gl_tex_structured_gradient = nullptr;
-      return false;
     }
-    return true;
+    return tasks;
+  }
+
+  void DataManager::SetLoadReport (vis::TaskGraph& graph)
+  {
+    graph.PrintReport();
+    if (!graph.GetError().empty())
+      fprintf(stderr, "vis::DataManager: %s\n", graph.GetError().c_str());
+
+    m_load_stages = graph.GetTimings();
+    m_load_total_ms = graph.GetTotalTime();
+    m_load_critical_ms = graph.GetCriticalPathTime();
+    m_load_critical_path = graph.GetCriticalPath();
   }
 
   bool DataManager::PreviousVolume ()
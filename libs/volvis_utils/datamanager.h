@@ -31,6 +31,8 @@
 #include <volvis_utils/unstructuredgridvolume.h>
 #include <volvis_utils/transferfunction.h>
 #include <volvis_utils/reader.h>
+#include <volvis_utils/preprocessingregistry.h>
+#include <vis_utils/taskgraph.h>
 
 #include <gl_utils/texture3d.h>
 #include <gl_utils/texture1d.h>
@@ -98,6 +100,11 @@ namespace vis
 
     gl::Texture3D* GetCurrentGradientTexture ();
 
+    // Products shared by the renderers, see preprocessingregistry.h
+    PreprocessingRegistry& GetPreprocessingRegistry () { return m_preprocessing_registry; }
+    // Key of a product of the current volume, and of the current transfer function if it depends on it
+    std::string GetPreprocessingKey (const std::string& product, bool uses_transfer_function, const std::string& parameters = "");
+
     bool PreviousVolume ();
     bool NextVolume ();
     bool SetVolume (std::string name);
@@ -122,6 +129,19 @@ namespace vis
     void DeleteVolumeData ();
     void DeleteTransferFunctionData ();
     void DeleteGradientData ();
+
+    // Time to read and upload the last volume, and to compute its gradient
+    double GetLastVolumeLoadTime () { return m_time_volume_load_ms; }
+    double GetLastGradientTime () { return m_time_gradient_ms; }
+    // Upload of the last volume texture (part of the load time), and the memory allocated for it
+    double GetLastVolumeUploadTime () { return m_time_volume_upload_ms; }
+    size_t GetLastVolumeUploadBytes () { return m_volume_upload_bytes; }
+    size_t GetLastVolumeStagingBytes () { return m_volume_staging_bytes; }
+    // Stages of the last volume load, run as a vis::TaskGraph
+    const std::vector<vis::TaskGraph::TaskTiming>& GetLastLoadStages () { return m_load_stages; }
+    double GetLastLoadTotalTime () { return m_load_total_ms; }
+    double GetLastLoadCriticalPathTime () { return m_load_critical_ms; }
+    std::string GetLastLoadCriticalPath () { return m_load_critical_path; }
   protected:
 #ifndef USE_DATA_PROVIDER
     void ReadStructuredDatasetsFromRes ();
@@ -130,6 +150,11 @@ namespace vis
 
     bool GenerateStructuredVolumeTexture ();
     bool GenerateStructuredGradientTexture ();
+    // Tasks computing the gradient of the current model, after read (on the workers)
+    //   or after volume_upload (compute shader), returns them
+    std::vector<vis::TaskGraph::TaskID> AddGradientTasks (vis::TaskGraph& graph, vis::TaskGraph::TaskID read,
+                                                          vis::TaskGraph::TaskID volume_upload, glm::vec3*& gradients);
+    void SetLoadReport (vis::TaskGraph& graph);
 
     // Compute Shaders doesn't support rgb textures, so
     //  we bind 3 r textures, set the data in the shader,
@@ -157,6 +182,18 @@ namespace vis
     gl::Texture3D* curr_gl_tex_structured_gradient;
 
     std::string m_path_to_data;
+
+    double m_time_volume_load_ms;
+    double m_time_gradient_ms;
+    double m_time_volume_upload_ms;
+    size_t m_volume_upload_bytes;
+    size_t m_volume_staging_bytes;
+    std::vector<vis::TaskGraph::TaskTiming> m_load_stages;
+    double m_load_total_ms;
+    double m_load_critical_ms;
+    std::string m_load_critical_path;
+
+    PreprocessingRegistry m_preprocessing_registry;
     
 #ifdef USE_DATA_PROVIDER
     std::unique_ptr<DataProvider> m_data_provider;
@@ -0,0 +1,319 @@
+#include "occupancygrid.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace vis
+{
+  OccupancyGrid::OccupancyGrid ()
+    : m_volume(nullptr)
+    , m_volume_name("")
+    , m_volume_resolution(0)
+    , m_block_size(0)
+    , m_grid_resolution(0)
+    , m_number_of_empty_blocks(0)
+    , m_time_minmax_ms(0.0)
+    , m_time_occupancy_ms(0.0)
+  {
+  }
+
+  OccupancyGrid::~OccupancyGrid ()
+  {
+    Clear();
+  }
+
+  void OccupancyGrid::Clear ()
+  {
+    m_volume = nullptr;
+    m_volume_name = "";
+    m_volume_resolution = glm::ivec3(0);
+    m_block_size = 0;
+    m_grid_resolution = glm::ivec3(0);
+
+    m_block_min.clear();
+    m_block_max.clear();
+    m_occupancy.clear();
+    m_distance.clear();
+
+    m_number_of_empty_blocks = 0;
+  }
+
+  bool OccupancyGrid::BuildBlockMinMax (StructuredGridVolume* vol, int block_size)
+  {
+    if (!vol || block_size <= 0) return false;
+
+    auto t_start = std::chrono::high_resolution_clock::now();
+
+    Clear();
+
+    m_volume = vol;
+    m_volume_name = vol->GetName();
+    m_volume_resolution = glm::ivec3(vol->GetWidth(), vol->GetHeight(), vol->GetDepth());
+    m_block_size = block_size;
+    m_grid_resolution = (m_volume_resolution + glm::ivec3(block_size - 1)) / block_size;
+
+    size_t n_blocks = GetNumberOfBlocks();
+    m_block_min.assign(n_blocks, 1.0f);
+    m_block_max.assign(n_blocks, 0.0f);
+    m_occupancy.assign(n_blocks, 1);
+    m_distance.assign(n_blocks, 0);
+
+    // A trilinear sample inside block b, in voxel space [b*bs, (b+1)*bs], may
+    //   fetch voxels from b*bs - 1 up to (b+1)*bs. So each voxel contributes to
+    //   at most two blocks per axis.
+    std::vector<glm::ivec2> axis_blocks[3];
+    for (int a = 0; a < 3; a++)
+    {
+      axis_blocks[a].resize(m_volume_resolution[a]);
+      for (int i = 0; i < m_volume_resolution[a]; i++)
+      {
+        int b_first = std::max(0, (i + block_size - 1) / block_size - 1);
+        int b_last = std::min(m_grid_resolution[a] - 1, (i + 1) / block_size);
+        axis_blocks[a][i] = glm::ivec2(b_first, b_last);
+      }
+    }
+
+    for (int z = 0; z < m_volume_resolution.z; z++)
+    {
+      glm::ivec2 bz = axis_blocks[2][z];
+      for (int y = 0; y < m_volume_resolution.y; y++)
+      {
+        glm::ivec2 by = axis_blocks[1][y];
+        for (int x = 0; x < m_volume_resolution.x; x++)
+        {
+          glm::ivec2 bx = axis_blocks[0][x];
+          float v = (float)vol->GetNormalizedSample(x, y, z);
+
+          for (int k = bz.x; k <= bz.y; k++)
+          {
+            for (int j = by.x; j <= by.y; j++)
+            {
+              for (int i = bx.x; i <= bx.y; i++)
+              {
+                size_t id = BlockIndex(i, j, k);
+                m_block_min[id] = std::min(m_block_min[id], v);
+                m_block_max[id] = std::max(m_block_max[id], v);
+              }
+            }
+          }
+        }
+      }
+    }
+
+    auto t_end = std::chrono::high_resolution_clock::now();
+    m_time_minmax_ms = std::chrono::duration<double, std::milli>(t_end - t_start).count();
+
+    printf("vis::OccupancyGrid: Block min/max of \"%s\" built with %dx%dx%d blocks of size %d in %.2f ms.\n",
+      m_volume_name.c_str(), m_grid_resolution.x, m_grid_resolution.y, m_grid_resolution.z,
+      m_block_size, m_time_minmax_ms);
+
+    return true;
+  }
+
+  bool OccupancyGrid::IsBlockMinMaxBuiltFor (StructuredGridVolume* vol, int block_size)
+  {
+    return vol && m_volume == vol && m_block_size == block_size
+      && m_volume_name.compare(vol->GetName()) == 0
+      && m_volume_resolution == glm::ivec3(vol->GetWidth(), vol->GetHeight(), vol->GetDepth())
+      && !m_block_min.empty();
+  }
+
+  bool OccupancyGrid::UpdateOccupancy (TransferFunction* tf, int tf_length)
+  {
+    if (!tf || m_block_min.empty() || tf_length < 2) return false;
+
+    auto t_start = std::chrono::high_resolution_clock::now();
+
+    // Prefix sum of the opacity table: sum of alpha over [lo, hi] is
+    //   alpha_prefix[hi + 1] - alpha_prefix[lo]
+    std::vector<double> alpha_prefix(tf_length + 1, 0.0);
+    for (int i = 0; i < tf_length; i++)
+    {
+      double alpha = std::max(0.0, (double)tf->GetOpcN((double)i / (double)(tf_length - 1)));
+      alpha_prefix[i + 1] = alpha_prefix[i] + alpha;
+    }
+
+    // The transfer function texture is linearly filtered, so one extra texel
+    //   is taken at each side of the [min, max] range.
+    double tf_max_id = (double)(tf_length - 1);
+    m_number_of_empty_blocks = 0;
+    for (size_t id = 0; id < m_block_min.size(); id++)
+    {
+      int lo = std::max(0, (int)std::floor(m_block_min[id] * tf_max_id) - 1);
+      int hi = std::min(tf_length - 1, (int)std::ceil(m_block_max[id] * tf_max_id) + 1);
+
+      bool empty = lo > hi || (alpha_prefix[hi + 1] - alpha_prefix[lo]) <= 0.0;
+      m_occupancy[id] = empty ? 0 : 1;
+      if (empty) m_number_of_empty_blocks++;
+    }
+
+    ComputeChebyshevDistanceTransform();
+
+    auto t_end = std::chrono::high_resolution_clock::now();
+    m_time_occupancy_ms = std::chrono::duration<double, std::milli>(t_end - t_start).count();
+
+    printf("vis::OccupancyGrid: Occupancy updated in %.2f ms (%zu of %zu blocks are empty).\n",
+      m_time_occupancy_ms, m_number_of_empty_blocks, GetNumberOfBlocks());
+
+    return true;
+  }
+
+  gl::Texture3D* OccupancyGrid::GenerateDistanceTexture ()
+  {
+    if (m_distance.empty()) return nullptr;
+
+    gl::Texture3D* tex3d = new gl::Texture3D(m_grid_resolution.x, m_grid_resolution.y, m_grid_resolution.z);
+    tex3d->GenerateTexture(GL_NEAREST, GL_NEAREST, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    tex3d->SetData((GLvoid*)m_distance.data(), GL_R8UI, GL_RED_INTEGER, GL_UNSIGNED_BYTE);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    gl::ExitOnGLError("vis::OccupancyGrid: After GenerateDistanceTexture");
+    return tex3d;
+  }
+
+  size_t OccupancyGrid::GenerateBoundaryMesh (std::vector<glm::vec3>& vertices, std::vector<unsigned int>& indices)
+  {
+    vertices.clear();
+    indices.clear();
+    if (m_occupancy.empty()) return 0;
+
+    auto t_start = std::chrono::high_resolution_clock::now();
+
+    glm::ivec3 res = m_grid_resolution;
+    glm::vec3 vol_max = glm::vec3(m_volume_resolution);
+
+    for (int z = 0; z < res.z; z++)
+    {
+      for (int y = 0; y < res.y; y++)
+      {
+        for (int x = 0; x < res.x; x++)
+        {
+          if (!m_occupancy[BlockIndex(x, y, z)]) continue;
+
+          // Block bounds, the last block of each axis may be partial
+          glm::vec3 bmin = glm::vec3(x, y, z) * (float)m_block_size;
+          glm::vec3 bmax = glm::min(bmin + glm::vec3((float)m_block_size), vol_max);
+
+          for (int a = 0; a < 3; a++)
+          {
+            for (int side = 0; side < 2; side++)
+            {
+              glm::ivec3 n(x, y, z);
+              n[a] += side == 0 ? -1 : +1;
+              if (n[a] >= 0 && n[a] < res[a] && m_occupancy[BlockIndex(n.x, n.y, n.z)])
+                continue;
+
+              // Face perpendicular to axis a, spanned by axes u and v
+              int u = (a + 1) % 3, v = (a + 2) % 3;
+              glm::vec3 p = bmin;
+              p[a] = side == 0 ? bmin[a] : bmax[a];
+
+              unsigned int first = (unsigned int)vertices.size();
+              glm::vec3 q = p;
+              vertices.push_back(q);
+              q[u] = bmax[u];
+              vertices.push_back(q);
+              q[v] = bmax[v];
+              vertices.push_back(q);
+              q[u] = bmin[u];
+              vertices.push_back(q);
+
+              indices.push_back(first + 0); indices.push_back(first + 1); indices.push_back(first + 2);
+              indices.push_back(first + 0); indices.push_back(first + 2); indices.push_back(first + 3);
+            }
+          }
+        }
+      }
+    }
+
+    auto t_end = std::chrono::high_resolution_clock::now();
+    printf("vis::OccupancyGrid: Boundary mesh with %zu faces generated in %.2f ms.\n",
+      indices.size() / 6, std::chrono::duration<double, std::milli>(t_end - t_start).count());
+
+    return indices.size() / 6;
+  }
+
+  size_t OccupancyGrid::GetNumberOfBlocks ()
+  {
+    return (size_t)m_grid_resolution.x * (size_t)m_grid_resolution.y * (size_t)m_grid_resolution.z;
+  }
+
+  float OccupancyGrid::GetBlockMin (int x, int y, int z)
+  {
+    return m_block_min[BlockIndex(x, y, z)];
+  }
+
+  float OccupancyGrid::GetBlockMax (int x, int y, int z)
+  {
+    return m_block_max[BlockIndex(x, y, z)];
+  }
+
+  bool OccupancyGrid::IsBlockEmpty (int x, int y, int z)
+  {
+    return m_occupancy[BlockIndex(x, y, z)] == 0;
+  }
+
+  unsigned char OccupancyGrid::GetBlockDistance (int x, int y, int z)
+  {
+    return m_distance[BlockIndex(x, y, z)];
+  }
+
+  size_t OccupancyGrid::BlockIndex (int x, int y, int z)
+  {
+    return (size_t)x + (size_t)m_grid_resolution.x * ((size_t)y + (size_t)m_grid_resolution.y * (size_t)z);
+  }
+
+  // Two-pass chamfer transform using the 26-neighborhood with unit weights,
+  //   which gives the exact chessboard distance. Distances are capped at 255.
+  void OccupancyGrid::ComputeChebyshevDistanceTransform ()
+  {
+    const int d_inf = 255;
+    glm::ivec3 res = m_grid_resolution;
+
+    for (size_t id = 0; id < m_occupancy.size(); id++)
+      m_distance[id] = m_occupancy[id] ? 0 : d_inf;
+
+    auto relax = [&](int x, int y, int z, int sign)
+    {
+      size_t id = BlockIndex(x, y, z);
+      int d = m_distance[id];
+      if (d == 0) return;
+      for (int dz = -1; dz <= 1; dz++)
+      {
+        for (int dy = -1; dy <= 1; dy++)
+        {
+          for (int dx = -1; dx <= 1; dx++)
+          {
+            // Only the already visited half of the neighborhood
+            int order = dz != 0 ? dz : (dy != 0 ? dy : dx);
+            if (order * sign >= 0) continue;
+
+            int nx = x + dx, ny = y + dy, nz = z + dz;
+            if (nx < 0 || ny < 0 || nz < 0 || nx >= res.x || ny >= res.y || nz >= res.z)
+              continue;
+
+            d = std::min(d, m_distance[BlockIndex(nx, ny, nz)] + 1);
+          }
+        }
+      }
+      m_distance[id] = (unsigned char)std::min(d, d_inf);
+    };
+
+    // Forward pass
+    for (int z = 0; z < res.z; z++)
+      for (int y = 0; y < res.y; y++)
+        for (int x = 0; x < res.x; x++)
+          relax(x, y, z, +1);
+
+    // Backward pass
+    for (int z = res.z - 1; z >= 0; z--)
+      for (int y = res.y - 1; y >= 0; y--)
+        for (int x = res.x - 1; x >= 0; x--)
+          relax(x, y, z, -1);
+  }
+}
@@ -0,0 +1,105 @@
+/**
+ * Transfer function aware block occupancy grid
+ * . Empty space skipping for direct volume rendering
+ *
+ * The volume is split into blocks of block_size^3 voxels. For each block we
+ *   store the [min, max] of the normalized scalar values that a trilinear
+ *   sample taken inside the block can touch (one voxel of overlap).
+ * A block is empty iff the transfer function opacity is zero over its whole
+ *   [min, max] range, which is answered in O(1) with a prefix sum of the
+ *   transfer function opacity table.
+ * A Chebyshev (L-infinity) distance transform over the occupancy grid then
+ *   gives, for each empty block, how many blocks a ray can jump in any
+ *   direction before reaching a non-empty one.
+ *
+ * The voxel pass (BuildBlockMinMax) only depends on the volume. When the
+ *   transfer function changes, only UpdateOccupancy must be called again.
+ *
+ * The boundary faces of the non-empty blocks can also be extracted as a
+ *   proxy mesh, which is rasterized to get tight ray entry/exit distances.
+**/
+#ifndef VOL_VIS_UTILS_OCCUPANCY_GRID_H
+#define VOL_VIS_UTILS_OCCUPANCY_GRID_H
+
+#include <volvis_utils/structuredgridvolume.h>
+#include <volvis_utils/transferfunction.h>
+#include <gl_utils/texture3d.h>
+
+#include <vector>
+#include <string>
+
+#include <glm/glm.hpp>
+
+namespace vis
+{
+  class OccupancyGrid
+  {
+  public:
+    OccupancyGrid ();
+    ~OccupancyGrid ();
+
+    void Clear ();
+
+    // Voxel pass: compute the [min, max] of each block
+    bool BuildBlockMinMax (StructuredGridVolume* vol, int block_size);
+    // Check if the current block min/max was computed for this volume and block size
+    bool IsBlockMinMaxBuiltFor (StructuredGridVolume* vol, int block_size);
+
+    // Transfer function pass: update occupancy and the distance transform
+    // . tf_length must match the number of texels of the transfer function texture
+    bool UpdateOccupancy (TransferFunction* tf, int tf_length = 256);
+
+    // Generate a GL_R8UI texture with the Chebyshev distance of each block
+    // . 0 means the block is non-empty
+    gl::Texture3D* GenerateDistanceTexture ();
+
+    // Generate the faces between non-empty and empty (or outside) blocks
+    // . vertices in voxel coordinates [0, volume resolution]
+    // . two triangles per face, without shared vertices between faces
+    size_t GenerateBoundaryMesh (std::vector<glm::vec3>& vertices, std::vector<unsigned int>& indices);
+
+    int GetBlockSize () { return m_block_size; }
+    glm::ivec3 GetBlockGridResolution () { return m_grid_resolution; }
+    size_t GetNumberOfBlocks ();
+    size_t GetNumberOfEmptyBlocks () { return m_number_of_empty_blocks; }
+
+    float GetBlockMin (int x, int y, int z);
+    float GetBlockMax (int x, int y, int z);
+    bool IsBlockEmpty (int x, int y, int z);
+    unsigned char GetBlockDistance (int x, int y, int z);
+
+    std::vector<float>& GetBlockMinData () { return m_block_min; }
+    std::vector<float>& GetBlockMaxData () { return m_block_max; }
+    std::vector<unsigned char>& GetOccupancyData () { return m_occupancy; }
+    std::vector<unsigned char>& GetDistanceData () { return m_distance; }
+
+    // Time in milliseconds of the last voxel and transfer function passes
+    double GetBlockMinMaxBuildTime () { return m_time_minmax_ms; }
+    double GetOccupancyUpdateTime () { return m_time_occupancy_ms; }
+
+  protected:
+
+  private:
+    size_t BlockIndex (int x, int y, int z);
+    void ComputeChebyshevDistanceTransform ();
+
+    StructuredGridVolume* m_volume;
+    std::string m_volume_name;
+    glm::ivec3 m_volume_resolution;
+
+    int m_block_size;
+    glm::ivec3 m_grid_resolution;
+
+    std::vector<float> m_block_min;
+    std::vector<float> m_block_max;
+    std::vector<unsigned char> m_occupancy;
+    std::vector<unsigned char> m_distance;
+
+    size_t m_number_of_empty_blocks;
+
+    double m_time_minmax_ms;
+    double m_time_occupancy_ms;
+  };
+}
+
+#endif
@@ -0,0 +1,136 @@
+#include "preprocessingregistry.h"
+
+#include <cstdio>
+
+namespace vis
+{
+  PreprocessingRegistry::PreprocessingRegistry ()
+    : total_bytes(0)
+    , budget_bytes(256 * 1024 * 1024)
+    , use_counter(0)
+  {
+    ResetStatistics();
+  }
+
+  PreprocessingRegistry::~PreprocessingRegistry ()
+  {
+    for (std::map<std::string, Product>::iterator it = products.begin(); it != products.end(); ++it)
+      it->second.destroy(it->second.data);
+    products.clear();
+  }
+
+  std::string PreprocessingRegistry::MakeKey (const std::string& product, const std::string& volume,
+                                              const std::string& transfer_function, const std::string& parameters)
+  {
+    return product + "|" + volume + "|" + transfer_function + "|" + parameters;
+  }
+
+  void PreprocessingRegistry::Release (const void* product)
+  {
+    if (product == nullptr) return;
+
+    for (std::map<std::string, Product>::iterator it = products.begin(); it != products.end(); ++it)
+    {
+      if (it->second.data != product) continue;
+      if (it->second.references > 0) it->second.references--;
+      Evict();
+      return;
+    }
+    fprintf(stderr, "vis::PreprocessingRegistry: released a product that is not registered\n");
+  }
+
+  void PreprocessingRegistry::SetBudget (size_t bytes)
+  {
+    budget_bytes = bytes;
+    Evict();
+  }
+
+  void PreprocessingRegistry::Clear ()
+  {
+    std::map<std::string, Product>::iterator it = products.begin();
+    while (it != products.end())
+    {
+      if (it->second.references == 0)
+      {
+        it->second.destroy(it->second.data);
+        total_bytes -= it->second.bytes;
+        it = products.erase(it);
+      }
+      else
+        ++it;
+    }
+  }
+
+  int PreprocessingRegistry::GetNumberOfReferences ()
+  {
+    int n = 0;
+    for (std::map<std::string, Product>::iterator it = products.begin(); it != products.end(); ++it)
+      n += it->second.references;
+    return n;
+  }
+
+  void PreprocessingRegistry::ResetStatistics ()
+  {
+    hits = builds = 0;
+    saved_ms = 0.0;
+  }
+
+  size_t PreprocessingRegistry::GetBytes (gl::Texture3D* texture)
+  {
+    // Levels and format as registered by the texture itself
+    for (const gl::MemoryRegistry::Allocation& a : gl::MemoryRegistry::Instance().GetAllocations())
+      if (a.kind == gl::MemoryRegistry::TEXTURE && a.id == texture->GetTextureID())
+        return a.bytes;
+    return gl::MemoryRegistry::GetTextureBytes(GL_R32F, texture->GetWidth(), texture->GetHeight(), texture->GetDepth());
+  }
+
+  size_t PreprocessingRegistry::GetBytes (BlockMinMax* blocks)
+  {
+    return (blocks->min_values.size() + blocks->max_values.size()) * sizeof(float);
+  }
+
+  void* PreprocessingRegistry::Reference (const std::string& key)
+  {
+    std::map<std::string, Product>::iterator it = products.find(key);
+    if (it == products.end()) return nullptr;
+
+    it->second.references++;
+    it->second.last_use = ++use_counter;
+    hits++;
+    saved_ms += it->second.build_ms;
+    return it->second.data;
+  }
+
+  void PreprocessingRegistry::Insert (const std::string& key, void* data, size_t bytes, void (*destroy) (void*), double build_ms)
+  {
+    Product product;
+    product.data = data;
+    product.destroy = destroy;
+    product.bytes = bytes;
+    product.references = 1;
+    product.build_ms = build_ms;
+    product.last_use = ++use_counter;
+    products[key] = product;
+
+    total_bytes += bytes;
+    builds++;
+    Evict();
+  }
+
+  void PreprocessingRegistry::Evict ()
+  {
+    while (total_bytes > budget_bytes)
+    {
+      std::map<std::string, Product>::iterator lru = products.end();
+      for (std::map<std::string, Product>::iterator it = products.begin(); it != products.end(); ++it)
+        if (it->second.references == 0 && (lru == products.end() || it->second.last_use < lru->second.last_use))
+          lru = it;
+      // The rest is in use
+      if (lru == products.end()) return;
+
+      lru->second.destroy(lru->second.data);
+      total_bytes -= lru->second.bytes;
+      products.erase(lru);
+    }
+  }
+}
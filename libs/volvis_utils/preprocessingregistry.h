@@ -0,0 +1,123 @@
+/**
+ * preprocessingregistry.h
+ *
+ * Preprocessing products shared by the renderers
+ * . e.g. summed area tables, extinction coefficient volumes, block min/max
+ *
+ * A product is identified by a key made of the volume, the transfer function
+ *   (only if it depends on it) and its own parameters. Renderers acquire a
+ *   product with a function that builds it and release it instead of deleting
+ *   it, so switching to a renderer that needs the same product reuses it.
+ * Products no longer referenced are kept while the total size fits in the
+ *   budget, then the least recently used ones are deleted.
+ *
+ * Textures are registered in gl::MemoryRegistry under the "Preprocessing" tag.
+**/
+#ifndef VOL_VIS_UTILS_PREPROCESSING_REGISTRY_H
+#define VOL_VIS_UTILS_PREPROCESSING_REGISTRY_H
+
+#include <gl_utils/memoryregistry.h>
+#include <gl_utils/profiler.h>
+#include <gl_utils/texture3d.h>
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace vis
+{
+  // Min and max normalized values of each block of a volume
+  struct BlockMinMax
+  {
+    std::vector<float> min_values;
+    std::vector<float> max_values;
+  };
+
+  class PreprocessingRegistry
+  {
+  public:
+    PreprocessingRegistry ();
+    ~PreprocessingRegistry ();
+
+    static std::string MakeKey (const std::string& product, const std::string& volume,
+                                const std::string& transfer_function, const std::string& parameters);
+
+    // The product of key, built (T* build ()) if there is none
+    // . must be released, returns nullptr if build fails
+    template<typename T, typename Build>
+    T* Acquire (const std::string& key, Build build)
+    {
+      if (void* data = Reference(key)) return (T*)data;
+
+      std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+      T* product = nullptr;
+      {
+        PROFILE_ZONE(key);
+        gl::MemoryRegistry::ScopedTag memory_tag("Preprocessing");
+        product = build();
+      }
+      if (product == nullptr) return nullptr;
+      double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+      Insert(key, product, GetBytes(product), &Delete<T>, ms);
+      return product;
+    }
+
+    // The product is deleted later, when it is no longer referenced and the budget is exceeded
+    void Release (const void* product);
+
+    // Bytes of the products, referenced or not, 0 to keep only the referenced ones
+    void SetBudget (size_t bytes);
+    size_t GetBudget () { return budget_bytes; }
+
+    // Deletes the products that are not referenced
+    void Clear ();
+
+    size_t GetTotalBytes () { return total_bytes; }
+    int GetNumberOfProducts () { return (int)products.size(); }
+    int GetNumberOfReferences ();
+    // Products reused since the last ResetStatistics, and the time it took to build them
+    int GetNumberOfHits () { return hits; }
+    int GetNumberOfBuilds () { return builds; }
+    double GetSavedTime () { return saved_ms; }
+    void ResetStatistics ();
+
+    static size_t GetBytes (gl::Texture3D* texture);
+    static size_t GetBytes (BlockMinMax* blocks);
+
+  protected:
+  private:
+    struct Product
+    {
+      void* data;
+      void (*destroy) (void*);
+      size_t bytes;
+      int references;
+      double build_ms;
+      unsigned long long last_use;
+    };
+
+    template<typename T>
+    static void Delete (void* data)
+    {
+      delete (T*)data;
+    }
+
+    // Data of key with one more reference, nullptr if there is none
+    void* Reference (const std::string& key);
+    void Insert (const std::string& key, void* data, size_t bytes, void (*destroy) (void*), double build_ms);
+    void Evict ();
+
+    std::map<std::string, Product> products;
+    size_t total_bytes;
+    size_t budget_bytes;
+    unsigned long long use_counter;
+
+    int hits, builds;
+    double saved_ms;
+  };
+}
+
+#endif
@@ -7,6 +7,7 @@
 #include <file_utils/pvm.h>
 #include <file_utils/pvm_old.h>
 #include <file_utils/rawloader.h>
+#include <gl_utils/profiler.h>
 
 #include <fstream>
 #include <array>
@@ -27,6 +28,7 @@ namespace vis
 
   StructuredGridVolume* VolumeReader::ReadStructuredVolume (std::string filepath)
   {
+    PROFILE_ZONE("ReadStructuredVolume");
     StructuredGridVolume* ret = nullptr;
 
     int found = filepath.find_last_of('.');
@@ -314,7 +316,7 @@ namespace vis
             {
               for (int z = z0; z < z1; z++)
               {
-                syn_data[x + (width * y) + (width * height * z)] = unsigned char(v);
+                syn_data[x + (width * y) + (width * height * z)] = (unsigned char)v;
               }
             }
           }
@@ -349,7 +351,7 @@ namespace vis
         {
           int xt, yt, zt, v;
           iffile >> xt >> yt >> zt >> v;
-          syn_data[xt + (width * yt) + (width * height * zt)] = unsigned char(v);
+          syn_data[xt + (width * yt) + (width * height * zt)] = (unsigned char)v;
         }
       }
       
@@ -727,6 +729,7 @@ namespace vis
   
   vis::TransferFunction* TransferFunctionReader::ReadTransferFunction (std::string file)
   {
+    PROFILE_ZONE("ReadTransferFunction");
     TransferFunction* tf_ret = NULL;
 
     int found = file.find_last_of('.');
@@ -61,6 +61,10 @@ namespace vis
 
     virtual gl::Texture1D* GenerateTexture_1D_RGBA () { return NULL; }
     virtual gl::Texture1D* GenerateTexture_1D_RGBt () { return NULL; }
+    // Writes the transfer function into a texture generated before, false if
+    //   it is not supported or the length differs
+    virtual bool UpdateTexture_1D_RGBA (gl::Texture1D* tex) { return false; }
+    virtual bool UpdateTexture_1D_RGBt (gl::Texture1D* tex) { return false; }
     
     std::string GetName () { return m_name; }
     void SetName (std::string name) { m_name = name; }
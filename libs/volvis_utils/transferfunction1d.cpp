@@ -57,64 +57,50 @@ namespace vis
 
   gl::Texture1D* TransferFunction1D::GenerateTexture_1D_RGBA ()
   {
-    if (!m_built)
-      Build();
+    float* data = GenerateTextureData(false);
+    if (data == NULL) return NULL;
+
+    gl::Texture1D* ret = new gl::Texture1D(max_density + 1);
+    ret->GenerateTexture(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE);
+    ret->SetData((void*)data, GL_RGBA16F, GL_RGBA, GL_FLOAT);
+    delete[] data;
+    return ret;
+  }
 
-    if (m_transferfunction)
-    {
-      int tf_size = max_density + 1;
-      gl::Texture1D* ret = new gl::Texture1D (tf_size);
-      ret->GenerateTexture(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE);
-      float* data = new float[tf_size * 4];
-      for (int i = 0; i < tf_size; i++)
-      {
-        data[(i * 4)]     = (float)(m_transferfunction[i].r);
-        data[(i * 4) + 1] = (float)(m_transferfunction[i].g);
-        data[(i * 4) + 2] = (float)(m_transferfunction[i].b);
+  gl::Texture1D* TransferFunction1D::GenerateTexture_1D_RGBt ()
+  {
+    float* data = GenerateTextureData(true);
+    if (data == NULL) return NULL;
+
+    gl::Texture1D* ret = new gl::Texture1D(max_density + 1);
+    ret->GenerateTexture(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE);
+    ret->SetData((void*)data, GL_RGBA16F, GL_RGBA, GL_FLOAT);
+    delete[] data;
+    return ret;
+  }
 
-        float v4 = (double)(m_transferfunction[i].a);
+  bool TransferFunction1D::UpdateTexture_1D_RGBA (gl::Texture1D* tex)
+  {
+    if (tex == NULL || tex->GetLength() != (unsigned int)(max_density + 1)) return false;
 
-        if (extinction_coef_type)
-          v4 = ExtinctionToMaterialOpacity(v4);
-        
-        data[(i * 4) + 3] = v4;
-      }
-      ret->SetData ((void*)data, GL_RGBA16F, GL_RGBA, GL_FLOAT);
-      delete[] data;
-      return ret;
-    }
-    return NULL;
+    float* data = GenerateTextureData(false);
+    if (data == NULL) return false;
+
+    bool ret = tex->UpdateData((void*)data, GL_RGBA, GL_FLOAT);
+    delete[] data;
+    return ret;
   }
 
-  gl::Texture1D* TransferFunction1D::GenerateTexture_1D_RGBt ()
+  bool TransferFunction1D::UpdateTexture_1D_RGBt (gl::Texture1D* tex)
   {
-    if (!m_built)
-      Build();
+    if (tex == NULL || tex->GetLength() != (unsigned int)(max_density + 1)) return false;
 
-    if (m_transferfunction)
-    {
-      int tf_size = max_density + 1;
-      gl::Texture1D* ret = new gl::Texture1D(tf_size);
-      ret->GenerateTexture(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE);
-      float* data = new float[tf_size * 4];
-      for (int i = 0; i < tf_size; i++)
-      {
-        data[(i * 4)]     = (float)(m_transferfunction[i].r);
-        data[(i * 4) + 1] = (float)(m_transferfunction[i].g);
-        data[(i * 4) + 2] = (float)(m_transferfunction[i].b);
-
-        float v4 = (float)(m_transferfunction[i].a);
+    float* data = GenerateTextureData(true);
+    if (data == NULL) return false;
 
-        if (!extinction_coef_type)
-          v4 = MaterialOpacityToExtinction(v4);
-        
-        data[(i * 4) + 3] = v4;
-      }
-      ret->SetData((void*)data, GL_RGBA16F, GL_RGBA, GL_FLOAT);
-      delete[] data;
-      return ret;
-    }
-    return NULL;
+    bool ret = tex->UpdateData((void*)data, GL_RGBA, GL_FLOAT);
+    delete[] data;
+    return ret;
   }
 
   void TransferFunction1D::Build ()
@@ -356,4 +342,32 @@ namespace vis
       }
     }
   }
+
+  float* TransferFunction1D::GenerateTextureData (bool alpha_as_extinction)
+  {
+    if (!m_built)
+      Build();
+
+    if (!m_transferfunction) return NULL;
+
+    int tf_size = max_density + 1;
+    float* data = new float[tf_size * 4];
+    for (int i = 0; i < tf_size; i++)
+    {
+      data[(i * 4)]     = (float)(m_transferfunction[i].r);
+      data[(i * 4) + 1] = (float)(m_transferfunction[i].g);
+      data[(i * 4) + 2] = (float)(m_transferfunction[i].b);
+
+      float v4 = (float)(m_transferfunction[i].a);
+
+      if (alpha_as_extinction && !extinction_coef_type)
+        v4 = MaterialOpacityToExtinction(v4);
+      else if (!alpha_as_extinction && extinction_coef_type)
+        v4 = ExtinctionToMaterialOpacity(v4);
+
+      data[(i * 4) + 3] = v4;
+    }
+    return data;
+  }
+
 }
\ No newline at end of file
@@ -46,6 +46,8 @@ namespace vis
 
     virtual gl::Texture1D* GenerateTexture_1D_RGBA ();
     virtual gl::Texture1D* GenerateTexture_1D_RGBt ();
+    virtual bool UpdateTexture_1D_RGBA (gl::Texture1D* tex);
+    virtual bool UpdateTexture_1D_RGBt (gl::Texture1D* tex);
 
     void SetExtinctionCoefficientInput (bool s);
 
@@ -65,6 +67,8 @@ namespace vis
     bool m_built;
   private:
     void BuildLinear ();
+    // RGBA texels, alpha as extinction coefficient or as opacity
+    float* GenerateTextureData (bool alpha_as_extinction);
 
     std::vector<TransferControlPoint> m_cpt_rgb;
     std::vector<TransferControlPoint> m_cpt_alpha;
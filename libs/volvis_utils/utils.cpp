@@ -1,6 +1,10 @@
 #include "utils.h"
 
 #include <vis_utils/summedareatable.h>
+#include <vis_utils/taskgraph.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <iostream>
 #include <random>
 #include <fstream>
@@ -17,6 +21,60 @@ namespace vis
     GLfloat a;
   };
 
+  namespace
+  {
+    glm::dvec3 FiniteDifferenceGradient (StructuredGridVolume* vol, int x, int y, int z,
+      int n, int gradient_sample_size, bool normalized_gradient)
+    {
+      glm::dvec3 s1, s2;
+      s1.x = vol->GetNormalizedSample(x - n, y, z);
+      s2.x = vol->GetNormalizedSample(x + n, y, z);
+      s1.y = vol->GetNormalizedSample(x, y - n, z);
+      s2.y = vol->GetNormalizedSample(x, y + n, z);
+      s1.z = vol->GetNormalizedSample(x, y, z - n);
+      s2.z = vol->GetNormalizedSample(x, y, z + n);
+
+      glm::dvec3 s2s1 = (s2 - s1);
+
+      if (normalized_gradient)
+      {
+        s2s1 = glm::normalize<double>(s2s1);
+      }
+      else
+      {
+        s2s1.x = s2s1.x / 2.0f * (float)gradient_sample_size;
+        s2s1.y = s2s1.y / 2.0f * (float)gradient_sample_size;
+        s2s1.z = s2s1.z / 2.0f * (float)gradient_sample_size;
+      }
+
+      if (s2s1.x != s2s1.x) //lm.IsNaN
+        s2s1 = glm::dvec3(0);
+
+      return s2s1;
+    }
+
+    glm::dvec3 SobelFeldmanGradient (StructuredGridVolume* vol, int x, int y, int z)
+    {
+      glm::dvec3 sg(0.0);
+      for (int v1 = -1; v1 <= 1; v1++)
+      {
+        for (int v2 = -1; v2 <= 1; v2++)
+        {
+          sg.z += ((double)vol->GetNormalizedSample(x + v1, y + v2, z - 1)) * (4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)))
+            + ((double)vol->GetNormalizedSample(x + v1, y + v2, z + 1)) * (-4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)));
+
+          sg.y += ((double)vol->GetNormalizedSample(x + v1, y - 1, z + v2)) * (4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)))
+            + ((double)vol->GetNormalizedSample(x + v1, y + 1, z + v2)) * (-4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)));
+
+          sg.x += ((double)vol->GetNormalizedSample(x - 1, y + v2, z + v1)) * (4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)))
+            + ((double)vol->GetNormalizedSample(x + 1, y + v2, z + v1)) * (-4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)));
+        }
+      }
+      // not normalized (for tests...)
+      return sg;
+    }
+  }
+
   gl::Texture3D* GenerateRTexture(StructuredGridVolume* vol, int init_x, int init_y, int init_z,
     int last_x, int last_y, int last_z)
   {
@@ -55,6 +113,87 @@ namespace vis
     return tex3d_r;
   }
 
+  gl::Texture3D* GenerateNativeRTexture (StructuredGridVolume* vol, size_t max_slab_bytes, VolumeUploadStatistics* stats)
+  {
+    if (!vol || !vol->GetArrayData()) return NULL;
+
+    const size_t size_x = vol->GetWidth();
+    const size_t size_y = vol->GetHeight();
+    const size_t size_z = vol->GetDepth();
+    const size_t slice_voxels = size_x * size_y;
+
+    GLint internalformat;
+    GLenum type;
+    size_t bytes_per_voxel;
+    switch (vol->m_data_storage_size)
+    {
+    case DataStorageSize::_8_BITS:
+      internalformat = GL_R8; type = GL_UNSIGNED_BYTE; bytes_per_voxel = sizeof(GLubyte);
+      break;
+    case DataStorageSize::_16_BITS:
+      internalformat = GL_R16; type = GL_UNSIGNED_SHORT; bytes_per_voxel = sizeof(GLushort);
+      break;
+    case DataStorageSize::_NORMALIZED_F:
+    case DataStorageSize::_NORMALIZED_D:
+#ifdef USE_16F_INTERNAL_FORMAT
+      internalformat = GL_R16F;
+#else
+      internalformat = GL_R32F;
+#endif
+      type = GL_FLOAT; bytes_per_voxel = sizeof(GLfloat);
+      break;
+    default:
+      return NULL;
+    }
+
+    auto t_start = std::chrono::high_resolution_clock::now();
+
+    gl::Texture3D* tex3d_r = new gl::Texture3D((unsigned int)size_x, (unsigned int)size_y, (unsigned int)size_z);
+    tex3d_r->GenerateTexture(TEXTURE_FILTER, TEXTURE_FILTER, TEXTURE_WRAP, TEXTURE_WRAP, TEXTURE_WRAP);
+
+    // Native types are copied from the volume, doubles are converted
+    const unsigned char* src = static_cast<const unsigned char*>(vol->GetArrayData());
+    const bool is_double = vol->m_data_storage_size == DataStorageSize::_NORMALIZED_D;
+    bool ok = tex3d_r->SetDataSlabs(internalformat, GL_RED, type, bytes_per_voxel, max_slab_bytes,
+      [&](void* dst, unsigned int first_slice, unsigned int n_slices)
+    {
+      const size_t first = first_slice * slice_voxels;
+      const size_t count = n_slices * slice_voxels;
+      if (is_double)
+      {
+        const double* values = reinterpret_cast<const double*>(src) + first;
+        GLfloat* out = static_cast<GLfloat*>(dst);
+        for (size_t i = 0; i < count; i++) out[i] = (GLfloat)values[i];
+      }
+      else
+      {
+        memcpy(dst, src + first * bytes_per_voxel, count * bytes_per_voxel);
+      }
+    });
+
+    // The transfer is asynchronous: wait for it to measure it
+    glFinish();
+    auto t_end = std::chrono::high_resolution_clock::now();
+
+    if (!ok)
+    {
+      delete tex3d_r;
+      return NULL;
+    }
+
+    if (stats)
+    {
+      const size_t slice_bytes = slice_voxels * bytes_per_voxel;
+      const size_t slab_bytes = std::max(std::min(max_slab_bytes / slice_bytes, size_z), (size_t)1) * slice_bytes;
+      stats->internal_format = internalformat;
+      stats->upload_bytes = slice_bytes * size_z;
+      stats->staging_bytes = 2 * slab_bytes;
+      stats->upload_ms = std::chrono::duration<double, std::milli>(t_end - t_start).count();
+    }
+
+    return tex3d_r;
+  }
+
   gl::Texture3D* GenerateRTexture (StructuredGridVolume* vol, VIS_UTILS_DATA_TYPE vdatatype)
   {
     if (!vol) return NULL;
@@ -156,43 +295,13 @@ namespace vis
     //Generation of gradients
     int n = gradient_sample_size;
     glm::dvec3* gradients = new glm::dvec3[width * height * depth];
-    glm::dvec3 s1, s2;
+    TaskPool::Instance().ParallelFor(depth, [&] (int z0, int z1) {
+      for (int z = z0; z < z1; z++)
+        for (int y = 0; y < height; y++)
+          for (int x = 0; x < width; x++)
+            gradients[x + (y * width) + (z * width * height)] = FiniteDifferenceGradient(vol, x, y, z, n, gradient_sample_size, normalized_gradient);
+    });
     int index = 0;
-    for (int z = 0; z < depth; z++)
-    {
-      for (int y = 0; y < height; y++)
-      {
-        for (int x = 0; x < width; x++)
-        {
-          s1.x = vol->GetNormalizedSample(x - n, y, z);
-          s2.x = vol->GetNormalizedSample(x + n, y, z);
-          s1.y = vol->GetNormalizedSample(x, y - n, z);
-          s2.y = vol->GetNormalizedSample(x, y + n, z);
-          s1.z = vol->GetNormalizedSample(x, y, z - n);
-          s2.z = vol->GetNormalizedSample(x, y, z + n);
-
-          glm::dvec3 s2s1 = (s2 - s1);
-
-          if (normalized_gradient)
-          {
-            s2s1 = glm::normalize<double>(s2s1);
-          }
-          else
-          {
-            s2s1.x = s2s1.x / 2.0f * (float)gradient_sample_size;
-            s2s1.y = s2s1.y / 2.0f * (float)gradient_sample_size;
-            s2s1.z = s2s1.z / 2.0f * (float)gradient_sample_size;
-          }
-
-          gradients[index] = s2s1;
-
-          if (gradients[index].x != gradients[index].x) //lm.IsNaN
-            gradients[index] = glm::dvec3(0);
-
-          index++;
-        }
-      }
-    }
 
     //2
     //Filtering
@@ -285,55 +394,49 @@ namespace vis
 
   // https://en.wikipedia.org/wiki/Sobel_operator  
   gl::Texture3D* GenerateSobelFeldmanGradientTexture(StructuredGridVolume* vol)
+  {
+    glm::vec3* gradients_values = ComputeSobelFeldmanGradients(vol);
+    gl::Texture3D* tex3d_gradient = GenerateGradientTexture(gradients_values, vol->GetWidth(), vol->GetHeight(), vol->GetDepth());
+    delete[] gradients_values;
+
+    return tex3d_gradient;
+  }
+
+  glm::vec3* ComputeGradients(StructuredGridVolume* vol, int gradient_sample_size, bool normalized_gradient)
   {
     int width = vol->GetWidth();
     int height = vol->GetHeight();
     int depth = vol->GetDepth();
 
-    int n = 1;
-    glm::dvec3* gradients = new glm::dvec3[width * height * depth];
-    for (int z = 0; z < depth; z++)
-    {
-      for (int y = 0; y < height; y++)
-      {
-        for (int x = 0; x < width; x++)
-        {
-          glm::dvec3 sg(0.0);
-          for (int v1 = -1; v1 <= 1; v1++)
-          {
-            for (int v2 = -1; v2 <= 1; v2++)
-            {
-              sg.z += ((double)vol->GetNormalizedSample(x + v1, y + v2, z - 1)) * (4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)))
-                + ((double)vol->GetNormalizedSample(x + v1, y + v2, z + 1)) * (-4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)));
-
-              sg.y += ((double)vol->GetNormalizedSample(x + v1, y - 1, z + v2)) * (4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)))
-                + ((double)vol->GetNormalizedSample(x + v1, y + 1, z + v2)) * (-4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)));
-
-              sg.x += ((double)vol->GetNormalizedSample(x - 1, y + v2, z + v1)) * (4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)))
-                + ((double)vol->GetNormalizedSample(x + 1, y + v2, z + v1)) * (-4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)));
-            }
-          }
+    glm::vec3* gradients_values = new glm::vec3[width * height * depth];
+    TaskPool::Instance().ParallelFor(depth, [&] (int z0, int z1) {
+      for (int z = z0; z < z1; z++)
+        for (int y = 0; y < height; y++)
+          for (int x = 0; x < width; x++)
+            gradients_values[x + (y * width) + (z * width * height)] =
+              FiniteDifferenceGradient(vol, x, y, z, gradient_sample_size, gradient_sample_size, normalized_gradient);
+    });
+    return gradients_values;
+  }
 
-          // not normalized (for tests...)
-          gradients[x + (y * width) + (z * width * height)] = sg;
-        }
-      }
-    }
+  glm::vec3* ComputeSobelFeldmanGradients(StructuredGridVolume* vol)
+  {
+    int width = vol->GetWidth();
+    int height = vol->GetHeight();
+    int depth = vol->GetDepth();
 
     glm::vec3* gradients_values = new glm::vec3[width * height * depth];
-    for (int k = 0; k < depth; k++)
-    {
-      for (int j = 0; j < height; j++)
-      {
-        for (int i = 0; i < width; i++)
-        {
-          gradients_values[i + (j * width) + (k * width * height)] = gradients[i + (j * width) + (k * width * height)];
-        }
-      }
-    }
+    TaskPool::Instance().ParallelFor(depth, [&] (int z0, int z1) {
+      for (int z = z0; z < z1; z++)
+        for (int y = 0; y < height; y++)
+          for (int x = 0; x < width; x++)
+            gradients_values[x + (y * width) + (z * width * height)] = SobelFeldmanGradient(vol, x, y, z);
+    });
+    return gradients_values;
+  }
 
-    //4
-    //Creating Texture
+  gl::Texture3D* GenerateGradientTexture(glm::vec3* gradients_values, int width, int height, int depth)
+  {
     gl::Texture3D* tex3d_gradient = new gl::Texture3D(width, height, depth);
     tex3d_gradient->GenerateTexture(TEXTURE_FILTER, TEXTURE_FILTER, TEXTURE_WRAP, TEXTURE_WRAP, TEXTURE_WRAP);
 
@@ -343,9 +446,6 @@ namespace vis
     tex3d_gradient->SetData((GLvoid*)gradients_values, GL_RGB32F, GL_RGB, GL_FLOAT);
 #endif
 
-    delete[] gradients_values;
-    delete[] gradients;
-
     return tex3d_gradient;
   }
 
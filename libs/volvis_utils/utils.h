@@ -47,6 +47,24 @@ namespace vis
 
   gl::Texture3D* GenerateRTexture (StructuredGridVolume* vol, VIS_UTILS_DATA_TYPE vdatatype);
 
+  typedef struct VolumeUploadStatistics {
+    GLint internal_format;
+    // bytes of the texture, as sent to the driver
+    size_t upload_bytes;
+    // memory allocated for the upload: pixel unpack buffers and conversion
+    size_t staging_bytes;
+    double upload_ms;
+  } VolumeUploadStatistics;
+
+  // Same sampled values as GenerateRTexture, without converting the volume to float:
+  // . 8 and 16 bit volumes are uploaded as they are to normalized GL_R8 and GL_R16
+  // . float volumes to GL_R16F (GL_R32F without USE_16F_INTERNAL_FORMAT), double volumes
+  //   are converted to float one slab at a time
+  // The volume is streamed in slabs of at most max_slab_bytes (see gl::Texture3D::SetDataSlabs)
+  gl::Texture3D* GenerateNativeRTexture (StructuredGridVolume* vol,
+    size_t max_slab_bytes = 64 * 1024 * 1024,
+    VolumeUploadStatistics* stats = NULL);
+
   gl::Texture3D* GenerateGradientTexture (StructuredGridVolume* vol,
     int gradient_sample_size = 1,
     int filter_nxnxn = 0,
@@ -61,6 +79,13 @@ namespace vis
   // https://en.wikipedia.org/wiki/Sobel_operator  
   gl::Texture3D* GenerateSobelFeldmanGradientTexture (StructuredGridVolume* vol);
 
+  // CPU part of the gradient textures, without filtering, computed by slices on vis::TaskPool
+  // . width * height * depth values, deleted by the caller
+  glm::vec3* ComputeGradients (StructuredGridVolume* vol, int gradient_sample_size = 1, bool normalized_gradient = true);
+  glm::vec3* ComputeSobelFeldmanGradients (StructuredGridVolume* vol);
+  // Texture of the computed gradients, requires the context
+  gl::Texture3D* GenerateGradientTexture (glm::vec3* gradients, int width, int height, int depth);
+
   //https://stackoverflow.com/questions/1972172/interpolating-a-scalar-field-in-a-3d-space
   //https://www.ncbi.nlm.nih.gov/pmc/articles/PMC3719212/
 